@@ -0,0 +1,178 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: aggregate.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for aggregate.h
+
+	Outline:
+		Public Functions:
+			Aggregate
+			add
+			merge
+			getCount
+			getSum
+			getMean
+			getMinimum
+			getMaximum
+
+		Private Functions:
+			addToSum
+******************************************************************************/
+
+#include "aggregate.h"
+
+#include <cmath>
+#include <limits>
+
+using std::fabs;
+using std::isfinite;
+using std::numeric_limits;
+
+namespace day {
+
+	// Adds value to sum and the rounding error of the addition to compensation
+	static inline void addCompensated(double &sum, double &compensation, double value) {
+
+		double total = sum + value;
+		// Whichever operand is smaller in magnitude lost its low bits in the addition
+		double larger = fabs(sum) >= fabs(value) ? sum : value;
+		double smaller = fabs(sum) >= fabs(value) ? value : sum;
+
+		compensation += (larger - total) + smaller;
+		sum = total;
+	}
+
+	Aggregate::Aggregate(Summation summation) : summation(summation), count(0), sum(0), compensation(0),
+		minimum(numeric_limits<double>::infinity()), maximum(-numeric_limits<double>::infinity()) {
+	}
+
+	void Aggregate::add(const double *values, size_t count) {
+
+		// Four independent lanes, so each addition does not have to wait for the one before it. Lane 0 carries
+		// on from the sum so far and the lanes are always combined in the same order, so the result is still
+		// the same bits every time
+		double sums[LANES] = { sum, 0, 0, 0 };
+		double compensations[LANES] = { 0, 0, 0, 0 };
+		double minimums[LANES] = { minimum, minimum, minimum, minimum };
+		double maximums[LANES] = { maximum, maximum, maximum, maximum };
+		size_t end = count / LANES * LANES;
+
+		if (summation == Summation::COMPENSATED) {
+
+			for (size_t i = 0; i < end; i += LANES) {
+
+				for (int lane = 0; lane < LANES; lane++)
+					addCompensated(sums[lane], compensations[lane], values[i + lane]);
+			}
+
+			for (size_t i = end; i < count; i++)
+				addCompensated(sums[0], compensations[0], values[i]);
+		} else {
+
+			for (size_t i = 0; i < end; i += LANES) {
+
+				for (int lane = 0; lane < LANES; lane++)
+					sums[lane] += values[i + lane];
+			}
+
+			for (size_t i = end; i < count; i++)
+				sums[0] += values[i];
+		}
+
+		for (size_t i = 0; i < end; i += LANES) {
+
+			for (int lane = 0; lane < LANES; lane++) {
+
+				minimums[lane] = values[i + lane] < minimums[lane] ? values[i + lane] : minimums[lane];
+				maximums[lane] = values[i + lane] > maximums[lane] ? values[i + lane] : maximums[lane];
+			}
+		}
+
+		for (size_t i = end; i < count; i++) {
+
+			minimums[0] = values[i] < minimums[0] ? values[i] : minimums[0];
+			maximums[0] = values[i] > maximums[0] ? values[i] : maximums[0];
+		}
+
+		sum = sums[0];
+
+		for (int lane = 1; lane < LANES; lane++) {
+
+			addToSum(sums[lane]);
+			compensation += compensations[lane];
+			minimum = minimums[lane] < minimum ? minimums[lane] : minimum;
+			maximum = maximums[lane] > maximum ? maximums[lane] : maximum;
+		}
+
+		compensation += compensations[0];
+		minimum = minimums[0] < minimum ? minimums[0] : minimum;
+		maximum = maximums[0] > maximum ? maximums[0] : maximum;
+		this->count += count;
+	}
+
+	void Aggregate::merge(const Aggregate &other) {
+
+		addToSum(other.sum);
+
+		// Always 0 for NAIVE
+		compensation += other.compensation;
+		count += other.count;
+
+		if (other.minimum < minimum)
+			minimum = other.minimum;
+
+		if (other.maximum > maximum)
+			maximum = other.maximum;
+	}
+
+	size_t Aggregate::getCount() const {
+
+		return count;
+	}
+
+	double Aggregate::getSum() const {
+
+		// Once an infinite value is added the compensation is NaN from inf - inf, while the sum is already the answer
+		return isfinite(sum) ? sum + compensation : sum;
+	}
+
+	double Aggregate::getMean() const {
+
+		return count == 0 ? numeric_limits<double>::quiet_NaN() : getSum() / count;
+	}
+
+	double Aggregate::getMinimum() const {
+
+		return minimum;
+	}
+
+	double Aggregate::getMaximum() const {
+
+		return maximum;
+	}
+
+	void Aggregate::addToSum(double value) {
+
+		if (summation == Summation::COMPENSATED)
+			addCompensated(sum, compensation, value);
+		else
+			sum += value;
+	}
+}
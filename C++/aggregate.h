@@ -0,0 +1,189 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: aggregate.h
+
+	Author: Matthew Day
+
+	Class Name: Aggregate
+
+	Description:
+		The count, sum, minimum and maximum of a set of answers, built up a
+		block at a time so that answers can be reduced as soon as they are
+		evaluated instead of being written to an output column first.
+
+		The sum is either added up directly or with compensated summation
+		(Neumaier's variant of Kahan summation), which carries the rounding
+		error of each addition in a second double so that the result is as
+		accurate as adding in twice the precision. Aggregates of separate parts
+		of the rows can be merged, and merging the same parts in the same order
+		always gives the same bits.
+
+		A NaN answer makes the sum NaN but is skipped by the minimum and
+		maximum.
+
+	Outline:
+		Public Functions:
+			Aggregate
+			add
+			merge
+			getCount
+			getSum
+			getMean
+			getMinimum
+			getMaximum
+
+		Private Functions:
+			addToSum
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+using std::size_t;
+
+namespace day {
+
+	enum class Summation {
+
+		// Each answer is added to the sum in turn
+		NAIVE,
+		// The rounding error of every addition is kept and added back at the end
+		COMPENSATED
+	};
+
+	class Aggregate {
+
+	private:
+
+		// Number of partial sums kept while adding a block
+		static const int LANES = 4;
+
+		Summation summation;
+		size_t count;
+		double sum;
+		// Rounding error lost from sum so far, only used by COMPENSATED
+		double compensation;
+		double minimum;
+		double maximum;
+	public:
+
+		/******************************************************************************
+			Function Name: Aggregate
+
+			Des:
+				Creates an aggregate of no answers.
+
+			Params:
+				summation - type Summation, how the sum is added up.
+		******************************************************************************/
+		Aggregate(Summation summation = Summation::COMPENSATED);
+
+		/******************************************************************************
+			Function Name: add
+
+			Des:
+				Adds a block of answers.
+
+			Params:
+				values - type const double *, the answers.
+				count - type size_t, the number of answers in param values.
+		******************************************************************************/
+		void add(const double *values, size_t count);
+
+		/******************************************************************************
+			Function Name: merge
+
+			Des:
+				Adds the answers of another aggregate, as if they came after the
+					answers already added.
+
+			Params:
+				other - type const Aggregate &, the aggregate to be merged.
+		******************************************************************************/
+		void merge(const Aggregate &other);
+
+		/******************************************************************************
+			Function Name: getCount
+
+			Des:
+				Gets the number of answers.
+
+			Returns:
+				type size_t, the number of answers.
+		******************************************************************************/
+		size_t getCount() const;
+
+		/******************************************************************************
+			Function Name: getSum
+
+			Des:
+				Gets the sum of the answers.
+
+			Returns:
+				type double, the sum, 0 if there are no answers. Infinite answers give
+					an infinite or NaN sum like plain summation.
+		******************************************************************************/
+		double getSum() const;
+
+		/******************************************************************************
+			Function Name: getMean
+
+			Des:
+				Gets the mean of the answers.
+
+			Returns:
+				type double, the mean, NaN if there are no answers.
+		******************************************************************************/
+		double getMean() const;
+
+		/******************************************************************************
+			Function Name: getMinimum
+
+			Des:
+				Gets the smallest answer.
+
+			Returns:
+				type double, the smallest answer, infinity if there are none.
+		******************************************************************************/
+		double getMinimum() const;
+
+		/******************************************************************************
+			Function Name: getMaximum
+
+			Des:
+				Gets the largest answer.
+
+			Returns:
+				type double, the largest answer, -infinity if there are none.
+		******************************************************************************/
+		double getMaximum() const;
+	private:
+
+		/******************************************************************************
+			Function Name: addToSum
+
+			Des:
+				Adds a single value to the sum, keeping its rounding error when the
+					sum is compensated.
+
+			Params:
+				value - type double, the value to be added.
+		******************************************************************************/
+		void addToSum(double value);
+	};
+}
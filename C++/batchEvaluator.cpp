@@ -0,0 +1,397 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: batchEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for batchEvaluator.h
+
+	Outline:
+		Public Functions:
+			BatchEvaluator
+			BatchEvaluator
+			evaluate
+			evaluate
+			evaluate
+			aggregate
+			aggregate
+			select
+			select
+			filter
+
+		Private Functions
+			prepare
+			gatherBlock
+			evaluateBlock
+			evaluateBlock
+******************************************************************************/
+
+#include "batchEvaluator.h"
+
+namespace day {
+
+	BatchEvaluator::BatchEvaluator() {
+	}
+
+	BatchEvaluator::BatchEvaluator(InstructionSet instructionSet) : kernels(instructionSet) {
+	}
+
+	void BatchEvaluator::evaluate(const CompiledExpression &expression, const double *const *columns, double *output, size_t rows) {
+
+		prepare(expression, columns);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, columns, first, count, output + first);
+		}
+	}
+
+	void BatchEvaluator::evaluate(const CompiledExpression &expression, const double *const *columns, const size_t *selection, size_t count, double *output) {
+
+		prepare(expression, columns);
+
+		for (size_t first = 0; first < count; first += BLOCK_SIZE) {
+
+			int blockCount = count - first < BLOCK_SIZE ? count - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, gatherBlock(expression, columns, selection + first, blockCount), 0, blockCount, output + first);
+		}
+	}
+
+	void BatchEvaluator::evaluate(const MultiExpression &expression, const double *const *columns, double *const *outputs, size_t rows) {
+
+		if ((columns == nullptr && expression.getVariableCount() > 0) || (outputs == nullptr && expression.getEquationCount() > 0))
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		for (int i = 0; i < expression.getVariableCount(); i++) {
+
+			if (columns[i] == nullptr)
+				throw invalid_argument("Not every variable has a column bound to it");
+		}
+
+		for (int i = 0; i < expression.getEquationCount(); i++) {
+
+			if (outputs[i] == nullptr)
+				throw invalid_argument("Not every equation has an output bound to it");
+		}
+
+		// Only grows, like the scratch space of a CompiledExpression
+		if (scratch.size() < (size_t)expression.getSlotCount() * BLOCK_SIZE)
+			scratch.resize((size_t)expression.getSlotCount() * BLOCK_SIZE);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, columns, outputs, first, count);
+		}
+	}
+
+	void BatchEvaluator::aggregate(const CompiledExpression &expression, const double *const *columns, size_t rows, Aggregate &result) {
+
+		prepare(expression, columns);
+
+		if (blockAnswers.empty())
+			blockAnswers.resize(BLOCK_SIZE);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, columns, first, count, blockAnswers.data());
+			result.add(blockAnswers.data(), count);
+		}
+	}
+
+	void BatchEvaluator::aggregate(const CompiledExpression &expression, const double *const *columns, const size_t *selection, size_t count, Aggregate &result) {
+
+		prepare(expression, columns);
+
+		if (blockAnswers.empty())
+			blockAnswers.resize(BLOCK_SIZE);
+
+		for (size_t first = 0; first < count; first += BLOCK_SIZE) {
+
+			int blockCount = count - first < BLOCK_SIZE ? count - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, gatherBlock(expression, columns, selection + first, blockCount), 0, blockCount, blockAnswers.data());
+			result.add(blockAnswers.data(), blockCount);
+		}
+	}
+
+	size_t BatchEvaluator::select(const CompiledExpression &predicate, const double *const *columns, size_t rows, size_t *selection) {
+
+		size_t result = 0;
+
+		prepare(predicate, columns);
+
+		if (blockAnswers.empty())
+			blockAnswers.resize(BLOCK_SIZE);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(predicate, columns, first, count, blockAnswers.data());
+
+			// Every row is written and only kept when it passes, so there is no branch to mispredict
+			for (int i = 0; i < count; i++) {
+
+				selection[result] = first + i;
+				result += blockAnswers[i] != 0;
+			}
+		}
+
+		return result;
+	}
+
+	size_t BatchEvaluator::select(const CompiledExpression &predicate, const double *const *columns, const size_t *selection, size_t count, size_t *result) {
+
+		size_t passed = 0;
+
+		prepare(predicate, columns);
+
+		if (blockAnswers.empty())
+			blockAnswers.resize(BLOCK_SIZE);
+
+		for (size_t first = 0; first < count; first += BLOCK_SIZE) {
+
+			int blockCount = count - first < BLOCK_SIZE ? count - first : BLOCK_SIZE;
+
+			evaluateBlock(predicate, gatherBlock(predicate, columns, selection + first, blockCount), 0, blockCount, blockAnswers.data());
+
+			// A row is never written past where it is read, so param result may be the same as param selection
+			for (int i = 0; i < blockCount; i++) {
+
+				result[passed] = selection[first + i];
+				passed += blockAnswers[i] != 0;
+			}
+		}
+
+		return passed;
+	}
+
+	void BatchEvaluator::filter(const CompiledExpression &predicate, const double *const *columns, size_t rows, uint64_t *bitmap) {
+
+		prepare(predicate, columns);
+
+		if (blockAnswers.empty())
+			blockAnswers.resize(BLOCK_SIZE);
+
+		// BLOCK_SIZE is a multiple of 64, so every block starts at the first bit of a word
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(predicate, columns, first, count, blockAnswers.data());
+
+			for (int i = 0; i < count; i += 64) {
+
+				uint64_t word = 0;
+				int bits = count - i < 64 ? count - i : 64;
+
+				for (int j = 0; j < bits; j++)
+					word |= (uint64_t)(blockAnswers[i + j] != 0) << j;
+
+				bitmap[(first + i) / 64] = word;
+			}
+		}
+	}
+
+	void BatchEvaluator::prepare(const CompiledExpression &expression, const double *const *columns) {
+
+		if (columns == nullptr && expression.getVariableCount() > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		for (int i = 0; i < expression.getVariableCount(); i++) {
+
+			if (columns[i] == nullptr)
+				throw invalid_argument("Not every variable has a column bound to it");
+		}
+
+		// Only grows, so an evaluator that is reused does not allocate again. Checked apart from each other, since
+		// evaluating a MultiExpression grows the scratch space without using the operand stack
+		if (scratch.size() < (size_t)expression.getMaxStackDepth() * BLOCK_SIZE)
+			scratch.resize((size_t)expression.getMaxStackDepth() * BLOCK_SIZE);
+
+		if (operandStack.size() < (size_t)expression.getMaxStackDepth())
+			operandStack.resize(expression.getMaxStackDepth());
+	}
+
+	const double *const *BatchEvaluator::gatherBlock(const CompiledExpression &expression, const double *const *columns, const size_t *selection, int count) {
+
+		int variableCount = expression.getVariableCount();
+
+		// Only grows, like the scratch space
+		if (gathered.size() < (size_t)variableCount * BLOCK_SIZE) {
+
+			gathered.resize((size_t)variableCount * BLOCK_SIZE);
+			gatheredColumns.resize(variableCount);
+		}
+
+		for (int j = 0; j < variableCount; j++) {
+
+			double *column = gathered.data() + (size_t)j * BLOCK_SIZE;
+
+			for (int i = 0; i < count; i++)
+				column[i] = columns[j][selection[i]];
+
+			gatheredColumns[j] = column;
+		}
+
+		return gatheredColumns.data();
+	}
+
+	void BatchEvaluator::evaluateBlock(const CompiledExpression &expression, const double *const *columns, size_t first, int count, double *output) {
+
+		const vector<Token> &postFix = expression.getPostFix();
+		const vector<double> &values = expression.getValues();
+		// Number of operands on the stack, the top operand is operandStack[depth - 1]
+		int depth = 0;
+
+		for (const Token &token : postFix) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = { nullptr, values[token.index], true };
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					// Columns are read in place instead of being copied to the stack
+					operandStack[depth++] = { columns[token.index] + first, 0, false };
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack[depth++] = { nullptr, -1, true };
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER:
+				case Opcode::SQUARE_ROOT:
+				case Opcode::MODULO_POWER_OF_TWO: {
+
+					Operand &top = operandStack[depth - 1];
+					// Integer operand kept in the token, only used by some unary operators
+					double tokenOperand = token.index;
+
+					if (top.isScalar) {
+
+						kernels.apply(token.opcode, &top.scalar, true, &tokenOperand, true, &top.scalar, 1);
+					} else {
+
+						double *result = scratch.data() + (size_t)(depth - 1) * BLOCK_SIZE;
+
+						kernels.apply(token.opcode, top.data, false, &tokenOperand, true, result, count);
+						top = { result, 0, false };
+					}
+
+					break;
+				}
+				default:
+
+					// Every other opcode left by validatePostFix is a binary operator
+					Operand &left = operandStack[depth - 2];
+					const Operand &right = operandStack[depth - 1];
+
+					if (left.isScalar && right.isScalar) {
+
+						// Values shared by every row stay a single value
+						kernels.apply(token.opcode, &left.scalar, true, &right.scalar, true, &left.scalar, 1);
+					} else {
+
+						double *result = scratch.data() + (size_t)(depth - 2) * BLOCK_SIZE;
+
+						kernels.apply(token.opcode, left.isScalar ? &left.scalar : left.data, left.isScalar, right.isScalar ? &right.scalar : right.data, right.isScalar, result, count);
+						left = { result, 0, false };
+					}
+
+					depth--;
+			};
+		}
+
+		if (operandStack[0].isScalar) {
+
+			for (int i = 0; i < count; i++)
+				output[i] = operandStack[0].scalar;
+		} else {
+
+			for (int i = 0; i < count; i++)
+				output[i] = operandStack[0].data[i];
+		}
+	}
+
+	void BatchEvaluator::evaluateBlock(const MultiExpression &expression, const double *const *columns, double *const *outputs, size_t first, int count) {
+
+		const vector<double> &values = expression.getValues();
+
+		// Where an operand of this block is read from, only VALUE operands are shared by every row
+		auto read = [&](const MultiExpression::Operand &operand) -> const double * {
+
+			switch (operand.source) {
+
+				case MultiExpression::Source::VALUE:
+
+					return &values[operand.index];
+				case MultiExpression::Source::VARIABLE:
+
+					return columns[operand.index] + first;
+				case MultiExpression::Source::SCRATCH:
+
+					return scratch.data() + (size_t)operand.index * BLOCK_SIZE;
+				default:
+
+					return outputs[operand.index] + first;
+			}
+		};
+
+		for (const MultiExpression::Step &step : expression.getSteps()) {
+
+			// Operators on values only were folded when compiled, so every result is a block
+			double *result = step.result.source == MultiExpression::Source::SCRATCH ? scratch.data() + (size_t)step.result.index * BLOCK_SIZE : outputs[step.result.index] + first;
+
+			kernels.apply(step.opcode, read(step.left), step.left.source == MultiExpression::Source::VALUE, read(step.right), step.right.source == MultiExpression::Source::VALUE, result, count);
+		}
+
+		// Answers that are a value, a column or the output of an earlier equation are copied
+		for (int i = 0; i < expression.getEquationCount(); i++) {
+
+			const MultiExpression::Operand &answer = expression.getAnswers()[i];
+			double *output = outputs[i] + first;
+
+			if (answer.source == MultiExpression::Source::OUTPUT && answer.index == i)
+				continue;
+
+			if (answer.source == MultiExpression::Source::VALUE) {
+
+				for (int j = 0; j < count; j++)
+					output[j] = values[answer.index];
+			} else {
+
+				const double *source = read(answer);
+
+				for (int j = 0; j < count; j++)
+					output[j] = source[j];
+			}
+		}
+	}
+}
@@ -0,0 +1,390 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: batchEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: BatchEvaluator
+
+	Description:
+		Evaluates a compiled equation over many rows at once. Each variable is
+		given as a column of values and the answers are written to an output
+		column. The rows are split into blocks of BLOCK_SIZE and the post-fix
+		equation is run one operator at a time over a whole block, so each
+		opcode is dispatched once per block instead of once per row and the
+		intermediate blocks stay in the L1 cache. The operators run on the
+		SimdKernels of the widest instruction set the CPU supports.
+
+		aggregate reduces the answers of each block as soon as the block is
+		evaluated, so answers that are only summed never go to memory.
+
+		Rows can be filtered by a predicate such as (a*b) > 100 & c != 0, where
+		a row passes when the answer is not 0. select writes the rows that
+		pass to a selection vector and filter writes them to a bitmap. evaluate,
+		aggregate and select also take a selection vector, and then only the
+		selected rows are evaluated. Their values are gathered into a block of
+		each column first, so the operators still run over whole blocks and an
+		expensive equation is never evaluated for rows that were filtered out.
+
+		A MultiExpression is evaluated by running its steps over each block,
+		writing to one output column for each of its equations.
+
+		An evaluator reuses its scratch space between calls, so each thread
+		should use its own evaluator.
+
+	Outline:
+		Public Functions:
+			BatchEvaluator
+			BatchEvaluator
+			evaluate
+			evaluate
+			evaluate
+			aggregate
+			aggregate
+			select
+			select
+			filter
+
+		Private Functions
+			prepare
+			gatherBlock
+			evaluateBlock
+			evaluateBlock
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "aggregate.h"
+#include "compiledExpression.h"
+#include "multiExpression.h"
+#include "simdKernels.h"
+#include "token.h"
+
+using std::vector;
+using std::size_t;
+using std::uint64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	class BatchEvaluator {
+
+	public:
+
+		// Number of rows evaluated together, small enough for every operand block to stay in the L1 cache
+		static const int BLOCK_SIZE = 1024;
+	private:
+
+		// An entry on the operand stack, either a single value shared by every row or a block of values
+		struct Operand {
+
+			const double *data;
+			double scalar;
+			bool isScalar;
+		};
+
+		// One block of BLOCK_SIZE values for each level of the operand stack
+		vector<double> scratch;
+		vector<Operand> operandStack;
+		// Answers of a single block, reduced by aggregate while they are still in the L1 cache
+		vector<double> blockAnswers;
+		// The selected rows of each column, one block for each variable slot
+		vector<double> gathered;
+		vector<const double *> gatheredColumns;
+		SimdKernels kernels;
+	public:
+
+		/******************************************************************************
+			Function Name: BatchEvaluator
+
+			Des:
+				Uses the widest instruction set supported by the CPU.
+		******************************************************************************/
+		BatchEvaluator();
+
+		/******************************************************************************
+			Function Name: BatchEvaluator
+
+			Des:
+				Uses the given instruction set if the CPU supports it.
+
+			Params:
+				instructionSet - type InstructionSet, the requested instruction set.
+		******************************************************************************/
+		BatchEvaluator(InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for every row.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				output - type double *, output column to get the answer for each row.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void evaluate(const CompiledExpression &expression, const double *const *columns, double *output, size_t rows);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for the selected rows only.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				selection - type const size_t *, the rows to be evaluated, as
+					returned by select.
+				count - type size_t, the number of rows in param selection.
+				output - type double *, output to get the answer for each selected
+					row, in the order of param selection.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void evaluate(const CompiledExpression &expression, const double *const *columns, const size_t *selection, size_t count, double *output);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates every equation of a MultiExpression for every row, in one
+					pass over the columns.
+
+			Params:
+				expression - type const MultiExpression &, the equations to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				outputs - type double * const *, one output column for each equation
+					to get the answer for each row. An output may not be one of the
+					param columns.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if a column or output is missing.
+		******************************************************************************/
+		void evaluate(const MultiExpression &expression, const double *const *columns, double *const *outputs, size_t rows);
+
+		/******************************************************************************
+			Function Name: aggregate
+
+			Des:
+				Evaluates the equation for every row and adds the answers to an
+					aggregate a block at a time, without writing them to an output
+					column.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				rows - type size_t, the number of rows.
+				result - type Aggregate &, the answers are added to it.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void aggregate(const CompiledExpression &expression, const double *const *columns, size_t rows, Aggregate &result);
+
+		/******************************************************************************
+			Function Name: aggregate
+
+			Des:
+				Evaluates the equation for the selected rows only and adds the
+					answers to an aggregate.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				selection - type const size_t *, the rows to be evaluated, as
+					returned by select.
+				count - type size_t, the number of rows in param selection.
+				result - type Aggregate &, the answers are added to it.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void aggregate(const CompiledExpression &expression, const double *const *columns, const size_t *selection, size_t count, Aggregate &result);
+
+		/******************************************************************************
+			Function Name: select
+
+			Des:
+				Finds the rows where the answer to the predicate is not 0.
+
+			Params:
+				predicate - type const CompiledExpression &, the equation deciding
+					which rows pass. Example input: (a*b) > 100 & c != 0.
+				columns - type const double * const *, one column for each variable
+					slot of param predicate, each holding param rows values.
+				rows - type size_t, the number of rows.
+				selection - type size_t *, output to get the rows that pass in
+					ascending order, must hold param rows values.
+
+			Returns:
+				type size_t, the number of rows that pass.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		size_t select(const CompiledExpression &predicate, const double *const *columns, size_t rows, size_t *selection);
+
+		/******************************************************************************
+			Function Name: select
+
+			Des:
+				Finds the selected rows where the answer to the predicate is not 0,
+					only evaluating the predicate for the selected rows. Used to
+					apply one filter after another.
+
+			Params:
+				predicate - type const CompiledExpression &, the equation deciding
+					which rows pass.
+				columns - type const double * const *, one column for each variable
+					slot of param predicate.
+				selection - type const size_t *, the rows to be checked, as returned
+					by select.
+				count - type size_t, the number of rows in param selection.
+				result - type size_t *, output to get the rows that pass in the order
+					of param selection, must hold param count values. May be the
+					same as param selection.
+
+			Returns:
+				type size_t, the number of rows that pass.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		size_t select(const CompiledExpression &predicate, const double *const *columns, const size_t *selection, size_t count, size_t *result);
+
+		/******************************************************************************
+			Function Name: filter
+
+			Des:
+				Evaluates the predicate for every row and sets a bit for each row
+					where the answer is not 0.
+
+			Params:
+				predicate - type const CompiledExpression &, the equation deciding
+					which rows pass.
+				columns - type const double * const *, one column for each variable
+					slot of param predicate, each holding param rows values.
+				rows - type size_t, the number of rows.
+				bitmap - type uint64_t *, output to get row i in bit i % 64 of word
+					i / 64, like the columns of BitSlicedEvaluator. Must hold
+					(rows + 63) / 64 words, bits past the last row are 0.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void filter(const CompiledExpression &predicate, const double *const *columns, size_t rows, uint64_t *bitmap);
+
+	private:
+
+		/******************************************************************************
+			Function Name: prepare
+
+			Des:
+				Checks the columns and grows the scratch space for the equation.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void prepare(const CompiledExpression &expression, const double *const *columns);
+
+		/******************************************************************************
+			Function Name: gatherBlock
+
+			Des:
+				Copies the values of the selected rows of each column next to each
+					other, so they can be evaluated as a single block.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				selection - type const size_t *, the rows of the block.
+				count - type int, the number of rows in the block.
+
+			Returns:
+				type const double * const *, one gathered column for each variable
+					slot, holding param count values.
+		******************************************************************************/
+		const double *const *gatherBlock(const CompiledExpression &expression, const double *const *columns, const size_t *selection, int count);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Evaluates the equation for a single block of rows.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				first - type size_t, the first row of the block.
+				count - type int, the number of rows in the block.
+				output - type double *, output to get the answer for each row of the
+					block.
+		******************************************************************************/
+		void evaluateBlock(const CompiledExpression &expression, const double *const *columns, size_t first, int count, double *output);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Runs the steps of a MultiExpression over one block of rows.
+
+			Params:
+				expression - type const MultiExpression &, the equations to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				outputs - type double * const *, one output column for each equation.
+				first - type size_t, the first row of the block.
+				count - type int, the number of rows in the block.
+		******************************************************************************/
+		void evaluateBlock(const MultiExpression &expression, const double *const *columns, double *const *outputs, size_t first, int count);
+	};
+}
@@ -0,0 +1,3442 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <charconv>
+#include <memory>
+#include <functional>
+#include <stack>
+
+#include "reversePolishNotation.h"
+#include "compiledExpression.h"
+#include "batchEvaluator.h"
+#include "parallelEvaluator.h"
+#include "expressionCache.h"
+#include "registerMachine.h"
+#include "jitExpression.h"
+#include "constexprExpression.h"
+#include "columnReader.h"
+#include "bitSlicedEvaluator.h"
+#include "boolExpression.h"
+#include "stringUtils.h"
+#include "formulaGraph.h"
+#include "multiExpression.h"
+#include "dualEvaluator.h"
+#include "typedExpression.h"
+#include "typedBatchEvaluator.h"
+
+using namespace std;
+using namespace day;
+
+// Equations used by every benchmark, a mix of short and long equations
+const vector<string> EQUATIONS = {
+	"1+2",
+	"3+4*2/(1-5)^2",
+	"-(2.5+3.75)*2(4)-10%3",
+	"(1.5*2.25+3.125/4-5.5)^2*(6.75-7.5/8.25)+9.125*(10.5-11.25*12.75)/13.5",
+	"((((1+2)*3-4)/5+6)*7-8)/9+((10-11)*12+13)/14-15*16+17-18*19/20"
+};
+
+// Keeps the optimizer from removing the work being measured
+volatile double sink;
+
+// Number of checks that did not hold, main returns 1 when any did not
+int failures = 0;
+
+// Records a check that must hold, printing it when it does not
+void expect(bool condition, const string &description) {
+
+	if (!condition) {
+
+		failures++;
+		cout << "\tFAILED: " << description << endl;
+	}
+}
+
+double nanosecondsSince(chrono::steady_clock::time_point start) {
+
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// Largest difference in ulps allowed between OptimizationLevel::FAST and NONE, which may round differently
+const long long FAST_ULPS = 64;
+
+// NaN results only have to agree on being NaN, since the sign of a NaN is not part of its value
+bool isSame(double a, double b) {
+
+	return memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+}
+
+// Number of representable doubles between two finite values of the same sign
+long long ulpDistance(double a, double b) {
+
+	long long bitsA, bitsB;
+
+	memcpy(&bitsA, &a, sizeof(double));
+	memcpy(&bitsB, &b, sizeof(double));
+
+	return bitsA > bitsB ? bitsA - bitsB : bitsB - bitsA;
+}
+
+// Largest difference in ulps allowed between '^' under AVX2 or AVX-512, which works out pow with tables, and pow
+const long long POWER_ULPS = 1;
+
+// Answers of BatchEvaluator are the same as evaluate, except that '^' may differ by POWER_ULPS under AVX2 and AVX-512
+bool isSameBatch(double batch, double expected, const string &equation, InstructionSet instructionSet) {
+
+	if (isSame(batch, expected))
+		return true;
+
+	if (equation.find('^') == string::npos || (instructionSet != InstructionSet::AVX2 && instructionSet != InstructionSet::AVX512))
+		return false;
+
+	return isfinite(batch) && isfinite(expected) && signbit(batch) == signbit(expected) && ulpDistance(batch, expected) <= POWER_ULPS;
+}
+
+// The string based getNumber that parseNumber replaced, kept for comparison
+double legacyGetNumber(const char *data, int length, int start, int &end) {
+
+	string number = "";
+	int pos = start;
+
+	if (data[start] == '-') {
+
+		number.push_back('-');
+		pos++;
+	}
+
+	end = length - 1;
+
+	for (int i = pos; i < length; i++) {
+
+		if (isdigit(data[i]) || data[i] == '.')
+			number.push_back(data[i]);
+		else {
+
+			end = i - 1;
+			break;
+		}
+	}
+
+	return stod(number);
+}
+
+// The string tokens that the typed token stream replaced, kept for comparison. Each number becomes '`' and
+//		its index, a '-' before '(' becomes '~*', and the post-fix equation is a string of the same characters
+const char LEGACY_ARG_PREFIX = '`';
+const char LEGACY_NEGATIVE_ONE_VALUE = '~';
+
+bool legacyIsOperator(char value) {
+
+	return value == '(' || value == ')' || value == '^' || value == '*' || value == '/' || value == '%' || value == '+' || value == '-';
+}
+
+int legacyGetPrecedenceLevel(char curOperator) {
+
+	switch (curOperator) {
+
+		case '+':
+		case '-':
+
+			return 1;
+		case '*':
+		case '/':
+		case '%':
+
+			return 2;
+		case '^':
+
+			return 3;
+		default:
+
+			return 0;
+	};
+}
+
+string legacyStripValuesFromEquation(const char *equation, int length, vector<double> &values) {
+
+	string result = "";
+	int endPos;
+	int nextArgument = 0;
+
+	for (int i = 0; i < length; i++) {
+
+		if (isblank(equation[i]))
+			continue;
+
+		if (equation[i] == '-' && (i == 0 || (legacyIsOperator(equation[i - 1]) && equation[i - 1] != ')'))) {
+
+			if (equation[i + 1] == '(') {
+
+				result.push_back(LEGACY_NEGATIVE_ONE_VALUE);
+				result.push_back('*');
+			} else {
+
+				result.append(LEGACY_ARG_PREFIX + to_string(nextArgument++));
+				values.push_back(legacyGetNumber(equation, length, i, endPos));
+				i = endPos;
+			}
+		} else if (isdigit(equation[i]) || equation[i] == '.') {
+
+			result.append(LEGACY_ARG_PREFIX + to_string(nextArgument++));
+			values.push_back(legacyGetNumber(equation, length, i, endPos));
+			i = endPos;
+		} else if (equation[i] == '(' && i > 0 && isdigit(equation[i - 1])) {
+
+			result.push_back('*');
+			result.push_back(equation[i]);
+		} else if (equation[i] == ')' && i + 1 != length && isdigit(equation[i + 1])) {
+
+			result.push_back(equation[i]);
+			result.push_back('*');
+		} else
+			result.push_back(equation[i]);
+	}
+
+	return result;
+}
+
+string legacyConvertInfixToPostFix(const char *equation, int length) {
+
+	stack<char> operatorStack;
+	string postFixString;
+
+	for (int i = 0; i < length; i++) {
+
+		if (!legacyIsOperator(equation[i])) {
+
+			postFixString += equation[i];
+		} else if (equation[i] == '(') {
+
+			operatorStack.push(equation[i]);
+		} else if (equation[i] == ')') {
+
+			while (!operatorStack.empty() && operatorStack.top() != '(') {
+
+				postFixString += operatorStack.top();
+				operatorStack.pop();
+			}
+
+			if (!operatorStack.empty())
+				operatorStack.pop();
+		} else {
+
+			while (!operatorStack.empty() && legacyGetPrecedenceLevel(operatorStack.top()) >= legacyGetPrecedenceLevel(equation[i])) {
+
+				postFixString += operatorStack.top();
+				operatorStack.pop();
+			}
+
+			operatorStack.push(equation[i]);
+		}
+	}
+
+	while (!operatorStack.empty()) {
+
+		if (operatorStack.top() != '(')
+			postFixString += operatorStack.top();
+
+		operatorStack.pop();
+	}
+
+	return postFixString;
+}
+
+double legacyCalcResult(const char *equation, int length, const vector<double> &values) {
+
+	stack<double> operandStack;
+	double num1, num2;
+
+	for (int i = 0; i < length; i++) {
+
+		if (equation[i] == LEGACY_NEGATIVE_ONE_VALUE) {
+
+			operandStack.push(-1);
+		} else if (equation[i] == LEGACY_ARG_PREFIX) {
+
+			// The index of the value is read back from the text
+			operandStack.push(values[(int)legacyGetNumber(equation, length, i + 1, i)]);
+		} else {
+
+			num2 = operandStack.top();
+			operandStack.pop();
+			num1 = operandStack.top();
+			operandStack.pop();
+
+			switch (equation[i]) {
+
+				case '+':
+
+					operandStack.push(num1 + num2);
+					break;
+				case '-':
+
+					operandStack.push(num1 - num2);
+					break;
+				case '*':
+
+					operandStack.push(num1 * num2);
+					break;
+				case '/':
+
+					operandStack.push(num1 / num2);
+					break;
+				case '%':
+
+					operandStack.push((int)num1 % (int)num2);
+					break;
+				default:
+
+					operandStack.push(pow(num1, num2));
+			};
+		}
+	}
+
+	return operandStack.top();
+}
+
+// Reports the cost per token of each stage of evaluateEquation, with the string tokens it replaced and the typed tokens
+void benchmarkTokenStream() {
+
+	const int ITERATIONS = 200000;
+
+	ReversePolishNotation rpn;
+	double stripTime = 0, convertTime = 0, calcTime = 0;
+	double legacyStripTime = 0, legacyConvertTime = 0, legacyCalcTime = 0;
+	long long tokens = 0;
+	int mismatches = 0;
+
+	for (const string &equation : EQUATIONS) {
+
+		vector<double> values;
+		vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), values);
+		vector<Token> postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+		vector<double> legacyValues;
+		string legacyInfix = legacyStripValuesFromEquation(equation.c_str(), equation.size(), legacyValues);
+		string legacyPostFix = legacyConvertInfixToPostFix(legacyInfix.c_str(), legacyInfix.size());
+
+		if (legacyCalcResult(legacyPostFix.c_str(), legacyPostFix.size(), legacyValues) != rpn.calcResult(postFix.data(), postFix.size(), values))
+			mismatches++;
+
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++) {
+
+			values.clear();
+			sink = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), values).size();
+		}
+
+		stripTime += nanosecondsSince(start);
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sink = rpn.convertInfixToPostFix(infix.data(), infix.size()).size();
+
+		convertTime += nanosecondsSince(start);
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sink = rpn.calcResult(postFix.data(), postFix.size(), values);
+
+		calcTime += nanosecondsSince(start);
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++) {
+
+			legacyValues.clear();
+			sink = legacyStripValuesFromEquation(equation.c_str(), equation.size(), legacyValues).size();
+		}
+
+		legacyStripTime += nanosecondsSince(start);
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sink = legacyConvertInfixToPostFix(legacyInfix.c_str(), legacyInfix.size()).size();
+
+		legacyConvertTime += nanosecondsSince(start);
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sink = legacyCalcResult(legacyPostFix.c_str(), legacyPostFix.size(), legacyValues);
+
+		legacyCalcTime += nanosecondsSince(start);
+		tokens += (long long)infix.size() * ITERATIONS;
+	}
+
+	cout << "Token stream (ns per token, string tokens then typed tokens)" << endl;
+	cout << "\tstripValuesFromEquation: " << legacyStripTime / tokens << "\t" << stripTime / tokens << endl;
+	cout << "\tconvertInfixToPostFix:   " << legacyConvertTime / tokens << "\t" << convertTime / tokens << endl;
+	cout << "\tcalcResult:              " << legacyCalcTime / tokens << "\t" << calcTime / tokens << endl;
+	cout << "\t" << mismatches << " mismatches" << endl;
+}
+
+// Reports the cost of evaluating an equation that was compiled once
+void benchmarkCompiledEvaluation() {
+
+	const int ITERATIONS = 1000000;
+
+	cout << "Compiled evaluation (ns per evaluation)" << endl;
+
+	for (const string &equation : EQUATIONS) {
+
+		CompiledExpression expression(equation.c_str(), equation.size());
+		vector<double> variables;
+		double sum = 0;
+
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sum += expression.evaluate(variables);
+
+		sink = sum;
+
+		cout << "	" << nanosecondsSince(start) / ITERATIONS << "\t" << equation << endl;
+	}
+}
+
+// Compares evaluating each row on its own with evaluating blocks of rows
+void benchmarkBatchEvaluation() {
+
+	const int ROWS = 1000000;
+	const vector<string> FORMULAS = { "price*qty-fee", "(price-fee)*qty/(1+fee)^2-price%7*qty" };
+
+	vector<double> price(ROWS), qty(ROWS), fee(ROWS), output(ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		price[i] = 1 + i % 997 * 0.25;
+		qty[i] = 1 + i % 13;
+		fee[i] = i % 7 * 0.125;
+	}
+
+	cout << "Batch evaluation (ns per row)" << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		CompiledExpression expression(formula.c_str(), formula.size());
+		BatchEvaluator evaluator;
+		vector<double> variables(3);
+		vector<const double *> columns;
+
+		for (const string &name : expression.getVariableNames())
+			columns.push_back(name == "price" ? price.data() : name == "qty" ? qty.data() : fee.data());
+
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ROWS; i++) {
+
+			for (int j = 0; j < expression.getVariableCount(); j++)
+				variables[j] = columns[j][i];
+
+			output[i] = expression.evaluate(variables);
+		}
+
+		double rowTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+		evaluator.evaluate(expression, columns.data(), output.data(), ROWS);
+
+		double batchTime = nanosecondsSince(start);
+
+		sink = output[ROWS - 1];
+
+		cout << "\t" << formula << endl;
+		cout << "\t\tevaluate per row: " << rowTime / ROWS << endl;
+		cout << "\t\tBatchEvaluator:   " << batchTime / ROWS << endl;
+	}
+}
+
+// Reports the throughput of BatchEvaluator at each instruction set level and checks that every level matches calcResult bit-for-bit,
+//		apart from the last bit of '^' under AVX2 and AVX-512
+void benchmarkInstructionSets() {
+
+	const int ROWS = 1000000;
+	const vector<string> FORMULAS = { "a*b+c-a/b", "a%b-c%7+(a-c)%b", "a^2+b^-1*c^0-c^1", "a^b", "b^1.5+b^c", "(b/3)^(a/100)" };
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+	vector<double> a(ROWS), b(ROWS), c(ROWS), output(ROWS), expected(ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		a[i] = (i % 2001 - 1000) * 0.37;
+		b[i] = 1 + i % 29 * 0.5;
+		c[i] = -(i % 101) * 1.25;
+	}
+
+	cout << "Instruction sets (million rows per second), detected " << SimdKernels::getInstructionSetName(SimdKernels::detectInstructionSet()) << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		CompiledExpression expression(formula.c_str(), formula.size());
+		vector<const double *> columns;
+		vector<double> variables(3);
+
+		for (const string &name : expression.getVariableNames())
+			columns.push_back(name == "a" ? a.data() : name == "b" ? b.data() : c.data());
+
+		for (int i = 0; i < ROWS; i++) {
+
+			for (int j = 0; j < expression.getVariableCount(); j++)
+				variables[j] = columns[j][i];
+
+			expected[i] = expression.evaluate(variables);
+		}
+
+		cout << "\t" << formula << endl;
+
+		for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+			BatchEvaluator evaluator(instructionSet);
+			int mismatches = 0, differences = 0;
+			long long maxUlps = 0;
+
+			// Levels the CPU does not support fall back to a narrower one, so they are skipped
+			if (SimdKernels(instructionSet).getInstructionSet() != instructionSet)
+				continue;
+
+			auto start = chrono::steady_clock::now();
+
+			evaluator.evaluate(expression, columns.data(), output.data(), ROWS);
+
+			double time = nanosecondsSince(start);
+
+			for (int i = 0; i < ROWS; i++) {
+
+				if (isSame(output[i], expected[i]))
+					continue;
+
+				if (isSameBatch(output[i], expected[i], formula, instructionSet)) {
+
+					differences++;
+					maxUlps = max(maxUlps, ulpDistance(output[i], expected[i]));
+				}
+				else
+					mismatches++;
+			}
+
+			cout << "\t\t" << SimdKernels::getInstructionSetName(instructionSet) << ": " << ROWS / time * 1000 << ", " << mismatches << " mismatches, ";
+			cout << differences << " last bit differences, " << maxUlps << " ulps" << endl;
+
+			expect(mismatches == 0, formula + " on " + SimdKernels::getInstructionSetName(instructionSet) + " differs from calcResult");
+		}
+	}
+}
+
+// Fails the run when '^' of an instruction set differs from pow by more than POWER_ULPS, including when the answers
+//		are written over x or y as BatchEvaluator does with its scratch space
+void testPower() {
+
+	// Not a multiple of any width, so every kernel also leaves values for the plain loop
+	const int ROWS = 4099;
+	const double INFINITE = numeric_limits<double>::infinity();
+	const vector<double> SPECIAL_VALUES = { 0.0, -0.0, 1, -1, 0.5, -2.5, numeric_limits<double>::denorm_min(), numeric_limits<double>::min(),
+		numeric_limits<double>::max(), INFINITE, -INFINITE, numeric_limits<double>::quiet_NaN() };
+	const vector<double> EXPONENTS = { 1.5, -3.25, 0.5, 1e-3, 300 };
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+	vector<double> x(ROWS), y(ROWS);
+
+	// Bases from e^-354 to e^354, bases close to 1 with large exponents, negative bases and special values
+	for (int i = 0; i < ROWS; i++) {
+
+		if (i % 3 == 0) {
+
+			x[i] = exp((i % 1013 - 506) * 0.7);
+			y[i] = (i % 7 - 3) * 0.37;
+		}
+		else if (i % 3 == 1) {
+
+			x[i] = 1 + (i % 211 - 105) * 1e-4;
+			y[i] = (i % 977 - 488) * 17.25;
+		}
+		else {
+
+			x[i] = (i % 101) * 0.25 - 5;
+			y[i] = i % 9 - 4 + (i % 2) * 0.5;
+		}
+
+		if (i % 13 == 0)
+			x[i] = SPECIAL_VALUES[i / 13 % SPECIAL_VALUES.size()];
+
+		if (i % 17 == 0)
+			y[i] = SPECIAL_VALUES[i / 17 % SPECIAL_VALUES.size()];
+	}
+
+	int checks = 0;
+	int failed = failures;
+
+	for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+		SimdKernels kernels(instructionSet);
+		string name = SimdKernels::getInstructionSetName(instructionSet);
+
+		if (kernels.getInstructionSet() != instructionSet)
+			continue;
+
+		// Into a separate block, then over x, then over y
+		for (int target = 0; target < 3; target++) {
+
+			vector<double> left = x, right = y, output(ROWS);
+			double *result = target == 0 ? output.data() : target == 1 ? left.data() : right.data();
+
+			kernels.apply(Opcode::POWER, left.data(), false, right.data(), false, result, ROWS);
+
+			for (int i = 0; i < ROWS; i++) {
+
+				expect(isSameBatch(result[i], pow(x[i], y[i]), "^", instructionSet), name + " gave " + to_string(result[i]) + " for " + to_string(x[i]) + "^" + to_string(y[i]));
+				checks++;
+			}
+		}
+
+		for (double exponent : EXPONENTS) {
+
+			vector<double> output(ROWS);
+
+			kernels.apply(Opcode::POWER, x.data(), false, &exponent, true, output.data(), ROWS);
+
+			for (int i = 0; i < ROWS; i++) {
+
+				expect(isSameBatch(output[i], pow(x[i], exponent), "^", instructionSet), name + " gave " + to_string(output[i]) + " for " + to_string(x[i]) + "^" + to_string(exponent));
+				checks++;
+			}
+		}
+	}
+
+	cout << "Power, pow on every instruction set" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Reports how ParallelEvaluator scales from 1 thread to every hardware thread and checks that it is reentrant
+void benchmarkThreads() {
+
+	const int ROWS = 4000000;
+	const int EXPRESSION_ROWS = 65536;
+	const int EXPRESSION_COUNT = 64;
+	const string FORMULA = "(a-b)/c*(a+b)%7";
+	// Every eighth equation calls pow for every row, the others are cheap
+	const string CHEAP_FORMULA = "a*b+c";
+	const string COSTLY_FORMULA = "a^1.5+b^c^0.5-c^a^0.25";
+
+	vector<double> a(ROWS), b(ROWS), c(ROWS), output(ROWS), expected(ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		a[i] = 1 + i % 1009 * 0.5;
+		b[i] = 1 + i % 31 * 0.25;
+		c[i] = 1 + i % 17 * 0.125;
+	}
+
+	const double *columns[] = { a.data(), b.data(), c.data() };
+	CompiledExpression expression(FORMULA.c_str(), FORMULA.size());
+	CompiledExpression cheap(CHEAP_FORMULA.c_str(), CHEAP_FORMULA.size());
+	CompiledExpression costly(COSTLY_FORMULA.c_str(), COSTLY_FORMULA.size());
+	vector<const CompiledExpression *> expressions;
+	vector<const double *const *> expressionColumns;
+	vector<vector<double>> expressionOutputs(EXPRESSION_COUNT, vector<double>(EXPRESSION_ROWS));
+	vector<double *> outputs;
+
+	for (int i = 0; i < EXPRESSION_COUNT; i++) {
+
+		expressions.push_back(i % 8 == 0 ? &costly : &cheap);
+		expressionColumns.push_back(columns);
+		outputs.push_back(expressionOutputs[i].data());
+	}
+
+	BatchEvaluator serial;
+
+	serial.evaluate(expression, columns, expected.data(), ROWS);
+
+	int hardwareThreads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+
+	cout << "Threads (ms), " << hardwareThreads << " hardware threads" << endl;
+
+	// Doubles the number of threads each time and always ends with every hardware thread
+	for (int threads = 1; threads <= hardwareThreads; threads = threads < hardwareThreads && threads * 2 > hardwareThreads ? hardwareThreads : threads * 2) {
+
+		ThreadPool pool(threads);
+		ParallelEvaluator evaluator(pool);
+
+		auto start = chrono::steady_clock::now();
+
+		evaluator.evaluate(expression, columns, output.data(), ROWS);
+
+		double rowsTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+		evaluator.evaluate(expressions, expressionColumns, outputs, EXPRESSION_ROWS);
+
+		double expressionsTime = nanosecondsSince(start);
+
+		cout << "\t" << threads << " threads: rows " << rowsTime / 1e6 << ", uneven equations " << expressionsTime / 1e6 << endl;
+	}
+
+	// Shares one pool, one expression and one ReversePolishNotation between more threads than there are cores
+	const int CHECK_THREADS = 4;
+	ThreadPool pool(CHECK_THREADS);
+	ParallelEvaluator evaluator(pool);
+	ReversePolishNotation rpn;
+	atomic<int> mismatches(0);
+
+	evaluator.evaluate(expression, columns, output.data(), ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		if (memcmp(&output[i], &expected[i], sizeof(double)) != 0)
+			mismatches++;
+	}
+
+	pool.parallelFor(EXPRESSION_COUNT * 100, [&](size_t i, int) {
+
+		string equation = to_string(i) + "*(" + to_string(i % 7) + "+1)-3";
+
+		if (rpn.evaluateEquation(equation.c_str(), equation.size()) != (double)i * (i % 7 + 1) - 3)
+			mismatches++;
+	});
+
+	cout << "\tReentrancy check on " << CHECK_THREADS << " threads: " << mismatches << " mismatches" << endl;
+}
+
+// Compares compiling every equation with looking it up in ExpressionCache from many threads at once
+void benchmarkCache() {
+
+	const int LOOKUPS = 2000000;
+	const int DISTINCT_EQUATIONS = 5000;
+	const int THREADS = 4;
+
+	vector<string> equations;
+
+	for (int i = 0; i < DISTINCT_EQUATIONS; i++)
+		equations.push_back("(price * " + to_string(i) + " - fee) / (qty + " + to_string(i % 97) + ")");
+
+	// Most requests are for a small set of popular equations
+	auto pick = [&](size_t i) { return (i * 2654435761u) % (i % 4 == 0 ? DISTINCT_EQUATIONS : 200); };
+
+	ThreadPool pool(THREADS);
+	atomic<long long> checksum(0);
+
+	auto start = chrono::steady_clock::now();
+
+	pool.parallelFor(LOOKUPS / 1000, [&](size_t task, int) {
+
+		for (size_t i = task * 1000; i < (task + 1) * 1000; i++) {
+
+			const string &equation = equations[pick(i)];
+			CompiledExpression expression(equation.c_str(), equation.size());
+
+			checksum += expression.getVariableCount();
+		}
+	});
+
+	double compileTime = nanosecondsSince(start);
+	// Budget for roughly half of the distinct equations so the cache has to evict
+	ExpressionCache cache(DISTINCT_EQUATIONS / 2 * 100);
+
+	start = chrono::steady_clock::now();
+
+	pool.parallelFor(LOOKUPS / 1000, [&](size_t task, int) {
+
+		for (size_t i = task * 1000; i < (task + 1) * 1000; i++) {
+
+			const string &equation = equations[pick(i)];
+
+			checksum += cache.getExpression(equation.c_str(), equation.size())->getVariableCount();
+		}
+	});
+
+	double cacheTime = nanosecondsSince(start);
+
+	sink = checksum;
+
+	cout << "Expression cache (ns per lookup, " << THREADS << " threads)" << endl;
+	cout << "\tcompile every time: " << compileTime / LOOKUPS << endl;
+	cout << "\tExpressionCache:    " << cacheTime / LOOKUPS << endl;
+	cout << "\thits " << cache.getHits() << ", misses " << cache.getMisses() << ", evictions " << cache.getEvictions();
+	cout << ", " << cache.getSize() << " equations using " << cache.getMemoryUsage() << " of " << cache.getMemoryBudget() << " bytes" << endl;
+}
+
+// Fails the run when an equation from the cache answers differently from the same equation compiled directly
+void testCache() {
+
+	// Spellings that only differ in whitespace, where the whitespace may or may not change the equation
+	const vector<string> EQUATIONS_TESTED = { "a!=b", "a != b", "a ! = b", "a !=b", "a! =b", "!a = b", "a<=b", "a < = b", "a <= b", "a< =b",
+		"a>=b", "a > = b", "a >=b", "a < b", "a = b", "a * b - 2 3", "a*b-23", "a 2", "- a + b", "-a+b", "a - -b", "2e - 1", "2e-1", "2e -1",
+		"3E + 2", "3E+2", "1e- 5", "1e-5", "1e -5", "a*2.e - 1", "2 e-1" };
+	const double INPUTS[][2] = { { 0, 5 }, { 5, 5 }, { 7, 5 }, { -1, 0 }, { 0, 0 } };
+
+	ExpressionCache cache(1 << 20);
+	int checks = 0;
+	int failed = failures;
+
+	// Each equation is looked up twice, so the second lookup may be answered by an entry of another spelling
+	for (int pass = 0; pass < 2; pass++) {
+
+		for (const string &equation : EQUATIONS_TESTED) {
+
+			Expected<CompiledExpression> direct = CompiledExpression::tryCompile(equation.c_str(), equation.size());
+			shared_ptr<const CompiledExpression> cached;
+
+			try {
+
+				cached = cache.getExpression(equation.c_str(), equation.size());
+			} catch (const invalid_argument &) {
+			}
+
+			expect((bool)direct == (cached != nullptr), "\"" + equation + "\" is " + (direct ? "valid" : "invalid") + " but the cache " + (cached ? "accepts" : "rejects") + " it");
+			checks++;
+
+			if (!direct || !cached)
+				continue;
+
+			bool sameVariables = cached->getVariableCount() == direct.getValue().getVariableCount();
+
+			for (const string &name : direct.getValue().getVariableNames())
+				sameVariables = sameVariables && cached->getVariableIndex(name) != -1;
+
+			expect(sameVariables, "\"" + equation + "\" from the cache has other variables");
+			checks++;
+
+			if (!sameVariables)
+				continue;
+
+			for (const auto &input : INPUTS) {
+
+				vector<double> variables(direct.getValue().getVariableCount());
+				vector<double> cachedVariables(cached->getVariableCount());
+
+				for (int j = 0; j < (int)variables.size(); j++) {
+
+					const string &name = direct.getValue().getVariableNames()[j];
+
+					variables[j] = input[name == "a" ? 0 : 1];
+					cachedVariables[cached->getVariableIndex(name)] = input[name == "a" ? 0 : 1];
+				}
+
+				double expected = direct.getValue().evaluate(variables);
+				double answer = cached->evaluate(cachedVariables);
+
+				expect(isSame(answer, expected), "\"" + equation + "\" from the cache gives " + to_string(answer) + " instead of " + to_string(expected)
+					+ " with a = " + to_string(input[0]) + ", b = " + to_string(input[1]));
+				checks++;
+			}
+		}
+	}
+
+	cout << "Expression cache checks, " << EQUATIONS_TESTED.size() << " spellings, " << cache.getSize() << " entries" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Checks that the optimized equations give the same answers and measures how much shorter and faster they are
+void benchmarkOptimizer() {
+
+	const int ROWS = 1000000;
+	const vector<string> FORMULAS = { "-x*2*3+4*-1*y", "x*1+0-y/1+x^1-0", "(2+3)*x-(1.5*4-6)*y^(1+1)", "-(-(x))*-y*(7%4+2^-1)",
+		"x^2+y^-1-x^0*y", "x/4-y/0.125+x/-0.5", "x%8-y%-16+(x*3)%1-x%8.5", "x^3+y^0.5-x^-4+y/3-x^20" };
+	const double SPECIAL_VALUES[] = { 0.0, -0.0, numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN() };
+	const OptimizationLevel LEVELS[] = { OptimizationLevel::NONE, OptimizationLevel::EXACT, OptimizationLevel::FAST };
+	const char *LEVEL_NAMES[] = { "none: ", "exact:", "fast: " };
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+	vector<double> x(ROWS), y(ROWS), output(ROWS), expected(ROWS), batchOutput(ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		x[i] = i % 97 == 0 ? SPECIAL_VALUES[i / 97 % 5] : (i % 2001 - 1000) * 0.37;
+		y[i] = i % 89 == 0 ? SPECIAL_VALUES[i / 89 % 5] : 1 + i % 29 * 0.5;
+	}
+
+	cout << "Optimizer (tokens, ns per row for evaluate, then BatchEvaluator, differences from none)" << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		cout << "\t" << formula << endl;
+
+		for (int level = 0; level < 3; level++) {
+
+			CompiledExpression expression(formula.c_str(), formula.size(), LEVELS[level]);
+			vector<const double *> columns;
+			vector<double> variables(2);
+			int mismatches = 0, batchMismatches = 0;
+			long long maxUlps = 0;
+			double sum = 0;
+
+			for (const string &name : expression.getVariableNames())
+				columns.push_back(name == "x" ? x.data() : y.data());
+
+			auto start = chrono::steady_clock::now();
+
+			for (int i = 0; i < ROWS; i++) {
+
+				for (int j = 0; j < expression.getVariableCount(); j++)
+					variables[j] = columns[j][i];
+
+				output[i] = expression.evaluate(variables);
+				sum += output[i];
+			}
+
+			double evaluateTime = nanosecondsSince(start);
+
+			sink = sum;
+
+			if (LEVELS[level] == OptimizationLevel::NONE)
+				expected = output;
+
+			// Rounding differences are only allowed at OptimizationLevel::FAST and are reported in ulps
+			for (int i = 0; i < ROWS; i++) {
+
+				if (isSame(output[i], expected[i]))
+					continue;
+
+				if (LEVELS[level] == OptimizationLevel::FAST && isfinite(output[i]) && isfinite(expected[i]) && signbit(output[i]) == signbit(expected[i]))
+					maxUlps = max(maxUlps, ulpDistance(output[i], expected[i]));
+				else
+					mismatches++;
+			}
+
+			double batchTime = 0;
+
+			// Every instruction set must give the same answers as evaluate at the same level
+			for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+				if (SimdKernels(instructionSet).getInstructionSet() != instructionSet)
+					continue;
+
+				BatchEvaluator evaluator(instructionSet);
+
+				start = chrono::steady_clock::now();
+
+				evaluator.evaluate(expression, columns.data(), batchOutput.data(), ROWS);
+
+				batchTime = nanosecondsSince(start);
+
+				for (int i = 0; i < ROWS; i++)
+					batchMismatches += !isSameBatch(batchOutput[i], output[i], formula, instructionSet);
+			}
+
+			cout << "\t\t" << LEVEL_NAMES[level] << " " << expression.getPostFix().size() << " tokens, " << evaluateTime / ROWS << ", " << batchTime / ROWS;
+			cout << ", " << mismatches << " mismatches, " << maxUlps << " ulps, " << batchMismatches << " batch mismatches" << endl;
+
+			expect(mismatches == 0 && batchMismatches == 0 && maxUlps <= FAST_ULPS, formula + " at " + LEVEL_NAMES[level] + " differs from none");
+		}
+	}
+}
+
+// Fails the run when an optimized equation answers differently from the equation as written, beyond what FAST allows
+void testOptimizer() {
+
+	struct EdgeCase {
+
+		string equation;
+		vector<double> inputs;
+		// FAST turns x^0.5 into a square root, which differs from pow for -0 and -infinity
+		bool squareRoot;
+	};
+
+	const double INFINITE = numeric_limits<double>::infinity();
+	const double NOT_A_NUMBER = numeric_limits<double>::quiet_NaN();
+	const vector<double> MODULO_INPUTS = { -7.5, -8, -9, -17.25, -0.0, 0, 5.5, 1023.75, -1e12, NOT_A_NUMBER, -INFINITE };
+	const vector<double> NEGATE_INPUTS = { -0.0, 0, -INFINITE, INFINITE, NOT_A_NUMBER, 3.5, -2 };
+	const vector<EdgeCase> EDGE_CASES = {
+		{ "x^0.5", { -4, -0.25, -1e300, -0.0, -INFINITE, 0, 4, 2, INFINITE, NOT_A_NUMBER }, true },
+		{ "(x*3)^0.5 + 1", { -4, -0.0, 0, 0.75, 1e300 }, true },
+		{ "x%8", MODULO_INPUTS, false },
+		{ "x%-8", MODULO_INPUTS, false },
+		{ "x%2", MODULO_INPUTS, false },
+		{ "x%1024", MODULO_INPUTS, false },
+		{ "-x%4", MODULO_INPUTS, false },
+		{ "(x-3)%16", MODULO_INPUTS, false },
+		{ "-(-x)", NEGATE_INPUTS, false },
+		{ "-(-(-x))", NEGATE_INPUTS, false },
+		{ "-x*-1", NEGATE_INPUTS, false },
+		{ "-(-(x))*-1 + 0", NEGATE_INPUTS, false }
+	};
+	const OptimizationLevel LEVELS[] = { OptimizationLevel::EXACT, OptimizationLevel::FAST };
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+	int checks = 0;
+	int failed = failures;
+
+	for (const EdgeCase &edge : EDGE_CASES) {
+
+		CompiledExpression reference(edge.equation.c_str(), edge.equation.size(), OptimizationLevel::NONE);
+
+		for (OptimizationLevel level : LEVELS) {
+
+			CompiledExpression expression(edge.equation.c_str(), edge.equation.size(), level);
+			string name = edge.equation + (level == OptimizationLevel::EXACT ? " at exact" : " at fast");
+			vector<double> output(edge.inputs.size());
+			const double *columns[] = { edge.inputs.data() };
+
+			for (size_t i = 0; i < edge.inputs.size(); i++) {
+
+				double x = edge.inputs[i];
+				double expected = reference.evaluate({ x });
+				double answer = expression.evaluate({ x });
+				bool allowed = isSame(answer, expected);
+
+				if (!allowed && level == OptimizationLevel::FAST) {
+
+					if (isfinite(answer) && isfinite(expected) && signbit(answer) == signbit(expected))
+						allowed = ulpDistance(answer, expected) <= FAST_ULPS;
+					else
+						allowed = edge.squareRoot && (x == -INFINITE || (x == 0 && signbit(x)));
+				}
+
+				expect(allowed, name + " with x = " + to_string(x) + " gave " + to_string(answer) + " instead of " + to_string(expected));
+				output[i] = answer;
+				checks++;
+			}
+
+			// Every instruction set gives the answers of evaluate at the same level
+			for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+				if (SimdKernels(instructionSet).getInstructionSet() != instructionSet)
+					continue;
+
+				vector<double> batchOutput(edge.inputs.size());
+
+				BatchEvaluator(instructionSet).evaluate(expression, columns, batchOutput.data(), edge.inputs.size());
+
+				for (size_t i = 0; i < edge.inputs.size(); i++) {
+
+					expect(isSameBatch(batchOutput[i], output[i], edge.equation, instructionSet), name + " with x = " + to_string(edge.inputs[i]) + " differs on " + SimdKernels::getInstructionSetName(instructionSet));
+					checks++;
+				}
+			}
+		}
+	}
+
+	cout << "Optimizer edge cases, " << EDGE_CASES.size() << " equations" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Compares the stack based CompiledExpression::evaluate with RegisterMachine on short and long equations
+void benchmarkRegisterMachine() {
+
+	const int ITERATIONS = 1000000;
+	const vector<string> FORMULAS = { "x+y", "x*y-x/y", "(x-1.5)*(y+2.25)-x%3+y^2*x", "((((x+y)*3-x)/y+6)*x-8)/9+((x-y)*12+y)/14-x*16+y-x*y/20",
+		"(x*y+x-y)*(x-y*2)/(y+x*3)-(x*x-y*y)*(x+y)/(x-y+0.5)+(x+1)*(y+2)*(x+3)*(y+4)-x/(y+5)/(x+6)" };
+	const double INPUTS[][2] = { { 1.25, 3.5 }, { -7.75, 0.5 }, { 1000.5, -2.125 }, { 0.001, 42 } };
+
+	cout << "Register machine (ns per evaluation, stack then register machine)" << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		// Not optimized, so both engines run every operator of the equation
+		CompiledExpression expression(formula.c_str(), formula.size(), OptimizationLevel::NONE);
+		RegisterMachine machine(expression);
+		vector<double> variables(2);
+		int mismatches = 0;
+		double sum = 0;
+
+		for (const auto &input : INPUTS) {
+
+			variables[expression.getVariableIndex("x")] = input[0];
+			variables[expression.getVariableIndex("y")] = input[1];
+
+			double expected = expression.evaluate(variables);
+			double result = machine.evaluate(variables);
+
+			mismatches += memcmp(&expected, &result, sizeof(double)) != 0;
+		}
+
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++) {
+
+			variables[0] = i * 0.5;
+			sum += expression.evaluate(variables);
+		}
+
+		double stackTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++) {
+
+			variables[0] = i * 0.5;
+			sum += machine.evaluate(variables);
+		}
+
+		double registerTime = nanosecondsSince(start);
+
+		sink = sum;
+
+		cout << "\t" << stackTime / ITERATIONS << "\t" << registerTime / ITERATIONS << "\t" << machine.getInstructionCount() << " instructions, ";
+		cout << mismatches << " mismatches\t" << formula << endl;
+
+		expect(mismatches == 0, "RegisterMachine differs from evaluate on " + formula);
+	}
+}
+
+// Checks the JIT against calcResult and compares it with the interpreters
+void benchmarkJit() {
+
+	const int ROWS = 1000000;
+	const vector<string> FORMULAS = { "x*y-x/y", "x%3-y%-2+x%8-y%4", "-x*y^2+x^-1-y^20+x^-7", "x^y+(x+1)^(y-2)*x-y^0.5",
+		"((((x+y)*3-x)/y+6)*x-8)/9+((x-y)*12+y)/14-x*16+y-x*y/20",
+		"x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y^x-y)))))))))))))", "x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x-y))))))))))))))" };
+	const double SPECIAL_VALUES[] = { 0.0, -0.0, numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN() };
+
+	vector<double> x(ROWS), y(ROWS), output(ROWS);
+	ReversePolishNotation rpn;
+
+	for (int i = 0; i < ROWS; i++) {
+
+		x[i] = i % 97 == 0 ? SPECIAL_VALUES[i / 97 % 5] : (i % 2001 - 1000) * 0.37;
+		y[i] = i % 89 == 0 ? SPECIAL_VALUES[i / 89 % 5] : 1 + i % 29 * 0.5;
+	}
+
+	cout << "JIT (ns per row for the stack, register machine, JIT and JIT batch, mismatches against calcResult), ";
+	cout << (JitExpression::isAvailable() ? "available" : "not available") << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		CompiledExpression expression(formula.c_str(), formula.size(), OptimizationLevel::FAST);
+		RegisterMachine machine(expression);
+		JitExpression jit(expression);
+		vector<const double *> columns;
+		vector<double> variables(2);
+		int mismatches = 0;
+		double sum = 0;
+
+		for (const string &name : expression.getVariableNames())
+			columns.push_back(name == "x" ? x.data() : y.data());
+
+		// Every row is checked on the single row function and the batch function
+		jit.evaluate(columns.data(), output.data(), ROWS);
+
+		for (int i = 0; i < ROWS; i += 7) {
+
+			for (int j = 0; j < expression.getVariableCount(); j++)
+				variables[j] = columns[j][i];
+
+			double expected = rpn.calcResult(expression.getPostFix().data(), expression.getPostFix().size(), expression.getValues(), variables);
+
+			mismatches += !isSame(jit.evaluate(variables), expected) + !isSame(output[i], expected) + !isSame(machine.evaluate(variables), expected);
+		}
+
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ROWS; i++) {
+
+			variables[0] = x[i];
+			variables[1] = y[i];
+			sum += expression.evaluate(variables);
+		}
+
+		double stackTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ROWS; i++) {
+
+			variables[0] = x[i];
+			variables[1] = y[i];
+			sum += machine.evaluate(variables.data());
+		}
+
+		double registerTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ROWS; i++) {
+
+			variables[0] = x[i];
+			variables[1] = y[i];
+			sum += jit.evaluate(variables.data());
+		}
+
+		double jitTime = nanosecondsSince(start);
+
+		start = chrono::steady_clock::now();
+
+		jit.evaluate(columns.data(), output.data(), ROWS);
+
+		double batchTime = nanosecondsSince(start);
+
+		sink = sum;
+
+		cout << "\t" << stackTime / ROWS << "\t" << registerTime / ROWS << "\t" << jitTime / ROWS << "\t" << batchTime / ROWS;
+		cout << "\t" << mismatches << (jit.isCompiled() ? "" : " (interpreted)") << "\t" << formula << endl;
+
+		expect(mismatches == 0, "JIT differs from calcResult on " + formula);
+	}
+}
+
+// Fails the run when the JIT or its fallback answers differently from calcResult, for every kind of operator
+void testJit() {
+
+	const vector<string> FORMULAS = { "x*y-x/y", "x%3-y%-2+x%8-y%4", "-x*y^2+x^-1-y^20+x^-7", "x^y+(x+1)^(y-2)*x-y^0.5",
+		"x>1", "(x>1) + (y<=x)*2 - !(x=y)", "x>1 & y!=0 | x<-3", "(x>=y)*x^2 + (x<y)*y%4",
+		"x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x+(y+(x-y))))))))))))))" };
+	const double INFINITE = numeric_limits<double>::infinity();
+	const vector<double> INPUTS = { -7.75, -1, -0.0, 0, 0.5, 1, 1.25, 3, 1000.5, INFINITE, -INFINITE, numeric_limits<double>::quiet_NaN() };
+	const OptimizationLevel LEVELS[] = { OptimizationLevel::NONE, OptimizationLevel::FAST };
+
+	ReversePolishNotation rpn;
+	int checks = 0;
+	int failed = failures;
+
+	// Every pair of inputs is a row
+	vector<double> x, y;
+
+	for (double first : INPUTS) {
+
+		for (double second : INPUTS) {
+
+			x.push_back(first);
+			y.push_back(second);
+		}
+	}
+
+	for (const string &formula : FORMULAS) {
+
+		for (OptimizationLevel level : LEVELS) {
+
+			CompiledExpression expression(formula.c_str(), formula.size(), level);
+			RegisterMachine machine(expression);
+			vector<const double *> columns;
+			vector<double> variables(expression.getVariableCount());
+
+			for (const string &name : expression.getVariableNames())
+				columns.push_back(name == "x" ? x.data() : y.data());
+
+			// The compiled code and the fallback it replaces are both checked
+			for (bool enabled : { true, false }) {
+
+				JitExpression jit(expression, enabled);
+				vector<double> output(x.size());
+
+				jit.evaluate(columns.data(), output.data(), x.size());
+
+				for (size_t i = 0; i < x.size(); i++) {
+
+					for (int j = 0; j < expression.getVariableCount(); j++)
+						variables[j] = columns[j][i];
+
+					double expected = rpn.calcResult(expression.getPostFix().data(), expression.getPostFix().size(), expression.getValues(), variables);
+					string row = " with x = " + to_string(x[i]) + ", y = " + to_string(y[i]) + (enabled ? "" : " without the JIT");
+
+					expect(isSame(jit.evaluate(variables), expected), "JIT differs from calcResult on " + formula + row);
+					expect(isSame(output[i], expected), "JIT batch differs from calcResult on " + formula + row);
+					expect(isSame(machine.evaluate(variables), expected), "RegisterMachine differs from calcResult on " + formula + row);
+					checks += 3;
+				}
+			}
+		}
+	}
+
+	cout << "JIT checks, " << FORMULAS.size() << " equations, " << (JitExpression::isAvailable() ? "available" : "not available") << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Equation parsed while the benchmark is compiled, kept at namespace scope so it can be a template argument
+static constexpr auto CONSTEXPR_PROGRAM = ConstexprParser::compile("(1.5*2.25+3.125/4-5.5)^2*(x-7.5/8.25)+9.125*(10.5-y*12.75)/13.5");
+
+// Compares parsing at run time with ConstexprExpression, which is parsed by the compiler
+void benchmarkConstexpr() {
+
+	const int ITERATIONS = 1000000;
+	const string EQUATION = "(1.5*2.25+3.125/4-5.5)^2*(x-7.5/8.25)+9.125*(10.5-y*12.75)/13.5";
+
+	ReversePolishNotation rpn;
+	CompiledExpression expression(EQUATION.c_str(), EQUATION.size());
+	ConstexprExpression<CONSTEXPR_PROGRAM> constexprExpression;
+	vector<double> variables(2);
+	int mismatches = 0;
+	double sum = 0;
+
+	for (int i = 0; i < 1000; i++) {
+
+		variables[0] = i * 0.37 - 100;
+		variables[1] = 1 + i % 29 * 0.5;
+
+		double expected = expression.evaluate(variables);
+		double result = constexprExpression(variables[0], variables[1]);
+
+		mismatches += memcmp(&expected, &result, sizeof(double)) != 0;
+	}
+
+	// evaluateEquation has no variables, so the values are written into the equation as it would be done at run time
+	string withValues = EQUATION;
+
+	withValues.replace(withValues.find('x'), 1, "1.25");
+	withValues.replace(withValues.find('y'), 1, "3.5");
+
+	auto start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS / 10; i++)
+		sum += rpn.evaluateEquation(withValues.c_str(), withValues.size());
+
+	double parseTime = nanosecondsSince(start) / (ITERATIONS / 10);
+
+	start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+
+		variables[0] = i * 0.5;
+		sum += expression.evaluate(variables);
+	}
+
+	double compiledTime = nanosecondsSince(start) / ITERATIONS;
+
+	start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS; i++)
+		sum += constexprExpression(i * 0.5, variables[1]);
+
+	double constexprTime = nanosecondsSince(start) / ITERATIONS;
+
+	sink = sum;
+
+	cout << "Constexpr expression (ns per evaluation), " << mismatches << " mismatches against CompiledExpression" << endl;
+	cout << "\tevaluateEquation:    " << parseTime << endl;
+	cout << "\tCompiledExpression:  " << compiledTime << endl;
+	cout << "\tConstexprExpression: " << constexprTime << endl;
+}
+
+// Equations with bool and comparison operators, parsed while the benchmark is compiled
+static constexpr auto LOGIC_PROGRAM = ConstexprParser::compile("a<b&!(c>=a)|a!=b=0");
+static constexpr auto NOT_PROGRAM = ConstexprParser::compile("!a+b*!c");
+static constexpr auto COMPARE_PROGRAM = ConstexprParser::compile("a <= b-c | -a>b & c=-1");
+static constexpr auto IMPLICIT_PROGRAM = ConstexprParser::compile("2a>b&b<3(c) | !-a");
+
+// Checks that ConstexprExpression gives the answers of CompiledExpression for bool and comparison operators, and
+//		that ConstexprParser rejects the same out of range numbers as the run time parser
+void testConstexpr() {
+
+	const double NOT_A_NUMBER = numeric_limits<double>::quiet_NaN();
+	const vector<double> INPUTS = { -2, -1, -0.0, 0, 0.5, 1, 2, 3, NOT_A_NUMBER };
+
+	struct Literal {
+
+		string equation;
+		// False for numbers too large for a double or too small for anything but 0, which from_chars reports as out of range
+		bool inRange;
+		bool compiled;
+	};
+
+	// compile is only a constant expression when it is used to initialize one, so here it runs and throws at run time
+	auto compiles = [](const auto &equation) {
+
+		try {
+
+			ConstexprParser::compile(equation);
+		} catch (const invalid_argument &) {
+
+			return false;
+		}
+
+		return true;
+	};
+
+	const vector<Literal> LITERALS = {
+		{ "1e400", false, compiles("1e400") },
+		{ "-1e400", false, compiles("-1e400") },
+		{ "1.8e308", false, compiles("1.8e308") },
+		{ "x*1e999", false, compiles("x*1e999") },
+		{ "1e-400", false, compiles("1e-400") },
+		{ "2e-324", false, compiles("2e-324") },
+		{ "1e308", true, compiles("1e308") },
+		{ "1.7e308", true, compiles("1.7e308") },
+		{ "1e-310", true, compiles("1e-310") },
+		{ "0e999", true, compiles("0e999") },
+		{ "0.0e-999", true, compiles("0.0e-999") }
+	};
+
+	ConstexprExpression<LOGIC_PROGRAM> logic;
+	ConstexprExpression<NOT_PROGRAM> notExpression;
+	ConstexprExpression<COMPARE_PROGRAM> compare;
+	ConstexprExpression<IMPLICIT_PROGRAM> implicit;
+	const vector<pair<string, function<double(double, double, double)>>> EQUATIONS = {
+		{ "a<b&!(c>=a)|a!=b=0", [&](double a, double b, double c) { return logic(a, b, c); } },
+		{ "!a+b*!c", [&](double a, double b, double c) { return notExpression(a, b, c); } },
+		{ "a <= b-c | -a>b & c=-1", [&](double a, double b, double c) { return compare(a, b, c); } },
+		{ "2a>b&b<3(c) | !-a", [&](double a, double b, double c) { return implicit(a, b, c); } }
+	};
+
+	ReversePolishNotation rpn;
+	int checks = 0;
+	int failed = failures;
+
+	for (const auto &equation : EQUATIONS) {
+
+		CompiledExpression expression(equation.first.c_str(), equation.first.size());
+
+		for (double a : INPUTS) {
+
+			for (double b : INPUTS) {
+
+				for (double c : INPUTS) {
+
+					double expected = expression.evaluate({ a, b, c });
+					double result = equation.second(a, b, c);
+
+					expect(isSame(result, expected), equation.first + " with " + to_string(a) + ", " + to_string(b) + ", " + to_string(c) + " gave "
+						+ to_string(result) + " instead of " + to_string(expected));
+					checks++;
+				}
+			}
+		}
+	}
+
+	for (const Literal &literal : LITERALS) {
+
+		bool parsed = true;
+
+		try {
+
+			vector<double> values;
+
+			rpn.stripValuesFromEquation(literal.equation.c_str(), literal.equation.size(), values);
+		} catch (const invalid_argument &) {
+
+			parsed = false;
+		}
+
+		expect(parsed == literal.inRange && literal.compiled == literal.inRange, literal.equation + (literal.inRange ? " was rejected" : " was accepted"));
+		checks++;
+	}
+
+	cout << "Constexpr bool and comparison operators, " << EQUATIONS.size() << " equations" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Equations with a minus sign before a variable or '(', parsed while the benchmark is compiled
+static constexpr auto DIVIDE_NEGATIVE_PROGRAM = ConstexprParser::compile("a/-b");
+static constexpr auto POWER_NEGATIVE_PROGRAM = ConstexprParser::compile("2^-x");
+static constexpr auto NEGATIVE_POWER_PROGRAM = ConstexprParser::compile("-x^2");
+static constexpr auto NEGATIVE_PARENTHESIS_PROGRAM = ConstexprParser::compile("a/-(b+x)");
+
+// Checks that a minus sign before a variable or '(' only negates that operand, at every optimization level, in batches,
+// in the fused path of evaluateEquation and in ConstexprExpression
+void testUnaryMinus() {
+
+	struct Negation {
+
+		string equation;
+		function<double(double, double, double)> expected;
+	};
+
+	const vector<Negation> NEGATIONS = {
+		{ "a/-b", [](double a, double b, double) { return a / -b; } },
+		{ "2^-x", [](double, double, double x) { return pow(2, -x); } },
+		{ "x^-2", [](double, double, double x) { return pow(x, -2); } },
+		{ "-x^2", [](double, double, double x) { return -pow(x, 2); } },
+		{ "a*-b^2", [](double a, double b, double) { return a * -pow(b, 2); } },
+		{ "a^-b*x", [](double a, double b, double x) { return pow(a, -b) * x; } },
+		{ "a/-(b+x)", [](double a, double b, double x) { return a / -(b + x); } },
+		{ "2^-(x)", [](double, double, double x) { return pow(2, -x); } },
+		{ "-a-b", [](double a, double b, double) { return -a - b; } },
+		{ "a--b", [](double a, double b, double) { return a - -b; } },
+		{ "-(-x)%4", [](double, double, double x) { return (double)((int)x % 4); } }
+	};
+	// Rows of a, b and x
+	const vector<vector<double>> ROWS = { { 6, 2, 3 }, { -1.5, 3, -2 }, { 0.25, -0.5, 0.5 }, { 7, 4, 5 } };
+	const OptimizationLevel LEVELS[] = { OptimizationLevel::NONE, OptimizationLevel::EXACT, OptimizationLevel::FAST };
+	const string LEVEL_NAMES[] = { "none", "exact", "fast" };
+
+	ReversePolishNotation rpn;
+	BatchEvaluator evaluator;
+	int checks = 0;
+	int failed = failures;
+
+	for (const Negation &negation : NEGATIONS) {
+
+		vector<double> expected;
+
+		for (const vector<double> &row : ROWS)
+			expected.push_back(negation.expected(row[0], row[1], row[2]));
+
+		for (int level = 0; level < 3; level++) {
+
+			CompiledExpression expression(negation.equation.c_str(), negation.equation.size(), LEVELS[level]);
+			vector<vector<double>> columnValues;
+			vector<const double *> columns;
+			vector<double> output(ROWS.size());
+
+			for (const string &name : expression.getVariableNames()) {
+
+				columnValues.emplace_back();
+
+				for (const vector<double> &row : ROWS)
+					columnValues.back().push_back(row[name == "a" ? 0 : name == "b" ? 1 : 2]);
+			}
+
+			for (const vector<double> &column : columnValues)
+				columns.push_back(column.data());
+
+			evaluator.evaluate(expression, columns.data(), output.data(), ROWS.size());
+
+			for (size_t i = 0; i < ROWS.size(); i++) {
+
+				vector<double> variables;
+
+				for (const vector<double> &column : columnValues)
+					variables.push_back(column[i]);
+
+				double result = expression.evaluate(variables);
+				// FAST may turn '^' into multiplying, which is only close to pow
+				bool close = LEVELS[level] == OptimizationLevel::FAST ? ulpDistance(result, expected[i]) <= FAST_ULPS : isSame(result, expected[i]);
+				bool batchClose = LEVELS[level] == OptimizationLevel::FAST ? ulpDistance(output[i], expected[i]) <= FAST_ULPS : isSame(output[i], expected[i]);
+				string row = " at " + LEVEL_NAMES[level] + " row " + to_string(i) + " is " + to_string(result) + ", expected " + to_string(expected[i]);
+
+				expect(close, negation.equation + row);
+				expect(batchClose, negation.equation + " batch" + row);
+				checks += 2;
+			}
+		}
+
+		// evaluateEquation has no variables, so each one is written into the equation in parenthesis
+		for (size_t i = 0; i < ROWS.size(); i++) {
+
+			string withValues;
+
+			for (char c : negation.equation) {
+
+				if (c == 'a' || c == 'b' || c == 'x')
+					withValues += "(" + to_string(ROWS[i][c == 'a' ? 0 : c == 'b' ? 1 : 2]) + ")";
+				else
+					withValues += c;
+			}
+
+			double result = rpn.evaluateEquation(withValues.c_str(), withValues.size());
+
+			expect(isSame(result, expected[i]), withValues + " is " + to_string(result) + ", expected " + to_string(expected[i]));
+			checks++;
+		}
+	}
+
+	for (const vector<double> &row : ROWS) {
+
+		double a = row[0], b = row[1], x = row[2];
+
+		expect(isSame(ConstexprExpression<DIVIDE_NEGATIVE_PROGRAM>()(a, b), a / -b), "ConstexprExpression a/-b");
+		expect(isSame(ConstexprExpression<POWER_NEGATIVE_PROGRAM>()(x), pow(2, -x)), "ConstexprExpression 2^-x");
+		expect(isSame(ConstexprExpression<NEGATIVE_POWER_PROGRAM>()(x), -pow(x, 2)), "ConstexprExpression -x^2");
+		expect(isSame(ConstexprExpression<NEGATIVE_PARENTHESIS_PROGRAM>()(a, b, x), a / -(b + x)), "ConstexprExpression a/-(b+x)");
+		checks += 4;
+	}
+
+	cout << "Unary minus checks, " << NEGATIONS.size() << " equations" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Compares rejecting invalid equations by exception with the try functions as the share of invalid equations grows
+void benchmarkErrors() {
+
+	const int INPUTS = 10000;
+	const int REPEATS = 20;
+	const vector<string> INVALID = {
+		"1.2.3+4",
+		"3+*4",
+		"(1+2))*3",
+		"4 5+6",
+		"2+#3",
+		"x*2+1",
+		"7*-"
+	};
+
+	ReversePolishNotation rpn;
+
+	cout << "Rejecting invalid equations (ns per equation)" << endl;
+
+	for (int rejectPercent : { 0, 1, 10, 50 }) {
+
+		vector<string> inputs;
+		int mismatches = 0;
+		double sum = 0;
+
+		for (int i = 0; i < INPUTS; i++) {
+
+			if (i * 37 % 100 < rejectPercent)
+				inputs.push_back(INVALID[i % INVALID.size()]);
+			else
+				inputs.push_back(EQUATIONS[i % EQUATIONS.size()]);
+		}
+
+		// Both paths must accept the same equations with the same answers and reject the rest with the same message
+		for (const string &input : inputs) {
+
+			Expected<double> expected = rpn.tryEvaluateEquation(input.c_str(), input.size());
+			Expected<CompiledExpression> compiled = CompiledExpression::tryCompile(input.c_str(), input.size());
+			string message;
+			string compiledMessage;
+			double result = 0;
+
+			try {
+
+				result = rpn.evaluateEquation(input.c_str(), input.size());
+			} catch (const invalid_argument &exception) {
+
+				message = exception.what();
+			}
+
+			try {
+
+				CompiledExpression expression(input.c_str(), input.size());
+			} catch (const invalid_argument &exception) {
+
+				compiledMessage = exception.what();
+			}
+
+			if (expected)
+				mismatches += !message.empty() || memcmp(&result, &expected.getValue(), sizeof(double)) != 0;
+			else
+				mismatches += message != expected.getError().getMessage();
+
+			mismatches += compiled.hasValue() != compiledMessage.empty();
+
+			if (!compiled)
+				mismatches += compiledMessage != compiled.getError().getMessage();
+		}
+
+		auto start = chrono::steady_clock::now();
+
+		for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+			for (const string &input : inputs) {
+
+				try {
+
+					sum += rpn.evaluateEquation(input.c_str(), input.size());
+				} catch (const invalid_argument &) {
+
+					sum -= 1;
+				}
+			}
+		}
+
+		double throwTime = nanosecondsSince(start) / (INPUTS * REPEATS);
+
+		start = chrono::steady_clock::now();
+
+		for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+			for (const string &input : inputs) {
+
+				Expected<double> result = rpn.tryEvaluateEquation(input.c_str(), input.size());
+
+				sum += result ? result.getValue() : -1;
+			}
+		}
+
+		double tryTime = nanosecondsSince(start) / (INPUTS * REPEATS);
+
+		start = chrono::steady_clock::now();
+
+		for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+			for (const string &input : inputs) {
+
+				try {
+
+					CompiledExpression expression(input.c_str(), input.size());
+
+					sum += expression.getMaxStackDepth();
+				} catch (const invalid_argument &) {
+
+					sum -= 1;
+				}
+			}
+		}
+
+		double constructTime = nanosecondsSince(start) / (INPUTS * REPEATS);
+
+		start = chrono::steady_clock::now();
+
+		for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+			for (const string &input : inputs) {
+
+				Expected<CompiledExpression> expression = CompiledExpression::tryCompile(input.c_str(), input.size());
+
+				sum += expression ? expression.getValue().getMaxStackDepth() : -1;
+			}
+		}
+
+		double tryCompileTime = nanosecondsSince(start) / (INPUTS * REPEATS);
+
+		sink = sum;
+
+		cout << "\t" << rejectPercent << "% invalid, " << mismatches << " mismatches" << endl;
+		cout << "\t\tevaluateEquation:    " << throwTime << endl;
+		cout << "\t\ttryEvaluateEquation: " << tryTime << endl;
+		cout << "\t\tCompiledExpression:  " << constructTime << endl;
+		cout << "\t\ttryCompile:          " << tryCompileTime << endl;
+	}
+}
+
+// Compares the single pass evaluateEquation with calling each step of it separately and checks that both accept the same equations
+void benchmarkFused() {
+
+	const int ITERATIONS = 100000;
+	const int RANDOM_EQUATIONS = 200000;
+	// '%' is left out since a random modulus of 0 would stop the benchmark
+	const string ALPHABET = "0123456789.+-*/^()  x";
+	// Longer than FIXED_STACK_DEPTH / 2 chars, so evaluateEquation keeps its stacks off the call stack
+	const string LONG_EQUATION = "(((1.5+2.25)*(3.125-4.5)/(5.75+6.5))^2-((7.25*8.5)-(9.75/10.25))*((11.5-12.75)+(13.25*14.5)))/(15.75+16.25*17.5-18.75)";
+
+	ReversePolishNotation rpn;
+	int mismatches = 0;
+	int accepted = 0;
+	unsigned int seed = 12345;
+	// Empty and blank equations have no tokens, which both paths report as invalid
+	vector<string> randomEquations = { "", "   ", "\t", " \t " };
+
+	// Random text built from the chars of an equation, most of which is invalid in different ways
+	for (int i = 0; i < RANDOM_EQUATIONS; i++) {
+
+		string equation;
+		// Up to 48 chars, so equations too long for the stacks on the call stack are checked as well
+		int length = 1 + i % 48;
+
+		for (int j = 0; j < length; j++) {
+
+			seed = seed * 1103515245 + 12345;
+			equation += ALPHABET[(seed >> 16) % ALPHABET.size()];
+		}
+
+		randomEquations.push_back(equation);
+	}
+
+	for (const string &equation : randomEquations) {
+
+		string message;
+		string stagedMessage;
+		double result = 0;
+		double stagedResult = 0;
+
+		try {
+
+			result = rpn.evaluateEquation(equation.c_str(), equation.size());
+		} catch (const invalid_argument &exception) {
+
+			message = exception.what();
+		}
+
+		try {
+
+			vector<double> values;
+			vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), values);
+			vector<Token> postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+
+			stagedResult = rpn.calcResult(postFix.data(), postFix.size(), values);
+		} catch (const invalid_argument &exception) {
+
+			stagedMessage = exception.what();
+		}
+
+		accepted += message.empty();
+		mismatches += message != stagedMessage || memcmp(&result, &stagedResult, sizeof(double)) != 0;
+	}
+
+	cout << "Single pass evaluateEquation (ns per equation), " << mismatches << " mismatches in " << randomEquations.size()
+		<< " random equations, " << accepted << " valid" << endl;
+
+	expect(mismatches == 0, "evaluateEquation differs from the staged path on random equations");
+
+	vector<string> equations = EQUATIONS;
+
+	equations.push_back(LONG_EQUATION);
+
+	for (const string &equation : equations) {
+
+		double sum = 0;
+		auto start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++) {
+
+			vector<double> values;
+			vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), values);
+			vector<Token> postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+
+			sum += rpn.calcResult(postFix.data(), postFix.size(), values);
+		}
+
+		double stagedTime = nanosecondsSince(start) / ITERATIONS;
+
+		start = chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			sum += rpn.evaluateEquation(equation.c_str(), equation.size());
+
+		double fusedTime = nanosecondsSince(start) / ITERATIONS;
+
+		sink = sum;
+
+		cout << "\t" << stagedTime << "\t" << fusedTime << "\t" << equation << endl;
+	}
+}
+
+// Compares evaluating a CSV row by row as text with ColumnReader and BatchEvaluator over CSV and binary columns
+void benchmarkColumns() {
+
+	const int ROWS = 1000000;
+	const string EQUATION = "(high-low)/close";
+	const vector<string> NAMES = { "date", "open", "high", "low", "close", "volume" };
+
+	vector<vector<double>> values(NAMES.size(), vector<double>(ROWS));
+	string csv;
+	char digits[32];
+
+	for (size_t i = 0; i < NAMES.size(); i++)
+		csv += NAMES[i] + (i + 1 < NAMES.size() ? "," : "\n");
+
+	for (int row = 0; row < ROWS; row++) {
+
+		values[0][row] = row;
+		values[1][row] = 100 + row % 1000 * 0.25;
+		values[2][row] = values[1][row] + 1 + row % 7 * 0.5;
+		values[3][row] = values[1][row] - 1 - row % 5 * 0.125;
+		values[4][row] = values[1][row] + (row % 3 - 1) * 0.375;
+		values[5][row] = 1000 + row % 10000;
+
+		for (size_t i = 0; i < NAMES.size(); i++) {
+
+			csv.append(digits, to_chars(digits, digits + sizeof(digits), values[i][row]).ptr);
+			csv += i + 1 < NAMES.size() ? ',' : '\n';
+		}
+	}
+
+	ostringstream binaryStream;
+	vector<const double *> valueColumns;
+
+	for (const vector<double> &column : values)
+		valueColumns.push_back(column.data());
+
+	ColumnReader::writeBinary(binaryStream, NAMES, valueColumns, ROWS);
+
+	string binary = binaryStream.str();
+	ReversePolishNotation rpn;
+	CompiledExpression expression(EQUATION.c_str(), EQUATION.size());
+	BatchEvaluator evaluator;
+	vector<double> expected(ROWS);
+	vector<double> answers(ROWS);
+	int mismatches = 0;
+
+	for (int row = 0; row < ROWS; row++)
+		expected[row] = expression.evaluate({ values[2][row], values[3][row], values[4][row] });
+
+	// What a wrapper script does for each row, leaving out starting a process: put the fields into the equation as text
+	auto start = chrono::steady_clock::now();
+	const int TEXT_ROWS = ROWS / 10;
+
+	for (int row = 0; row < TEXT_ROWS; row++) {
+
+		string equation = "(" + to_string(values[2][row]) + "-" + to_string(values[3][row]) + ")/" + to_string(values[4][row]);
+
+		sink = rpn.evaluateEquation(equation.c_str(), equation.size());
+	}
+
+	double textTime = nanosecondsSince(start) / TEXT_ROWS;
+	double times[2];
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		const string &file = pass == 0 ? csv : binary;
+
+		start = chrono::steady_clock::now();
+
+		ColumnReader reader(file.data(), file.size());
+		vector<int> selected;
+		vector<const double *> columns;
+		size_t first = 0;
+		size_t rows;
+
+		for (const string &name : expression.getVariableNames())
+			selected.push_back(reader.getColumnIndex(name));
+
+		while ((rows = reader.readBlock(selected, columns)) > 0) {
+
+			evaluator.evaluate(expression, columns.data(), answers.data() + first, rows);
+			first += rows;
+		}
+
+		times[pass] = nanosecondsSince(start) / ROWS;
+		mismatches += first != (size_t)ROWS || memcmp(answers.data(), expected.data(), ROWS * sizeof(double)) != 0;
+	}
+
+	cout << "Column files (ns per row, " << csv.size() / ROWS << " CSV bytes per row), " << mismatches << " mismatches" << endl;
+	cout << "\tevaluateEquation per row: " << textTime << endl;
+	cout << "\tCSV columns:              " << times[0] << endl;
+	cout << "\tbinary columns:           " << times[1] << endl;
+}
+
+// Compares writing answers to a column and summing them with reducing them as they are evaluated, and checks that the
+// parallel aggregate gives the same bits for any number of threads
+void benchmarkAggregate() {
+
+	const int ROWS = 1 << 22;
+	const int REPEATS = 10;
+	const string EQUATION = "(x-y)*x+y";
+
+	CompiledExpression expression(EQUATION.c_str(), EQUATION.size());
+	vector<double> x(ROWS);
+	vector<double> y(ROWS);
+	vector<double> output(ROWS);
+	const double *columns[] = { x.data(), y.data() };
+	BatchEvaluator evaluator;
+	long double exactSum = 0;
+
+	// Whole numbers, so every answer and the long double sum are exact and the error of each sum is known
+	for (int i = 0; i < ROWS; i++) {
+
+		x[i] = i % 1000 + 1e6 * (i % 3 == 0);
+		y[i] = 1 + i % 17;
+	}
+
+	evaluator.evaluate(expression, columns, output.data(), ROWS);
+
+	for (int i = 0; i < ROWS; i++)
+		exactSum += output[i];
+
+	auto start = chrono::steady_clock::now();
+	double sum = 0;
+	double minimum = 0;
+	double maximum = 0;
+
+	// What a caller had to do before: keep every answer, then reduce them
+	for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+		evaluator.evaluate(expression, columns, output.data(), ROWS);
+
+		sum = 0;
+		minimum = numeric_limits<double>::infinity();
+		maximum = -numeric_limits<double>::infinity();
+
+		for (int i = 0; i < ROWS; i++) {
+
+			sum += output[i];
+			minimum = min(minimum, output[i]);
+			maximum = max(maximum, output[i]);
+		}
+	}
+
+	double outputTime = nanosecondsSince(start) / ((double)ROWS * REPEATS);
+	Aggregate naive(Summation::NAIVE);
+	Aggregate compensated;
+
+	start = chrono::steady_clock::now();
+
+	for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+		naive = Aggregate(Summation::NAIVE);
+		evaluator.aggregate(expression, columns, ROWS, naive);
+	}
+
+	double naiveTime = nanosecondsSince(start) / ((double)ROWS * REPEATS);
+
+	start = chrono::steady_clock::now();
+
+	for (int repeat = 0; repeat < REPEATS; repeat++) {
+
+		compensated = Aggregate();
+		evaluator.aggregate(expression, columns, ROWS, compensated);
+	}
+
+	double compensatedTime = nanosecondsSince(start) / ((double)ROWS * REPEATS);
+	int mismatches = 0;
+	double parallelSum = 0;
+
+	for (int threads = 1; threads <= 4; threads++) {
+
+		ThreadPool pool(threads);
+		ParallelEvaluator parallel(pool);
+
+		for (int repeat = 0; repeat < 3; repeat++) {
+
+			double result = parallel.aggregate(expression, columns, ROWS).getSum();
+
+			if (threads == 1 && repeat == 0)
+				parallelSum = result;
+
+			mismatches += memcmp(&result, &parallelSum, sizeof(double)) != 0;
+		}
+	}
+
+	sink = sum + minimum + maximum;
+
+	cout << "Aggregate of " << ROWS << " rows (ns per row, error against a long double sum)" << endl;
+	cout << "\toutput column then sum:   " << outputTime << "\t" << (double)(sum - exactSum) << endl;
+	cout << "\taggregate, naive:         " << naiveTime << "\t" << (double)(naive.getSum() - exactSum) << endl;
+	cout << "\taggregate, compensated:   " << compensatedTime << "\t" << (double)(compensated.getSum() - exactSum) << endl;
+	cout << "\tparallel, 1 to 4 threads: " << mismatches << " mismatches\t" << (double)(parallelSum - exactSum) << endl;
+}
+
+// Fails the run when compensated summation gives a different answer than plain summation for infinite answers
+void testAggregate() {
+
+	const int ROWS = 1001;
+	const string EQUATION = "1/x";
+	const double INFINITE = numeric_limits<double>::infinity();
+
+	struct InfiniteCase {
+
+		// Rows where x is 0 or -0, so that 1/x is infinity or -infinity
+		vector<int> zeros;
+		vector<int> negativeZeros;
+		double expected;
+	};
+
+	// Every other row is 1/x for x from 1 to 4, so the sum is finite without the zeros
+	const vector<InfiniteCase> CASES = {
+		{ { 0 }, { }, INFINITE },
+		{ { 500 }, { }, INFINITE },
+		{ { 1000 }, { }, INFINITE },
+		{ { }, { 3 }, -INFINITE },
+		{ { 7, 900 }, { }, INFINITE },
+		{ { 2 }, { 999 }, numeric_limits<double>::quiet_NaN() }
+	};
+
+	CompiledExpression expression(EQUATION.c_str(), EQUATION.size());
+	BatchEvaluator evaluator;
+	ThreadPool pool(2);
+	ParallelEvaluator parallel(pool);
+	int checks = 0;
+	int failed = failures;
+
+	for (const InfiniteCase &infinite : CASES) {
+
+		vector<double> x(ROWS);
+		const double *columns[] = { x.data() };
+		string name = to_string(infinite.zeros.size()) + " zeros and " + to_string(infinite.negativeZeros.size()) + " negative zeros";
+
+		for (int i = 0; i < ROWS; i++)
+			x[i] = 1 + i % 4;
+
+		for (int row : infinite.zeros)
+			x[row] = 0;
+
+		for (int row : infinite.negativeZeros)
+			x[row] = -0.0;
+
+		for (Summation summation : { Summation::NAIVE, Summation::COMPENSATED }) {
+
+			Aggregate result(summation);
+			string summationName = summation == Summation::NAIVE ? " naive" : " compensated";
+
+			evaluator.aggregate(expression, columns, ROWS, result);
+
+			expect(isSame(result.getSum(), infinite.expected), "sum of 1/x with " + name + summationName + " is " + to_string(result.getSum()));
+			expect(isSame(result.getMean(), infinite.expected), "mean of 1/x with " + name + summationName + " is " + to_string(result.getMean()));
+			checks += 2;
+		}
+
+		// ParallelEvaluator uses compensated summation by default
+		Aggregate result = parallel.aggregate(expression, columns, ROWS);
+
+		expect(isSame(result.getSum(), infinite.expected), "parallel sum of 1/x with " + name + " is " + to_string(result.getSum()));
+		checks++;
+	}
+
+	cout << "Aggregate checks, " << CASES.size() << " columns with infinite answers" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Checks truth tables of random bool equations against evaluating one assignment at a time and reports the throughput of
+// BitSlicedEvaluator at each instruction set level
+void benchmarkBitSliced() {
+
+	const int VARIABLES = 20;
+	const int EQUATIONS_TESTED = 20;
+	const int OPERANDS = 24;
+	const size_t WORDS = 1 << 18;
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+	const Opcode OPERATORS[] = { Opcode::AND, Opcode::OR, Opcode::EQUAL };
+	const vector<bool> VALUES = { false, true };
+
+	unsigned int seed = 12345;
+	auto next = [&seed](unsigned int range) {
+
+		seed = seed * 1103515245 + 12345;
+
+		return (seed >> 16) % range;
+	};
+	vector<vector<Token>> equations;
+
+	// Random equations of OPERANDS operands, each operator applied as soon as it is valid half of the time
+	for (int i = 0; i < EQUATIONS_TESTED; i++) {
+
+		vector<Token> equation;
+		int depth = 0;
+		int pushed = 0;
+
+		while (pushed < OPERANDS || depth > 1) {
+
+			if (pushed < OPERANDS && (depth < 2 || next(2) == 0)) {
+
+				if (next(16) == 0)
+					equation.push_back({ Opcode::PUSH_VALUE, (int)next(2) });
+				else
+					equation.push_back({ Opcode::PUSH_VARIABLE, (int)next(VARIABLES) });
+
+				pushed++;
+				depth++;
+			} else {
+
+				equation.push_back({ OPERATORS[next(3)], 0 });
+				depth--;
+			}
+
+			if (next(4) == 0)
+				equation.push_back({ Opcode::NOT, 0 });
+		}
+
+		equations.push_back(equation);
+	}
+
+	ReversePolishNotation rpn;
+	size_t assignments = (size_t)1 << VARIABLES;
+	int mismatches = 0;
+	vector<bool> variables(VARIABLES);
+	double scalarTime = 0;
+
+	for (const vector<Token> &equation : equations) {
+
+		BitSlicedEvaluator evaluator(equation.data(), equation.size(), VALUES, VARIABLES);
+		vector<BitSlicedEvaluator::Word> table = evaluator.truthTable();
+		auto start = chrono::steady_clock::now();
+
+		for (size_t i = 0; i < assignments; i++) {
+
+			for (int j = 0; j < VARIABLES; j++)
+				variables[j] = i >> j & 1;
+
+			if (rpn.calcResult(equation.data(), equation.size(), VALUES, variables) != (bool)(table[i / 64] >> (i % 64) & 1))
+				mismatches++;
+		}
+
+		scalarTime += nanosecondsSince(start);
+	}
+
+	cout << "Bit-sliced bool equations (million assignments per second), " << EQUATIONS_TESTED << " random equations of "
+		<< VARIABLES << " variables, " << mismatches << " truth table mismatches" << endl;
+	cout << "	one assignment at a time: " << EQUATIONS_TESTED * assignments / scalarTime * 1000 << " (including the check)" << endl;
+
+	vector<vector<BitSlicedEvaluator::Word>> bitmaps(VARIABLES, vector<BitSlicedEvaluator::Word>(WORDS));
+	vector<const BitSlicedEvaluator::Word *> columns;
+	vector<BitSlicedEvaluator::Word> output(WORDS), expected(WORDS);
+
+	for (vector<BitSlicedEvaluator::Word> &bitmap : bitmaps) {
+
+		for (BitSlicedEvaluator::Word &word : bitmap)
+			word = (BitSlicedEvaluator::Word)next(1 << 16) << 48 ^ (BitSlicedEvaluator::Word)next(1 << 16) << 24 ^ next(1 << 16);
+
+		columns.push_back(bitmap.data());
+	}
+
+	for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+		// Levels the CPU does not support fall back to a narrower one, so they are skipped
+		if (SimdKernels(instructionSet).getInstructionSet() != instructionSet)
+			continue;
+
+		double tableTime = 0;
+		double bitmapTime = 0;
+		int bitmapMismatches = 0;
+
+		for (const vector<Token> &equation : equations) {
+
+			BitSlicedEvaluator evaluator(equation.data(), equation.size(), VALUES, VARIABLES, instructionSet);
+			auto start = chrono::steady_clock::now();
+			vector<BitSlicedEvaluator::Word> table = evaluator.truthTable();
+
+			tableTime += nanosecondsSince(start);
+			sink = table[0];
+			start = chrono::steady_clock::now();
+			evaluator.evaluate(columns.data(), output.data(), WORDS);
+			bitmapTime += nanosecondsSince(start);
+
+			// Every level is checked against the scalar one
+			BitSlicedEvaluator(equation.data(), equation.size(), VALUES, VARIABLES, InstructionSet::SCALAR).evaluate(columns.data(), expected.data(), WORDS);
+
+			if (output != expected)
+				bitmapMismatches++;
+		}
+
+		cout << "	" << SimdKernels::getInstructionSetName(instructionSet) << ": truth table " << EQUATIONS_TESTED * assignments / tableTime * 1000
+			<< ", bitmaps " << EQUATIONS_TESTED * WORDS * 64 / bitmapTime * 1000 << ", " << bitmapMismatches << " bitmap mismatches" << endl;
+	}
+}
+
+// Checks the precedence of the bool operators, checks BoolExpression against the staged bool functions on random text and
+// compares short-circuit jumps with evaluating every clause of a long '|' chain
+void benchmarkBoolExpression() {
+
+	const int RANDOM_EQUATIONS = 200000;
+	const int ROWS = 200000;
+	const int CLAUSES = 64;
+	const string ALPHABET = "ab01!&|=()-+  ";
+	// Each equation only gives its answer when '!' binds tightest, then '=', then '&', then '|'
+	const vector<pair<string, bool>> PRECEDENCE = { { "1 | 0 & 0", true }, { "!0 & 0", false }, { "0 = 0 & 0", false },
+		{ "1 | 1 = 0", true }, { "!1 = 0", true }, { "!(1 | 0) | !!1", true }, { "0 & 1 | 1 & 1", true } };
+
+	ReversePolishNotation rpn;
+	int precedenceMismatches = 0;
+
+	for (const pair<string, bool> &test : PRECEDENCE)
+		precedenceMismatches += rpn.evaluateBoolEquation(test.first.c_str(), test.first.size()) != test.second;
+
+	int mismatches = 0;
+	int accepted = 0;
+	unsigned int seed = 12345;
+
+	// Random text, evaluated as a bool equation for every assignment of its variables and as an arithmetic equation
+	for (int i = 0; i < RANDOM_EQUATIONS; i++) {
+
+		string equation;
+		int length = 1 + i % 16;
+
+		for (int j = 0; j < length; j++) {
+
+			seed = seed * 1103515245 + 12345;
+			equation += ALPHABET[(seed >> 16) % ALPHABET.size()];
+		}
+
+		// Blank equations have no tokens, which convertInfixToPostFix reports as a null equation rather than an invalid one
+		if (equation.find_first_not_of(' ') == string::npos)
+			continue;
+
+		Expected<BoolExpression> expression = BoolExpression::tryCompile(equation.c_str(), equation.size());
+		string stagedMessage;
+		vector<Token> postFix;
+		vector<bool> values;
+		vector<string> variableNames;
+
+		try {
+
+			vector<double> numbers;
+			vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), numbers, variableNames);
+
+			postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+
+			for (double number : numbers)
+				values.push_back(number != 0);
+
+			rpn.validateBoolPostFix(postFix.data(), postFix.size(), values.size(), variableNames.size());
+		} catch (const invalid_argument &exception) {
+
+			stagedMessage = exception.what();
+		}
+
+		if (expression.hasValue() != stagedMessage.empty() || (!expression && expression.getError().getMessage() != stagedMessage)) {
+
+			mismatches++;
+		} else if (expression) {
+
+			int variableCount = variableNames.size();
+
+			accepted++;
+
+			for (int assignment = 0; assignment < 1 << variableCount; assignment++) {
+
+				vector<bool> variables(variableCount);
+
+				for (int j = 0; j < variableCount; j++)
+					variables[j] = assignment >> j & 1;
+
+				mismatches += expression.getValue().evaluate(variables) != rpn.calcResult(postFix.data(), postFix.size(), values, variables);
+			}
+		}
+
+		// The arithmetic functions must reject the bool operators the same way
+		string message;
+		double result = 0;
+		double stagedResult = 0;
+
+		stagedMessage.clear();
+
+		try {
+
+			result = rpn.evaluateEquation(equation.c_str(), equation.size());
+		} catch (const invalid_argument &exception) {
+
+			message = exception.what();
+		}
+
+		try {
+
+			vector<double> numbers;
+			vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), numbers);
+
+			postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+			stagedResult = rpn.calcResult(postFix.data(), postFix.size(), numbers);
+		} catch (const invalid_argument &exception) {
+
+			stagedMessage = exception.what();
+		}
+
+		mismatches += message != stagedMessage || memcmp(&result, &stagedResult, sizeof(double)) != 0;
+	}
+
+	cout << "Bool equations, " << precedenceMismatches << " precedence mismatches, " << mismatches << " mismatches in "
+		<< RANDOM_EQUATIONS << " random equations, " << accepted << " valid bool equations" << endl;
+
+	// A rule of CLAUSES clauses like c0 & !d0 | c1 & !d1 | ..., where the first clause decides most rows
+	string rule;
+
+	for (int i = 0; i < CLAUSES; i++)
+		rule += (i > 0 ? " | c" : "c") + to_string(i) + " & !d" + to_string(i);
+
+	BoolExpression expression(rule.c_str(), rule.size());
+	int variableCount = expression.getVariableCount();
+	vector<bool> values;
+	// Rows of variables, as bools for BoolExpression and as a vector<bool> per row for calcResult
+	unique_ptr<bool[]> rows(new bool[(size_t)ROWS * variableCount]);
+	vector<vector<bool>> rowVectors(ROWS, vector<bool>(variableCount));
+
+	for (int i = 0; i < ROWS; i++) {
+
+		for (int j = 0; j < variableCount; j++) {
+
+			seed = seed * 1103515245 + 12345;
+
+			// Slots 0 and 1 are c0 and d0, which make the first clause true in 7 of 8 rows. Every other variable is random
+			bool value = j < 2 ? ((seed >> 16) % 8 != 0) != (j == 1) : (seed >> 16) % 2 != 0;
+
+			rows[(size_t)i * variableCount + j] = value;
+			rowVectors[i][j] = value;
+		}
+	}
+
+	const vector<Token> &postFix = expression.getPostFix();
+	int ruleMismatches = 0;
+	int trueRows = 0;
+	int jumpTrueRows = 0;
+
+	for (int i = 0; i < ROWS; i++)
+		ruleMismatches += expression.evaluate(rows.get() + (size_t)i * variableCount) != rpn.calcResult(postFix.data(), postFix.size(), values, rowVectors[i]);
+
+	auto start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ROWS; i++)
+		trueRows += rpn.calcResult(postFix.data(), postFix.size(), values, rowVectors[i]);
+
+	double stackTime = nanosecondsSince(start) / ROWS;
+
+	start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ROWS; i++)
+		jumpTrueRows += expression.evaluate(rows.get() + (size_t)i * variableCount);
+
+	double jumpTime = nanosecondsSince(start) / ROWS;
+
+	cout << "\t" << CLAUSES << " clause '|' rule (ns per row), " << trueRows << " of " << ROWS << " rows true, "
+		<< ruleMismatches + (jumpTrueRows != trueRows) << " mismatches" << endl;
+	cout << "\t\tcalcResult:     " << stackTime << endl;
+	cout << "\t\tBoolExpression: " << jumpTime << " (" << expression.getInstructionCount() << " instructions)" << endl;
+}
+
+// Checks comparisons in every engine and reports how much a selection vector saves over evaluating every row
+void benchmarkFilter() {
+
+	const int ROWS = 1000000;
+	const int RANDOM_EQUATIONS = 200000;
+	const string ALPHABET = "12<>!=&|*-()  ";
+	const string PREDICATE = "(a*b) > 1500 & c != 0";
+	const string REFINEMENT = "a - b <= 5 | c >= 3";
+	const string PROJECTION = "(a^1.7 + b^2.3) / (c*c + 1) - (a + b)^0.3 * a^1.1";
+	const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+	// Comparisons bind looser than arithmetic and tighter than '=', '!=', '&' and '|'
+	const vector<pair<string, double>> PRECEDENCE = { { "1 < 2", 1 }, { "1 + 1 = 2", 1 }, { "2 = 3", 0 }, { "1 < 2 = 1", 1 },
+		{ "2 <= 2 & 3 >= 4", 0 }, { "3 != 3 | 4 > -1", 1 }, { "-1 < -0.5", 1 }, { "!(1 > 2) * 5", 5 }, { "2*3 > 5 & !0", 1 },
+		{ "0 < 1 < 2", 1 }, { "1 | 0 & 0", 1 } };
+
+	ReversePolishNotation rpn;
+	int precedenceMismatches = 0;
+
+	for (const pair<string, double> &test : PRECEDENCE)
+		precedenceMismatches += rpn.evaluateEquation(test.first.c_str(), test.first.size()) != test.second;
+
+	// In a bool equation every number is a bool first, and '!=' is the same as !(a = b)
+	precedenceMismatches += rpn.evaluateBoolEquation("2 = 3", 5) != true;
+	precedenceMismatches += rpn.evaluateBoolEquation("1 != 0 & 0 != 0", 15) != false;
+
+	int mismatches = 0;
+	int accepted = 0;
+	unsigned int seed = 12345;
+
+	// Random text, evaluated by the single pass evaluateEquation and by the staged path
+	for (int i = 0; i < RANDOM_EQUATIONS; i++) {
+
+		string equation;
+		int length = 1 + i % 16;
+
+		for (int j = 0; j < length; j++) {
+
+			seed = seed * 1103515245 + 12345;
+			equation += ALPHABET[(seed >> 16) % ALPHABET.size()];
+		}
+
+		if (equation.find_first_not_of(' ') == string::npos)
+			continue;
+
+		string message, stagedMessage;
+		double result = 0, stagedResult = 0;
+
+		try {
+
+			result = rpn.evaluateEquation(equation.c_str(), equation.size());
+		} catch (const invalid_argument &exception) {
+
+			message = exception.what();
+		}
+
+		try {
+
+			vector<double> values;
+			vector<Token> infix = rpn.stripValuesFromEquation(equation.c_str(), equation.size(), values);
+			vector<Token> postFix = rpn.convertInfixToPostFix(infix.data(), infix.size());
+
+			stagedResult = rpn.calcResult(postFix.data(), postFix.size(), values);
+		} catch (const invalid_argument &exception) {
+
+			stagedMessage = exception.what();
+		}
+
+		accepted += message.empty();
+		mismatches += message != stagedMessage || memcmp(&result, &stagedResult, sizeof(double)) != 0;
+	}
+
+	cout << "Filters, " << precedenceMismatches << " precedence mismatches, " << mismatches << " mismatches in "
+		<< RANDOM_EQUATIONS << " random equations, " << accepted << " valid equations" << endl;
+
+	vector<double> a(ROWS), b(ROWS), c(ROWS);
+
+	for (int i = 0; i < ROWS; i++) {
+
+		seed = seed * 1103515245 + 12345;
+		a[i] = (seed >> 16) % 1000 * 0.05;
+		seed = seed * 1103515245 + 12345;
+		b[i] = (seed >> 16) % 1000 * 0.05;
+		seed = seed * 1103515245 + 12345;
+		c[i] = (seed >> 16) % 4;
+	}
+
+	// NaN and -0 in a few rows, where only '!=' is true and -0 equals 0
+	a[1] = nan("");
+	c[2] = -0.0;
+
+	CompiledExpression predicate(PREDICATE.c_str(), PREDICATE.size());
+	CompiledExpression refinement(REFINEMENT.c_str(), REFINEMENT.size());
+	CompiledExpression projection(PROJECTION.c_str(), PROJECTION.size());
+	auto getColumns = [&](const CompiledExpression &expression) {
+
+		vector<const double *> result;
+
+		for (const string &name : expression.getVariableNames())
+			result.push_back(name == "a" ? a.data() : name == "b" ? b.data() : c.data());
+
+		return result;
+	};
+	vector<const double *> predicateColumns = getColumns(predicate);
+	vector<const double *> refinementColumns = getColumns(refinement);
+	vector<const double *> projectionColumns = getColumns(projection);
+	vector<double> expected(ROWS), output(ROWS);
+
+	for (int i = 0; i < ROWS; i++)
+		expected[i] = predicate.evaluate({ predicateColumns[0][i], predicateColumns[1][i], predicateColumns[2][i] });
+
+	cout << "\t" << PREDICATE << " (million rows per second)" << endl;
+
+	for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+
+		BatchEvaluator evaluator(instructionSet);
+		int kernelMismatches = 0;
+
+		if (SimdKernels(instructionSet).getInstructionSet() != instructionSet)
+			continue;
+
+		auto start = chrono::steady_clock::now();
+
+		evaluator.evaluate(predicate, predicateColumns.data(), output.data(), ROWS);
+
+		double time = nanosecondsSince(start);
+
+		for (int i = 0; i < ROWS; i++)
+			kernelMismatches += memcmp(&output[i], &expected[i], sizeof(double)) != 0;
+
+		cout << "\t\t" << SimdKernels::getInstructionSetName(instructionSet) << ": " << ROWS / time * 1000 << ", " << kernelMismatches << " mismatches" << endl;
+	}
+
+	BatchEvaluator evaluator;
+	vector<size_t> selection(ROWS), refined(ROWS);
+	vector<uint64_t> bitmap((ROWS + 63) / 64);
+	size_t count = evaluator.select(predicate, predicateColumns.data(), ROWS, selection.data());
+	int selectionMismatches = 0;
+	size_t next = 0;
+
+	evaluator.filter(predicate, predicateColumns.data(), ROWS, bitmap.data());
+
+	// The selection vector, the bitmap and calcResult must agree on every row
+	for (int i = 0; i < ROWS; i++) {
+
+		bool passes = expected[i] != 0;
+		bool selected = next < count && selection[next] == (size_t)i;
+
+		next += selected;
+		selectionMismatches += passes != selected || passes != (bool)(bitmap[i / 64] >> (i % 64) & 1);
+	}
+
+	// A second filter only checks the rows that passed the first one
+	size_t refinedCount = evaluator.select(refinement, refinementColumns.data(), selection.data(), count, refined.data());
+	size_t expectedRefined = 0;
+
+	for (size_t i = 0; i < count; i++) {
+
+		size_t row = selection[i];
+
+		if (refinement.evaluate({ refinementColumns[0][row], refinementColumns[1][row], refinementColumns[2][row] }) != 0) {
+
+			selectionMismatches += expectedRefined >= refinedCount || refined[expectedRefined] != row;
+			expectedRefined++;
+		}
+	}
+
+	selectionMismatches += expectedRefined != refinedCount;
+
+	// Every row is evaluated and the answers of the rows that fail are thrown away, against only evaluating the rows that pass
+	auto start = chrono::steady_clock::now();
+
+	evaluator.evaluate(predicate, predicateColumns.data(), expected.data(), ROWS);
+	evaluator.evaluate(projection, projectionColumns.data(), output.data(), ROWS);
+
+	double allTime = nanosecondsSince(start);
+	double allSum = 0;
+
+	for (int i = 0; i < ROWS; i++) {
+
+		if (expected[i] != 0)
+			allSum += output[i];
+	}
+
+	start = chrono::steady_clock::now();
+
+	count = evaluator.select(predicate, predicateColumns.data(), ROWS, selection.data());
+	evaluator.evaluate(projection, projectionColumns.data(), selection.data(), count, output.data());
+
+	double selectedTime = nanosecondsSince(start);
+	double selectedSum = 0;
+
+	for (size_t i = 0; i < count; i++)
+		selectedSum += output[i];
+
+	sink = selectedSum;
+
+	cout << "\tSelection vectors, " << count << " of " << ROWS << " rows pass, " << selectionMismatches + (allSum != selectedSum) << " mismatches" << endl;
+	cout << "\t\t" << PROJECTION << " (ns per row)" << endl;
+	cout << "\t\tevery row:     " << allTime / ROWS << endl;
+	cout << "\t\tselected rows: " << selectedTime / ROWS << endl;
+}
+
+// Compares parseNumber with the string based getNumber over literal heavy input
+void benchmarkNumberParsing() {
+
+	const int ITERATIONS = 200;
+	const int LITERALS = 10000;
+
+	string data;
+	vector<int> starts;
+
+	for (int i = 0; i < LITERALS; i++) {
+
+		starts.push_back(data.size());
+		data += to_string(i * 7919 % 100000) + "." + to_string(i * 104729 % 1000000) + "+";
+	}
+
+	double sum = 0;
+	int end;
+	auto start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+
+		for (int literalStart : starts)
+			sum += legacyGetNumber(data.c_str(), data.size(), literalStart, end);
+	}
+
+	double legacyTime = nanosecondsSince(start);
+	double value;
+
+	start = chrono::steady_clock::now();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+
+		for (int literalStart : starts) {
+
+			parseNumber(data.c_str(), data.size(), literalStart, end, value);
+			sum += value;
+		}
+	}
+
+	double parseTime = nanosecondsSince(start);
+
+	sink = sum;
+
+	cout << "Number parsing (ns per literal)" << endl;
+	cout << "	stod based getNumber: " << legacyTime / ((double)ITERATIONS * LITERALS) << endl;
+	cout << "	parseNumber:          " << parseTime / ((double)ITERATIONS * LITERALS) << endl;
+}
+
+// Compares recalculating only the formulas an input change reaches with evaluating every formula again
+void benchmarkFormulas() {
+
+	const int INPUTS = 1000;
+	const int LAYERS = 8;
+	const int WIDTH = 2000;
+	const int CHANGES = 200;
+	const int WINDOW = 16;
+	// Every fourth formula only depends on whether its first dependency is above 0.5, so most changes stop there
+	const vector<string> SHAPES = { "(a + b + c) / 3", "a*0.5 + b*0.25 + c^2*0.25", "(a - b)*(a - b) + c*0.1", "(a > 0.5) + b*0 + c*0" };
+
+	vector<string> names;
+	vector<unique_ptr<CompiledExpression>> expressions;
+	vector<vector<int>> dependencies;
+	vector<double> values(INPUTS + LAYERS * WIDTH);
+	unsigned int seed = 11;
+
+	auto random = [&]() {
+
+		seed = seed * 1103515245 + 12345;
+
+		return (seed >> 16) & 0x7FFF;
+	};
+
+	for (int i = 0; i < INPUTS; i++) {
+
+		names.push_back("in" + to_string(i));
+		values[i] = random() / 32768.0;
+	}
+
+	int threads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+	ThreadPool pool(threads);
+	ThreadPool single(1);
+	FormulaGraph graph(pool);
+	FormulaGraph serialGraph(single);
+
+	for (int i = 0; i < INPUTS; i++) {
+
+		graph.setInput(names[i], values[i]);
+		serialGraph.setInput(names[i], values[i]);
+	}
+
+	// Each formula uses three nearby nodes of the layer below, like cells referring to the rows around them, the first layer uses the inputs
+	for (int layer = 0; layer < LAYERS; layer++) {
+
+		int first = layer == 0 ? 0 : INPUTS + (layer - 1) * WIDTH;
+		int count = layer == 0 ? INPUTS : WIDTH;
+
+		for (int j = 0; j < WIDTH; j++) {
+
+			string name = "f" + to_string(layer) + "_" + to_string(j);
+			string shape = SHAPES[j % SHAPES.size()];
+			vector<int> used;
+			string equation;
+
+			for (char symbol : shape) {
+
+				if (symbol >= 'a' && symbol <= 'c') {
+
+					int dependency = first + (j * count / WIDTH + random() % WINDOW) % count;
+
+					used.push_back(dependency);
+					equation += names[dependency];
+				} else {
+
+					equation.push_back(symbol);
+				}
+			}
+
+			unique_ptr<CompiledExpression> expression(new CompiledExpression(equation.c_str(), equation.size()));
+			vector<int> slots(expression->getVariableCount());
+
+			// The slots follow the order of first use, which may merge repeated names
+			for (int k = 0; k < expression->getVariableCount(); k++)
+				slots[k] = find_if(used.begin(), used.end(), [&](int node) { return names[node] == expression->getVariableNames()[k]; }) - used.begin();
+
+			for (int &slot : slots)
+				slot = used[slot];
+
+			graph.addFormula(name, equation.c_str(), equation.size());
+			serialGraph.addFormula(name, equation.c_str(), equation.size());
+			names.push_back(name);
+			expressions.push_back(std::move(expression));
+			dependencies.push_back(slots);
+		}
+	}
+
+	// Evaluates every formula in layer order, which is all that could be done without the graph
+	auto recomputeAll = [&]() {
+
+		vector<double> arguments;
+
+		for (size_t i = 0; i < expressions.size(); i++) {
+
+			arguments.resize(dependencies[i].size());
+
+			for (size_t k = 0; k < dependencies[i].size(); k++)
+				arguments[k] = values[dependencies[i][k]];
+
+			values[INPUTS + i] = expressions[i]->evaluate(arguments);
+		}
+	};
+
+	int mismatches = 0;
+
+	auto compare = [&]() {
+
+		for (size_t i = INPUTS; i < names.size(); i++) {
+
+			double value = graph.getValue(names[i]);
+			double serialValue = serialGraph.getValue(names[i]);
+
+			if (memcmp(&value, &values[i], sizeof(double)) != 0 || memcmp(&serialValue, &values[i], sizeof(double)) != 0)
+				mismatches++;
+		}
+	};
+
+	auto start = chrono::steady_clock::now();
+
+	recomputeAll();
+
+	double fullTime = nanosecondsSince(start);
+
+	start = chrono::steady_clock::now();
+
+	size_t initial = graph.recalculate();
+
+	double initialTime = nanosecondsSince(start);
+
+	serialGraph.recalculate();
+	compare();
+
+	// Changes one input at a time
+	size_t evaluated = 0;
+	double singleTime = 0;
+
+	for (int i = 0; i < CHANGES; i++) {
+
+		int input = random() % INPUTS;
+
+		values[input] = random() / 32768.0;
+		graph.setInput(names[input], values[input]);
+		serialGraph.setInput(names[input], values[input]);
+
+		start = chrono::steady_clock::now();
+		evaluated += graph.recalculate();
+		singleTime += nanosecondsSince(start);
+
+		serialGraph.recalculate();
+	}
+
+	recomputeAll();
+	compare();
+
+	// Changes every input, so every formula is reached and the levels are wide enough to share
+	for (int i = 0; i < INPUTS; i++) {
+
+		values[i] = random() / 32768.0;
+		graph.setInput(names[i], values[i]);
+		serialGraph.setInput(names[i], values[i]);
+	}
+
+	start = chrono::steady_clock::now();
+
+	size_t everyEvaluated = serialGraph.recalculate();
+
+	double serialTime = nanosecondsSince(start);
+
+	start = chrono::steady_clock::now();
+	graph.recalculate();
+
+	double parallelTime = nanosecondsSince(start);
+
+	recomputeAll();
+	compare();
+
+	// Setting inputs to the values they already have evaluates nothing
+	for (int i = 0; i < INPUTS; i++)
+		graph.setInput(names[i], values[i]);
+
+	size_t unchanged = graph.recalculate();
+
+	// Cycles are rejected when the formula closing them is added, and the graph stays usable
+	int cycles = 0;
+	const vector<pair<string, string>> CYCLE_FORMULAS = { { "self", "self + 1" }, { "cycleA", "cycleB + 1" }, { "cycleB", "cycleC * 2" }, { "cycleC", "cycleA - in0" }, { "cycleC", "cycleD + 1" }, { "cycleD", "cycleB" } };
+
+	for (const pair<string, string> &formula : CYCLE_FORMULAS) {
+
+		try {
+
+			graph.addFormula(formula.first, formula.second.c_str(), formula.second.size());
+		} catch (const invalid_argument &) {
+
+			cycles++;
+		}
+	}
+
+	// A formula may use one added later
+	graph.setInput("cycleX", 3);
+	graph.addFormula("later", "early * 2", 9);
+	graph.addFormula("early", "in0 + cycleX", 12);
+	graph.recalculate();
+
+	if (graph.getValue("later") != (values[0] + 3) * 2)
+		mismatches++;
+
+	graph.setInput("cycleX", 4);
+	graph.recalculate();
+
+	if (graph.getValue("later") != (values[0] + 4) * 2)
+		mismatches++;
+
+	cout << "Formula graph (ms), " << graph.getFormulaCount() << " formulas on " << LAYERS << " levels" << endl;
+	cout << "\tRecompute every formula: " << fullTime / 1e6 << endl;
+	cout << "\tFirst recalculation: " << initialTime / 1e6 << " for " << initial << " formulas" << endl;
+	cout << "\tOne input changed: " << singleTime / CHANGES / 1e6 << ", " << evaluated / (double)CHANGES << " formulas evaluated on average" << endl;
+	cout << "\tEvery input changed: " << serialTime / 1e6 << " on 1 thread, " << parallelTime / 1e6 << " on " << threads << " threads for " << everyEvaluated << " formulas" << endl;
+	cout << "\tInputs set to the same values: " << unchanged << " formulas evaluated" << endl;
+	cout << "\tCycles rejected: " << cycles << " of 3, " << mismatches << " mismatches" << endl;
+}
+
+// Compares evaluating dashboard equations that share subterms one at a time with evaluating them merged
+void benchmarkShared() {
+
+	const int ROWS = 1000000;
+	// Subterms the equations are built from, most of them used by several equations
+	const vector<string> TERMS = { "(high-low)/close", "(close-open)/open", "(high+low+close)/3", "volume*close", "(high-low)^2", "volume^0.5" };
+
+	vector<string> equations;
+
+	for (size_t i = 0; i < TERMS.size(); i++) {
+
+		for (size_t j = i + 1; j < TERMS.size(); j++) {
+
+			equations.push_back(TERMS[i] + "*" + TERMS[j] + "+" + to_string(i));
+			equations.push_back("(" + TERMS[j] + "-" + TERMS[i] + ")/" + TERMS[i]);
+		}
+	}
+
+	// Operands in the other order, an equation given twice, a bare column, a value and a comparison
+	equations.push_back("close/(high-low)*(close*volume)");
+	equations.push_back(equations[0]);
+	equations.push_back("close");
+	equations.push_back("2+3");
+	equations.push_back("(high-low)/close > 0.05");
+
+	vector<double> high(ROWS), low(ROWS), open(ROWS), close(ROWS), volume(ROWS);
+	unsigned int seed = 5;
+
+	auto random = [&]() {
+
+		seed = seed * 1103515245 + 12345;
+
+		return ((seed >> 16) & 0x7FFF) / 32768.0;
+	};
+
+	for (int i = 0; i < ROWS; i++) {
+
+		low[i] = 50 + random() * 50;
+		high[i] = low[i] + random() * 10;
+		open[i] = low[i] + random() * (high[i] - low[i]);
+		close[i] = low[i] + random() * (high[i] - low[i]);
+		volume[i] = random() * 1e6;
+	}
+
+	auto column = [&](const string &name) {
+
+		return name == "high" ? high.data() : name == "low" ? low.data() : name == "open" ? open.data() : name == "close" ? close.data() : volume.data();
+	};
+
+	MultiExpression merged(equations);
+	vector<CompiledExpression> separate;
+	vector<vector<const double *>> separateColumns;
+	int separateOperations = 0;
+
+	for (const string &equation : equations) {
+
+		separate.emplace_back(equation.c_str(), equation.size());
+		separateColumns.emplace_back();
+
+		for (const string &name : separate.back().getVariableNames())
+			separateColumns.back().push_back(column(name));
+
+		for (const Token &token : separate.back().getPostFix())
+			if (token.opcode != Opcode::PUSH_VALUE && token.opcode != Opcode::PUSH_VARIABLE && token.opcode != Opcode::PUSH_NEGATIVE_ONE)
+				separateOperations++;
+	}
+
+	vector<const double *> mergedColumns;
+
+	for (const string &name : merged.getVariableNames())
+		mergedColumns.push_back(column(name));
+
+	vector<vector<double>> expected(equations.size(), vector<double>(ROWS));
+	vector<vector<double>> answers(equations.size(), vector<double>(ROWS));
+	vector<double *> outputs;
+
+	for (vector<double> &answer : answers)
+		outputs.push_back(answer.data());
+
+	BatchEvaluator evaluator;
+
+	auto start = chrono::steady_clock::now();
+
+	for (size_t i = 0; i < equations.size(); i++)
+		evaluator.evaluate(separate[i], separateColumns[i].data(), expected[i].data(), ROWS);
+
+	double separateTime = nanosecondsSince(start);
+
+	start = chrono::steady_clock::now();
+	evaluator.evaluate(merged, mergedColumns.data(), outputs.data(), ROWS);
+
+	double mergedTime = nanosecondsSince(start);
+
+	// Only the NaN returned for two NaN operands may differ once operands are reordered
+	int mismatches = 0;
+
+	for (size_t i = 0; i < equations.size(); i++)
+		for (int j = 0; j < ROWS; j++)
+			if (memcmp(&answers[i][j], &expected[i][j], sizeof(double)) != 0 && !(isnan(answers[i][j]) && isnan(expected[i][j])))
+				mismatches++;
+
+	int errors = 0;
+
+	try {
+
+		MultiExpression invalid({ "a+b", "a+*b" });
+	} catch (const invalid_argument &) {
+
+		errors++;
+	}
+
+	cout << "Shared subterms, " << equations.size() << " equations over " << ROWS << " rows" << endl;
+	cout << "\tOperators per row: " << separateOperations << " on their own, " << merged.getOperationCount() << " merged, " << merged.getSavedOperations() << " saved, " << merged.getSlotCount() << " scratch blocks" << endl;
+	cout << "\tOne at a time (ms): " << separateTime / 1e6 << endl;
+	cout << "\tMerged (ms):        " << mergedTime / 1e6 << endl;
+	cout << "\t" << mismatches << " mismatches, " << errors << " of 1 invalid sets rejected" << endl;
+}
+
+// Checks that one BatchEvaluator gives the same answers as a new one when MultiExpression and CompiledExpression are
+// evaluated on it in turn, since the two share its scratch space
+void testShared() {
+
+	const int ROWS = 3000;
+	// Merged into more scratch slots than any equation below needs for its operand stack
+	const vector<string> MERGED = { "(a-b)/c*(a+b)", "(a+b)*(c-d)/(a-b)", "((a-b)/c+(c-d))*((a+b)/d-(c+d))", "a*b-c*d+(a-d)*(b-c)" };
+	const vector<string> EQUATIONS = { "a*b", "a-(b-(c-d))", "(a+b)*(c+d)", "a/(b+c*(d-a))" };
+
+	vector<double> a(ROWS), b(ROWS), c(ROWS), d(ROWS);
+	vector<size_t> selection;
+
+	for (int i = 0; i < ROWS; i++) {
+
+		a[i] = 1 + i % 7;
+		b[i] = 0.5 * (i % 11) - 2;
+		c[i] = 3 - i % 5;
+		d[i] = 0.25 * (i % 13);
+
+		if (i % 3 != 0)
+			selection.push_back(i);
+	}
+
+	auto column = [&](const string &name) {
+
+		return name == "a" ? a.data() : name == "b" ? b.data() : name == "c" ? c.data() : d.data();
+	};
+
+	MultiExpression merged(MERGED);
+	vector<const double *> mergedColumns;
+	vector<vector<double>> expectedMerged(MERGED.size(), vector<double>(ROWS));
+	vector<double *> expectedOutputs;
+
+	for (const string &name : merged.getVariableNames())
+		mergedColumns.push_back(column(name));
+
+	for (vector<double> &answer : expectedMerged)
+		expectedOutputs.push_back(answer.data());
+
+	BatchEvaluator().evaluate(merged, mergedColumns.data(), expectedOutputs.data(), ROWS);
+
+	int checks = 0;
+	int failed = failures;
+
+	for (const string &equation : EQUATIONS) {
+
+		CompiledExpression expression(equation.c_str(), equation.size());
+		vector<const double *> columns;
+
+		for (const string &name : expression.getVariableNames())
+			columns.push_back(column(name));
+
+		vector<double> expected(ROWS), expectedSelected(selection.size());
+
+		BatchEvaluator().evaluate(expression, columns.data(), expected.data(), ROWS);
+		BatchEvaluator().evaluate(expression, columns.data(), selection.data(), selection.size(), expectedSelected.data());
+
+		// The merged equations first, then the equation, then the merged equations again on the same evaluator
+		BatchEvaluator evaluator;
+		vector<vector<double>> answersMerged(MERGED.size(), vector<double>(ROWS));
+		vector<double *> outputs;
+		vector<double> answers(ROWS), answersSelected(selection.size());
+
+		for (vector<double> &answer : answersMerged)
+			outputs.push_back(answer.data());
+
+		evaluator.evaluate(merged, mergedColumns.data(), outputs.data(), ROWS);
+		evaluator.evaluate(expression, columns.data(), answers.data(), ROWS);
+		evaluator.evaluate(expression, columns.data(), selection.data(), selection.size(), answersSelected.data());
+		evaluator.evaluate(merged, mergedColumns.data(), outputs.data(), ROWS);
+
+		expect(equal(answers.begin(), answers.end(), expected.begin(), isSame), equation + " after a MultiExpression on the same evaluator");
+		expect(equal(answersSelected.begin(), answersSelected.end(), expectedSelected.begin(), isSame), equation + " over selected rows after a MultiExpression on the same evaluator");
+		checks += 2;
+
+		for (size_t i = 0; i < MERGED.size(); i++) {
+
+			expect(equal(answersMerged[i].begin(), answersMerged[i].end(), expectedMerged[i].begin(), isSame), MERGED[i] + " merged after " + equation + " on the same evaluator");
+			checks++;
+		}
+	}
+
+	cout << "Shared subterm checks, " << MERGED.size() << " merged equations in " << merged.getSlotCount() << " scratch blocks, " << EQUATIONS.size() << " equations" << endl;
+	cout << "\t" << checks << " checks, " << failures - failed << " failed" << endl;
+}
+
+// Checks the partials of DualEvaluator against derivatives worked out by hand and compares one dual pass with finite differences
+void benchmarkGradient() {
+
+	const int POINTS = 100000;
+	const int ROWS = 1000000;
+
+	struct Derivative {
+
+		string equation;
+		function<double(double, double)> dx;
+		function<double(double, double)> dy;
+	};
+
+	// Equations of x and y with their partials worked out by hand
+	const vector<Derivative> DERIVATIVES = {
+		{ "x^y", [](double x, double y) { return y * pow(x, y - 1); }, [](double x, double y) { return pow(x, y) * log(x); } },
+		{ "x*y - x/y", [](double, double y) { return y - 1 / y; }, [](double x, double y) { return x + x / (y * y); } },
+		{ "(x-y)^2 + (x*x + y*y)^0.5", [](double x, double y) { return 2 * (x - y) + x / sqrt(x * x + y * y); }, [](double x, double y) { return -2 * (x - y) + y / sqrt(x * x + y * y); } },
+		{ "x^3 - 2*x*y + y%3", [](double x, double y) { return 3 * x * x - 2 * y; }, [](double x, double) { return -2 * x; } },
+		{ "-(x/y)^0.5 + (x > y)", [](double x, double y) { return -0.5 / sqrt(x / y) / y; }, [](double x, double y) { return 0.5 / sqrt(x / y) * x / (y * y); } }
+	};
+
+	DualEvaluator dual;
+	BatchEvaluator batch;
+	vector<double> partials;
+	int mismatches = 0;
+	int valueMismatches = 0;
+	unsigned int seed = 3;
+
+	auto random = [&]() {
+
+		seed = seed * 1103515245 + 12345;
+
+		return ((seed >> 16) & 0x7FFF) / 32768.0;
+	};
+
+	auto isClose = [](double value, double expected) {
+
+		return fabs(value - expected) <= 1e-12 * max(1.0, fabs(expected));
+	};
+
+	for (const Derivative &derivative : DERIVATIVES) {
+
+		CompiledExpression expression(derivative.equation.c_str(), derivative.equation.size());
+		int xSlot = expression.getVariableIndex("x");
+		int ySlot = expression.getVariableIndex("y");
+		vector<double> x(POINTS), y(POINTS), output(POINTS), expected(POINTS), dx(POINTS), dy(POINTS);
+		vector<const double *> columns(2);
+		vector<double *> partialColumns(2);
+
+		for (int i = 0; i < POINTS; i++) {
+
+			x[i] = 0.25 + random() * 4;
+			y[i] = 0.25 + random() * 4;
+		}
+
+		columns[xSlot] = x.data();
+		columns[ySlot] = y.data();
+		partialColumns[xSlot] = dx.data();
+		partialColumns[ySlot] = dy.data();
+
+		dual.evaluate(expression, columns.data(), output.data(), partialColumns.data(), POINTS);
+		batch.evaluate(expression, columns.data(), expected.data(), POINTS);
+
+		for (int i = 0; i < POINTS; i++) {
+
+			if (!isClose(dx[i], derivative.dx(x[i], y[i])) || !isClose(dy[i], derivative.dy(x[i], y[i])))
+				mismatches++;
+
+			if (memcmp(&output[i], &expected[i], sizeof(double)) != 0)
+				valueMismatches++;
+		}
+
+		// A single row gives the same answer and partials as a block
+		vector<double> values(2);
+
+		values[xSlot] = x[0];
+		values[ySlot] = y[0];
+
+		double answer = dual.evaluate(expression, values, partials);
+
+		if (memcmp(&answer, &output[0], sizeof(double)) != 0 || partials[xSlot] != dx[0] || partials[ySlot] != dy[0])
+			valueMismatches++;
+	}
+
+	// Points where a factor is infinite or a term has no derivative
+	struct EdgeCase {
+
+		string equation;
+		vector<double> values;
+		vector<double> expected;
+	};
+
+	const vector<EdgeCase> EDGE_CASES = {
+		{ "x^2", { 0 }, { 0 } },
+		{ "x^y", { 0, 2 }, { 0, 0 } },
+		{ "x^0.5 + y", { 0, 3 }, { numeric_limits<double>::infinity(), 1 } },
+		{ "0.5^x", { 2 }, { 0.25 * log(0.5) } },
+		{ "x%3 + y", { 7.5, 2 }, { 0, 1 } },
+		{ "(x > y)*x", { 3, 2 }, { 1, 0 } },
+		{ "x/y", { 1, 0 }, { numeric_limits<double>::infinity(), -numeric_limits<double>::infinity() } },
+		{ "5", { }, { } }
+	};
+
+	int edgeMismatches = 0;
+
+	for (const EdgeCase &edge : EDGE_CASES) {
+
+		CompiledExpression expression(edge.equation.c_str(), edge.equation.size());
+
+		dual.evaluate(expression, edge.values, partials);
+
+		for (size_t k = 0; k < edge.expected.size(); k++)
+			if (partials[k] != edge.expected[k])
+				edgeMismatches++;
+	}
+
+	// Six variables, so finite differences take 13 evaluations
+	const string EQUATION = "(a-b)^2/c + d*e^1.5 - (f+a)^0.5*b + a*b*c/(d+e+f)";
+	CompiledExpression expression(EQUATION.c_str(), EQUATION.size());
+	int variables = expression.getVariableCount();
+	vector<vector<double>> inputs(variables, vector<double>(ROWS));
+	vector<vector<double>> derivatives(variables, vector<double>(ROWS));
+	vector<vector<double>> differences(variables, vector<double>(ROWS));
+	vector<double> output(ROWS), shifted(ROWS), plus(ROWS), minus(ROWS);
+	vector<const double *> columns(variables);
+	vector<double *> partialColumns(variables);
+
+	for (int k = 0; k < variables; k++) {
+
+		for (int i = 0; i < ROWS; i++)
+			inputs[k][i] = 1 + random() * 3;
+
+		columns[k] = inputs[k].data();
+		partialColumns[k] = derivatives[k].data();
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	dual.evaluate(expression, columns.data(), output.data(), partialColumns.data(), ROWS);
+
+	double dualTime = nanosecondsSince(start);
+
+	start = chrono::steady_clock::now();
+	batch.evaluate(expression, columns.data(), output.data(), ROWS);
+
+	// Central differences, with a step scaled to each value
+	for (int k = 0; k < variables; k++) {
+
+		for (int sign = 1; sign >= -1; sign -= 2) {
+
+			for (int i = 0; i < ROWS; i++)
+				shifted[i] = inputs[k][i] + sign * 1e-6 * inputs[k][i];
+
+			columns[k] = shifted.data();
+			batch.evaluate(expression, columns.data(), sign == 1 ? plus.data() : minus.data(), ROWS);
+		}
+
+		columns[k] = inputs[k].data();
+
+		for (int i = 0; i < ROWS; i++)
+			differences[k][i] = (plus[i] - minus[i]) / (2e-6 * inputs[k][i]);
+	}
+
+	double differenceTime = nanosecondsSince(start);
+	double largestError = 0;
+
+	for (int k = 0; k < variables; k++)
+		for (int i = 0; i < ROWS; i++)
+			largestError = max(largestError, fabs(differences[k][i] - derivatives[k][i]) / max(1.0, fabs(derivatives[k][i])));
+
+	cout << "Gradients, " << DERIVATIVES.size() << " equations at " << POINTS << " points" << endl;
+	cout << "\t" << mismatches << " partials off the hand worked ones, " << valueMismatches << " answers different from BatchEvaluator, " << edgeMismatches << " edge case mismatches" << endl;
+	cout << "\t" << variables << " variables over " << ROWS << " rows (ms): dual numbers " << dualTime / 1e6 << ", central differences " << differenceTime / 1e6 << endl;
+	cout << "\tLargest relative error of central differences: " << largestError << endl;
+}
+
+// Evaluates an equation of a, b and c over every row with values of type T, returning the time of one pass in nanoseconds
+template <typename T>
+double timeTypedEvaluation(const string &equation, const vector<vector<double>> &inputs, vector<T> &output, int repeats) {
+
+	TypedExpression<T> expression(equation.c_str(), equation.size());
+	TypedBatchEvaluator<T> evaluator;
+	vector<vector<T>> values(expression.getVariableCount());
+	vector<const T *> columns;
+
+	for (int j = 0; j < expression.getVariableCount(); j++) {
+
+		const vector<double> &input = inputs[expression.getVariableNames()[j][0] - 'a'];
+
+		values[j].assign(input.begin(), input.end());
+		columns.push_back(values[j].data());
+	}
+
+	output.resize(inputs[0].size());
+	evaluator.evaluate(expression, columns.data(), output.data(), output.size());
+
+	auto start = chrono::steady_clock::now();
+
+	for (int repeat = 0; repeat < repeats; repeat++)
+		evaluator.evaluate(expression, columns.data(), output.data(), output.size());
+
+	return nanosecondsSince(start) / repeats;
+}
+
+// Compares the throughput of the same equation evaluated with each value type and checks the answers of each type
+void benchmarkTypes() {
+
+	const int ROWS = 1000000;
+	const int REPEATS = 10;
+	const vector<string> FORMULAS = { "a*b + c - a*c - b", "a*b - c*(a+b) + 7*c - a/b" };
+	const vector<string> DOUBLE_FORMULAS = { "a*b+c-a/b", "a%b-c%7+(a-c)%b", "a^2+b^-1*c", "a^b - (a > c) + !(b - 1)" };
+
+	// Small integers, so that every type holds the same values
+	vector<vector<double>> inputs(3, vector<double>(ROWS));
+
+	for (int i = 0; i < ROWS; i++) {
+
+		inputs[0][i] = i % 2001 - 1000;
+		inputs[1][i] = 1 + i % 29;
+		inputs[2][i] = -(i % 101);
+	}
+
+	cout << "Value types over " << ROWS << " rows (million rows per second), " << SimdKernels::getInstructionSetName(TypedKernels<float>().getInstructionSet()) << endl;
+
+	for (const string &formula : FORMULAS) {
+
+		vector<float> floats;
+		vector<double> doubles;
+		vector<int64_t> integers;
+		vector<long double> longDoubles;
+		double floatTime = timeTypedEvaluation(formula, inputs, floats, REPEATS);
+		double doubleTime = timeTypedEvaluation(formula, inputs, doubles, REPEATS);
+		double integerTime = timeTypedEvaluation(formula, inputs, integers, REPEATS);
+		double longDoubleTime = timeTypedEvaluation(formula, inputs, longDoubles, REPEATS);
+		double largestError = 0;
+
+		for (int i = 0; i < ROWS; i++)
+			largestError = max(largestError, fabs((floats[i] - doubles[i]) / max(1.0, fabs(doubles[i]))));
+
+		cout << "\t" << formula << endl;
+		cout << "\t\tfloat " << ROWS / floatTime * 1e3 << ", double " << ROWS / doubleTime * 1e3 << ", int64 " << ROWS / integerTime * 1e3 << ", long double " << ROWS / longDoubleTime * 1e3 << endl;
+		cout << "\t\tLargest relative error of float: " << largestError << endl;
+	}
+
+	// The double type answers like BatchEvaluator, bit for bit
+	int doubleMismatches = 0;
+
+	for (const string &formula : DOUBLE_FORMULAS) {
+
+		CompiledExpression expression(formula.c_str(), formula.size());
+		BatchEvaluator batch;
+		vector<const double *> columns;
+		vector<double> expected(ROWS), typed;
+
+		for (const string &name : expression.getVariableNames())
+			columns.push_back(inputs[name[0] - 'a'].data());
+
+		batch.evaluate(expression, columns.data(), expected.data(), ROWS);
+		timeTypedEvaluation(formula, inputs, typed, 1);
+
+		for (int i = 0; i < ROWS; i++)
+			if (memcmp(&typed[i], &expected[i], sizeof(double)) != 0)
+				doubleMismatches++;
+	}
+
+	// Answers that double can not hold or gets wrong, and the rules for integers with no answer
+	struct IntegerCase {
+
+		string equation;
+		vector<int64_t> values;
+		int64_t expected;
+	};
+
+	const int64_t SMALLEST = numeric_limits<int64_t>::min();
+	const vector<IntegerCase> INTEGER_CASES = {
+		{ "a*b", { 3037000499, 3037000499 }, 9223372030926249001 },
+		{ "a + 1", { 9007199254740992 }, 9007199254740993 },
+		{ "a - b", { 9007199254740993, 1 }, 9007199254740992 },
+		{ "a^39", { 3 }, 4052555153018976267 },
+		{ "a^b", { 3, 39 }, 4052555153018976267 },
+		{ "a*a", { SMALLEST + 1 }, 1 },
+		{ "a%b", { -7, 3 }, -1 },
+		{ "a%b", { 9007199254740993, 10 }, 3 },
+		{ "a/b", { -7, 2 }, -3 },
+		{ "7/2 + a", { 0 }, 3 },
+		{ "a/b", { 5, 0 }, 0 },
+		{ "a%b", { 5, 0 }, 0 },
+		{ "a/b", { SMALLEST, -1 }, SMALLEST },
+		{ "a^-1", { 2 }, 0 },
+		{ "a^b", { -1, -3 }, -1 },
+		{ "(a > b) + (a = b)*2", { 9007199254740993, 9007199254740992 }, 1 }
+	};
+
+	int integerMismatches = 0;
+	int batchMismatches = 0;
+
+	for (const IntegerCase &integerCase : INTEGER_CASES) {
+
+		TypedExpression<int64_t> expression(integerCase.equation.c_str(), integerCase.equation.size());
+		TypedBatchEvaluator<int64_t> evaluator;
+		vector<const int64_t *> columns;
+		int64_t answer;
+
+		for (const int64_t &value : integerCase.values)
+			columns.push_back(&value);
+
+		evaluator.evaluate(expression, columns.data(), &answer, 1);
+
+		if (expression.evaluate(integerCase.values) != integerCase.expected)
+			integerMismatches++;
+
+		if (answer != integerCase.expected)
+			batchMismatches++;
+	}
+
+	// Numbers that are not integers have no int64_t value
+	int rejected = 0;
+
+	try {
+
+		TypedExpression<int64_t> expression("a*1.5", 5);
+	} catch (const invalid_argument &) {
+
+		rejected++;
+	}
+
+	TypedExpression<double> accepted("a*1.5", 5);
+
+	cout << "\t" << doubleMismatches << " double mismatches with BatchEvaluator over " << DOUBLE_FORMULAS.size() << " equations" << endl;
+	cout << "\t" << integerMismatches << " int64 mismatches, " << batchMismatches << " batch mismatches over " << INTEGER_CASES.size() << " cases, " << rejected << " of 1 non-integer numbers rejected" << endl;
+}
+
+int main(int argc, char **argv) {
+
+	// Run a single benchmark when its name is given, otherwise run all of them. "tests" runs only the checks,
+	//		and the run fails when any check of the benchmarks that ran did not hold
+	string name = argc > 1 ? argv[1] : "";
+
+	if (name == "" || name == "tokens")
+		benchmarkTokenStream();
+
+	if (name == "" || name == "compiled")
+		benchmarkCompiledEvaluation();
+
+	if (name == "" || name == "batch")
+		benchmarkBatchEvaluation();
+
+	if (name == "" || name == "simd")
+		benchmarkInstructionSets();
+
+	if (name == "" || name == "simd" || name == "tests")
+		testPower();
+
+	if (name == "" || name == "threads")
+		benchmarkThreads();
+
+	if (name == "" || name == "cache")
+		benchmarkCache();
+
+	if (name == "" || name == "cache" || name == "tests")
+		testCache();
+
+	if (name == "" || name == "optimizer")
+		benchmarkOptimizer();
+
+	if (name == "" || name == "optimizer" || name == "tests")
+		testOptimizer();
+
+	if (name == "" || name == "register")
+		benchmarkRegisterMachine();
+
+	if (name == "" || name == "jit")
+		benchmarkJit();
+
+	if (name == "" || name == "jit" || name == "tests")
+		testJit();
+
+	if (name == "" || name == "constexpr")
+		benchmarkConstexpr();
+
+	if (name == "" || name == "constexpr" || name == "tests")
+		testConstexpr();
+
+	if (name == "" || name == "minus" || name == "tests")
+		testUnaryMinus();
+
+	if (name == "" || name == "errors")
+		benchmarkErrors();
+
+	if (name == "" || name == "fused")
+		benchmarkFused();
+
+	if (name == "" || name == "columns")
+		benchmarkColumns();
+
+	if (name == "" || name == "aggregate")
+		benchmarkAggregate();
+
+	if (name == "" || name == "aggregate" || name == "tests")
+		testAggregate();
+
+	if (name == "" || name == "bits")
+		benchmarkBitSliced();
+
+	if (name == "" || name == "bool")
+		benchmarkBoolExpression();
+
+	if (name == "" || name == "filter")
+		benchmarkFilter();
+
+	if (name == "" || name == "formulas")
+		benchmarkFormulas();
+
+	if (name == "" || name == "shared")
+		benchmarkShared();
+
+	if (name == "" || name == "shared" || name == "tests")
+		testShared();
+
+	if (name == "" || name == "gradient")
+		benchmarkGradient();
+
+	if (name == "" || name == "types")
+		benchmarkTypes();
+
+	if (name == "" || name == "numbers")
+		benchmarkNumberParsing();
+
+	return failures == 0 ? 0 : 1;
+}
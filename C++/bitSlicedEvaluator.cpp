@@ -0,0 +1,185 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: bitSlicedEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for bitSlicedEvaluator.h
+
+	Outline:
+		Public Functions:
+			BitSlicedEvaluator
+			BitSlicedEvaluator
+			evaluate
+			truthTable
+			getVariableCount
+
+		Private Functions:
+			initialize
+			evaluateBlock
+******************************************************************************/
+
+#include "bitSlicedEvaluator.h"
+
+#include <algorithm>
+
+#include "reversePolishNotation.h"
+
+using std::copy;
+
+namespace day {
+
+	BitSlicedEvaluator::BitSlicedEvaluator(const Token *equation, int length, const vector<bool> &values, int variableCount) : values(values), variableCount(variableCount) {
+
+		initialize(equation, length);
+	}
+
+	BitSlicedEvaluator::BitSlicedEvaluator(const Token *equation, int length, const vector<bool> &values, int variableCount, InstructionSet instructionSet)
+		: values(values), variableCount(variableCount), kernels(instructionSet) {
+
+		initialize(equation, length);
+	}
+
+	void BitSlicedEvaluator::evaluate(const Word *const *columns, Word *output, size_t words) {
+
+		if (columns == nullptr && variableCount > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		for (int i = 0; i < variableCount; i++) {
+
+			if (columns[i] == nullptr)
+				throw invalid_argument("Not every variable has a column bound to it");
+		}
+
+		for (size_t first = 0; first < words; first += BLOCK_WORDS) {
+
+			int count = words - first < BLOCK_WORDS ? words - first : BLOCK_WORDS;
+
+			for (int i = 0; i < variableCount; i++)
+				blockColumns[i] = columns[i] + first;
+
+			evaluateBlock(blockColumns.data(), count, output + first);
+		}
+	}
+
+	vector<BitSlicedEvaluator::Word> BitSlicedEvaluator::truthTable() {
+
+		// Bits of a word where the variable in slot j is 1, for the slots that change within a word
+		static const Word WORD_PATTERNS[] = { 0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+			0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000 };
+		// Slots below this change within a block, the rest are the same for a whole block
+		const int BLOCK_SLOTS = 12;
+
+		if (variableCount > MAX_TRUTH_TABLE_VARIABLES)
+			throw invalid_argument("Equation has too many variables for a truth table");
+
+		size_t words = variableCount < 6 ? 1 : (size_t)1 << (variableCount - 6);
+		vector<Word> result(words);
+		// The words of a block for each slot that changes within a block, which every block repeats
+		vector<Word> patterns((size_t)BLOCK_SLOTS * BLOCK_WORDS);
+		const Word *zeros = constantBlocks.data();
+		const Word *ones = constantBlocks.data() + BLOCK_WORDS;
+
+		for (int j = 0; j < variableCount && j < BLOCK_SLOTS; j++) {
+
+			for (int i = 0; i < BLOCK_WORDS; i++)
+				patterns[(size_t)j * BLOCK_WORDS + i] = j < 6 ? WORD_PATTERNS[j] : (i >> (j - 6) & 1 ? ~(Word)0 : 0);
+
+			blockColumns[j] = patterns.data() + (size_t)j * BLOCK_WORDS;
+		}
+
+		for (size_t first = 0; first < words; first += BLOCK_WORDS) {
+
+			int count = words - first < BLOCK_WORDS ? words - first : BLOCK_WORDS;
+
+			// The first word of a block is a multiple of BLOCK_WORDS, so the bits of the higher slots come from it
+			for (int j = BLOCK_SLOTS; j < variableCount; j++)
+				blockColumns[j] = first >> (j - 6) & 1 ? ones : zeros;
+
+			evaluateBlock(blockColumns.data(), count, result.data() + first);
+		}
+
+		// Clear the bits past the last assignment when they do not fill a word
+		if (variableCount < 6)
+			result[0] &= ((Word)1 << (1 << variableCount)) - 1;
+
+		return result;
+	}
+
+	int BitSlicedEvaluator::getVariableCount() const {
+
+		return variableCount;
+	}
+
+	void BitSlicedEvaluator::initialize(const Token *equation, int length) {
+
+		ReversePolishNotation rpn;
+		int maxStackDepth = rpn.validateBoolPostFix(equation, length, values.size(), variableCount);
+
+		this->equation.assign(equation, equation + length);
+		scratch.resize((size_t)maxStackDepth * BLOCK_WORDS);
+		operandStack.resize(maxStackDepth);
+		blockColumns.resize(variableCount);
+		constantBlocks.resize(2 * BLOCK_WORDS);
+
+		for (int i = 0; i < BLOCK_WORDS; i++)
+			constantBlocks[BLOCK_WORDS + i] = ~(Word)0;
+	}
+
+	void BitSlicedEvaluator::evaluateBlock(const Word *const *columns, int count, Word *output) {
+
+		// Number of operands on the stack, the top operand is operandStack[depth - 1]
+		int depth = 0;
+
+		for (const Token &token : equation) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = constantBlocks.data() + (values[token.index] ? BLOCK_WORDS : 0);
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					// Columns are read in place instead of being copied to the stack
+					operandStack[depth++] = columns[token.index];
+					break;
+				case Opcode::NOT: {
+
+					Word *result = scratch.data() + (size_t)(depth - 1) * BLOCK_WORDS;
+
+					kernels.applyBitwise(Opcode::NOT, operandStack[depth - 1], operandStack[depth - 1], result, count);
+					operandStack[depth - 1] = result;
+					break;
+				}
+				default: {
+
+					// Every other opcode left by validateBoolPostFix is a binary operator
+					Word *result = scratch.data() + (size_t)(depth - 2) * BLOCK_WORDS;
+
+					kernels.applyBitwise(token.opcode, operandStack[depth - 2], operandStack[depth - 1], result, count);
+					operandStack[depth - 2] = result;
+					depth--;
+				}
+			};
+		}
+
+		copy(operandStack[0], operandStack[0] + count, output);
+	}
+}
@@ -0,0 +1,215 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: bitSlicedEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: BitSlicedEvaluator
+
+	Description:
+		Evaluates a post-fix bool equation of '!', '&', '|', '=' and '!=' for
+		many assignments at once. Each variable is given as a column of bits, 64
+		assignments to a word, and each operator is a single bitwise
+		instruction over a whole word, or over 512 assignments with AVX-512.
+		Like BatchEvaluator, the words are split into blocks of BLOCK_WORDS
+		that are run one operator at a time, so the intermediate blocks stay in
+		the L1 cache.
+
+		truthTable evaluates every assignment of the variables. The bits of
+		the variables are never stored in memory for a whole table, since
+		each block of assignments repeats the same patterns.
+
+		An evaluator reuses its scratch space between calls, so each thread
+		should use its own evaluator.
+
+	Outline:
+		Public Functions:
+			BitSlicedEvaluator
+			BitSlicedEvaluator
+			evaluate
+			truthTable
+			getVariableCount
+
+		Private Functions:
+			initialize
+			evaluateBlock
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "simdKernels.h"
+#include "token.h"
+
+using std::vector;
+using std::size_t;
+using std::uint64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	class BitSlicedEvaluator {
+
+	public:
+
+		// 64 assignments, one per bit
+		typedef uint64_t Word;
+
+		// Number of words evaluated together, 4096 assignments
+		static const int BLOCK_WORDS = 64;
+		// Most variables truthTable accepts, the table of 30 variables takes 128 MB
+		static const int MAX_TRUTH_TABLE_VARIABLES = 30;
+	private:
+
+		vector<Token> equation;
+		vector<bool> values;
+		int variableCount;
+		// One block of BLOCK_WORDS words for each level of the operand stack
+		vector<Word> scratch;
+		vector<const Word *> operandStack;
+		// The words of the current block for each variable slot
+		vector<const Word *> blockColumns;
+		// A block of 0 bits followed by a block of 1 bits, used for values and whole blocks of a variable
+		vector<Word> constantBlocks;
+		SimdKernels kernels;
+	public:
+
+		/******************************************************************************
+			Function Name: BitSlicedEvaluator
+
+			Des:
+				Uses the widest instruction set supported by the CPU.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				values - type const vector<bool> &, the bool of each PUSH_VALUE token
+					in param equation.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+
+			Throws:
+				Throws exception if the equation is unsolvable or uses an arithmetic
+					operator.
+		******************************************************************************/
+		BitSlicedEvaluator(const Token *equation, int length, const vector<bool> &values, int variableCount);
+
+		/******************************************************************************
+			Function Name: BitSlicedEvaluator
+
+			Des:
+				Uses the given instruction set if the CPU supports it.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				values - type const vector<bool> &, the bool of each PUSH_VALUE token
+					in param equation.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+				instructionSet - type InstructionSet, the requested instruction set.
+
+			Throws:
+				Throws exception if the equation is unsolvable or uses an arithmetic
+					operator.
+		******************************************************************************/
+		BitSlicedEvaluator(const Token *equation, int length, const vector<bool> &values, int variableCount, InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for every assignment. Assignment i is bit
+					i % 64 of word i / 64 in every column.
+
+			Params:
+				columns - type const Word *const *, one column of bits for each
+					variable slot, each holding param words words.
+				output - type Word *, output column to get the answer for each
+					assignment.
+				words - type size_t, the number of words in each column.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void evaluate(const Word *const *columns, Word *output, size_t words);
+
+		/******************************************************************************
+			Function Name: truthTable
+
+			Des:
+				Evaluates the equation for all 2^n assignments of its n variables.
+					In assignment i, the variable in slot j is bit j of i.
+
+			Returns:
+				type vector<Word>, the answer to assignment i in bit i % 64 of word
+					i / 64. Bits past 2^n are 0.
+
+			Throws:
+				Throws exception if there are more than MAX_TRUTH_TABLE_VARIABLES
+					variables.
+		******************************************************************************/
+		vector<Word> truthTable();
+
+		/******************************************************************************
+			Function Name: getVariableCount
+
+			Returns:
+				type int, the number of variable slots.
+		******************************************************************************/
+		int getVariableCount() const;
+	private:
+
+		/******************************************************************************
+			Function Name: initialize
+
+			Des:
+				Checks the equation and sets up the scratch space.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+
+			Throws:
+				Throws exception if the equation is unsolvable or uses an arithmetic
+					operator.
+		******************************************************************************/
+		void initialize(const Token *equation, int length);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Evaluates the equation for a single block of words.
+
+			Params:
+				columns - type const Word *const *, the words of the block for each
+					variable slot.
+				count - type int, the number of words in the block.
+				output - type Word *, output to get the answers of the block.
+		******************************************************************************/
+		void evaluateBlock(const Word *const *columns, int count, Word *output);
+	};
+}
@@ -0,0 +1,336 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: boolExpression.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for boolExpression.h
+
+	Outline:
+		Public Functions:
+			BoolExpression
+			tryCompile
+			evaluate
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getPostFix
+			getValues
+			getInstructionCount
+
+		Private Functions:
+			compile
+			emit
+			threadJumps
+			run
+******************************************************************************/
+
+#include "boolExpression.h"
+
+namespace day {
+
+	BoolExpression::BoolExpression(const char *equation, int length) {
+
+		EquationError error = compile(equation, length);
+
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
+	}
+
+	Expected<BoolExpression> BoolExpression::tryCompile(const char *equation, int length) {
+
+		BoolExpression result;
+		EquationError error = result.compile(equation, length);
+
+		if (error.code != ErrorCode::NONE)
+			return error;
+
+		return result;
+	}
+
+	bool BoolExpression::evaluate(const vector<bool> &variableValues) const {
+
+		bool result;
+
+		if (variableValues.size() < variableNames.size())
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		if (maxSavedDepth <= ReversePolishNotation::FIXED_STACK_DEPTH) {
+
+			unsigned char savedStack[ReversePolishNotation::FIXED_STACK_DEPTH];
+
+			result = run(variableValues, savedStack);
+		} else {
+
+			vector<unsigned char> savedStack(maxSavedDepth);
+
+			result = run(variableValues, savedStack.data());
+		}
+
+		return result;
+	}
+
+	bool BoolExpression::evaluate(const bool *variableValues) const {
+
+		bool result;
+
+		if (maxSavedDepth <= ReversePolishNotation::FIXED_STACK_DEPTH) {
+
+			unsigned char savedStack[ReversePolishNotation::FIXED_STACK_DEPTH];
+
+			result = run(variableValues, savedStack);
+		} else {
+
+			vector<unsigned char> savedStack(maxSavedDepth);
+
+			result = run(variableValues, savedStack.data());
+		}
+
+		return result;
+	}
+
+	int BoolExpression::getVariableCount() const {
+
+		return variableNames.size();
+	}
+
+	int BoolExpression::getVariableIndex(const string &name) const {
+
+		int result = -1;
+
+		for (int i = 0; i < (int)variableNames.size() && result == -1; i++) {
+
+			if (variableNames[i] == name)
+				result = i;
+		}
+
+		return result;
+	}
+
+	const vector<string> &BoolExpression::getVariableNames() const {
+
+		return variableNames;
+	}
+
+	const vector<Token> &BoolExpression::getPostFix() const {
+
+		return postFix;
+	}
+
+	const vector<bool> &BoolExpression::getValues() const {
+
+		return values;
+	}
+
+	int BoolExpression::getInstructionCount() const {
+
+		return program.size() - 1;
+	}
+
+	EquationError BoolExpression::compile(const char *equation, int length) {
+
+		ReversePolishNotation rpn;
+		vector<double> numbers;
+		vector<Token> infix;
+		int maxStackDepth;
+
+		EquationError error = rpn.tryStripValuesFromEquation(equation, length, numbers, variableNames, infix);
+
+		if (error.code == ErrorCode::NONE)
+			error = rpn.tryConvertInfixToPostFix(infix.data(), infix.size(), postFix);
+
+		if (error.code == ErrorCode::NONE)
+			error = rpn.tryValidateBoolPostFix(postFix.data(), postFix.size(), numbers.size(), variableNames.size(), maxStackDepth);
+
+		if (error.code == ErrorCode::NONE) {
+
+			// Index of the first token of the operand that ends at each token
+			vector<int> starts(postFix.size());
+			vector<int> operandStack;
+
+			values.resize(numbers.size());
+
+			for (size_t i = 0; i < numbers.size(); i++)
+				values[i] = numbers[i] != 0;
+
+			for (int i = 0; i < (int)postFix.size(); i++) {
+
+				switch (postFix[i].opcode) {
+
+					case Opcode::PUSH_VALUE:
+					case Opcode::PUSH_VARIABLE:
+
+						starts[i] = i;
+						break;
+					case Opcode::NOT:
+
+						starts[i] = operandStack.back();
+						operandStack.pop_back();
+						break;
+					default:
+
+						// A binary operator starts where its first operand does
+						operandStack.pop_back();
+						starts[i] = operandStack.back();
+						operandStack.pop_back();
+				};
+
+				operandStack.push_back(starts[i]);
+			}
+
+			maxSavedDepth = 0;
+			program.clear();
+			program.reserve(postFix.size() + 1);
+			emit(postFix.size() - 1, starts, 0);
+			program.push_back({ Operation::HALT, 0 });
+			threadJumps();
+		}
+
+		return error;
+	}
+
+	void BoolExpression::emit(int end, const vector<int> &starts, int savedDepth) {
+
+		const Token &token = postFix[end];
+
+		switch (token.opcode) {
+
+			case Opcode::PUSH_VALUE:
+
+				program.push_back({ Operation::LOAD_VALUE, values[token.index] ? 1 : 0 });
+				break;
+			case Opcode::PUSH_VARIABLE:
+
+				program.push_back({ Operation::LOAD_VARIABLE, token.index });
+				break;
+			case Opcode::NOT:
+
+				emit(end - 1, starts, savedDepth);
+				program.push_back({ Operation::NOT, 0 });
+				break;
+			case Opcode::EQUAL:
+			case Opcode::NOT_EQUAL:
+
+				// The first operand ends just before the second one starts
+				emit(starts[end - 1] - 1, starts, savedDepth);
+				program.push_back({ Operation::SAVE, 0 });
+
+				if (savedDepth + 1 > maxSavedDepth)
+					maxSavedDepth = savedDepth + 1;
+
+				emit(end - 1, starts, savedDepth + 1);
+				program.push_back({ token.opcode == Opcode::EQUAL ? Operation::EQUAL : Operation::NOT_EQUAL, 0 });
+				break;
+			default: {
+
+				// '|' is decided by a true first operand and '&' by a false one, which is left in the accumulator
+				emit(starts[end - 1] - 1, starts, savedDepth);
+
+				int jump = program.size();
+
+				program.push_back({ token.opcode == Opcode::OR ? Operation::JUMP_IF_TRUE : Operation::JUMP_IF_FALSE, 0 });
+				emit(end - 1, starts, savedDepth);
+				program[jump].operand = program.size();
+			}
+		};
+	}
+
+	void BoolExpression::threadJumps() {
+
+		for (Instruction &instruction : program) {
+
+			if (instruction.operation != Operation::JUMP_IF_TRUE && instruction.operation != Operation::JUMP_IF_FALSE)
+				continue;
+
+			// Targets only move forward, so this always ends
+			for (;;) {
+
+				const Instruction &target = program[instruction.operand];
+
+				// The accumulator is unchanged when the jump lands, so a jump of the same kind is taken and the other kind is not
+				if (target.operation == instruction.operation)
+					instruction.operand = target.operand;
+				else if (target.operation == Operation::JUMP_IF_TRUE || target.operation == Operation::JUMP_IF_FALSE)
+					instruction.operand++;
+				else
+					break;
+			}
+		}
+	}
+
+	template <typename Values>
+	bool BoolExpression::run(const Values &variableValues, unsigned char *savedStack) const {
+
+		bool accumulator = false;
+		// Number of saved operands, the last one is savedStack[depth - 1]
+		int depth = 0;
+
+		for (int i = 0; program[i].operation != Operation::HALT; i++) {
+
+			const Instruction &instruction = program[i];
+
+			switch (instruction.operation) {
+
+				case Operation::LOAD_VARIABLE:
+
+					accumulator = variableValues[instruction.operand];
+					break;
+				case Operation::LOAD_VALUE:
+
+					accumulator = instruction.operand != 0;
+					break;
+				case Operation::NOT:
+
+					accumulator = !accumulator;
+					break;
+				case Operation::SAVE:
+
+					savedStack[depth++] = accumulator;
+					break;
+				case Operation::EQUAL:
+
+					accumulator = savedStack[--depth] == accumulator;
+					break;
+				case Operation::NOT_EQUAL:
+
+					accumulator = savedStack[--depth] != accumulator;
+					break;
+				case Operation::JUMP_IF_TRUE:
+
+					// The loop moves on to the instruction after i
+					if (accumulator)
+						i = instruction.operand - 1;
+
+					break;
+				case Operation::JUMP_IF_FALSE:
+
+					if (!accumulator)
+						i = instruction.operand - 1;
+
+					break;
+				case Operation::HALT:
+
+					break;
+			};
+		}
+
+		return accumulator;
+	}
+}
@@ -0,0 +1,327 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: boolExpression.h
+
+	Author: Matthew Day
+
+	Class Name: BoolExpression
+
+	Description:
+		A bool equation of '!', '&', '|', '=' and '!=' that has been compiled
+		once so that it can be evaluated many times with different values bound
+		to its named variables.
+
+		The post-fix equation is compiled into a program that keeps the
+		current answer in a single accumulator. '&' and '|' become jumps that
+		skip their second operand when the first one already decides the
+		answer, so in a | <long subtree> the subtree is never evaluated when a
+		is true. A jump that lands on another jump of the same kind goes
+		straight to its target, so the first true clause of a long '|' chain
+		jumps to the end of the program at once. Only '=' and '!=' need both of
+		their operands, so the first one is saved on a stack while the second
+		is evaluated.
+
+		The post-fix equation and its values are kept, so the same equation can
+		be given to a BitSlicedEvaluator.
+
+	Outline:
+		Public Functions:
+			BoolExpression
+			tryCompile
+			evaluate
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getPostFix
+			getValues
+			getInstructionCount
+
+		Private Functions:
+			BoolExpression
+			compile
+			emit
+			threadJumps
+			run
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "expected.h"
+#include "reversePolishNotation.h"
+#include "token.h"
+
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace day {
+
+	class BoolExpression {
+
+	private:
+
+		enum class Operation : unsigned char {
+
+			// Sets the accumulator to the variable in slot operand
+			LOAD_VARIABLE,
+			// Sets the accumulator to operand, 0 or 1
+			LOAD_VALUE,
+			NOT,
+			// Pushes the accumulator, the first operand of '=' or '!='
+			SAVE,
+			// Pop the first operand of '=' or '!=' and compare it with the accumulator
+			EQUAL,
+			NOT_EQUAL,
+			// Continue at instruction operand if the accumulator is true or false
+			JUMP_IF_TRUE,
+			JUMP_IF_FALSE,
+			HALT
+		};
+
+		struct Instruction {
+
+			Operation operation;
+			int operand;
+		};
+
+		// The validated equation in post-fix notation
+		vector<Token> postFix;
+		// Values corresponding to the PUSH_VALUE tokens in the post-fix equation
+		vector<bool> values;
+		// Names of the variables in the order of their slots
+		vector<string> variableNames;
+		// The post-fix equation as jumps, ended by HALT
+		vector<Instruction> program;
+		// Most operands of '=' and '!=' saved at once
+		int maxSavedDepth;
+	public:
+
+		/******************************************************************************
+			Function Name: BoolExpression
+
+			Des:
+				Compiles the bool equation so that it can be evaluated many times.
+
+			Params:
+				equation - type const char *, the in-fix bool equation to be
+					compiled. Numbers are true if they are not 0. Example input:
+					active & !(expired | banned = 1).
+				length - type int, the length of the param equation.
+
+			Throws:
+				Throws exception if the equation is invalid or uses an arithmetic
+					operator.
+		******************************************************************************/
+		BoolExpression(const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: tryCompile
+
+			Des:
+				Compiles the bool equation without throwing if it is invalid.
+
+			Params:
+				equation - type const char *, the in-fix bool equation to be
+					compiled.
+				length - type int, the length of the param equation.
+
+			Returns:
+				type Expected<BoolExpression>, the compiled equation, or the reason
+					the equation is invalid.
+		******************************************************************************/
+		static Expected<BoolExpression> tryCompile(const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the values bound to its variables.
+
+			Params:
+				variableValues - type const vector<bool> &, the value of each
+					variable in the order of their slots.
+
+			Returns:
+				type bool, the answer to the equation
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		bool evaluate(const vector<bool> &variableValues) const;
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation without checking the number of variables.
+
+			Params:
+				variableValues - type const bool *, the value of each variable in
+					the order of their slots.
+
+			Returns:
+				type bool, the answer to the equation
+		******************************************************************************/
+		bool evaluate(const bool *variableValues) const;
+
+		/******************************************************************************
+			Function Name: getVariableCount
+
+			Des:
+				Gets the number of distinct variables used in the equation.
+
+			Returns:
+				type int, the number of variable slots.
+		******************************************************************************/
+		int getVariableCount() const;
+
+		/******************************************************************************
+			Function Name: getVariableIndex
+
+			Des:
+				Finds the slot of the variable with the given name.
+
+			Params:
+				name - type const string &, the name of the variable.
+
+			Returns:
+				type int, the slot of the variable or -1 if the equation does not use it.
+		******************************************************************************/
+		int getVariableIndex(const string &name) const;
+
+		/******************************************************************************
+			Function Name: getVariableNames
+
+			Des:
+				Gets the names of the variables in the order of their slots.
+
+			Returns:
+				type const vector<string> &, the names of the variables.
+		******************************************************************************/
+		const vector<string> &getVariableNames() const;
+
+		/******************************************************************************
+			Function Name: getPostFix
+
+			Des:
+				Gets the validated equation in post-fix notation.
+
+			Returns:
+				type const vector<Token> &, the post-fix equation.
+		******************************************************************************/
+		const vector<Token> &getPostFix() const;
+
+		/******************************************************************************
+			Function Name: getValues
+
+			Des:
+				Gets the values corresponding to the PUSH_VALUE tokens in the post-fix
+					equation.
+
+			Returns:
+				type const vector<bool> &, the values of the equation.
+		******************************************************************************/
+		const vector<bool> &getValues() const;
+
+		/******************************************************************************
+			Function Name: getInstructionCount
+
+			Des:
+				Gets the length of the compiled program.
+
+			Returns:
+				type int, the number of instructions, not counting the HALT at the
+					end.
+		******************************************************************************/
+		int getInstructionCount() const;
+	private:
+
+		/******************************************************************************
+			Function Name: BoolExpression
+
+			Des:
+				Creates an empty expression for compile to fill in.
+		******************************************************************************/
+		BoolExpression() = default;
+
+		/******************************************************************************
+			Function Name: compile
+
+			Des:
+				Compiles the equation into this expression.
+
+			Params:
+				equation - type const char *, the in-fix bool equation to be
+					compiled.
+				length - type int, the length of the param equation.
+
+			Returns:
+				type EquationError, the reason the equation is invalid, or
+					ErrorCode::NONE if it was compiled.
+		******************************************************************************/
+		EquationError compile(const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: emit
+
+			Des:
+				Appends the instructions of the operand of the post-fix equation that
+					ends at the given token.
+
+			Params:
+				end - type int, the index of the last token of the operand.
+				starts - type const vector<int> &, the index of the first token of
+					the operand that ends at each token.
+				savedDepth - type int, the number of operands of '=' and '!=' already
+					saved.
+		******************************************************************************/
+		void emit(int end, const vector<int> &starts, int savedDepth);
+
+		/******************************************************************************
+			Function Name: threadJumps
+
+			Des:
+				Points each jump past any jumps it lands on whose outcome is already
+					known.
+		******************************************************************************/
+		void threadJumps();
+
+		/******************************************************************************
+			Function Name: run
+
+			Des:
+				Runs the program.
+
+			Params:
+				variableValues - type const Values &, the value of each variable in
+					the order of their slots.
+				savedStack - type unsigned char *, scratch space for the saved
+					operands of '=' and '!=', must hold at least maxSavedDepth values.
+
+			Returns:
+				type bool, the answer to the equation
+		******************************************************************************/
+		template <typename Values>
+		bool run(const Values &variableValues, unsigned char *savedStack) const;
+	};
+}
@@ -0,0 +1,309 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: columnReader.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for columnReader.h
+
+	Outline:
+		Public Functions:
+			ColumnReader
+			getFormat
+			getColumnNames
+			getColumnIndex
+			readBlock
+			writeBinary
+
+		Private Functions:
+			readCsvHeader
+			readBinaryHeader
+			readCsvBlock
+******************************************************************************/
+
+#include "columnReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "stringUtils.h"
+
+using std::min;
+using std::isblank;
+using std::memchr;
+using std::memcmp;
+using std::memcpy;
+using std::to_string;
+using std::uintptr_t;
+
+namespace day {
+
+	// First bytes of a binary column file
+	static const char BINARY_MAGIC[8] = { 'D', 'A', 'Y', 'C', 'O', 'L', 'S', 0 };
+
+	ColumnReader::ColumnReader(const char *data, size_t size) : data(data), size(size), position(0), row(0), rowCount(0), columnData(nullptr) {
+
+		if (size >= sizeof(BINARY_MAGIC) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+
+			format = Format::BINARY;
+			readBinaryHeader();
+		} else {
+
+			format = Format::CSV;
+			readCsvHeader();
+		}
+	}
+
+	ColumnReader::Format ColumnReader::getFormat() const {
+
+		return format;
+	}
+
+	const vector<string> &ColumnReader::getColumnNames() const {
+
+		return columnNames;
+	}
+
+	int ColumnReader::getColumnIndex(const string &name) const {
+
+		int result = -1;
+
+		for (int i = 0; i < (int)columnNames.size() && result == -1; i++) {
+
+			if (columnNames[i] == name)
+				result = i;
+		}
+
+		return result;
+	}
+
+	size_t ColumnReader::readBlock(const vector<int> &selected, vector<const double *> &columns) {
+
+		int slotCount = 0;
+		size_t result;
+
+		// Each column is read once, however many times it is selected
+		selectedSlots.assign(columnNames.size(), -1);
+
+		for (int column : selected) {
+
+			if (column < 0 || column >= (int)columnNames.size())
+				throw invalid_argument("Column does not exist");
+
+			if (selectedSlots[column] == -1)
+				selectedSlots[column] = slotCount++;
+		}
+
+		if (blockValues.size() < (size_t)slotCount)
+			blockValues.resize(slotCount, vector<double>(BLOCK_ROWS));
+
+		columns.resize(selected.size());
+
+		if (format == Format::BINARY) {
+
+			result = min((size_t)BLOCK_ROWS, rowCount - row);
+
+			for (size_t i = 0; i < selected.size(); i++) {
+
+				const char *values = columnData + (selected[i] * rowCount + row) * sizeof(double);
+
+				// Used in place unless a double would be read from an address that is not aligned
+				if ((uintptr_t)values % alignof(double) == 0) {
+
+					columns[i] = (const double *)values;
+				} else {
+
+					vector<double> &copy = blockValues[selectedSlots[selected[i]]];
+
+					memcpy(copy.data(), values, result * sizeof(double));
+					columns[i] = copy.data();
+				}
+			}
+		} else {
+
+			result = readCsvBlock(slotCount);
+
+			for (size_t i = 0; i < selected.size(); i++)
+				columns[i] = blockValues[selectedSlots[selected[i]]].data();
+		}
+
+		row += result;
+
+		return result;
+	}
+
+	void ColumnReader::writeBinary(ostream &output, const vector<string> &names, const vector<const double *> &columns, size_t rows) {
+
+		if (names.size() != columns.size())
+			throw invalid_argument("Every column needs a name");
+
+		static const char PADDING[8] = { 0 };
+		uint64_t columnCount = names.size();
+		uint64_t rowCount = rows;
+
+		output.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+		output.write((const char *)&columnCount, sizeof(columnCount));
+		output.write((const char *)&rowCount, sizeof(rowCount));
+
+		for (const string &name : names) {
+
+			uint64_t nameLength = name.size();
+
+			output.write((const char *)&nameLength, sizeof(nameLength));
+			output.write(name.data(), name.size());
+			// Keeps the columns aligned to 8 bytes
+			output.write(PADDING, (8 - name.size() % 8) % 8);
+		}
+
+		for (const double *column : columns)
+			output.write((const char *)column, rows * sizeof(double));
+	}
+
+	void ColumnReader::readCsvHeader() {
+
+		const char *newline = (const char *)memchr(data, '\n', size);
+		size_t end = newline == nullptr ? size : newline - data;
+		size_t start = 0;
+
+		position = end + 1;
+
+		if (end > 0 && data[end - 1] == '\r')
+			end--;
+
+		while (start <= end && size > 0) {
+
+			const char *comma = (const char *)memchr(data + start, ',', end - start);
+			size_t fieldEnd = comma == nullptr ? end : comma - data;
+			size_t first = start;
+			size_t last = fieldEnd;
+
+			while (first < last && isblank(data[first]))
+				first++;
+
+			while (last > first && isblank(data[last - 1]))
+				last--;
+
+			columnNames.emplace_back(data + first, last - first);
+
+			start = fieldEnd + 1;
+		}
+	}
+
+	void ColumnReader::readBinaryHeader() {
+
+		size_t offset = sizeof(BINARY_MAGIC);
+		uint64_t columnCount;
+		uint64_t count;
+
+		if (size < offset + 2 * sizeof(uint64_t))
+			throw invalid_argument("Column file header is cut short");
+
+		memcpy(&columnCount, data + offset, sizeof(uint64_t));
+		memcpy(&count, data + offset + sizeof(uint64_t), sizeof(uint64_t));
+		offset += 2 * sizeof(uint64_t);
+
+		for (uint64_t i = 0; i < columnCount; i++) {
+
+			uint64_t nameLength;
+
+			if (offset > size || size - offset < sizeof(uint64_t))
+				throw invalid_argument("Column file header is cut short");
+
+			memcpy(&nameLength, data + offset, sizeof(uint64_t));
+			offset += sizeof(uint64_t);
+
+			if (size - offset < nameLength)
+				throw invalid_argument("Column file header is cut short");
+
+			columnNames.emplace_back(data + offset, nameLength);
+			offset += (nameLength + 7) / 8 * 8;
+		}
+
+		if (offset > size || (columnCount != 0 && (size - offset) / sizeof(double) / columnCount < count))
+			throw invalid_argument("Column file is smaller than its header says");
+
+		rowCount = count;
+		columnData = data + offset;
+	}
+
+	size_t ColumnReader::readCsvBlock(int slotCount) {
+
+		size_t result = 0;
+
+		while (result < (size_t)BLOCK_ROWS && position < size) {
+
+			const char *newline = (const char *)memchr(data + position, '\n', size - position);
+			size_t end = newline == nullptr ? size : newline - data;
+			size_t start = position;
+			int column = 0;
+			int found = 0;
+
+			position = end + 1;
+
+			if (end > start && data[end - 1] == '\r')
+				end--;
+
+			while (start < end && isblank(data[start]))
+				start++;
+
+			// Blank lines are not rows
+			if (start == end)
+				continue;
+
+			while (found < slotCount) {
+
+				const char *comma = (const char *)memchr(data + start, ',', end - start);
+				size_t fieldEnd = comma == nullptr ? end : comma - data;
+				int slot = column < (int)selectedSlots.size() ? selectedSlots[column] : -1;
+
+				if (slot != -1) {
+
+					size_t first = start;
+					size_t last = fieldEnd;
+					int numberEnd;
+
+					while (first < last && isblank(data[first]))
+						first++;
+
+					while (last > first && isblank(data[last - 1]))
+						last--;
+
+					// The number has to fill the whole field
+					if (!parseNumber(data + first, last - first, 0, numberEnd, blockValues[slot][result]) || numberEnd != (int)(last - first) - 1)
+						throw invalid_argument("Malformed number in row " + to_string(row + result + 1) + ", column " + columnNames[column]);
+
+					found++;
+				}
+
+				if (comma == nullptr)
+					break;
+
+				start = fieldEnd + 1;
+				column++;
+			}
+
+			if (found < slotCount)
+				throw invalid_argument("Row " + to_string(row + result + 1) + " is missing a column");
+
+			result++;
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,238 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: columnReader.h
+
+	Author: Matthew Day
+
+	Class Name: ColumnReader
+
+	Description:
+		Reads named columns of doubles out of a file held in memory, such as a
+		MappedFile, a block of rows at a time for BatchEvaluator. Only the
+		columns asked for are read. Two formats are supported:
+
+		CSV, where the first line holds the column names separated by ',' and
+		every other line holds one row of numbers. The fields of the selected
+		columns are converted with parseNumber straight out of the file into a
+		block of BLOCK_ROWS values per column, and every other field is
+		skipped without being converted. Blank lines are ignored.
+
+		A binary column file, which starts with the 8 bytes "DAYCOLS" and a 0,
+		then the number of columns and the number of rows as 64-bit unsigned
+		integers, then for each column the length of its name as a 64-bit
+		unsigned integer followed by the name, padded with 0 up to a multiple
+		of 8 bytes. After that every column is stored in turn as one double per
+		row. Numbers are in the byte order of the machine. The columns are used
+		in place, so a block costs no copying unless the file is not aligned
+		to 8 bytes in memory.
+
+	Outline:
+		Public Functions:
+			ColumnReader
+			getFormat
+			getColumnNames
+			getColumnIndex
+			readBlock
+			writeBinary
+
+		Private Functions:
+			readCsvHeader
+			readBinaryHeader
+			readCsvBlock
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "batchEvaluator.h"
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::invalid_argument;
+using std::size_t;
+using std::uint64_t;
+
+namespace day {
+
+	class ColumnReader {
+
+	public:
+
+		enum class Format { CSV, BINARY };
+
+		// Rows returned by each call to readBlock, a multiple of the batch block size
+		static const int BLOCK_ROWS = 16 * BatchEvaluator::BLOCK_SIZE;
+	private:
+
+		const char *data;
+		size_t size;
+		Format format;
+		vector<string> columnNames;
+		// Location in param data of the next CSV line
+		size_t position;
+		// Number of rows that have been returned
+		size_t row;
+		// Number of rows and location of the first column of a binary file
+		size_t rowCount;
+		const char *columnData;
+		// Values of each selected column for the current block, when they cannot be used in place
+		vector<vector<double>> blockValues;
+		// Slot in the selection of each column of the file, or -1 if it is not selected
+		vector<int> selectedSlots;
+	public:
+
+		/******************************************************************************
+			Function Name: ColumnReader
+
+			Des:
+				Reads the column names of the file. The format is found from the
+					first bytes of the file.
+
+			Params:
+				data - type const char *, the contents of the file. Must stay valid
+					for the lifetime of the reader.
+				size - type size_t, the number of bytes in param data.
+
+			Throws:
+				Throws exception if the header of the file is invalid.
+		******************************************************************************/
+		ColumnReader(const char *data, size_t size);
+
+		/******************************************************************************
+			Function Name: getFormat
+
+			Des:
+				Gets the format of the file.
+
+			Returns:
+				type Format, CSV or BINARY.
+		******************************************************************************/
+		Format getFormat() const;
+
+		/******************************************************************************
+			Function Name: getColumnNames
+
+			Des:
+				Gets the name of every column in the order they are stored.
+
+			Returns:
+				type const vector<string> &, the names.
+		******************************************************************************/
+		const vector<string> &getColumnNames() const;
+
+		/******************************************************************************
+			Function Name: getColumnIndex
+
+			Des:
+				Finds the column with the given name.
+
+			Params:
+				name - type const string &, the name of the column.
+
+			Returns:
+				type int, the index of the column, or -1 if there is no column with
+					that name.
+		******************************************************************************/
+		int getColumnIndex(const string &name) const;
+
+		/******************************************************************************
+			Function Name: readBlock
+
+			Des:
+				Reads the next block of up to BLOCK_ROWS rows of the selected
+					columns.
+
+			Params:
+				selected - type const vector<int> &, the index of each column to be
+					read. A column may be selected more than once.
+				columns - type vector<const double *> &, output to get the values of
+					each selected column, valid until the next call.
+
+			Returns:
+				type size_t, the number of rows read, 0 once every row has been read.
+
+			Throws:
+				Throws exception if a selected column does not exist, or if a CSV
+					row is missing a selected field or holds a malformed number.
+		******************************************************************************/
+		size_t readBlock(const vector<int> &selected, vector<const double *> &columns);
+
+		/******************************************************************************
+			Function Name: writeBinary
+
+			Des:
+				Writes columns in the binary column format.
+
+			Params:
+				output - type ostream &, receives the file.
+				names - type const vector<string> &, the name of each column.
+				columns - type const vector<const double *> &, the values of each
+					column, each holding param rows values.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if the number of names and columns do not match.
+		******************************************************************************/
+		static void writeBinary(ostream &output, const vector<string> &names, const vector<const double *> &columns, size_t rows);
+	private:
+
+		/******************************************************************************
+			Function Name: readCsvHeader
+
+			Des:
+				Reads the column names from the first line of a CSV file.
+		******************************************************************************/
+		void readCsvHeader();
+
+		/******************************************************************************
+			Function Name: readBinaryHeader
+
+			Des:
+				Reads the column names and the number of rows of a binary file.
+
+			Throws:
+				Throws exception if the header is cut short or the columns do not
+					fit in the file.
+		******************************************************************************/
+		void readBinaryHeader();
+
+		/******************************************************************************
+			Function Name: readCsvBlock
+
+			Des:
+				Converts the next block of rows of a CSV file into blockValues.
+
+			Params:
+				slotCount - type int, the number of selected columns.
+
+			Returns:
+				type size_t, the number of rows read.
+
+			Throws:
+				Throws exception if a row is missing a selected field or holds a
+					malformed number.
+		******************************************************************************/
+		size_t readCsvBlock(int slotCount);
+	};
+}
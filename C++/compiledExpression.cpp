@@ -0,0 +1,166 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: compiledExpression.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for compiledExpression.h
+
+	Outline:
+		Public Functions:
+			CompiledExpression
+			tryCompile
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getMaxStackDepth
+			getPostFix
+			getValues
+			getMemoryUsage
+
+		Private Functions:
+			compile
+******************************************************************************/
+
+#include "compiledExpression.h"
+
+namespace day {
+
+	CompiledExpression::CompiledExpression(const char *equation, int length, OptimizationLevel level) {
+
+		EquationError error = compile(equation, length, level);
+
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
+	}
+
+	Expected<CompiledExpression> CompiledExpression::tryCompile(const char *equation, int length, OptimizationLevel level) {
+
+		CompiledExpression result;
+		EquationError error = result.compile(equation, length, level);
+
+		if (error.code != ErrorCode::NONE)
+			return error;
+
+		return result;
+	}
+
+	double CompiledExpression::evaluate(const vector<double> &variableValues) const {
+
+		ReversePolishNotation rpn;
+		double result;
+
+		if (variableValues.size() < variableNames.size())
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		// The equation was validated when compiled so it is evaluated without any checks
+		if (maxStackDepth <= ReversePolishNotation::FIXED_STACK_DEPTH) {
+
+			double operandStack[ReversePolishNotation::FIXED_STACK_DEPTH];
+
+			result = rpn.calcValidatedResult(postFix.data(), postFix.size(), values.data(), variableValues.data(), operandStack);
+		} else {
+
+			vector<double> operandStack(maxStackDepth);
+
+			result = rpn.calcValidatedResult(postFix.data(), postFix.size(), values.data(), variableValues.data(), operandStack.data());
+		}
+
+		return result;
+	}
+
+	int CompiledExpression::getVariableCount() const {
+
+		return variableNames.size();
+	}
+
+	int CompiledExpression::getVariableIndex(const string &name) const {
+
+		int result = -1;
+
+		for (int i = 0; i < (int)variableNames.size() && result == -1; i++) {
+
+			if (variableNames[i] == name)
+				result = i;
+		}
+
+		return result;
+	}
+
+	const vector<string> &CompiledExpression::getVariableNames() const {
+
+		return variableNames;
+	}
+
+	int CompiledExpression::getMaxStackDepth() const {
+
+		return maxStackDepth;
+	}
+
+	const vector<Token> &CompiledExpression::getPostFix() const {
+
+		return postFix;
+	}
+
+	const vector<double> &CompiledExpression::getValues() const {
+
+		return values;
+	}
+
+	size_t CompiledExpression::getMemoryUsage() const {
+
+		size_t result = sizeof(CompiledExpression);
+
+		result += postFix.capacity() * sizeof(Token);
+		result += values.capacity() * sizeof(double);
+		result += variableNames.capacity() * sizeof(string);
+
+		for (const string &name : variableNames)
+			result += name.capacity() + 1;
+
+		return result;
+	}
+
+	EquationError CompiledExpression::compile(const char *equation, int length, OptimizationLevel level) {
+
+		ReversePolishNotation rpn;
+		ExpressionOptimizer optimizer;
+		vector<Token> infix;
+		vector<Token> editedEquation;
+
+		EquationError error = rpn.tryStripValuesFromEquation(equation, length, values, variableNames, infix);
+
+		if (error.code == ErrorCode::NONE)
+			error = rpn.tryConvertInfixToPostFix(infix.data(), infix.size(), editedEquation);
+
+		// The optimizer relies on the equation being valid
+		if (error.code == ErrorCode::NONE)
+			error = rpn.tryValidatePostFix(editedEquation.data(), editedEquation.size(), values.size(), variableNames.size(), maxStackDepth);
+
+		if (error.code == ErrorCode::NONE) {
+
+			postFix = optimizer.optimize(editedEquation.data(), editedEquation.size(), values, level);
+
+			error = rpn.tryValidatePostFix(postFix.data(), postFix.size(), values.size(), variableNames.size(), maxStackDepth);
+		}
+
+		return error;
+	}
+}
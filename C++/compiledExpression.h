@@ -0,0 +1,242 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: compiledExpression.h
+
+	Author: Matthew Day
+
+	Class Name: CompiledExpression
+
+	Description:
+		An equation that has been converted to post-fix notation once so that it
+		can be evaluated many times with different values bound to its named
+		variables. Only the post-fix evaluation is done per call. The post-fix
+		equation is shortened by ExpressionOptimizer when compiled.
+
+	Outline:
+		Public Functions:
+			CompiledExpression
+			tryCompile
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getMaxStackDepth
+			getPostFix
+			getValues
+			getMemoryUsage
+
+		Private Functions:
+			CompiledExpression
+			compile
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+
+#include "reversePolishNotation.h"
+#include "expressionOptimizer.h"
+
+using std::string;
+using std::vector;
+using std::invalid_argument;
+using std::size_t;
+
+namespace day {
+
+	class CompiledExpression {
+
+	private:
+
+		// The equation in post-fix notation as returned by ExpressionOptimizer
+		vector<Token> postFix;
+		// Values corresponding to the arguments in the post-fix equation
+		vector<double> values;
+		// Names of the variables in the order of their slots
+		vector<string> variableNames;
+		// Maximum depth of the operand stack, worked out once by validatePostFix
+		int maxStackDepth;
+	public:
+
+		/******************************************************************************
+			Function Name: CompiledExpression
+
+			Des:
+				Compiles the equation so that it can be evaluated many times.
+
+			Params:
+				equation - type const char *, the in-fix equation to be compiled.
+					Example input: price*qty-fee.
+				length - type int, the length of the param equation.
+				level - type OptimizationLevel, which rewrites ExpressionOptimizer may
+					make to the post-fix equation.
+
+			Throws:
+				Throws exception if the equation is invalid.
+		******************************************************************************/
+		CompiledExpression(const char *equation, int length, OptimizationLevel level = OptimizationLevel::EXACT);
+
+		/******************************************************************************
+			Function Name: tryCompile
+
+			Des:
+				Compiles the equation without throwing if it is invalid.
+
+			Params:
+				equation - type const char *, the in-fix equation to be compiled.
+				length - type int, the length of the param equation.
+				level - type OptimizationLevel, which rewrites ExpressionOptimizer may
+					make to the post-fix equation.
+
+			Returns:
+				type Expected<CompiledExpression>, the compiled equation, or the
+					reason the equation is invalid.
+		******************************************************************************/
+		static Expected<CompiledExpression> tryCompile(const char *equation, int length, OptimizationLevel level = OptimizationLevel::EXACT);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the values bound to its variables.
+
+			Params:
+				variableValues - type const vector<double> &, the value of each
+					variable in the order of their slots.
+
+			Returns:
+				type double, the answer to the equation
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		double evaluate(const vector<double> &variableValues) const;
+
+		/******************************************************************************
+			Function Name: getVariableCount
+
+			Des:
+				Gets the number of distinct variables used in the equation.
+
+			Returns:
+				type int, the number of variable slots.
+		******************************************************************************/
+		int getVariableCount() const;
+
+		/******************************************************************************
+			Function Name: getVariableIndex
+
+			Des:
+				Finds the slot of the variable with the given name.
+
+			Params:
+				name - type const string &, the name of the variable.
+
+			Returns:
+				type int, the slot of the variable or -1 if the equation does not use it.
+		******************************************************************************/
+		int getVariableIndex(const string &name) const;
+
+		/******************************************************************************
+			Function Name: getVariableNames
+
+			Des:
+				Gets the names of the variables in the order of their slots.
+
+			Returns:
+				type const vector<string> &, the names of the variables.
+		******************************************************************************/
+		const vector<string> &getVariableNames() const;
+
+		/******************************************************************************
+			Function Name: getMaxStackDepth
+
+			Des:
+				Gets the maximum number of operands on the stack while evaluating.
+
+			Returns:
+				type int, the maximum depth of the operand stack.
+		******************************************************************************/
+		int getMaxStackDepth() const;
+
+		/******************************************************************************
+			Function Name: getPostFix
+
+			Des:
+				Gets the validated equation in post-fix notation.
+
+			Returns:
+				type const vector<Token> &, the post-fix equation.
+		******************************************************************************/
+		const vector<Token> &getPostFix() const;
+
+		/******************************************************************************
+			Function Name: getValues
+
+			Des:
+				Gets the values corresponding to the PUSH_VALUE tokens in the post-fix
+					equation.
+
+			Returns:
+				type const vector<double> &, the values of the equation.
+		******************************************************************************/
+		const vector<double> &getValues() const;
+
+		/******************************************************************************
+			Function Name: getMemoryUsage
+
+			Des:
+				Estimates the memory used by the compiled equation, including the
+					memory owned by its members.
+
+			Returns:
+				type size_t, the estimated number of bytes.
+		******************************************************************************/
+		size_t getMemoryUsage() const;
+	private:
+
+		/******************************************************************************
+			Function Name: CompiledExpression
+
+			Des:
+				Creates an empty expression for compile to fill in.
+		******************************************************************************/
+		CompiledExpression() = default;
+
+		/******************************************************************************
+			Function Name: compile
+
+			Des:
+				Compiles the equation into this expression.
+
+			Params:
+				equation - type const char *, the in-fix equation to be compiled.
+				length - type int, the length of the param equation.
+				level - type OptimizationLevel, which rewrites ExpressionOptimizer may
+					make to the post-fix equation.
+
+			Returns:
+				type EquationError, the reason the equation is invalid, or
+					ErrorCode::NONE if it was compiled.
+		******************************************************************************/
+		EquationError compile(const char *equation, int length, OptimizationLevel level);
+	};
+}
@@ -0,0 +1,746 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: constexprExpression.h
+
+	Author: Matthew Day
+
+	Class Name: ConstexprParser, ConstexprExpression
+
+	Description:
+		Converts an equation given as a string literal to post-fix notation
+		while the program is being compiled. ConstexprParser follows the same
+		rules as stripValuesFromEquation and convertInfixToPostFix, including
+		unary minus, implicit multiplication, named variables and the bool and
+		comparison operators '!', '&', '|', '=', '!=', '<', '<=', '>' and '>=',
+		but works on fixed size arrays so that it can run in a constant
+		expression. An invalid equation throws inside the constant
+		expression, which the compiler reports as an error. Like the run time
+		parser, that includes numbers too large for a double, e.g. 1e400, and
+		numbers other than 0 too small for one, e.g. 1e-400.
+
+		ConstexprExpression turns the post-fix equation into nested calls that
+		the compiler inlines into a single expression, so parts of the
+		equation that only use values are folded by the compiler. Variables
+		are bound by position, in the order they first appear in the equation.
+
+			static constexpr auto PROFIT = ConstexprParser::compile("price*qty-fee");
+
+			double profit = ConstexprExpression<PROFIT>()(9.99, 3, 0.5);
+
+		Numbers are converted exactly when they have at most 15 significant
+		digits and a decimal exponent within 22 of the digits, which covers
+		almost every literal. Longer numbers may differ from the run time
+		parser in the last bit. Bool and comparison operators give 1 or 0, with
+		every number other than 0 counting as true, as in calcResult.
+
+	Outline:
+		ConstexprParser Public Functions:
+			compile
+
+		ConstexprParser Private Functions:
+			parseNumber
+			isOperator
+			getOperatorOpcode
+			getPrecedenceLevel
+			isBlank
+			isDigit
+			isVariableChar
+
+		ConstexprExpression Public Functions:
+			operator()
+			evaluate
+			getVariableName
+
+		ConstexprExpression Private Functions:
+			evaluateToken
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "token.h"
+
+using std::size_t;
+using std::uint64_t;
+using std::pow;
+using std::numeric_limits;
+using std::invalid_argument;
+using std::string_view;
+
+namespace day {
+
+	// An equation in post-fix notation with room for every token a literal of N chars can produce
+	template <size_t N>
+	struct ConstexprProgram {
+
+		// The equation as written, which the variable names point into
+		char equation[N] = {};
+		// The equation in post-fix notation, never more than twice the length of the equation
+		Token tokens[2 * N] = {};
+		// Position of the first token of the operand that ends with each token
+		int starts[2 * N] = {};
+		double values[N] = {};
+		int variableStarts[N] = {};
+		int variableLengths[N] = {};
+		int length = 0;
+		int valueCount = 0;
+		int variableCount = 0;
+	};
+
+	class ConstexprParser {
+
+	private:
+
+		enum precedenceLevel { OPENING_PARENTHESIS, OR, AND, EQUAL, COMPARE, ADD_SUB, MUL_DIV_MOD, NEGATE, EXP, NOT, CLOSING_PARENTHESIS };
+	public:
+
+		/******************************************************************************
+			Function Name: compile
+
+			Des:
+				Converts an equation to post-fix notation, meant to be used to
+					initialize a constexpr variable.
+
+			Params:
+				equation - type const char (&)[N], the in-fix equation.
+					Example input: price*qty-fee.
+
+			Returns:
+				type ConstexprProgram<N>, the equation in post-fix notation.
+
+			Throws:
+				Throws exception if the equation is invalid or holds a number out
+					of the range of a double, which is a compile error when used in
+					a constant expression.
+		******************************************************************************/
+		template <size_t N>
+		static constexpr ConstexprProgram<N> compile(const char (&equation)[N]) {
+
+			ConstexprProgram<N> result;
+			Token infix[2 * N] = {};
+			int infixLength = 0;
+			// The string literal ends with '\0', which is not part of the equation
+			int length = N - 1;
+			int endPos = 0;
+			int previous = -1;
+			int next = 0;
+
+			for (int i = 0; i < (int)N; i++)
+				result.equation[i] = equation[i];
+
+			// Same steps as stripValuesFromEquation
+			for (int i = 0; i < length; i++) {
+
+				if (isBlank(equation[i]))
+					continue;
+
+				next = i + 1;
+
+				while (next < length && isBlank(equation[next]))
+					next++;
+
+				if (equation[i] == '-' && (previous == -1 || (isOperator(equation[previous]) && equation[previous] != ')'))) {
+
+					if (next == length)
+						throw invalid_argument("Equation is invalid");
+
+					if (equation[next] == '(' || (isVariableChar(equation[next]) && !isDigit(equation[next]))) {
+
+						infix[infixLength++] = { Opcode::NEGATE, 0 };
+					} else {
+
+						infix[infixLength++] = { Opcode::PUSH_VALUE, result.valueCount };
+						result.values[result.valueCount++] = -parseNumber(equation, length, next, endPos);
+
+						i = endPos;
+					}
+				} else if (isDigit(equation[i]) || equation[i] == '.') {
+
+					infix[infixLength++] = { Opcode::PUSH_VALUE, result.valueCount };
+					result.values[result.valueCount++] = parseNumber(equation, length, i, endPos);
+
+					i = endPos;
+				} else if (isVariableChar(equation[i])) {
+
+					if (previous != -1 && (isDigit(equation[previous]) || equation[previous] == '.'))
+						infix[infixLength++] = { Opcode::MULTIPLY, 0 };
+
+					endPos = i;
+
+					while (endPos + 1 < length && isVariableChar(equation[endPos + 1]))
+						endPos++;
+
+					int nameLength = endPos - i + 1;
+					int slot = 0;
+
+					for (; slot < result.variableCount; slot++) {
+
+						bool same = result.variableLengths[slot] == nameLength;
+
+						for (int j = 0; same && j < nameLength; j++)
+							same = equation[result.variableStarts[slot] + j] == equation[i + j];
+
+						if (same)
+							break;
+					}
+
+					if (slot == result.variableCount) {
+
+						result.variableStarts[slot] = i;
+						result.variableLengths[slot] = nameLength;
+						result.variableCount++;
+					}
+
+					infix[infixLength++] = { Opcode::PUSH_VARIABLE, slot };
+
+					i = endPos;
+				} else if (equation[i] == '(' && previous != -1 && isVariableChar(equation[previous])) {
+
+					infix[infixLength++] = { Opcode::MULTIPLY, 0 };
+					infix[infixLength++] = { Opcode::OPENING_PARENTHESIS, 0 };
+				} else if (equation[i] == ')' && next != length && isVariableChar(equation[next])) {
+
+					infix[infixLength++] = { Opcode::CLOSING_PARENTHESIS, 0 };
+					infix[infixLength++] = { Opcode::MULTIPLY, 0 };
+				} else if ((equation[i] == '<' || equation[i] == '>' || equation[i] == '!') && i + 1 < length && equation[i + 1] == '=') {
+
+					if (equation[i] == '<')
+						infix[infixLength++] = { Opcode::LESS_EQUAL, 0 };
+					else if (equation[i] == '>')
+						infix[infixLength++] = { Opcode::GREATER_EQUAL, 0 };
+					else
+						infix[infixLength++] = { Opcode::NOT_EQUAL, 0 };
+
+					i++;
+				} else {
+
+					infix[infixLength++] = { getOperatorOpcode(equation[i]), 0 };
+				}
+
+				previous = i;
+			}
+
+			// Same steps as convertInfixToPostFix
+			Opcode operatorStack[2 * N] = {};
+			int operatorCount = 0;
+
+			for (int i = 0; i < infixLength; i++) {
+
+				Opcode curOperator = infix[i].opcode;
+
+				if (curOperator == Opcode::PUSH_VALUE || curOperator == Opcode::PUSH_VARIABLE || curOperator == Opcode::PUSH_NEGATIVE_ONE) {
+
+					result.tokens[result.length++] = infix[i];
+				} else if (curOperator == Opcode::OPENING_PARENTHESIS) {
+
+					operatorStack[operatorCount++] = curOperator;
+				} else if (curOperator == Opcode::CLOSING_PARENTHESIS) {
+
+					while (operatorCount > 0 && operatorStack[operatorCount - 1] != Opcode::OPENING_PARENTHESIS)
+						result.tokens[result.length++] = { operatorStack[--operatorCount], 0 };
+
+					if (operatorCount == 0)
+						throw invalid_argument("Too many closing parenthesis");
+
+					operatorCount--;
+				} else if (curOperator == Opcode::NOT || curOperator == Opcode::NEGATE) {
+
+					// '!' and unary minus apply to the operand after them, so no operator before them can be evaluated yet
+					operatorStack[operatorCount++] = curOperator;
+				} else {
+
+					while (operatorCount > 0 && getPrecedenceLevel(operatorStack[operatorCount - 1]) >= getPrecedenceLevel(curOperator))
+						result.tokens[result.length++] = { operatorStack[--operatorCount], 0 };
+
+					operatorStack[operatorCount++] = curOperator;
+				}
+			}
+
+			while (operatorCount > 0) {
+
+				operatorCount--;
+
+				if (operatorStack[operatorCount] != Opcode::OPENING_PARENTHESIS)
+					result.tokens[result.length++] = { operatorStack[operatorCount], 0 };
+			}
+
+			// Same checks as validatePostFix, while working out where each operand starts
+			int startStack[2 * N] = {};
+			int depth = 0;
+
+			for (int i = 0; i < result.length; i++) {
+
+				switch (result.tokens[i].opcode) {
+
+					case Opcode::PUSH_VALUE:
+					case Opcode::PUSH_VARIABLE:
+					case Opcode::PUSH_NEGATIVE_ONE:
+
+						startStack[depth++] = i;
+						break;
+					case Opcode::NOT:
+					case Opcode::NEGATE:
+
+						if (depth < 1)
+							throw invalid_argument("Equation is invalid");
+
+						break;
+					default:
+
+						if (depth < 2)
+							throw invalid_argument("Equation is invalid");
+
+						depth--;
+				};
+
+				result.starts[i] = startStack[depth - 1];
+			}
+
+			if (depth != 1)
+				throw invalid_argument("Equation is invalid");
+
+			return result;
+		}
+	private:
+
+		/******************************************************************************
+			Function Name: parseNumber
+
+			Des:
+				Converts the number at the given position, with the same grammar as
+					parseNumber in stringUtils.h.
+
+			Params:
+				data - type const char *, the equation.
+				length - type int, the length of the param data.
+				start - type int, the position of the first char of the number.
+				end - type int &, receives the position of the last char of the
+					number.
+
+			Returns:
+				type double, the number.
+
+			Throws:
+				Throws exception if the number is malformed.
+		******************************************************************************/
+		static constexpr double parseNumber(const char *data, int length, int start, int &end) {
+
+			// Digits past the 19th do not fit in the mantissa and only move the decimal exponent
+			const int MAX_MANTISSA_DIGITS = 19;
+
+			uint64_t mantissa = 0;
+			int mantissaDigits = 0;
+			int decimalExponent = 0;
+			int digits = 0;
+			int pos = start;
+			double result = 0;
+
+			while (pos < length && isDigit(data[pos])) {
+
+				if (mantissaDigits < MAX_MANTISSA_DIGITS) {
+
+					mantissa = mantissa * 10 + (data[pos] - '0');
+					mantissaDigits += mantissa != 0;
+				} else {
+
+					decimalExponent++;
+				}
+
+				pos++;
+				digits++;
+			}
+
+			if (pos < length && data[pos] == '.') {
+
+				pos++;
+
+				while (pos < length && isDigit(data[pos])) {
+
+					if (mantissaDigits < MAX_MANTISSA_DIGITS) {
+
+						mantissa = mantissa * 10 + (data[pos] - '0');
+						mantissaDigits += mantissa != 0;
+						decimalExponent--;
+					}
+
+					pos++;
+					digits++;
+				}
+			}
+
+			if (digits == 0)
+				throw invalid_argument("Malformed number");
+
+			if (pos + 1 < length && (data[pos] == 'e' || data[pos] == 'E')) {
+
+				int exponentPos = pos + 1;
+				bool negative = false;
+				int exponent = 0;
+
+				if (exponentPos + 1 < length && (data[exponentPos] == '+' || data[exponentPos] == '-')) {
+
+					negative = data[exponentPos] == '-';
+					exponentPos++;
+				}
+
+				if (isDigit(data[exponentPos])) {
+
+					for (pos = exponentPos; pos < length && isDigit(data[pos]); pos++) {
+
+						// Larger exponents overflow to infinity or underflow to 0 either way
+						if (exponent < 100000)
+							exponent = exponent * 10 + (data[pos] - '0');
+					}
+
+					decimalExponent += negative ? -exponent : exponent;
+				}
+			}
+
+			if (pos < length && (data[pos] == '.' || isDigit(data[pos])))
+				throw invalid_argument("Malformed number");
+
+			// Powers of ten up to 1e22 are exact, so one multiplication or division rounds correctly
+			result = (double)mantissa;
+
+			for (; decimalExponent > 22 && result != 0; decimalExponent--)
+				result *= 10;
+
+			for (; decimalExponent < -22 && result != 0; decimalExponent++)
+				result /= 10;
+
+			double scale = 1;
+
+			for (int i = 0; i < (decimalExponent < 0 ? -decimalExponent : decimalExponent); i++)
+				scale *= 10;
+
+			result = decimalExponent < 0 ? result / scale : result * scale;
+
+			// from_chars rejects these as out of range, so the run time parser does as well
+			if (result > numeric_limits<double>::max() || (result == 0 && mantissa != 0))
+				throw invalid_argument("Malformed number");
+
+			end = pos - 1;
+
+			return result;
+		}
+
+		static constexpr bool isOperator(char value) {
+
+			return value == '(' || value == ')' || value == '^' || value == '*' || value == '/' || value == '%' || value == '+' || value == '-'
+				|| value == '!' || value == '&' || value == '|' || value == '=' || value == '<' || value == '>';
+		}
+
+		static constexpr Opcode getOperatorOpcode(char value) {
+
+			Opcode result = Opcode::ADD;
+
+			switch (value) {
+
+				case '(':
+
+					result = Opcode::OPENING_PARENTHESIS;
+					break;
+				case ')':
+
+					result = Opcode::CLOSING_PARENTHESIS;
+					break;
+				case '^':
+
+					result = Opcode::POWER;
+					break;
+				case '*':
+
+					result = Opcode::MULTIPLY;
+					break;
+				case '/':
+
+					result = Opcode::DIVIDE;
+					break;
+				case '%':
+
+					result = Opcode::MODULO;
+					break;
+				case '+':
+
+					result = Opcode::ADD;
+					break;
+				case '-':
+
+					result = Opcode::SUBTRACT;
+					break;
+				case '!':
+
+					result = Opcode::NOT;
+					break;
+				case '&':
+
+					result = Opcode::AND;
+					break;
+				case '|':
+
+					result = Opcode::OR;
+					break;
+				case '=':
+
+					result = Opcode::EQUAL;
+					break;
+				case '<':
+
+					result = Opcode::LESS;
+					break;
+				case '>':
+
+					result = Opcode::GREATER;
+					break;
+				default:
+
+					throw invalid_argument("Equation is invalid");
+			};
+
+			return result;
+		}
+
+		static constexpr precedenceLevel getPrecedenceLevel(Opcode curOperator) {
+
+			precedenceLevel result = OPENING_PARENTHESIS;
+
+			switch (curOperator) {
+
+				case Opcode::OPENING_PARENTHESIS:
+
+					result = OPENING_PARENTHESIS;
+					break;
+				case Opcode::OR:
+
+					result = OR;
+					break;
+				case Opcode::AND:
+
+					result = AND;
+					break;
+				case Opcode::EQUAL:
+				case Opcode::NOT_EQUAL:
+
+					result = EQUAL;
+					break;
+				case Opcode::LESS:
+				case Opcode::LESS_EQUAL:
+				case Opcode::GREATER:
+				case Opcode::GREATER_EQUAL:
+
+					result = COMPARE;
+					break;
+				case Opcode::ADD:
+				case Opcode::SUBTRACT:
+
+					result = ADD_SUB;
+					break;
+				case Opcode::MULTIPLY:
+				case Opcode::DIVIDE:
+				case Opcode::MODULO:
+
+					result = MUL_DIV_MOD;
+					break;
+				case Opcode::NEGATE:
+
+					result = NEGATE;
+					break;
+				case Opcode::POWER:
+
+					result = EXP;
+					break;
+				case Opcode::NOT:
+
+					result = NOT;
+					break;
+				default:
+
+					result = CLOSING_PARENTHESIS;
+			};
+
+			return result;
+		}
+
+		static constexpr bool isBlank(char value) {
+
+			return value == ' ' || value == '\t';
+		}
+
+		static constexpr bool isDigit(char value) {
+
+			return value >= '0' && value <= '9';
+		}
+
+		static constexpr bool isVariableChar(char value) {
+
+			return isDigit(value) || (value >= 'a' && value <= 'z') || (value >= 'A' && value <= 'Z') || value == '_';
+		}
+	};
+
+	template <const auto &Program>
+	class ConstexprExpression {
+
+	public:
+
+		// Number of values to pass when evaluating
+		static constexpr int VARIABLE_COUNT = Program.variableCount;
+
+		/******************************************************************************
+			Function Name: operator()
+
+			Des:
+				Evaluates the equation with the given variables.
+
+			Params:
+				variables - type Args..., the value of each variable in the order
+					they first appear in the equation.
+
+			Returns:
+				type double, the answer to the equation.
+		******************************************************************************/
+		template <typename... Args>
+		constexpr double operator()(Args... variables) const {
+
+			static_assert(sizeof...(Args) == VARIABLE_COUNT, "Every variable must have a value bound to it");
+
+			// Never empty, so equations without variables still have a valid array
+			const double variableValues[] = { (double)variables..., 0 };
+
+			return evaluate(variableValues);
+		}
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the variables in an array.
+
+			Params:
+				variables - type const double *, the value of each variable in the
+					order they first appear in the equation.
+
+			Returns:
+				type double, the answer to the equation.
+		******************************************************************************/
+		static constexpr double evaluate(const double *variables) {
+
+			return evaluateToken<Program.length - 1>(variables);
+		}
+
+		/******************************************************************************
+			Function Name: getVariableName
+
+			Des:
+				Gets the name of the variable bound to a position.
+
+			Params:
+				slot - type int, the position of the variable.
+
+			Returns:
+				type string_view, the name of the variable.
+		******************************************************************************/
+		static constexpr string_view getVariableName(int slot) {
+
+			return string_view(Program.equation + Program.variableStarts[slot], Program.variableLengths[slot]);
+		}
+	private:
+
+		/******************************************************************************
+			Function Name: evaluateToken
+
+			Des:
+				Evaluates the operand that ends with the token at position I. The
+					operands of an operator are evaluated by recursion, so the whole
+					equation is expanded into a single expression.
+
+			Params:
+				variables - type const double *, the value of each variable.
+
+			Returns:
+				type double, the value of the operand.
+		******************************************************************************/
+		template <int I>
+		static constexpr double evaluateToken(const double *variables) {
+
+			constexpr Token TOKEN = Program.tokens[I];
+			double result = 0;
+
+			if constexpr (TOKEN.opcode == Opcode::PUSH_VALUE) {
+
+				result = Program.values[TOKEN.index];
+			} else if constexpr (TOKEN.opcode == Opcode::PUSH_VARIABLE) {
+
+				result = variables[TOKEN.index];
+			} else if constexpr (TOKEN.opcode == Opcode::PUSH_NEGATIVE_ONE) {
+
+				result = -1;
+			} else if constexpr (TOKEN.opcode == Opcode::NEGATE) {
+
+				result = -evaluateToken<I - 1>(variables);
+			} else if constexpr (TOKEN.opcode == Opcode::NOT) {
+
+				result = evaluateToken<I - 1>(variables) == 0;
+			} else {
+
+				// The right operand ends just before the operator and the left one just before the right one starts
+				constexpr int RIGHT = I - 1;
+				constexpr int LEFT = Program.starts[RIGHT] - 1;
+
+				double num1 = evaluateToken<LEFT>(variables);
+				double num2 = evaluateToken<RIGHT>(variables);
+
+				if constexpr (TOKEN.opcode == Opcode::ADD)
+					result = num1 + num2;
+				else if constexpr (TOKEN.opcode == Opcode::SUBTRACT)
+					result = num1 - num2;
+				else if constexpr (TOKEN.opcode == Opcode::MULTIPLY)
+					result = num1 * num2;
+				else if constexpr (TOKEN.opcode == Opcode::DIVIDE)
+					result = num1 / num2;
+				else if constexpr (TOKEN.opcode == Opcode::MODULO)
+					result = (int)num1 % (int)num2;
+				else if constexpr (TOKEN.opcode == Opcode::POWER)
+					result = pow(num1, num2);
+				else if constexpr (TOKEN.opcode == Opcode::AND)
+					result = num1 != 0 && num2 != 0;
+				else if constexpr (TOKEN.opcode == Opcode::OR)
+					result = num1 != 0 || num2 != 0;
+				else if constexpr (TOKEN.opcode == Opcode::EQUAL)
+					result = num1 == num2;
+				else if constexpr (TOKEN.opcode == Opcode::NOT_EQUAL)
+					result = num1 != num2;
+				else if constexpr (TOKEN.opcode == Opcode::LESS)
+					result = num1 < num2;
+				else if constexpr (TOKEN.opcode == Opcode::LESS_EQUAL)
+					result = num1 <= num2;
+				else if constexpr (TOKEN.opcode == Opcode::GREATER)
+					result = num1 > num2;
+				else if constexpr (TOKEN.opcode == Opcode::GREATER_EQUAL)
+					result = num1 >= num2;
+			}
+
+			return result;
+		}
+	};
+}
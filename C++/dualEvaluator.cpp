@@ -0,0 +1,312 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: dualEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for dualEvaluator.h
+
+	Outline:
+		Public Functions:
+			DualEvaluator
+			DualEvaluator
+			evaluate
+			evaluate
+
+		Private Functions:
+			prepare
+			evaluateBlock
+			applyPartials
+******************************************************************************/
+
+#include "dualEvaluator.h"
+
+namespace day {
+
+	DualEvaluator::DualEvaluator() : variableCount(0), zeros(BLOCK_SIZE), answers(BLOCK_SIZE), leftFactors(BLOCK_SIZE), rightFactors(BLOCK_SIZE) {
+	}
+
+	DualEvaluator::DualEvaluator(InstructionSet instructionSet) : variableCount(0), zeros(BLOCK_SIZE), answers(BLOCK_SIZE), leftFactors(BLOCK_SIZE), rightFactors(BLOCK_SIZE), kernels(instructionSet) {
+	}
+
+	double DualEvaluator::evaluate(const CompiledExpression &expression, const vector<double> &variableValues, vector<double> &partials) {
+
+		if (variableValues.size() < (size_t)expression.getVariableCount())
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		vector<const double *> columns(expression.getVariableCount());
+		vector<double *> partialColumns(expression.getVariableCount());
+		double answer;
+
+		partials.resize(expression.getVariableCount());
+
+		// A single row is a block of one row
+		for (int i = 0; i < expression.getVariableCount(); i++) {
+
+			columns[i] = &variableValues[i];
+			partialColumns[i] = &partials[i];
+		}
+
+		prepare(expression, columns.data(), partialColumns.data());
+		evaluateBlock(expression, columns.data(), 0, 1, &answer, partialColumns.data());
+
+		return answer;
+	}
+
+	void DualEvaluator::evaluate(const CompiledExpression &expression, const double *const *columns, double *output, double *const *partials, size_t rows) {
+
+		prepare(expression, columns, partials);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, columns, first, count, output + first, partials);
+		}
+	}
+
+	void DualEvaluator::prepare(const CompiledExpression &expression, const double *const *columns, double *const *partials) {
+
+		if ((columns == nullptr || partials == nullptr) && expression.getVariableCount() > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		for (int i = 0; i < expression.getVariableCount(); i++) {
+
+			if (columns[i] == nullptr || partials[i] == nullptr)
+				throw invalid_argument("Not every variable has a column bound to it");
+		}
+
+		variableCount = expression.getVariableCount();
+
+		size_t size = (size_t)expression.getMaxStackDepth() * (variableCount + 1) * BLOCK_SIZE;
+
+		// Only grows, so an evaluator that is reused does not allocate again
+		if (scratch.size() < size)
+			scratch.resize(size);
+
+		if (operandStack.size() < (size_t)expression.getMaxStackDepth())
+			operandStack.resize(expression.getMaxStackDepth());
+	}
+
+	void DualEvaluator::evaluateBlock(const CompiledExpression &expression, const double *const *columns, size_t first, int count, double *output, double *const *partials) {
+
+		const vector<Token> &postFix = expression.getPostFix();
+		const vector<double> &values = expression.getValues();
+		// Distance between the value blocks of two depths of the operand stack
+		size_t stride = (size_t)(variableCount + 1) * BLOCK_SIZE;
+		int depth = 0;
+
+		for (const Token &token : postFix) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = { nullptr, values[token.index], true };
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack[depth++] = { nullptr, -1, true };
+					break;
+				case Opcode::PUSH_VARIABLE: {
+
+					double *seed = scratch.data() + depth * stride + BLOCK_SIZE;
+
+					// The column is read in place, only the partials are written: 1 for its own slot, 0 for the others
+					for (int k = 0; k < variableCount; k++)
+						for (int i = 0; i < count; i++)
+							seed[(size_t)k * BLOCK_SIZE + i] = k == token.index ? 1 : 0;
+
+					operandStack[depth++] = { columns[token.index] + first, 0, false };
+					break;
+				}
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER:
+				case Opcode::SQUARE_ROOT:
+				case Opcode::MODULO_POWER_OF_TWO: {
+
+					Operand &top = operandStack[depth - 1];
+					// Integer operand kept in the token, only used by some unary operators
+					Operand tokenOperand = { nullptr, (double)token.index, true };
+
+					if (top.isConstant) {
+
+						kernels.apply(token.opcode, &top.scalar, true, &tokenOperand.scalar, true, &top.scalar, 1);
+					} else {
+
+						double *value = scratch.data() + (depth - 1) * stride;
+
+						kernels.apply(token.opcode, top.data, false, &tokenOperand.scalar, true, answers.data(), count);
+						applyPartials(token.opcode, top, tokenOperand, answers.data(), value + BLOCK_SIZE, nullptr, value + BLOCK_SIZE, count);
+
+						for (int i = 0; i < count; i++)
+							value[i] = answers[i];
+
+						top = { value, 0, false };
+					}
+
+					break;
+				}
+				default:
+
+					// Every other opcode left by validatePostFix is a binary operator
+					Operand &left = operandStack[depth - 2];
+					const Operand &right = operandStack[depth - 1];
+
+					if (left.isConstant && right.isConstant) {
+
+						kernels.apply(token.opcode, &left.scalar, true, &right.scalar, true, &left.scalar, 1);
+					} else {
+
+						double *value = scratch.data() + (depth - 2) * stride;
+
+						kernels.apply(token.opcode, left.isConstant ? &left.scalar : left.data, left.isConstant, right.isConstant ? &right.scalar : right.data, right.isConstant, answers.data(), count);
+						applyPartials(token.opcode, left, right, answers.data(), value + BLOCK_SIZE, value + stride + BLOCK_SIZE, value + BLOCK_SIZE, count);
+
+						for (int i = 0; i < count; i++)
+							value[i] = answers[i];
+
+						left = { value, 0, false };
+					}
+
+					depth--;
+			};
+		}
+
+		const Operand &answer = operandStack[0];
+
+		for (int i = 0; i < count; i++)
+			output[i] = answer.isConstant ? answer.scalar : answer.data[i];
+
+		for (int k = 0; k < variableCount; k++) {
+
+			const double *partial = answer.isConstant ? zeros.data() : scratch.data() + (size_t)(k + 1) * BLOCK_SIZE;
+
+			for (int i = 0; i < count; i++)
+				partials[k][first + i] = partial[i];
+		}
+	}
+
+	void DualEvaluator::applyPartials(Opcode opcode, const Operand &left, const Operand &right, const double *answer, const double *leftPartials, const double *rightPartials, double *result, int count) {
+
+		// Constants are read with a stride of 0
+		const double *a = left.isConstant ? &left.scalar : left.data;
+		const double *b = right.isConstant ? &right.scalar : right.data;
+		int aStride = left.isConstant ? 0 : 1;
+		int bStride = right.isConstant ? 0 : 1;
+		bool hasFactors = true;
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+			case Opcode::SUBTRACT:
+
+				for (int i = 0; i < count; i++) {
+
+					leftFactors[i] = 1;
+					rightFactors[i] = opcode == Opcode::ADD ? 1 : -1;
+				}
+
+				break;
+			case Opcode::MULTIPLY:
+
+				for (int i = 0; i < count; i++) {
+
+					leftFactors[i] = b[i * bStride];
+					rightFactors[i] = a[i * aStride];
+				}
+
+				break;
+			case Opcode::DIVIDE:
+
+				for (int i = 0; i < count; i++) {
+
+					leftFactors[i] = 1 / b[i * bStride];
+					rightFactors[i] = -answer[i] / b[i * bStride];
+				}
+
+				break;
+			case Opcode::POWER:
+
+				// pow and log are only called for the operands that have partials
+				for (int i = 0; i < count; i++) {
+
+					double base = a[i * aStride];
+					double exponent = b[i * bStride];
+
+					leftFactors[i] = left.isConstant || exponent == 0 ? 0 : exponent * std::pow(base, exponent - 1);
+					rightFactors[i] = right.isConstant || answer[i] == 0 ? 0 : answer[i] * std::log(base);
+				}
+
+				break;
+			case Opcode::NEGATE:
+
+				for (int i = 0; i < count; i++)
+					leftFactors[i] = -1;
+
+				break;
+			case Opcode::SQUARE_ROOT:
+
+				for (int i = 0; i < count; i++)
+					leftFactors[i] = 0.5 / answer[i];
+
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				double exponent = right.scalar;
+
+				for (int i = 0; i < count; i++)
+					leftFactors[i] = exponent == 0 ? 0 : exponent * std::pow(a[i], exponent - 1);
+
+				break;
+			}
+			default:
+
+				// '%', the bool operators and the comparisons are step functions
+				hasFactors = false;
+		}
+
+		for (int k = 0; k < variableCount; k++) {
+
+			const double *leftPartial = leftPartials + (size_t)k * BLOCK_SIZE;
+			const double *rightPartial = rightPartials + (size_t)k * BLOCK_SIZE;
+			double *partial = result + (size_t)k * BLOCK_SIZE;
+
+			// A term whose partial is 0 is left out rather than multiplied, as its factor may be infinite
+			if (!hasFactors) {
+
+				for (int i = 0; i < count; i++)
+					partial[i] = 0;
+			} else if (right.isConstant) {
+
+				for (int i = 0; i < count; i++)
+					partial[i] = leftPartial[i] != 0 ? leftPartial[i] * leftFactors[i] : 0;
+			} else if (left.isConstant) {
+
+				for (int i = 0; i < count; i++)
+					partial[i] = rightPartial[i] != 0 ? rightPartial[i] * rightFactors[i] : 0;
+			} else {
+
+				for (int i = 0; i < count; i++)
+					partial[i] = (leftPartial[i] != 0 ? leftPartial[i] * leftFactors[i] : 0) + (rightPartial[i] != 0 ? rightPartial[i] * rightFactors[i] : 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,245 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: dualEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: DualEvaluator
+
+	Description:
+		Evaluates a compiled equation on dual numbers, so a single pass gives
+		the answer and its partial derivative with respect to every variable,
+		without the noise and the 2N+1 evaluations of finite differences.
+
+		Each operand carries its value and one partial for each variable
+		slot. A variable starts with a partial of 1 for its own slot and 0 for
+		the others, values have no partials, and each operator applies the
+		chain rule:
+			a+b, a-b	da+db, da-db
+			a*b			da*b + a*db
+			a/b			(da - a/b*db) / b
+			a^b			b*a^(b-1)*da + a^b*ln(a)*db
+			-a			-da
+		The two terms of a^b are only added when their partial is not 0, so
+		x^2 at x = 0, 0.5^x and x^0.5 for the other variables are not turned
+		to NaN by 0*inf. The ln(a) term is 0 when a^b is 0 and NaN when a is
+		negative, where a^b has no derivative with respect to b.
+
+		'%' truncates its operands to ints, so its answer is a step function
+		of them and its partials are 0, as are those of the bool operators
+		and comparisons, which only give 1 or 0.
+
+		Rows are evaluated in blocks like BatchEvaluator. The values are
+		computed by the same SimdKernels, so they are the same as the answers
+		of BatchEvaluator and CompiledExpression, and the partials of each
+		operator are simple loops over the block. BLOCK_SIZE is smaller than
+		the one of BatchEvaluator as every stack entry holds a block for each
+		partial too.
+
+		An evaluator reuses its scratch space between calls, so each thread
+		should use its own evaluator.
+
+	Outline:
+		Public Functions:
+			DualEvaluator
+			DualEvaluator
+			evaluate
+			evaluate
+
+		Private Functions:
+			prepare
+			evaluateBlock
+			applyPartials
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include "compiledExpression.h"
+#include "simdKernels.h"
+#include "token.h"
+
+using std::vector;
+using std::size_t;
+using std::invalid_argument;
+
+namespace day {
+
+	class DualEvaluator {
+
+	public:
+
+		// Number of rows evaluated together, smaller than BatchEvaluator as each operand holds a block for every partial
+		static const int BLOCK_SIZE = 256;
+	private:
+
+		// An entry on the operand stack. A constant is a single value with partials of 0, any other operand has its partials in the scratch blocks of its depth
+		struct Operand {
+
+			const double *data;
+			double scalar;
+			bool isConstant;
+		};
+
+		int variableCount;
+		// For each depth of the operand stack a value block followed by one block for each partial
+		vector<double> scratch;
+		// A block of 0s, read as the partials of constants
+		vector<double> zeros;
+		// The values of the operator being applied, kept apart until the partials have read the operands
+		vector<double> answers;
+		// Derivative of the operator with respect to each operand for every row, so each partial is leftPartial*leftFactor + rightPartial*rightFactor
+		vector<double> leftFactors;
+		vector<double> rightFactors;
+		vector<Operand> operandStack;
+		SimdKernels kernels;
+	public:
+
+		/******************************************************************************
+			Function Name: DualEvaluator
+
+			Des:
+				Uses the widest instruction set supported by the CPU for the values.
+		******************************************************************************/
+		DualEvaluator();
+
+		/******************************************************************************
+			Function Name: DualEvaluator
+
+			Des:
+				Uses the given instruction set for the values if the CPU supports it.
+
+			Params:
+				instructionSet - type InstructionSet, the requested instruction set.
+		******************************************************************************/
+		DualEvaluator(InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation and its partial derivatives for one set of
+					values.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				variableValues - type const vector<double> &, the value of each
+					variable in the order of their slots.
+				partials - type vector<double> &, output to get the partial
+					derivative with respect to each variable slot.
+
+			Returns:
+				type double, the answer to the equation.
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		double evaluate(const CompiledExpression &expression, const vector<double> &variableValues, vector<double> &partials);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation and its partial derivatives for every row.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				output - type double *, output column to get the answer for each row.
+				partials - type double * const *, one output column for each
+					variable slot to get the partial derivative with respect to it
+					for each row.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if a column or partial column is missing.
+		******************************************************************************/
+		void evaluate(const CompiledExpression &expression, const double *const *columns, double *output, double *const *partials, size_t rows);
+
+	private:
+
+		/******************************************************************************
+			Function Name: prepare
+
+			Des:
+				Checks the columns and grows the scratch space for the equation.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				partials - type double * const *, one partial column for each
+					variable slot.
+
+			Throws:
+				Throws exception if a column or partial column is missing.
+		******************************************************************************/
+		void prepare(const CompiledExpression &expression, const double *const *columns, double *const *partials);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Evaluates the equation and its partials for a single block of rows.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression.
+				first - type size_t, the first row of the block.
+				count - type int, the number of rows in the block.
+				output - type double *, output column to get the answers.
+				partials - type double * const *, one partial column for each
+					variable slot.
+		******************************************************************************/
+		void evaluateBlock(const CompiledExpression &expression, const double *const *columns, size_t first, int count, double *output, double *const *partials);
+
+		/******************************************************************************
+			Function Name: applyPartials
+
+			Des:
+				Works out the partials of an operator from those of its operands, by
+					the chain rule.
+
+			Params:
+				opcode - type Opcode, the operator.
+				left - type const Operand &, the left operand, or the only one of a
+					unary operator.
+				right - type const Operand &, the right operand, or the integer
+					operand kept in the token of a unary operator.
+				answer - type const double *, the values of the operator.
+				leftPartials - type const double *, the first partial block of param
+					left, the others follow it. Unused if param left is a constant.
+				rightPartials - type const double *, the first partial block of
+					param right. Unused if param right is a constant.
+				result - type double *, the first partial block to get the partials,
+					which may be param leftPartials.
+				count - type int, the number of rows in the block.
+		******************************************************************************/
+		void applyPartials(Opcode opcode, const Operand &left, const Operand &right, const double *answer, const double *leftPartials, const double *rightPartials, double *result, int count);
+	};
+}
@@ -0,0 +1,71 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: equationError.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for equationError.h
+
+	Outline:
+		Public Functions:
+			getMessage
+******************************************************************************/
+
+#include "equationError.h"
+
+namespace day {
+
+	string EquationError::getMessage() const {
+
+		string result;
+
+		switch (code) {
+
+			case ErrorCode::NONE:
+
+				result = "No error";
+				break;
+			case ErrorCode::NULL_EQUATION:
+
+				result = "Equation is null";
+				break;
+			case ErrorCode::MALFORMED_NUMBER:
+
+				result = "Malformed number at position " + to_string(position);
+				break;
+			case ErrorCode::TOO_MANY_CLOSING_PARENTHESIS:
+
+				result = "Too many closing parenthesis";
+				break;
+			case ErrorCode::INVALID_OPERATOR:
+
+				result = "Opcode is not a valid operator";
+				break;
+			case ErrorCode::UNBOUND_VARIABLE:
+
+				result = "Variable has no value bound to it";
+				break;
+			default:
+
+				result = "Equation is invalid";
+		};
+
+		return result;
+	}
+}
@@ -0,0 +1,82 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: equationError.h
+
+	Author: Matthew Day
+
+	Class Name: EquationError
+
+	Description:
+		Describes why an equation was rejected, returned by the non-throwing
+		functions of ReversePolishNotation and CompiledExpression in place of
+		an exception. The functions that throw build their message from it, so
+		both report the same errors.
+
+	Outline:
+		Public Functions:
+			getMessage
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+
+using std::string;
+using std::to_string;
+
+namespace day {
+
+	enum class ErrorCode : unsigned char {
+
+		NONE,
+		// The equation pointer is null
+		NULL_EQUATION,
+		// A number such as 1.2.3 that cannot be converted
+		MALFORMED_NUMBER,
+		// A char that is not a number, variable, operator or whitespace
+		UNEXPECTED_CHARACTER,
+		// An operator or operand where it cannot be, e.g. 1+*2, 1 2 or ()
+		INVALID_EQUATION,
+		// A ')' without a matching '('
+		TOO_MANY_CLOSING_PARENTHESIS,
+		// An in-fix token list holds an opcode that is not an operator of the in-fix notation
+		INVALID_OPERATOR,
+		// A post-fix equation refers to a variable slot that has no value
+		UNBOUND_VARIABLE
+	};
+
+	struct EquationError {
+
+		ErrorCode code;
+		// Position of the char in the equation, or of the token in a token
+		// list, where the error was found. The length of the equation when the
+		// equation ends too early
+		int position;
+
+		/******************************************************************************
+			Function Name: getMessage
+
+			Des:
+				Gets the message of the exception thrown for the error.
+
+			Returns:
+				type string, the message.
+		******************************************************************************/
+		string getMessage() const;
+	};
+}
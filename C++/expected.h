@@ -0,0 +1,166 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: expected.h
+
+	Author: Matthew Day
+
+	Class Name: Expected
+
+	Description:
+		Holds either the result of a function or the EquationError that kept it
+		from producing one, in the style of std::expected. Returned by the
+		non-throwing functions so that rejecting an equation costs no more than
+		a return.
+
+	Outline:
+		Public Functions:
+			Expected
+			Expected
+			hasValue
+			operator bool
+			getValue
+			getValue
+			getError
+******************************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "equationError.h"
+
+using std::optional;
+using std::invalid_argument;
+using std::move;
+
+namespace day {
+
+	template <typename T>
+	class Expected {
+
+	private:
+
+		// Empty when the function failed
+		optional<T> value;
+		EquationError error;
+	public:
+
+		/******************************************************************************
+			Function Name: Expected
+
+			Des:
+				Holds a result.
+
+			Params:
+				value - type T, the result.
+		******************************************************************************/
+		Expected(T value) : value(move(value)), error({ ErrorCode::NONE, -1 }) {
+
+		}
+
+		/******************************************************************************
+			Function Name: Expected
+
+			Des:
+				Holds an error.
+
+			Params:
+				error - type EquationError, the reason there is no result.
+		******************************************************************************/
+		Expected(EquationError error) : error(error) {
+
+		}
+
+		/******************************************************************************
+			Function Name: hasValue
+
+			Des:
+				Checks if there is a result.
+
+			Returns:
+				type bool, true if there is a result, false if there is an error.
+		******************************************************************************/
+		bool hasValue() const {
+
+			return value.has_value();
+		}
+
+		explicit operator bool() const {
+
+			return value.has_value();
+		}
+
+		/******************************************************************************
+			Function Name: getValue
+
+			Des:
+				Gets the result.
+
+			Returns:
+				type const T &, the result.
+
+			Throws:
+				Throws exception with the message of the error if there is no
+					result.
+		******************************************************************************/
+		const T &getValue() const {
+
+			if (!value.has_value())
+				throw invalid_argument(error.getMessage());
+
+			return *value;
+		}
+
+		/******************************************************************************
+			Function Name: getValue
+
+			Des:
+				Gets the result so that it can be moved out.
+
+			Returns:
+				type T &, the result.
+
+			Throws:
+				Throws exception with the message of the error if there is no
+					result.
+		******************************************************************************/
+		T &getValue() {
+
+			if (!value.has_value())
+				throw invalid_argument(error.getMessage());
+
+			return *value;
+		}
+
+		/******************************************************************************
+			Function Name: getError
+
+			Des:
+				Gets the error, whose code is ErrorCode::NONE if there is a result.
+
+			Returns:
+				type const EquationError &, the error.
+		******************************************************************************/
+		const EquationError &getError() const {
+
+			return error;
+		}
+	};
+}
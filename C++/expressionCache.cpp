@@ -0,0 +1,210 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: expressionCache.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for expressionCache.h
+
+	Outline:
+		Public Functions:
+			ExpressionCache
+			getExpression
+			getHits
+			getMisses
+			getEvictions
+			getMemoryUsage
+			getMemoryBudget
+			getSize
+
+		Private Functions
+			normalizeEquation
+			getShard
+******************************************************************************/
+
+#include "expressionCache.h"
+
+namespace day {
+
+	ExpressionCache::ExpressionCache(size_t memoryBudget, int shardCount) : memoryBudget(memoryBudget), hits(0), misses(0), evictions(0) {
+
+		if (shardCount < 1)
+			shardCount = 1;
+
+		for (int i = 0; i < shardCount; i++)
+			shards.emplace_back(new Shard());
+
+		shardBudget = memoryBudget / shardCount;
+	}
+
+	shared_ptr<const CompiledExpression> ExpressionCache::getExpression(const char *equation, int length) {
+
+		if (equation == nullptr)
+			throw invalid_argument("Equation is null");
+
+		// Reused by every lookup on this thread so that a hit does not allocate
+		static thread_local string key;
+
+		normalizeEquation(equation, length, key);
+
+		Shard &shard = getShard(key);
+
+		{
+			lock_guard<mutex> guard(shard.lock);
+			auto found = shard.index.find(key);
+
+			if (found != shard.index.end()) {
+
+				// Move the entry to the front of the list as the most recently used
+				shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+				hits.fetch_add(1, memory_order_relaxed);
+
+				return found->second->expression;
+			}
+		}
+
+		misses.fetch_add(1, memory_order_relaxed);
+
+		// Compiled without holding the lock so other lookups in the shard are not blocked
+		shared_ptr<const CompiledExpression> result = make_shared<const CompiledExpression>(key.c_str(), key.size());
+		// The key is stored twice, once in the list and once in the index
+		size_t bytes = result->getMemoryUsage() + sizeof(Entry) + 2 * (key.size() + 1);
+
+		// An equation larger than the whole shard budget is returned without being cached
+		if (bytes > shardBudget)
+			return result;
+
+		lock_guard<mutex> guard(shard.lock);
+		auto found = shard.index.find(key);
+
+		// Another thread may have compiled the same equation in the meantime
+		if (found != shard.index.end()) {
+
+			shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+
+			return found->second->expression;
+		}
+
+		shard.entries.push_front({ key, result, bytes });
+		shard.index.emplace(key, shard.entries.begin());
+		shard.bytes += bytes;
+
+		// Evict the least recently used entries until the shard is within its budget
+		while (shard.bytes > shardBudget) {
+
+			Entry &last = shard.entries.back();
+
+			shard.bytes -= last.bytes;
+			shard.index.erase(last.key);
+			shard.entries.pop_back();
+			evictions.fetch_add(1, memory_order_relaxed);
+		}
+
+		return result;
+	}
+
+	size_t ExpressionCache::getHits() const {
+
+		return hits.load(memory_order_relaxed);
+	}
+
+	size_t ExpressionCache::getMisses() const {
+
+		return misses.load(memory_order_relaxed);
+	}
+
+	size_t ExpressionCache::getEvictions() const {
+
+		return evictions.load(memory_order_relaxed);
+	}
+
+	size_t ExpressionCache::getMemoryUsage() const {
+
+		size_t result = 0;
+
+		for (const unique_ptr<Shard> &shard : shards) {
+
+			lock_guard<mutex> guard(shard->lock);
+			result += shard->bytes;
+		}
+
+		return result;
+	}
+
+	size_t ExpressionCache::getMemoryBudget() const {
+
+		return memoryBudget;
+	}
+
+	size_t ExpressionCache::getSize() const {
+
+		size_t result = 0;
+
+		for (const unique_ptr<Shard> &shard : shards) {
+
+			lock_guard<mutex> guard(shard->lock);
+			result += shard->entries.size();
+		}
+
+		return result;
+	}
+
+	void ExpressionCache::normalizeEquation(const char *equation, int length, string &result) const {
+
+		result.clear();
+
+		for (int i = 0; i < length; i++) {
+
+			if (!isblank(equation[i])) {
+
+				result.push_back(equation[i]);
+				continue;
+			}
+
+			int next = i + 1;
+
+			while (next < length && isblank(equation[next]))
+				next++;
+
+			// Keep a single space between two values or variables, e.g. "2 3" must not become "23"
+			if (!result.empty() && next < length && (isalnum(result.back()) || result.back() == '_' || result.back() == '.') && (isalnum(equation[next]) || equation[next] == '_' || equation[next] == '.'))
+				result.push_back(' ');
+
+			// '<=', '>=' and '!=' are only one operator when nothing separates the two chars, e.g. "a ! = b" is (!a) = b
+			if (!result.empty() && next < length && (result.back() == '<' || result.back() == '>' || result.back() == '!') && equation[next] == '=')
+				result.push_back(' ');
+
+			// An exponent is only part of a number when nothing separates them, e.g. "2e - 1" is 2*e - 1 but "2e-1" is 0.2
+			size_t size = result.size();
+			bool afterExponent = size >= 2 && (result[size - 1] == 'e' || result[size - 1] == 'E') && (isdigit(result[size - 2]) || result[size - 2] == '.');
+			bool afterExponentSign = size >= 3 && (result[size - 1] == '+' || result[size - 1] == '-') && (result[size - 2] == 'e' || result[size - 2] == 'E')
+				&& (isdigit(result[size - 3]) || result[size - 3] == '.');
+
+			if (next < length && ((afterExponent && (equation[next] == '+' || equation[next] == '-')) || (afterExponentSign && isdigit(equation[next]))))
+				result.push_back(' ');
+
+			i = next - 1;
+		}
+	}
+
+	ExpressionCache::Shard &ExpressionCache::getShard(const string &key) const {
+
+		return *shards[hash<string>()(key) % shards.size()];
+	}
+}
@@ -0,0 +1,251 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: expressionCache.h
+
+	Author: Matthew Day
+
+	Class Name: ExpressionCache
+
+	Description:
+		A bounded cache of compiled equations keyed by their text, so an
+		equation that is seen again skips stripValuesFromEquation and
+		convertInfixToPostFix. Whitespace is removed from the key, except for a
+		single space between two values or variables, between '<', '>' or
+		'!' and a following '=', and between a number ending in 'e' and a
+		sign or digit, so "a * b" and "a*b" share an entry while "2 3" still
+		differs from "23", "a ! = b" from "a!=b" and "2e - 1" from "2e-1".
+
+		The cache is split into shards by the hash of the key. Each shard has
+		its own lock and least recently used list and an equal part of the
+		memory budget, so threads looking up different equations rarely wait on
+		each other. Equations are compiled outside of the lock. Entries are
+		returned as shared pointers, so an evicted equation stays valid for as
+		long as a caller holds it.
+
+	Outline:
+		Public Functions:
+			ExpressionCache
+			getExpression
+			getHits
+			getMisses
+			getEvictions
+			getMemoryUsage
+			getMemoryBudget
+			getSize
+
+		Private Functions
+			normalizeEquation
+			getShard
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cctype>
+#include <cstddef>
+
+#include "compiledExpression.h"
+
+using std::string;
+using std::vector;
+using std::list;
+using std::unordered_map;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::make_shared;
+using std::mutex;
+using std::lock_guard;
+using std::atomic;
+using std::memory_order_relaxed;
+using std::hash;
+using std::isblank;
+using std::isalnum;
+using std::isdigit;
+using std::size_t;
+
+namespace day {
+
+	class ExpressionCache {
+
+	private:
+
+		struct Entry {
+
+			string key;
+			shared_ptr<const CompiledExpression> expression;
+			size_t bytes;
+		};
+
+		// Entries are kept in order of use, the most recently used first
+		struct Shard {
+
+			mutex lock;
+			list<Entry> entries;
+			unordered_map<string, list<Entry>::iterator> index;
+			size_t bytes = 0;
+		};
+
+		vector<unique_ptr<Shard>> shards;
+		size_t memoryBudget;
+		size_t shardBudget;
+
+		atomic<size_t> hits;
+		atomic<size_t> misses;
+		atomic<size_t> evictions;
+	public:
+
+		static const int DEFAULT_SHARD_COUNT = 16;
+
+		/******************************************************************************
+			Function Name: ExpressionCache
+
+			Des:
+				Creates an empty cache.
+
+			Params:
+				memoryBudget - type size_t, the maximum number of bytes used by the
+					cached equations and their keys, split equally between shards.
+				shardCount - type int, the number of independently locked shards.
+		******************************************************************************/
+		ExpressionCache(size_t memoryBudget, int shardCount = DEFAULT_SHARD_COUNT);
+
+		/******************************************************************************
+			Function Name: getExpression
+
+			Des:
+				Gets the compiled equation, compiling and caching it if it has not
+					been seen before or has been evicted.
+
+			Params:
+				equation - type const char *, the in-fix equation.
+				length - type int, the length of the param equation.
+
+			Returns:
+				type shared_ptr<const CompiledExpression>, the compiled equation.
+
+			Throws:
+				Throws exception if the equation is invalid. Invalid equations are
+					not cached.
+		******************************************************************************/
+		shared_ptr<const CompiledExpression> getExpression(const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: getHits
+
+			Des:
+				Gets the number of lookups that found a cached equation.
+
+			Returns:
+				type size_t, the number of hits.
+		******************************************************************************/
+		size_t getHits() const;
+
+		/******************************************************************************
+			Function Name: getMisses
+
+			Des:
+				Gets the number of lookups that had to compile the equation.
+
+			Returns:
+				type size_t, the number of misses.
+		******************************************************************************/
+		size_t getMisses() const;
+
+		/******************************************************************************
+			Function Name: getEvictions
+
+			Des:
+				Gets the number of equations removed to stay within the budget.
+
+			Returns:
+				type size_t, the number of evictions.
+		******************************************************************************/
+		size_t getEvictions() const;
+
+		/******************************************************************************
+			Function Name: getMemoryUsage
+
+			Des:
+				Gets the estimated number of bytes used by the cached equations.
+
+			Returns:
+				type size_t, the number of bytes.
+		******************************************************************************/
+		size_t getMemoryUsage() const;
+
+		/******************************************************************************
+			Function Name: getMemoryBudget
+
+			Des:
+				Gets the maximum number of bytes the cached equations may use.
+
+			Returns:
+				type size_t, the number of bytes.
+		******************************************************************************/
+		size_t getMemoryBudget() const;
+
+		/******************************************************************************
+			Function Name: getSize
+
+			Des:
+				Gets the number of cached equations.
+
+			Returns:
+				type size_t, the number of equations.
+		******************************************************************************/
+		size_t getSize() const;
+
+	private:
+
+		/******************************************************************************
+			Function Name: normalizeEquation
+
+			Des:
+				Removes whitespace from the equation that does not separate two
+					values or variables, '<', '>' or '!' from a following '=', or
+					a number ending in 'e' from what would make it an exponent.
+
+			Params:
+				equation - type const char *, the in-fix equation.
+				length - type int, the length of the param equation.
+				result - type string &, output to get the equation used as the key.
+		******************************************************************************/
+		void normalizeEquation(const char *equation, int length, string &result) const;
+
+		/******************************************************************************
+			Function Name: getShard
+
+			Des:
+				Finds the shard that holds the key.
+
+			Params:
+				key - type const string &, the normalized equation.
+
+			Returns:
+				type Shard &, the shard of the key.
+		******************************************************************************/
+		Shard &getShard(const string &key) const;
+	};
+}
@@ -0,0 +1,311 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: expressionOptimizer.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for expressionOptimizer.h
+
+	Outline:
+		Public Functions:
+			optimize
+
+		Private Functions:
+			isFoldable
+			isConstant
+			isIntegerPower
+			hasReciprocal
+			isPowerOfTwoModulus
+******************************************************************************/
+
+#include <cmath>
+
+#include "expressionOptimizer.h"
+
+using std::signbit;
+using std::fabs;
+using std::frexp;
+using std::isnormal;
+using std::abs;
+
+namespace day {
+
+	vector<Token> ExpressionOptimizer::optimize(const Token *postFix, int length, vector<double> &values, OptimizationLevel level) const {
+
+		if (postFix == nullptr)
+			throw invalid_argument("Equation is null");
+
+		ReversePolishNotation rpn;
+		vector<Token> result;
+		vector<Operand> operandStack;
+		// Values of the optimized equation, including the ones worked out ahead of time
+		vector<double> foldedValues;
+
+		if (level == OptimizationLevel::NONE)
+			return vector<Token>(postFix, postFix + length);
+
+		result.reserve(length);
+		foldedValues.reserve(values.size());
+
+		for (int i = 0; i < length; i++) {
+
+			Token token = postFix[i];
+			int start = result.size();
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack.push_back({ start, true, values[token.index] });
+					result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+					foldedValues.push_back(values[token.index]);
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack.push_back({ start, true, -1 });
+					result.push_back(token);
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack.push_back({ start, false, 0 });
+					result.push_back(token);
+					break;
+				case Opcode::POWER_INTEGER:
+				case Opcode::SQUARE_ROOT:
+				case Opcode::MODULO_POWER_OF_TWO:
+
+					operandStack.back().constant = false;
+					result.push_back(token);
+					break;
+				case Opcode::NOT: {
+
+					Operand &operand = operandStack.back();
+
+					if (operand.constant) {
+
+						operand.value = rpn.calcOperator(Opcode::NOT, operand.value, 0);
+						result.resize(operand.start);
+						result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+						foldedValues.push_back(operand.value);
+					} else {
+
+						result.push_back(token);
+					}
+
+					break;
+				}
+				case Opcode::NEGATE: {
+
+					Operand &operand = operandStack.back();
+
+					if (operand.constant) {
+
+						// The value is negated ahead of time
+						operand.value = -operand.value;
+						result.resize(operand.start);
+						result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+						foldedValues.push_back(operand.value);
+					} else if (result.back().opcode == Opcode::NEGATE) {
+
+						// Negating twice leaves the operand unchanged
+						result.pop_back();
+					} else {
+
+						result.push_back(token);
+					}
+
+					break;
+				}
+				default: {
+
+					Operand right = operandStack.back();
+					operandStack.pop_back();
+					Operand &left = operandStack.back();
+
+					if (left.constant && right.constant && isFoldable(token.opcode, left.value, right.value)) {
+
+						// The whole operator is worked out ahead of time
+						left.value = rpn.calcOperator(token.opcode, left.value, right.value);
+						result.resize(left.start);
+						result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+						foldedValues.push_back(left.value);
+					} else if (token.opcode == Opcode::MULTIPLY && (isConstant(right, -1) || isConstant(left, -1))) {
+
+						// Multiplying by -1 only flips the sign
+						if (isConstant(right, -1))
+							result.resize(right.start);
+						else
+							result.erase(result.begin() + left.start, result.begin() + right.start);
+
+						if (result.back().opcode == Opcode::NEGATE)
+							result.pop_back();
+						else
+							result.push_back({ Opcode::NEGATE, 0 });
+
+						left.constant = false;
+					} else if ((token.opcode == Opcode::MULTIPLY && isConstant(right, 1))
+						|| (token.opcode == Opcode::DIVIDE && isConstant(right, 1))
+						|| (token.opcode == Opcode::POWER && isConstant(right, 1))
+						|| (token.opcode == Opcode::SUBTRACT && isConstant(right, 0))
+						|| (token.opcode == Opcode::ADD && isConstant(right, -0.0))) {
+
+						// The right operand leaves the left one unchanged
+						result.resize(right.start);
+					} else if ((token.opcode == Opcode::MULTIPLY && isConstant(left, 1))
+						|| (token.opcode == Opcode::ADD && isConstant(left, -0.0))) {
+
+						// The left operand leaves the right one unchanged
+						result.erase(result.begin() + left.start, result.begin() + right.start);
+						left.constant = false;
+					} else if (token.opcode == Opcode::POWER && isConstant(right, 0)) {
+
+						// Any value to the power of 0 is 1, even infinity and NaN
+						left = { left.start, true, 1 };
+						result.resize(left.start);
+						result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+						foldedValues.push_back(1);
+					} else if (token.opcode == Opcode::POWER && right.constant && isIntegerPower(right.value, level)) {
+
+						result.resize(right.start);
+						result.push_back({ Opcode::POWER_INTEGER, (int)right.value });
+						left.constant = false;
+					} else if (token.opcode == Opcode::POWER && level == OptimizationLevel::FAST && isConstant(right, 0.5)) {
+
+						result.resize(right.start);
+						result.push_back({ Opcode::SQUARE_ROOT, 0 });
+						left.constant = false;
+					} else if (token.opcode == Opcode::DIVIDE && right.constant && hasReciprocal(right.value, level)) {
+
+						result.resize(right.start);
+						result.push_back({ Opcode::PUSH_VALUE, (int)foldedValues.size() });
+						result.push_back({ Opcode::MULTIPLY, 0 });
+						foldedValues.push_back(1 / right.value);
+						left.constant = false;
+					} else if (token.opcode == Opcode::MODULO && right.constant && isPowerOfTwoModulus(right.value)) {
+
+						// The sign of the divisor does not change the remainder
+						result.resize(right.start);
+						result.push_back({ Opcode::MODULO_POWER_OF_TWO, abs((int)right.value) });
+						left.constant = false;
+					} else {
+
+						result.push_back(token);
+						left.constant = false;
+					}
+
+					break;
+				}
+			};
+		}
+
+		// Only the values still used by the optimized equation are kept
+		values.clear();
+
+		for (size_t i = 0; i < result.size(); i++) {
+
+			if (result[i].opcode == Opcode::PUSH_VALUE) {
+
+				values.push_back(foldedValues[result[i].index]);
+				result[i].index = values.size() - 1;
+			}
+		}
+
+		return result;
+	}
+
+	bool ExpressionOptimizer::isFoldable(Opcode opcode, double num1, double num2) const {
+
+		bool result;
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+			case Opcode::SUBTRACT:
+			case Opcode::MULTIPLY:
+			case Opcode::DIVIDE:
+			case Opcode::POWER:
+			case Opcode::AND:
+			case Opcode::OR:
+			case Opcode::EQUAL:
+			case Opcode::NOT_EQUAL:
+			case Opcode::LESS:
+			case Opcode::LESS_EQUAL:
+			case Opcode::GREATER:
+			case Opcode::GREATER_EQUAL:
+
+				result = true;
+				break;
+			case Opcode::MODULO:
+
+				// Converting an out of range value to int and dividing by 0 are undefined
+				result = fabs(num1) < 2147483648.0 && fabs(num2) < 2147483648.0 && (int)num2 != 0;
+				break;
+			default:
+
+				result = false;
+				break;
+		};
+
+		return result;
+	}
+
+	bool ExpressionOptimizer::isConstant(const Operand &operand, double value) const {
+
+		return operand.constant && operand.value == value && signbit(operand.value) == signbit(value);
+	}
+	bool ExpressionOptimizer::isIntegerPower(double exponent, OptimizationLevel level) const {
+
+		bool result;
+
+		// x*x and 1/x round exactly like pow, longer chains of multiplications do not
+		if (level == OptimizationLevel::FAST)
+			result = fabs(exponent) <= MAX_INTEGER_POWER && exponent == (int)exponent;
+		else
+			result = exponent == 2 || exponent == -1;
+
+		return result;
+	}
+
+	bool ExpressionOptimizer::hasReciprocal(double divisor, OptimizationLevel level) const {
+
+		int exponent;
+		bool result = isnormal(divisor) && isnormal(1 / divisor);
+
+		// Only the reciprocal of a power of two is exact
+		if (level != OptimizationLevel::FAST)
+			result = result && fabs(frexp(divisor, &exponent)) == 0.5;
+
+		return result;
+	}
+
+	bool ExpressionOptimizer::isPowerOfTwoModulus(double divisor) const {
+
+		bool result = false;
+
+		// Converting an out of range value to int is undefined
+		if (fabs(divisor) < 2147483648.0) {
+
+			int modulus = abs((int)divisor);
+
+			result = modulus != 0 && (modulus & (modulus - 1)) == 0;
+		}
+
+		return result;
+	}
+}
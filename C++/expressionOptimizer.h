@@ -0,0 +1,205 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: expressionOptimizer.h
+
+	Author: Matthew Day
+
+	Class Name: ExpressionOptimizer
+
+	Description:
+		Rewrites a validated post-fix equation into a shorter one that gives the
+		same answer. Parts of the equation that only use values, including
+		comparisons, are worked out ahead of time, multiplying by -1 becomes NEGATE and operators that leave
+		their operand unchanged, such as x*1, are removed.
+
+		Operators with a value as their second operand are also replaced by
+		cheaper ones. x^2 and x^-1 become POWER_INTEGER, x^0 becomes 1, dividing
+		by a power of two becomes multiplying by its reciprocal and '%' by a
+		power of two becomes MODULO_POWER_OF_TWO, which needs no divide.
+
+		At OptimizationLevel::EXACT only rewrites that give a bit-for-bit
+		identical answer for every input, including -0, infinity and NaN, are
+		made. x+0 is kept since -0+0 is +0, while x-0 and x+(-0) are removed.
+		'%' is not folded when the result would depend on an out of range
+		conversion to int or a divide by 0. OptimizationLevel::FAST also turns
+		every integer power up to MAX_INTEGER_POWER into multiplications, x^0.5
+		into a square root and dividing by any value into multiplying by its
+		reciprocal, which may change the last bits of the answer.
+
+	Outline:
+		Public Functions:
+			optimize
+
+		Private Functions:
+			isFoldable
+			isConstant
+			isIntegerPower
+			hasReciprocal
+			isPowerOfTwoModulus
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include "reversePolishNotation.h"
+
+using std::vector;
+using std::invalid_argument;
+
+namespace day {
+
+	// How far ExpressionOptimizer may go when rewriting an equation
+	enum class OptimizationLevel {
+
+		// The equation is left as written
+		NONE,
+		// Only rewrites that give the identical answer for every input
+		EXACT,
+		// Also rewrites that may round differently, or differ for -0 and -infinity
+		// in the case of x^0.5
+		FAST
+	};
+
+	class ExpressionOptimizer {
+
+	private:
+
+		// An operand on the stack used to walk the equation
+		struct Operand {
+
+			// Position of the first token of the operand in the optimized equation
+			int start;
+			// True if the operand only depends on values
+			bool constant;
+			// Value of the operand when param constant is true
+			double value;
+		};
+	public:
+
+		// Largest power turned into multiplications at OptimizationLevel::FAST
+		static const int MAX_INTEGER_POWER = 64;
+
+		/******************************************************************************
+			Function Name: optimize
+
+			Des:
+				Rewrites the equation into a shorter one with the same answer.
+
+			Params:
+				postFix - type const Token *, the equation in post-fix notation,
+					already checked by validatePostFix.
+				length - type int, the length of the param postFix.
+				values - type vector<double> &, the values corresponding to the
+					PUSH_VALUE tokens in param postFix. Replaced by the values of
+					the optimized equation.
+				level - type OptimizationLevel, which rewrites are allowed.
+
+			Returns:
+				type vector<Token>, the optimized equation in post-fix notation.
+
+			Throws:
+				Throws exception if param postFix is null.
+		******************************************************************************/
+		vector<Token> optimize(const Token *postFix, int length, vector<double> &values, OptimizationLevel level) const;
+	private:
+
+		/******************************************************************************
+			Function Name: isFoldable
+
+			Des:
+				Checks if an operator can be applied to two values ahead of time
+					with the same answer as when it is evaluated.
+
+			Params:
+				opcode - type Opcode, the operator.
+				num1 - type double, the first operand.
+				num2 - type double, the second operand.
+
+			Returns:
+				type bool, true if the operator can be applied ahead of time.
+		******************************************************************************/
+		bool isFoldable(Opcode opcode, double num1, double num2) const;
+
+		/******************************************************************************
+			Function Name: isConstant
+
+			Des:
+				Checks if an operand is a value with exactly the given bits, so 0 and
+					-0 are told apart.
+
+			Params:
+				operand - type const Operand &, the operand.
+				value - type double, the value to compare with.
+
+			Returns:
+				type bool, true if the operand is the given value.
+		******************************************************************************/
+		bool isConstant(const Operand &operand, double value) const;
+
+		/******************************************************************************
+			Function Name: isIntegerPower
+
+			Des:
+				Checks if raising to the power of a value can be done with
+					POWER_INTEGER.
+
+			Params:
+				exponent - type double, the power.
+				level - type OptimizationLevel, which rewrites are allowed.
+
+			Returns:
+				type bool, true if the power can be done with POWER_INTEGER.
+		******************************************************************************/
+		bool isIntegerPower(double exponent, OptimizationLevel level) const;
+
+		/******************************************************************************
+			Function Name: hasReciprocal
+
+			Des:
+				Checks if dividing by a value can be done by multiplying by its
+					reciprocal. At OptimizationLevel::EXACT the reciprocal must be
+					exact, so the value must be a power of two.
+
+			Params:
+				divisor - type double, the value being divided by.
+				level - type OptimizationLevel, which rewrites are allowed.
+
+			Returns:
+				type bool, true if the reciprocal can be used.
+		******************************************************************************/
+		bool hasReciprocal(double divisor, OptimizationLevel level) const;
+
+		/******************************************************************************
+			Function Name: isPowerOfTwoModulus
+
+			Des:
+				Checks if '%' by a value can be done with MODULO_POWER_OF_TWO, which
+					is the case when the value converted to int is plus or minus a
+					power of two.
+
+			Params:
+				divisor - type double, the second operand of '%'.
+
+			Returns:
+				type bool, true if MODULO_POWER_OF_TWO can be used.
+		******************************************************************************/
+		bool isPowerOfTwoModulus(double divisor) const;
+	};
+}
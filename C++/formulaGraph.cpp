@@ -0,0 +1,321 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: formulaGraph.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for formulaGraph.h
+
+	Outline:
+		Public Functions:
+			FormulaGraph
+			addFormula
+			setInput
+			recalculate
+			getValue
+			getFormulaCount
+
+		Private Functions:
+			getOrAddNode
+			dependsOn
+			raiseLevels
+			markDependents
+			evaluateFormula
+******************************************************************************/
+
+#include "formulaGraph.h"
+
+namespace day {
+
+	FormulaGraph::FormulaGraph(ThreadPool &pool) : pool(pool), threadValues(pool.getThreadCount()), epoch(0), searches(0), formulaCount(0) {
+	}
+
+	void FormulaGraph::addFormula(const string &name, const char *equation, int length) {
+
+		auto found = indexes.find(name);
+
+		if (found != indexes.end() && nodes[found->second].expression != nullptr)
+			throw invalid_argument("Formula " + name + " is already defined");
+
+		unique_ptr<CompiledExpression> expression(new CompiledExpression(equation, length));
+		const vector<string> &variables = expression->getVariableNames();
+
+		// Only a name that other formulas already use can be part of a cycle, so a new one needs no search
+		if (found != indexes.end()) {
+
+			for (const string &variable : variables) {
+
+				auto dependency = indexes.find(variable);
+
+				if (dependency != indexes.end() && dependsOn(dependency->second, found->second))
+					throw invalid_argument("Formula " + name + " depends on itself");
+			}
+		} else {
+
+			for (const string &variable : variables)
+				if (variable == name)
+					throw invalid_argument("Formula " + name + " depends on itself");
+		}
+
+		int index = getOrAddNode(name);
+		int level = 0;
+		vector<int> dependencies;
+
+		dependencies.reserve(variables.size());
+
+		for (const string &variable : variables) {
+
+			int dependency = getOrAddNode(variable);
+
+			dependencies.push_back(dependency);
+			nodes[dependency].dependents.push_back(index);
+
+			if (nodes[dependency].level > level)
+				level = nodes[dependency].level;
+		}
+
+		Node &node = nodes[index];
+
+		node.expression = std::move(expression);
+		node.dependencies = std::move(dependencies);
+		node.level = level + 1;
+		node.isNew = true;
+		newFormulas.push_back(index);
+		formulaCount++;
+
+		if ((size_t)node.level >= levels.size())
+			levels.resize(node.level + 1);
+
+		raiseLevels(index);
+	}
+
+	void FormulaGraph::setInput(const string &name, double value) {
+
+		int index = getOrAddNode(name);
+
+		if (nodes[index].expression != nullptr)
+			throw invalid_argument("Formula " + name + " cannot be set as an input");
+
+		// Compares the bits so setting NaN again is not a change
+		if (memcmp(&values[index], &value, sizeof(double)) == 0)
+			return;
+
+		values[index] = value;
+		changedInputs.push_back(index);
+	}
+
+	size_t FormulaGraph::recalculate() {
+
+		atomic<size_t> evaluated(0);
+
+		epoch++;
+
+		for (int input : changedInputs) {
+
+			changedEpochs[input] = epoch;
+			markDependents(input);
+		}
+
+		for (int formula : newFormulas) {
+
+			if (nodes[formula].markedEpoch != epoch) {
+
+				nodes[formula].markedEpoch = epoch;
+				levels[nodes[formula].level].push_back(formula);
+			}
+
+			markDependents(formula);
+		}
+
+		changedInputs.clear();
+		newFormulas.clear();
+
+		// Every dependency of a formula is on a lower level, so it is final before the level is started
+		for (size_t level = 1; level < levels.size(); level++) {
+
+			vector<int> &formulas = levels[level];
+
+			// Marking adds them in the order the dependents were found, sorting walks the nodes and values in memory order
+			sort(formulas.begin(), formulas.end());
+
+			if (formulas.size() < (size_t)PARALLEL_FORMULAS) {
+
+				for (int formula : formulas)
+					if (evaluateFormula(formula, 0))
+						evaluated++;
+			} else {
+
+				pool.parallelFor(formulas.size(), [&](size_t i, int threadIndex) {
+
+					if (evaluateFormula(formulas[i], threadIndex))
+						evaluated++;
+				});
+			}
+
+			formulas.clear();
+		}
+
+		return evaluated;
+	}
+
+	double FormulaGraph::getValue(const string &name) const {
+
+		auto found = indexes.find(name);
+
+		if (found == indexes.end())
+			throw invalid_argument("No formula or input is named " + name);
+
+		return values[found->second];
+	}
+
+	int FormulaGraph::getFormulaCount() const {
+
+		return formulaCount;
+	}
+
+	int FormulaGraph::getOrAddNode(const string &name) {
+
+		auto found = indexes.find(name);
+
+		if (found != indexes.end())
+			return found->second;
+
+		Node node;
+
+		node.name = name;
+		node.level = 0;
+		node.markedEpoch = 0;
+		node.searchedEpoch = 0;
+		node.isNew = false;
+
+		nodes.push_back(std::move(node));
+		values.push_back(0);
+		changedEpochs.push_back(0);
+		indexes.emplace(name, (int)nodes.size() - 1);
+
+		return (int)nodes.size() - 1;
+	}
+
+	bool FormulaGraph::dependsOn(int node, int target) {
+
+		vector<int> pending{ node };
+		bool found = false;
+
+		searches++;
+
+		while (!pending.empty() && !found) {
+
+			int current = pending.back();
+
+			pending.pop_back();
+
+			if (current == target) {
+
+				found = true;
+			} else if (nodes[current].searchedEpoch != searches) {
+
+				nodes[current].searchedEpoch = searches;
+
+				for (int dependency : nodes[current].dependencies)
+					pending.push_back(dependency);
+			}
+		}
+
+		return found;
+	}
+
+	void FormulaGraph::raiseLevels(int node) {
+
+		vector<int> pending{ node };
+
+		while (!pending.empty()) {
+
+			int current = pending.back();
+			int level = nodes[current].level + 1;
+
+			pending.pop_back();
+
+			for (int dependent : nodes[current].dependents) {
+
+				if (nodes[dependent].level < level) {
+
+					nodes[dependent].level = level;
+					pending.push_back(dependent);
+
+					if ((size_t)level >= levels.size())
+						levels.resize(level + 1);
+				}
+			}
+		}
+	}
+
+	void FormulaGraph::markDependents(int node) {
+
+		vector<int> pending{ node };
+
+		while (!pending.empty()) {
+
+			int current = pending.back();
+
+			pending.pop_back();
+
+			for (int dependent : nodes[current].dependents) {
+
+				if (nodes[dependent].markedEpoch != epoch) {
+
+					nodes[dependent].markedEpoch = epoch;
+					levels[nodes[dependent].level].push_back(dependent);
+					pending.push_back(dependent);
+				}
+			}
+		}
+	}
+
+	bool FormulaGraph::evaluateFormula(int node, int threadIndex) {
+
+		Node &formula = nodes[node];
+		vector<double> &arguments = threadValues[threadIndex];
+		bool changed = formula.isNew;
+
+		for (int dependency : formula.dependencies)
+			if (changedEpochs[dependency] == epoch)
+				changed = true;
+
+		if (!changed)
+			return false;
+
+		arguments.resize(formula.dependencies.size());
+
+		for (size_t i = 0; i < formula.dependencies.size(); i++)
+			arguments[i] = values[formula.dependencies[i]];
+
+		double value = formula.expression->evaluate(arguments);
+
+		// Only this task writes the formula, and the formulas that read it are on a later level
+		if (formula.isNew || memcmp(&values[node], &value, sizeof(double)) != 0) {
+
+			values[node] = value;
+			changedEpochs[node] = epoch;
+		}
+
+		formula.isNew = false;
+
+		return true;
+	}
+}
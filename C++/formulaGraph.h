@@ -0,0 +1,303 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: formulaGraph.h
+
+	Author: Matthew Day
+
+	Class Name: FormulaGraph
+
+	Description:
+		A set of named formulas that refer to each other and to named inputs,
+		like the cells of a spreadsheet. Each formula is a CompiledExpression
+		whose variables are the names of other formulas or inputs. A name that
+		is not a formula is an input, which is 0 until it is set.
+
+		recalculate only evaluates the formulas that depend on an input that
+		was set since the last call, in topological order. Each formula is
+		kept at a level one above the highest of its dependencies, so the
+		formulas of a level never depend on each other and are evaluated in
+		parallel on the threads of a ThreadPool. A formula is skipped when none
+		of its dependencies changed value, so setting an input to the value it
+		already has, or a change that a formula such as x > 5 absorbs, stops
+		there.
+
+		A formula that would depend on itself is rejected when it is added,
+		and the graph is left unchanged. Formulas may be added in any order, a
+		name used before it is added is an input until then.
+
+		A FormulaGraph must not be used by two threads at the same time.
+
+	Outline:
+		Public Functions:
+			FormulaGraph
+			addFormula
+			setInput
+			recalculate
+			getValue
+			getFormulaCount
+
+		Private Functions:
+			getOrAddNode
+			dependsOn
+			raiseLevels
+			markDependents
+			evaluateFormula
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstring>
+
+#include "compiledExpression.h"
+#include "threadPool.h"
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+using std::atomic;
+using std::unordered_map;
+using std::invalid_argument;
+using std::size_t;
+using std::memcmp;
+using std::sort;
+
+namespace day {
+
+	class FormulaGraph {
+
+	public:
+
+		// Levels with fewer formulas than this are evaluated on the calling thread, where starting the pool costs more
+		static const int PARALLEL_FORMULAS = 64;
+	private:
+
+		struct Node {
+
+			string name;
+			// The formula, or nullptr for an input
+			unique_ptr<CompiledExpression> expression;
+			// Node bound to each variable slot of the formula
+			vector<int> dependencies;
+			// Formulas that use this node
+			vector<int> dependents;
+			// 0 for inputs, otherwise one above the highest dependency
+			int level;
+			// Recalculation in which the node was last marked to be checked
+			size_t markedEpoch;
+			// Cycle search in which the node was last visited
+			size_t searchedEpoch;
+			// Added since the last recalculation, so it is evaluated even if no dependency changed
+			bool isNew;
+		};
+
+		ThreadPool &pool;
+		vector<Node> nodes;
+		// Value of each node and the recalculation in which it last changed, kept apart from the nodes so evaluating reads them from few cache lines
+		vector<double> values;
+		vector<size_t> changedEpochs;
+		unordered_map<string, int> indexes;
+		// Inputs set since the last recalculation
+		vector<int> changedInputs;
+		// Formulas added since the last recalculation
+		vector<int> newFormulas;
+		// Formulas marked by the current recalculation, one list for each level
+		vector<vector<int>> levels;
+		// Values of the variables of a formula, one vector for each thread of the pool
+		vector<vector<double>> threadValues;
+		// Number of recalculations so far, used to mark nodes without clearing the marks
+		size_t epoch;
+		// Number of cycle searches so far, used the same way
+		size_t searches;
+		int formulaCount;
+	public:
+
+		/******************************************************************************
+			Function Name: FormulaGraph
+
+			Des:
+				Creates an empty graph that recalculates on the threads of the pool.
+
+			Params:
+				pool - type ThreadPool &, the threads to run on. Must outlive the
+					graph.
+		******************************************************************************/
+		FormulaGraph(ThreadPool &pool);
+
+		/******************************************************************************
+			Function Name: addFormula
+
+			Des:
+				Adds a named formula. It is evaluated by the next recalculate.
+
+			Params:
+				name - type const string &, the name other formulas use for it. May
+					be a name already used as an input.
+				equation - type const char *, the in-fix equation of the formula,
+					whose variables are names of formulas or inputs. Example input:
+					(high-low)/close.
+				length - type int, the length of the param equation.
+
+			Throws:
+				Throws exception if the equation is invalid, the name is already a
+					formula or the formula would depend on itself.
+		******************************************************************************/
+		void addFormula(const string &name, const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: setInput
+
+			Des:
+				Sets the value of an input. The formulas that depend on it are
+					evaluated by the next recalculate.
+
+			Params:
+				name - type const string &, the name of the input.
+				value - type double, the new value.
+
+			Throws:
+				Throws exception if the name is a formula.
+		******************************************************************************/
+		void setInput(const string &name, double value);
+
+		/******************************************************************************
+			Function Name: recalculate
+
+			Des:
+				Evaluates the formulas that were added or depend on an input that was
+					set since the last call, skipping each one whose dependencies all
+					kept their value.
+
+			Returns:
+				type size_t, the number of formulas evaluated.
+		******************************************************************************/
+		size_t recalculate();
+
+		/******************************************************************************
+			Function Name: getValue
+
+			Des:
+				Gets the value of a formula as of the last recalculate, or the value
+					of an input.
+
+			Params:
+				name - type const string &, the name of the formula or input.
+
+			Returns:
+				type double, the value.
+
+			Throws:
+				Throws exception if the name is not used by the graph.
+		******************************************************************************/
+		double getValue(const string &name) const;
+
+		/******************************************************************************
+			Function Name: getFormulaCount
+
+			Des:
+				Gets the number of formulas in the graph.
+
+			Returns:
+				type int, the number of formulas.
+		******************************************************************************/
+		int getFormulaCount() const;
+
+	private:
+
+		/******************************************************************************
+			Function Name: getOrAddNode
+
+			Des:
+				Finds the node of a name, adding an input for it if it is new.
+
+			Params:
+				name - type const string &, the name of the node.
+
+			Returns:
+				type int, the index of the node.
+		******************************************************************************/
+		int getOrAddNode(const string &name);
+
+		/******************************************************************************
+			Function Name: dependsOn
+
+			Des:
+				Checks if a node uses another one, directly or through other
+					formulas.
+
+			Params:
+				node - type int, the node whose dependencies are followed.
+				target - type int, the node being looked for.
+
+			Returns:
+				type bool, true if param node is param target or depends on it,
+					otherwise false.
+		******************************************************************************/
+		bool dependsOn(int node, int target);
+
+		/******************************************************************************
+			Function Name: raiseLevels
+
+			Des:
+				Moves the dependents of a node to a higher level where needed, after
+					the level of the node went up.
+
+			Params:
+				node - type int, the node whose level went up.
+		******************************************************************************/
+		void raiseLevels(int node);
+
+		/******************************************************************************
+			Function Name: markDependents
+
+			Des:
+				Adds every formula that depends on the node, directly or through
+					other formulas, to the list of its level. Each formula is only
+					added once per recalculation.
+
+			Params:
+				node - type int, the node that was set or added.
+		******************************************************************************/
+		void markDependents(int node);
+
+		/******************************************************************************
+			Function Name: evaluateFormula
+
+			Des:
+				Evaluates a marked formula if it is new or one of its dependencies
+					changed value.
+
+			Params:
+				node - type int, the formula to be evaluated.
+				threadIndex - type int, the thread evaluating it, used to pick the
+					vector of values.
+
+			Returns:
+				type bool, true if the formula was evaluated, false if it was
+					skipped.
+		******************************************************************************/
+		bool evaluateFormula(int node, int threadIndex);
+	};
+}
@@ -0,0 +1,514 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: jitExpression.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for jitExpression.h
+
+		Register use of the emitted functions:
+			rbx         variables, or the columns of the batch function
+			r12         constants
+			r13         current row of the batch function
+			r14, r15    output and number of rows of the batch function
+			xmm0-xmm14  the operand stack, xmm0 holds the answer
+			xmm15       scratch
+		rbx and r12 to r15 are saved by pow, and the spill area on the stack
+		keeps xmm registers alive across the call.
+
+	Outline:
+		Public Functions:
+			JitExpression
+			~JitExpression
+			evaluate
+			evaluate
+			evaluate
+			isCompiled
+			getFunction
+			getBatchFunction
+			isAvailable
+
+		Private Functions:
+			emitProgram
+******************************************************************************/
+
+#include "jitExpression.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define DAY_JIT_AVAILABLE
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using std::memcpy;
+using std::uint64_t;
+using std::int32_t;
+
+namespace day {
+
+	// Numbers of the general purpose registers used by the emitted code
+	enum GeneralRegister { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RSI = 6, RDI = 7, R12 = 12, R13 = 13, R14 = 14, R15 = 15 };
+
+	// Scratch xmm register, the others hold the operand stack
+	static const int XMM_SCRATCH = 15;
+	// Bytes of stack used to keep the operand stack alive across a call to pow
+	static const int SPILL_SIZE = 128;
+
+	static void emitInt32(vector<unsigned char> &code, int32_t value) {
+
+		unsigned char bytes[4];
+
+		memcpy(bytes, &value, 4);
+		code.insert(code.end(), bytes, bytes + 4);
+	}
+
+	static void emitInt64(vector<unsigned char> &code, uint64_t value) {
+
+		unsigned char bytes[8];
+
+		memcpy(bytes, &value, 8);
+		code.insert(code.end(), bytes, bytes + 8);
+	}
+
+	// prefix [REX] 0F opcode with both operands in registers, used for SSE2 and conversions
+	static void emitRegister(vector<unsigned char> &code, unsigned char prefix, unsigned char opcode, int reg, int rm) {
+
+		code.push_back(prefix);
+
+		if (reg >= 8 || rm >= 8)
+			code.push_back(0x40 | (reg >= 8) << 2 | (rm >= 8));
+
+		code.push_back(0x0F);
+		code.push_back(opcode);
+		code.push_back(0xC0 | (reg & 7) << 3 | (rm & 7));
+	}
+
+	// prefix [REX] 0F opcode with the memory operand [base + displacement]
+	static void emitMemory(vector<unsigned char> &code, unsigned char prefix, unsigned char opcode, int reg, int base, int displacement) {
+
+		code.push_back(prefix);
+
+		if (reg >= 8 || base >= 8)
+			code.push_back(0x40 | (reg >= 8) << 2 | (base >= 8));
+
+		code.push_back(0x0F);
+		code.push_back(opcode);
+		code.push_back(0x80 | (reg & 7) << 3 | (base & 7));
+
+		// rsp and r12 can only be used as a base through a SIB byte
+		if ((base & 7) == RSP)
+			code.push_back(0x24);
+
+		emitInt32(code, displacement);
+	}
+
+	// prefix [REX] 0F opcode with the memory operand [base + index * 8], base must not be rbp or r13
+	static void emitIndexed(vector<unsigned char> &code, unsigned char prefix, unsigned char opcode, int reg, int base, int index) {
+
+		code.push_back(prefix);
+
+		if (reg >= 8 || base >= 8 || index >= 8)
+			code.push_back(0x40 | (reg >= 8) << 2 | (index >= 8) << 1 | (base >= 8));
+
+		code.push_back(0x0F);
+		code.push_back(opcode);
+		code.push_back(0x04 | (reg & 7) << 3);
+		code.push_back(0xC0 | (index & 7) << 3 | (base & 7));
+	}
+
+	// mov destination, [base + displacement] on 64 bit registers
+	static void emitLoadPointer(vector<unsigned char> &code, int destination, int base, int displacement) {
+
+		code.push_back(0x48 | (destination >= 8) << 2 | (base >= 8));
+		code.push_back(0x8B);
+		code.push_back(0x80 | (destination & 7) << 3 | (base & 7));
+
+		if ((base & 7) == RSP)
+			code.push_back(0x24);
+
+		emitInt32(code, displacement);
+	}
+
+	// mov destination, source on 64 bit registers
+	static void emitMove(vector<unsigned char> &code, int destination, int source) {
+
+		code.push_back(0x48 | (source >= 8) << 2 | (destination >= 8));
+		code.push_back(0x89);
+		code.push_back(0xC0 | (source & 7) << 3 | (destination & 7));
+	}
+
+	// mov destination, value on a 64 bit register
+	static void emitMoveImmediate(vector<unsigned char> &code, int destination, uint64_t value) {
+
+		code.push_back(0x48 | (destination >= 8));
+		code.push_back(0xB8 + (destination & 7));
+		emitInt64(code, value);
+	}
+
+	static void emitPush(vector<unsigned char> &code, int source) {
+
+		if (source >= 8)
+			code.push_back(0x41);
+
+		code.push_back(0x50 + (source & 7));
+	}
+
+	static void emitPop(vector<unsigned char> &code, int destination) {
+
+		if (destination >= 8)
+			code.push_back(0x41);
+
+		code.push_back(0x58 + (destination & 7));
+	}
+
+	// Opcodes of the SSE2 instructions used, all take the prefix 0xF2 except movapd and xorpd which take 0x66
+	static const unsigned char MOVSD_LOAD = 0x10, MOVSD_STORE = 0x11, MOVAPD = 0x28, SQRTSD = 0x51, ADDSD = 0x58, MULSD = 0x59;
+	static const unsigned char SUBSD = 0x5C, DIVSD = 0x5E, XORPD = 0x57, CVTSI2SD = 0x2A, CVTTSD2SI = 0x2C;
+
+	JitExpression::JitExpression(const CompiledExpression &expression, bool enabled) : fallback(expression) {
+
+		vector<unsigned char> program;
+		size_t batchStart;
+
+		constants = expression.getValues();
+		constants.push_back(-1);
+		constants.push_back(1);
+		constants.push_back(-0.0);
+		variableCount = expression.getVariableCount();
+		code = nullptr;
+		codeSize = 0;
+		function = nullptr;
+		batchFunction = nullptr;
+
+		if (!enabled || !isAvailable() || expression.getMaxStackDepth() > MAX_JIT_STACK_DEPTH)
+			return;
+
+		if (!emitProgram(expression.getPostFix(), false, program))
+			return;
+
+		batchStart = program.size();
+
+		if (!emitProgram(expression.getPostFix(), true, program))
+			return;
+
+#ifdef DAY_JIT_AVAILABLE
+		size_t pageSize = sysconf(_SC_PAGESIZE);
+
+		codeSize = (program.size() + pageSize - 1) / pageSize * pageSize;
+
+		// The memory is never writable and executable at the same time
+		void *memory = mmap(nullptr, codeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (memory == MAP_FAILED)
+			return;
+
+		memcpy(memory, program.data(), program.size());
+
+		if (mprotect(memory, codeSize, PROT_READ | PROT_EXEC) != 0) {
+
+			munmap(memory, codeSize);
+			return;
+		}
+
+		code = memory;
+		function = reinterpret_cast<Function>(static_cast<unsigned char *>(code));
+		batchFunction = reinterpret_cast<BatchFunction>(static_cast<unsigned char *>(code) + batchStart);
+#endif
+	}
+
+	JitExpression::~JitExpression() {
+
+#ifdef DAY_JIT_AVAILABLE
+		if (code != nullptr)
+			munmap(code, codeSize);
+#endif
+	}
+
+	double JitExpression::evaluate(const vector<double> &variableValues) const {
+
+		if (variableValues.size() < (size_t)variableCount)
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		return evaluate(variableValues.data());
+	}
+
+	double JitExpression::evaluate(const double *variableValues) const {
+
+		double result;
+
+		if (function != nullptr)
+			result = function(variableValues);
+		else
+			result = fallback.evaluate(variableValues);
+
+		return result;
+	}
+
+	void JitExpression::evaluate(const double *const *columns, double *output, size_t rows) const {
+
+		if (batchFunction != nullptr) {
+
+			batchFunction(columns, output, rows);
+		} else {
+
+			vector<double> variableValues(variableCount);
+
+			for (size_t i = 0; i < rows; i++) {
+
+				for (int j = 0; j < variableCount; j++)
+					variableValues[j] = columns[j][i];
+
+				output[i] = fallback.evaluate(variableValues.data());
+			}
+		}
+	}
+
+	bool JitExpression::isCompiled() const {
+
+		return function != nullptr;
+	}
+
+	JitExpression::Function JitExpression::getFunction() const {
+
+		return function;
+	}
+
+	JitExpression::BatchFunction JitExpression::getBatchFunction() const {
+
+		return batchFunction;
+	}
+
+	bool JitExpression::isAvailable() {
+
+#ifdef DAY_JIT_AVAILABLE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool JitExpression::emitProgram(const vector<Token> &postFix, bool batch, vector<unsigned char> &result) const {
+
+		const int NEGATIVE_ONE = constants.size() - 3, ONE = constants.size() - 2, NEGATIVE_ZERO = constants.size() - 1;
+		// Number of operands on the stack, the top operand is in xmm(depth - 1)
+		int depth = 0;
+		// Location of the jump out of the loop of the batch function, patched once the loop ends
+		size_t exitJump = 0, loopStart = 0;
+		bool supported = true;
+
+		// Saves the registers the System V convention requires, 5 pushes and the spill area keep rsp 16 byte aligned for calls
+		emitPush(result, RBX);
+		emitPush(result, R12);
+		emitPush(result, R13);
+		emitPush(result, R14);
+		emitPush(result, R15);
+		result.insert(result.end(), { 0x48, 0x81, 0xEC });
+		emitInt32(result, SPILL_SIZE);
+
+		emitMove(result, RBX, RDI);
+		emitMoveImmediate(result, R12, (uint64_t)constants.data());
+
+		if (batch) {
+
+			emitMove(result, R14, RSI);
+			emitMove(result, R15, RDX);
+			// xor r13d, r13d
+			result.insert(result.end(), { 0x45, 0x31, 0xED });
+
+			loopStart = result.size();
+
+			// cmp r13, r15 then jae to the end of the loop
+			result.insert(result.end(), { 0x4D, 0x39, 0xFD, 0x0F, 0x83 });
+			exitJump = result.size();
+			emitInt32(result, 0);
+		}
+
+		for (size_t i = 0; i < postFix.size() && supported; i++) {
+
+			const Token &token = postFix[i];
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					emitMemory(result, 0xF2, MOVSD_LOAD, depth++, R12, token.index * 8);
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					emitMemory(result, 0xF2, MOVSD_LOAD, depth++, R12, NEGATIVE_ONE * 8);
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					if (batch) {
+
+						// rax = columns[index], then xmm = rax[row]
+						emitLoadPointer(result, RAX, RBX, token.index * 8);
+						emitIndexed(result, 0xF2, MOVSD_LOAD, depth++, RAX, R13);
+					} else {
+
+						emitMemory(result, 0xF2, MOVSD_LOAD, depth++, RBX, token.index * 8);
+					}
+
+					break;
+				case Opcode::ADD:
+
+					depth--;
+					emitRegister(result, 0xF2, ADDSD, depth - 1, depth);
+					break;
+				case Opcode::SUBTRACT:
+
+					depth--;
+					emitRegister(result, 0xF2, SUBSD, depth - 1, depth);
+					break;
+				case Opcode::MULTIPLY:
+
+					depth--;
+					emitRegister(result, 0xF2, MULSD, depth - 1, depth);
+					break;
+				case Opcode::DIVIDE:
+
+					// Handling divide by 0 exception is out of scope
+					depth--;
+					emitRegister(result, 0xF2, DIVSD, depth - 1, depth);
+					break;
+				case Opcode::MODULO:
+
+					// cvttsd2si truncates like (int), then eax / ecx leaves the remainder in edx
+					// Handling divide by 0 exception is out of scope
+					depth--;
+					emitRegister(result, 0xF2, CVTTSD2SI, RAX, depth - 1);
+					emitRegister(result, 0xF2, CVTTSD2SI, RCX, depth);
+					// cdq, idiv ecx
+					result.insert(result.end(), { 0x99, 0xF7, 0xF9 });
+					emitRegister(result, 0xF2, CVTSI2SD, depth - 1, RDX);
+					break;
+				case Opcode::MODULO_POWER_OF_TWO:
+
+					// Same mask and bias as calcValidatedResult
+					emitRegister(result, 0xF2, CVTTSD2SI, RAX, depth - 1);
+					// mov ecx, eax; sar ecx, 31; and ecx, mask
+					result.insert(result.end(), { 0x89, 0xC1, 0xC1, 0xF9, 0x1F, 0x81, 0xE1 });
+					emitInt32(result, token.index - 1);
+					// add eax, ecx; and eax, mask
+					result.insert(result.end(), { 0x01, 0xC8, 0x25 });
+					emitInt32(result, token.index - 1);
+					// sub eax, ecx
+					result.insert(result.end(), { 0x29, 0xC8 });
+					emitRegister(result, 0xF2, CVTSI2SD, depth - 1, RAX);
+					break;
+				case Opcode::NEGATE:
+
+					// Flips the sign bit like unary minus
+					emitMemory(result, 0xF2, MOVSD_LOAD, XMM_SCRATCH, R12, NEGATIVE_ZERO * 8);
+					emitRegister(result, 0x66, XORPD, depth - 1, XMM_SCRATCH);
+					break;
+				case Opcode::SQUARE_ROOT:
+
+					emitRegister(result, 0xF2, SQRTSD, depth - 1, depth - 1);
+					break;
+				case Opcode::POWER_INTEGER: {
+
+					// The multiplications are unrolled in the same order as calcOperator
+					unsigned int exponent = token.index < 0 ? 0u - (unsigned int)token.index : (unsigned int)token.index;
+
+					emitMemory(result, 0xF2, MOVSD_LOAD, XMM_SCRATCH, R12, ONE * 8);
+
+					for (; exponent != 0; exponent >>= 1) {
+
+						if (exponent & 1)
+							emitRegister(result, 0xF2, MULSD, XMM_SCRATCH, depth - 1);
+
+						if (exponent > 1)
+							emitRegister(result, 0xF2, MULSD, depth - 1, depth - 1);
+					}
+
+					if (token.index < 0) {
+
+						emitMemory(result, 0xF2, MOVSD_LOAD, depth - 1, R12, ONE * 8);
+						emitRegister(result, 0xF2, DIVSD, depth - 1, XMM_SCRATCH);
+					} else {
+
+						emitRegister(result, 0x66, MOVAPD, depth - 1, XMM_SCRATCH);
+					}
+
+					break;
+				}
+				case Opcode::POWER: {
+
+					depth--;
+
+					int left = depth - 1;
+					double (*function)(double, double) = pow;
+
+					// Every xmm register is lost across a call, so the operands below the two being used are spilled
+					for (int j = 0; j < left; j++)
+						emitMemory(result, 0xF2, MOVSD_STORE, j, RSP, j * 8);
+
+					if (left != 0) {
+
+						emitRegister(result, 0x66, MOVAPD, 0, left);
+						emitRegister(result, 0x66, MOVAPD, 1, left + 1);
+					}
+
+					// mov rax, pow; call rax
+					emitMoveImmediate(result, RAX, (uint64_t)function);
+					result.insert(result.end(), { 0xFF, 0xD0 });
+
+					if (left != 0)
+						emitRegister(result, 0x66, MOVAPD, left, 0);
+
+					for (int j = 0; j < left; j++)
+						emitMemory(result, 0xF2, MOVSD_LOAD, j, RSP, j * 8);
+
+					break;
+				}
+				default:
+
+					supported = false;
+			};
+		}
+
+		if (batch) {
+
+			// movsd [r14 + r13 * 8], xmm0; inc r13; jmp to the start of the loop
+			emitIndexed(result, 0xF2, MOVSD_STORE, 0, R14, R13);
+			result.insert(result.end(), { 0x49, 0xFF, 0xC5, 0xE9 });
+			emitInt32(result, (int32_t)(loopStart - (result.size() + 4)));
+
+			int32_t exitOffset = result.size() - (exitJump + 4);
+
+			memcpy(&result[exitJump], &exitOffset, 4);
+		}
+
+		result.insert(result.end(), { 0x48, 0x81, 0xC4 });
+		emitInt32(result, SPILL_SIZE);
+		emitPop(result, R15);
+		emitPop(result, R14);
+		emitPop(result, R13);
+		emitPop(result, R12);
+		emitPop(result, RBX);
+		result.push_back(0xC3);
+
+		return supported;
+	}
+}
@@ -0,0 +1,240 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: jitExpression.h
+
+	Author: Matthew Day
+
+	Class Name: JitExpression
+
+	Description:
+		Compiles the post-fix equation of a compiled expression into x86-64
+		machine code. Each position of the operand stack is kept in its own SSE2
+		register, xmm0 to xmm14, so the code is a straight line of scalar
+		double instructions with no dispatch and no loads or stores between
+		operators. '^' by a value that is not an integer calls pow.
+
+		Two functions are emitted, one that evaluates a single row from an
+		array of variables and one that loops over columns of variables and
+		writes a column of answers. Both give exactly the same answers as
+		calcResult, since every operator is the same IEEE operation in the same
+		order.
+
+		The JIT is only available on x86-64 with the System V calling
+		convention (Linux and macOS), and only for equations whose stack never
+		holds more than MAX_JIT_STACK_DEPTH operands. Otherwise, or when the
+		JIT is disabled, the equation is evaluated by a RegisterMachine.
+
+	Outline:
+		Public Functions:
+			JitExpression
+			~JitExpression
+			evaluate
+			evaluate
+			evaluate
+			isCompiled
+			getFunction
+			getBatchFunction
+			isAvailable
+
+		Private Functions:
+			emitProgram
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include "compiledExpression.h"
+#include "registerMachine.h"
+#include "token.h"
+
+using std::vector;
+using std::size_t;
+using std::invalid_argument;
+
+namespace day {
+
+	class JitExpression {
+
+	public:
+
+		// Evaluates the equation with the value of each variable in the order of their slots
+		typedef double (*Function)(const double *variableValues);
+		// Evaluates rows [0, rows) with the variable in slot j given by columns[j]
+		typedef void (*BatchFunction)(const double *const *columns, double *output, size_t rows);
+
+		// Most operands the stack may hold for the equation to be compiled
+		static const int MAX_JIT_STACK_DEPTH = 15;
+	private:
+
+		// Interpreter used when the equation is not compiled
+		RegisterMachine fallback;
+		// The values of the equation followed by -1, 1 and -0, read by the machine code
+		vector<double> constants;
+		int variableCount;
+		// Executable memory holding both functions, or nullptr if not compiled
+		void *code;
+		size_t codeSize;
+		Function function;
+		BatchFunction batchFunction;
+	public:
+
+		/******************************************************************************
+			Function Name: JitExpression
+
+			Des:
+				Compiles the equation into machine code if the JIT is available and
+					enabled.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to compile.
+				enabled - type bool, false to always use the interpreter.
+
+			Throws:
+				Throws exception if the equation uses an operator that cannot be
+					evaluated.
+		******************************************************************************/
+		JitExpression(const CompiledExpression &expression, bool enabled = true);
+
+		/******************************************************************************
+			Function Name: ~JitExpression
+
+			Des:
+				Frees the executable memory.
+		******************************************************************************/
+		~JitExpression();
+
+		JitExpression(const JitExpression &) = delete;
+		JitExpression &operator=(const JitExpression &) = delete;
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the values bound to its variables.
+
+			Params:
+				variableValues - type const vector<double> &, the value of each
+					variable in the order of their slots.
+
+			Returns:
+				type double, the answer to the equation
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		double evaluate(const vector<double> &variableValues) const;
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation without checking the number of variables.
+
+			Params:
+				variableValues - type const double *, the value of each variable in
+					the order of their slots.
+
+			Returns:
+				type double, the answer to the equation
+		******************************************************************************/
+		double evaluate(const double *variableValues) const;
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for every row of the given columns.
+
+			Params:
+				columns - type const double *const *, the values of the variable in
+					each slot, one column per slot with at least param rows values.
+				output - type double *, receives the answer for each row.
+				rows - type size_t, the number of rows.
+		******************************************************************************/
+		void evaluate(const double *const *columns, double *output, size_t rows) const;
+
+		/******************************************************************************
+			Function Name: isCompiled
+
+			Des:
+				Checks if the equation was compiled into machine code.
+
+			Returns:
+				type bool, true if the machine code is used, false if the
+					interpreter is.
+		******************************************************************************/
+		bool isCompiled() const;
+
+		/******************************************************************************
+			Function Name: getFunction
+
+			Des:
+				Gets the machine code that evaluates a single row. It stays valid
+					for the lifetime of the JitExpression.
+
+			Returns:
+				type Function, the function or nullptr if the equation was not
+					compiled.
+		******************************************************************************/
+		Function getFunction() const;
+
+		/******************************************************************************
+			Function Name: getBatchFunction
+
+			Des:
+				Gets the machine code that evaluates columns of rows. It stays valid
+					for the lifetime of the JitExpression.
+
+			Returns:
+				type BatchFunction, the function or nullptr if the equation was not
+					compiled.
+		******************************************************************************/
+		BatchFunction getBatchFunction() const;
+
+		/******************************************************************************
+			Function Name: isAvailable
+
+			Des:
+				Checks if the JIT can run on this platform.
+
+			Returns:
+				type bool, true if equations can be compiled into machine code.
+		******************************************************************************/
+		static bool isAvailable();
+	private:
+
+		/******************************************************************************
+			Function Name: emitProgram
+
+			Des:
+				Appends the machine code of one of the two functions.
+
+			Params:
+				postFix - type const vector<Token> &, the validated equation.
+				batch - type bool, true for the function that loops over columns.
+				result - type vector<unsigned char> &, receives the machine code.
+
+			Returns:
+				type bool, true if every operator could be compiled.
+		******************************************************************************/
+		bool emitProgram(const vector<Token> &postFix, bool batch, vector<unsigned char> &result) const;
+	};
+}
@@ -1,12 +1,239 @@
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <chrono>
+#include <charconv>
+#include <limits>
+#include <memory>
 
 #include "reversePolishNotation.h"
+#include "compiledExpression.h"
+#include "aggregate.h"
+#include "batchEvaluator.h"
+#include "columnReader.h"
+#include "mappedFile.h"
+#include "streamEvaluator.h"
+#include "threadPool.h"
 
 using namespace std;
 using namespace day;
 
-int main() {
+// Evaluates a file, or stdin when no file is given, with one equation per line and writes one answer per line
+int runBatch(const char *path) {
+
+	ThreadPool pool;
+	StreamEvaluator evaluator(pool);
+	size_t lines;
+	int result = 0;
+
+	// Output is only written in large blocks, so cout does not need to stay in step with printf
+	ios::sync_with_stdio(false);
+
+	auto start = chrono::steady_clock::now();
+
+	try {
+
+		if (path == nullptr || string(path) == "-") {
+
+			lines = evaluator.evaluate(cin, cout);
+		} else {
+
+			MappedFile file(path);
+
+			lines = evaluator.evaluate(file.getData(), file.getSize(), cout);
+		}
+
+		cout.flush();
+
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		cerr << "Evaluated " << lines << " lines in " << seconds << " s, " << lines / seconds << " lines/sec on "
+			<< pool.getThreadCount() << " threads" << endl;
+	} catch (exception &e) {
+
+		cerr << e.what() << endl;
+		result = 1;
+	}
+
+	return result;
+}
+
+// Evaluates the equation for every row of a CSV or binary column file, where each variable is the column of the same name.
+// Writes one answer per row, or a single aggregate of every answer, to the output file or stdout. With --where only the rows
+// where the predicate is not 0 are evaluated
+int runColumns(int argc, char **argv) {
+
+	string aggregate;
+	string outputPath;
+	string where;
+	int result = 0;
+
+	for (int i = 4; i + 1 < argc; i += 2) {
+
+		if (string(argv[i]) == "--aggregate")
+			aggregate = argv[i + 1];
+		else if (string(argv[i]) == "--output")
+			outputPath = argv[i + 1];
+		else if (string(argv[i]) == "--where")
+			where = argv[i + 1];
+	}
+
+	ios::sync_with_stdio(false);
+
+	auto start = chrono::steady_clock::now();
+
+	try {
+
+		if (argc < 4)
+			throw invalid_argument("Usage: --columns file equation [--where predicate] [--output file] [--aggregate sum|min|max|mean|count]");
+
+		if (aggregate != "" && aggregate != "sum" && aggregate != "min" && aggregate != "max" && aggregate != "mean" && aggregate != "count")
+			throw invalid_argument("Unknown aggregate " + aggregate);
+
+		MappedFile file(argv[2]);
+		ColumnReader reader(file.getData(), file.getSize());
+		CompiledExpression expression(argv[3], string(argv[3]).size());
+		unique_ptr<CompiledExpression> predicate;
+		BatchEvaluator evaluator;
+		ofstream outputFile;
+		// Columns read from the file, the ones of the equation first in the order of its slots then the rest of the predicate
+		vector<string> names = expression.getVariableNames();
+		vector<int> selected;
+		vector<const double *> columns;
+		// Position in names of each variable slot of the predicate, and its columns for the current block
+		vector<int> predicateSlots;
+		vector<const double *> predicateColumns;
+		vector<size_t> selection;
+		vector<double> answers;
+		string text;
+		size_t rows;
+		size_t totalRows = 0;
+		size_t selectedRows = 0;
+		Aggregate total;
+
+		if (where != "") {
+
+			predicate.reset(new CompiledExpression(where.c_str(), where.size()));
+
+			for (const string &name : predicate->getVariableNames()) {
+
+				size_t slot = 0;
+
+				while (slot < names.size() && names[slot] != name)
+					slot++;
+
+				if (slot == names.size())
+					names.push_back(name);
+
+				predicateSlots.push_back(slot);
+			}
+
+			predicateColumns.resize(predicateSlots.size());
+			selection.resize(ColumnReader::BLOCK_ROWS);
+		}
+
+		for (const string &name : names) {
+
+			selected.push_back(reader.getColumnIndex(name));
+
+			if (selected.back() == -1)
+				throw invalid_argument("Column " + name + " not found");
+		}
+
+		if (outputPath != "") {
+
+			outputFile.open(outputPath, ios::binary);
+
+			if (!outputFile)
+				throw invalid_argument("Cannot open file " + outputPath);
+		}
+
+		ostream &output = outputPath != "" ? outputFile : cout;
+
+		// Answers are only kept when they are written out, aggregates are reduced as they are evaluated
+		if (aggregate == "")
+			answers.resize(ColumnReader::BLOCK_ROWS);
+
+		while ((rows = reader.readBlock(selected, columns)) > 0) {
+
+			size_t count = rows;
+
+			totalRows += rows;
+
+			// The equation is only evaluated for the rows that pass the predicate
+			if (predicate) {
+
+				for (size_t i = 0; i < predicateSlots.size(); i++)
+					predicateColumns[i] = columns[predicateSlots[i]];
+
+				count = evaluator.select(*predicate, predicateColumns.data(), rows, selection.data());
+			}
+
+			selectedRows += count;
+
+			if (aggregate == "") {
+
+				// Each block of answers is written at once
+				char digits[32];
+
+				if (predicate)
+					evaluator.evaluate(expression, columns.data(), selection.data(), count, answers.data());
+				else
+					evaluator.evaluate(expression, columns.data(), answers.data(), rows);
+
+				text.clear();
+
+				for (size_t i = 0; i < count; i++) {
+
+					text.append(digits, to_chars(digits, digits + sizeof(digits), answers[i]).ptr);
+					text += '\n';
+				}
+
+				output.write(text.data(), text.size());
+			} else if (predicate)
+				evaluator.aggregate(expression, columns.data(), selection.data(), count, total);
+			else
+				evaluator.aggregate(expression, columns.data(), rows, total);
+		}
+
+		// Enough digits to read back the same double
+		output.precision(numeric_limits<double>::max_digits10);
+
+		if (aggregate == "sum")
+			output << total.getSum() << '\n';
+		else if (aggregate == "min")
+			output << total.getMinimum() << '\n';
+		else if (aggregate == "max")
+			output << total.getMaximum() << '\n';
+		else if (aggregate == "mean")
+			output << total.getMean() << '\n';
+		else if (aggregate == "count")
+			output << total.getCount() << '\n';
+
+		output.flush();
+
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		cerr << "Evaluated " << selectedRows << " of " << totalRows << " rows in " << seconds << " s, " << totalRows / seconds << " rows/sec" << endl;
+	} catch (exception &e) {
+
+		cerr << e.what() << endl;
+		result = 1;
+	}
+
+	return result;
+}
+
+// Run with --batch [file] to evaluate a file of equations, or --columns file equation [--where predicate] to evaluate an
+// equation over the columns of a file, otherwise equations are read one at a time until "0"
+int main(int argc, char **argv) {
+
+	if (argc > 1 && string(argv[1]) == "--batch")
+		return runBatch(argc > 2 ? argv[2] : nullptr);
+
+	if (argc > 1 && string(argv[1]) == "--columns")
+		return runColumns(argc, argv);
 
 	cout << "Enter equation" << endl;
 
@@ -19,18 +246,19 @@ int main() {
 
 		// Recreated each time to avoid old invalid data being left from previous invalid equations
 		vector<double> values;
+		vector<string> variables;
 		double result;
 
 		// Surrounded with try-catch to prevent testing from crashing the program while still outputting thrown exceptions
 		try {
 
-			string editedEquation = rpn.stripValuesFromEquation(equation.c_str(), equation.length(), values);
-			cout << editedEquation << endl;
+			vector<Token> editedEquation = rpn.stripValuesFromEquation(equation.c_str(), equation.length(), values, variables);
+			cout << rpn.formatEquation(editedEquation.data(), editedEquation.size(), values, variables) << endl;
 
-			editedEquation = rpn.convertInfixToPostFix(editedEquation.c_str(), editedEquation.size());
-			cout << editedEquation << endl;
+			editedEquation = rpn.convertInfixToPostFix(editedEquation.data(), editedEquation.size());
+			cout << rpn.formatEquation(editedEquation.data(), editedEquation.size(), values, variables) << endl;
 
-			result = rpn.calcResult(editedEquation.c_str(), editedEquation.size(), values);
+			result = rpn.calcResult(editedEquation.data(), editedEquation.size(), values);
 			cout << result << endl;
 		} catch (exception &e) {
 
@@ -0,0 +1,120 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: mappedFile.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for mappedFile.h
+
+	Outline:
+		Public Functions:
+			MappedFile
+			~MappedFile
+			getData
+			getSize
+******************************************************************************/
+
+#include "mappedFile.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#define DAY_MMAP_AVAILABLE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+
+using std::ifstream;
+using std::ios;
+#endif
+
+namespace day {
+
+	MappedFile::MappedFile(const string &path) : data(nullptr), size(0), mapped(false) {
+
+#ifdef DAY_MMAP_AVAILABLE
+		int file = open(path.c_str(), O_RDONLY);
+		struct stat status;
+
+		if (file == -1)
+			throw invalid_argument("Cannot open file " + path);
+
+		if (fstat(file, &status) == -1) {
+
+			close(file);
+			throw invalid_argument("Cannot read file " + path);
+		}
+
+		size = status.st_size;
+
+		// A file of 0 bytes cannot be mapped, and has no data anyway
+		if (size > 0) {
+
+			void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (memory == MAP_FAILED) {
+
+				close(file);
+				throw invalid_argument("Cannot map file " + path);
+			}
+
+			// The file is read from start to end once, so the kernel can read ahead and drop pages behind
+			madvise(memory, size, MADV_SEQUENTIAL);
+
+			data = (const char *)memory;
+			mapped = true;
+		}
+
+		// The mapping keeps the file open
+		close(file);
+#else
+		ifstream file(path, ios::binary | ios::ate);
+
+		if (!file)
+			throw invalid_argument("Cannot open file " + path);
+
+		size = file.tellg();
+		buffer.resize(size);
+		file.seekg(0);
+
+		if (!file.read(buffer.data(), size))
+			throw invalid_argument("Cannot read file " + path);
+
+		data = size > 0 ? buffer.data() : nullptr;
+#endif
+	}
+
+	MappedFile::~MappedFile() {
+
+#ifdef DAY_MMAP_AVAILABLE
+		if (mapped)
+			munmap((void *)data, size);
+#endif
+	}
+
+	const char *MappedFile::getData() const {
+
+		return data;
+	}
+
+	size_t MappedFile::getSize() const {
+
+		return size;
+	}
+}
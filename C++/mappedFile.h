@@ -0,0 +1,111 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: mappedFile.h
+
+	Author: Matthew Day
+
+	Class Name: MappedFile
+
+	Description:
+		Gives read-only access to the whole of a file as one block of memory.
+		On Linux and macOS the file is memory mapped, so nothing is copied and
+		pages are only read from disk as they are used. Elsewhere the file is
+		read into a buffer.
+
+	Outline:
+		Public Functions:
+			MappedFile
+			~MappedFile
+			getData
+			getSize
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+
+using std::string;
+using std::vector;
+using std::invalid_argument;
+using std::size_t;
+
+namespace day {
+
+	class MappedFile {
+
+	private:
+
+		const char *data;
+		size_t size;
+		// Copy of the file when it is not memory mapped
+		vector<char> buffer;
+		bool mapped;
+	public:
+
+		/******************************************************************************
+			Function Name: MappedFile
+
+			Des:
+				Maps the file into memory.
+
+			Params:
+				path - type const string &, the path of the file.
+
+			Throws:
+				Throws exception if the file cannot be opened or mapped.
+		******************************************************************************/
+		MappedFile(const string &path);
+
+		/******************************************************************************
+			Function Name: ~MappedFile
+
+			Des:
+				Unmaps the file.
+		******************************************************************************/
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		/******************************************************************************
+			Function Name: getData
+
+			Des:
+				Gets the contents of the file, valid for the lifetime of the
+					MappedFile.
+
+			Returns:
+				type const char *, the first byte of the file, or nullptr if the
+					file is empty.
+		******************************************************************************/
+		const char *getData() const;
+
+		/******************************************************************************
+			Function Name: getSize
+
+			Des:
+				Gets the size of the file.
+
+			Returns:
+				type size_t, the number of bytes in the file.
+		******************************************************************************/
+		size_t getSize() const;
+	};
+}
@@ -0,0 +1,335 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: multiExpression.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for multiExpression.h
+
+	Outline:
+		Public Functions:
+			MultiExpression
+			getEquationCount
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getOperationCount
+			getSavedOperations
+			getSlotCount
+			getSteps
+			getAnswers
+			getValues
+
+		Private Functions:
+			addNode
+			addValue
+			getValueSlot
+			isCommutative
+******************************************************************************/
+
+#include "multiExpression.h"
+
+namespace day {
+
+	MultiExpression::MultiExpression(const vector<string> &equations, OptimizationLevel level) : slotCount(0), separateOperations(0) {
+
+		vector<int> roots;
+		vector<int> stack;
+
+		for (size_t i = 0; i < equations.size(); i++) {
+
+			Expected<CompiledExpression> compiled = CompiledExpression::tryCompile(equations[i].c_str(), equations[i].size(), level);
+
+			if (!compiled)
+				throw invalid_argument("Equation " + to_string(i + 1) + ": " + compiled.getError().getMessage());
+
+			const CompiledExpression &expression = compiled.getValue();
+			const vector<double> &expressionValues = expression.getValues();
+			vector<int> variableSlots;
+
+			// Binds the slots of the equation to the slots shared by every equation
+			for (const string &name : expression.getVariableNames()) {
+
+				auto found = variableIndexes.find(name);
+
+				if (found == variableIndexes.end()) {
+
+					found = variableIndexes.emplace(name, (int)variableNames.size()).first;
+					variableNames.push_back(name);
+				}
+
+				variableSlots.push_back(found->second);
+			}
+
+			stack.clear();
+
+			for (const Token &token : expression.getPostFix()) {
+
+				switch (token.opcode) {
+
+					case Opcode::PUSH_VALUE:
+
+						stack.push_back(addValue(expressionValues[token.index]));
+						break;
+					case Opcode::PUSH_NEGATIVE_ONE:
+
+						stack.push_back(addValue(-1));
+						break;
+					case Opcode::PUSH_VARIABLE:
+
+						stack.push_back(addNode(Opcode::PUSH_VARIABLE, variableSlots[token.index], -1, 0));
+						break;
+					case Opcode::POWER_INTEGER:
+					case Opcode::MODULO_POWER_OF_TWO:
+
+						stack.back() = addNode(token.opcode, stack.back(), -1, token.index);
+						separateOperations++;
+						break;
+					case Opcode::NOT:
+					case Opcode::NEGATE:
+					case Opcode::SQUARE_ROOT:
+
+						stack.back() = addNode(token.opcode, stack.back(), -1, 0);
+						separateOperations++;
+						break;
+					default: {
+
+						// Every other opcode left by validatePostFix is a binary operator
+						int right = stack.back();
+
+						stack.pop_back();
+						stack.back() = addNode(token.opcode, stack.back(), right, 0);
+						separateOperations++;
+					}
+				}
+			}
+
+			roots.push_back(stack.back());
+		}
+
+		// Every operand node was made before its users, so the nodes are already in an order the steps can run in
+		vector<int> stepIndexes(nodes.size(), -1);
+		vector<int> lastUses(nodes.size(), -1);
+		vector<int> answering(nodes.size(), -1);
+		int stepCount = 0;
+
+		for (size_t i = 0; i < nodes.size(); i++) {
+
+			const Node &node = nodes[i];
+
+			if (node.opcode == Opcode::PUSH_VALUE || node.opcode == Opcode::PUSH_VARIABLE)
+				continue;
+
+			stepIndexes[i] = stepCount;
+			lastUses[node.left] = stepCount;
+
+			if (node.right >= 0)
+				lastUses[node.right] = stepCount;
+
+			stepCount++;
+		}
+
+		// An equation that is the same as an earlier one is copied from its output
+		for (size_t i = roots.size(); i-- > 0;)
+			answering[roots[i]] = i;
+
+		vector<Operand> placements(nodes.size());
+		vector<int> freeSlots;
+
+		steps.reserve(stepCount);
+
+		for (size_t i = 0; i < nodes.size(); i++) {
+
+			const Node &node = nodes[i];
+
+			if (node.opcode == Opcode::PUSH_VALUE) {
+
+				placements[i] = { Source::VALUE, node.left };
+				continue;
+			} else if (node.opcode == Opcode::PUSH_VARIABLE) {
+
+				placements[i] = { Source::VARIABLE, node.left };
+				continue;
+			}
+
+			Step step;
+
+			step.opcode = node.opcode;
+			step.left = placements[node.left];
+			step.right = node.right >= 0 ? placements[node.right] : Operand{ Source::VALUE, getValueSlot(node.tokenOperand) };
+
+			// Operands read for the last time free their slots first, the kernels may write over the operand they read
+			if (step.left.source == Source::SCRATCH && lastUses[node.left] == stepIndexes[i])
+				freeSlots.push_back(step.left.index);
+
+			if (node.right >= 0 && node.right != node.left && step.right.source == Source::SCRATCH && lastUses[node.right] == stepIndexes[i])
+				freeSlots.push_back(step.right.index);
+
+			if (answering[i] >= 0) {
+
+				step.result = { Source::OUTPUT, answering[i] };
+			} else if (!freeSlots.empty()) {
+
+				step.result = { Source::SCRATCH, freeSlots.back() };
+				freeSlots.pop_back();
+			} else {
+
+				step.result = { Source::SCRATCH, slotCount++ };
+			}
+
+			placements[i] = step.result;
+			steps.push_back(step);
+		}
+
+		for (int root : roots)
+			answers.push_back(placements[root]);
+
+		// Only needed while compiling
+		nodes = vector<Node>();
+		nodeIndexes = unordered_map<NodeKey, int, NodeKeyHash>();
+		valueIndexes = unordered_map<uint64_t, int>();
+	}
+
+	int MultiExpression::getEquationCount() const {
+
+		return answers.size();
+	}
+
+	int MultiExpression::getVariableCount() const {
+
+		return variableNames.size();
+	}
+
+	int MultiExpression::getVariableIndex(const string &name) const {
+
+		auto found = variableIndexes.find(name);
+
+		return found == variableIndexes.end() ? -1 : found->second;
+	}
+
+	const vector<string> &MultiExpression::getVariableNames() const {
+
+		return variableNames;
+	}
+
+	int MultiExpression::getOperationCount() const {
+
+		return steps.size();
+	}
+
+	int MultiExpression::getSavedOperations() const {
+
+		return separateOperations - (int)steps.size();
+	}
+
+	int MultiExpression::getSlotCount() const {
+
+		return slotCount;
+	}
+
+	const vector<MultiExpression::Step> &MultiExpression::getSteps() const {
+
+		return steps;
+	}
+
+	const vector<MultiExpression::Operand> &MultiExpression::getAnswers() const {
+
+		return answers;
+	}
+
+	const vector<double> &MultiExpression::getValues() const {
+
+		return values;
+	}
+
+	int MultiExpression::addNode(Opcode opcode, int left, int right, int tokenOperand) {
+
+		bool isOperator = opcode != Opcode::PUSH_VALUE && opcode != Opcode::PUSH_VARIABLE;
+
+		if (isOperator && nodes[left].opcode == Opcode::PUSH_VALUE && (right < 0 || nodes[right].opcode == Opcode::PUSH_VALUE)) {
+
+			double leftValue = values[nodes[left].left];
+			double rightValue = right < 0 ? tokenOperand : values[nodes[right].left];
+			double result;
+
+			kernels.apply(opcode, &leftValue, true, &rightValue, true, &result, 1);
+
+			return addValue(result);
+		}
+
+		if (right >= 0 && isCommutative(opcode) && left > right) {
+
+			int swapped = left;
+
+			left = right;
+			right = swapped;
+		}
+
+		NodeKey key = { opcode, left, right, tokenOperand };
+		auto found = nodeIndexes.find(key);
+
+		if (found != nodeIndexes.end())
+			return found->second;
+
+		nodes.push_back({ opcode, left, right, tokenOperand });
+		nodeIndexes.emplace(key, (int)nodes.size() - 1);
+
+		return nodes.size() - 1;
+	}
+
+	int MultiExpression::addValue(double value) {
+
+		return addNode(Opcode::PUSH_VALUE, getValueSlot(value), -1, 0);
+	}
+
+	int MultiExpression::getValueSlot(double value) {
+
+		uint64_t bits;
+
+		memcpy(&bits, &value, sizeof(double));
+
+		auto found = valueIndexes.find(bits);
+
+		if (found != valueIndexes.end())
+			return found->second;
+
+		values.push_back(value);
+		valueIndexes.emplace(bits, (int)values.size() - 1);
+
+		return values.size() - 1;
+	}
+
+	bool MultiExpression::isCommutative(Opcode opcode) {
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+			case Opcode::MULTIPLY:
+			case Opcode::AND:
+			case Opcode::OR:
+			case Opcode::EQUAL:
+			case Opcode::NOT_EQUAL:
+
+				return true;
+			default:
+
+				return false;
+		}
+	}
+}
@@ -0,0 +1,380 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: multiExpression.h
+
+	Author: Matthew Day
+
+	Class Name: MultiExpression
+
+	Description:
+		Several equations over the same variables compiled together, so that a
+		subterm they share, such as (high-low)/close, is computed once for each
+		row instead of once for each equation. Variables with the same name
+		are the same slot in every equation.
+
+		Each equation is compiled as a CompiledExpression, then its post-fix
+		tokens are hash-consed into one graph: an operator whose opcode and
+		operands were already seen reuses the node made for them. The operands
+		of '+', '*', '=', '!=', '&' and '|' are put in a fixed order first, so
+		a*b and b*a are one node. An operator on values only is folded into a
+		value.
+
+		The graph is then laid out as a list of steps in the order the nodes
+		were made, which puts every operand before its users. Each step writes
+		a block of rows to a scratch slot, which is reused once its last user
+		has run, or straight to the output of the equation it answers.
+		BatchEvaluator runs the steps over each block of rows, so all of the
+		answers come from a single pass over the columns.
+
+		Reordering the operands can only change which NaN is returned when
+		both operands are NaN, every other answer is the same as evaluating
+		each equation on its own.
+
+	Outline:
+		Public Functions:
+			MultiExpression
+			getEquationCount
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getOperationCount
+			getSavedOperations
+			getSlotCount
+			getSteps
+			getAnswers
+			getValues
+
+		Private Functions:
+			addNode
+			addValue
+			getValueSlot
+			isCommutative
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+#include "compiledExpression.h"
+#include "simdKernels.h"
+#include "token.h"
+
+using std::string;
+using std::to_string;
+using std::vector;
+using std::unordered_map;
+using std::invalid_argument;
+using std::uint64_t;
+using std::memcpy;
+
+namespace day {
+
+	class MultiExpression {
+
+	public:
+
+		// Where a step reads an operand from or writes its result to
+		enum class Source : unsigned char {
+
+			// A value shared by every row, index is its slot in getValues
+			VALUE,
+			// A column, index is the slot of the variable
+			VARIABLE,
+			// A block of scratch space, index is the slot
+			SCRATCH,
+			// The output column of the equation at index
+			OUTPUT
+		};
+
+		struct Operand {
+
+			Source source;
+			int index;
+		};
+
+		// One operator of the graph, computed for every row of a block
+		struct Step {
+
+			Opcode opcode;
+			Operand left;
+			// For unary operators, a value holding the integer operand kept in the token
+			Operand right;
+			Operand result;
+		};
+	private:
+
+		// A node of the graph while it is built
+		struct Node {
+
+			Opcode opcode;
+			// Children for operators, or the slot of the value or variable
+			int left;
+			int right;
+			int tokenOperand;
+		};
+
+		// The fields of a Node packed into a key, used to find the node made for the same operator and operands
+		struct NodeKey {
+
+			Opcode opcode;
+			int left;
+			int right;
+			int tokenOperand;
+
+			bool operator==(const NodeKey &other) const {
+
+				return opcode == other.opcode && left == other.left && right == other.right && tokenOperand == other.tokenOperand;
+			}
+		};
+
+		struct NodeKeyHash {
+
+			size_t operator()(const NodeKey &key) const {
+
+				uint64_t hash = (uint64_t)key.opcode;
+
+				hash = hash * 0x9E3779B97F4A7C15ULL + (uint32_t)key.left;
+				hash = hash * 0x9E3779B97F4A7C15ULL + (uint32_t)key.right;
+				hash = hash * 0x9E3779B97F4A7C15ULL + (uint32_t)key.tokenOperand;
+
+				return hash ^ (hash >> 29);
+			}
+		};
+
+		vector<Node> nodes;
+		unordered_map<NodeKey, int, NodeKeyHash> nodeIndexes;
+		// Slot of each value by its bits, so equal values share a node and -0 is kept apart from 0
+		unordered_map<uint64_t, int> valueIndexes;
+		vector<double> values;
+		vector<string> variableNames;
+		unordered_map<string, int> variableIndexes;
+		vector<Step> steps;
+		// Where the answer of each equation is found once the steps have run
+		vector<Operand> answers;
+		int slotCount;
+		// Number of operators in the equations compiled on their own
+		int separateOperations;
+		// Folds operators on values only
+		SimdKernels kernels;
+	public:
+
+		/******************************************************************************
+			Function Name: MultiExpression
+
+			Des:
+				Compiles the equations together so that every subterm they share is
+					computed once.
+
+			Params:
+				equations - type const vector<string> &, the in-fix equations.
+					Example input: {(high-low)/close, (high-low)/close*100}.
+				level - type OptimizationLevel, which rewrites ExpressionOptimizer may
+					make to each equation before they are merged.
+
+			Throws:
+				Throws exception if any equation is invalid, naming the first one.
+		******************************************************************************/
+		MultiExpression(const vector<string> &equations, OptimizationLevel level = OptimizationLevel::EXACT);
+
+		/******************************************************************************
+			Function Name: getEquationCount
+
+			Des:
+				Gets the number of equations, which is the number of outputs.
+
+			Returns:
+				type int, the number of equations.
+		******************************************************************************/
+		int getEquationCount() const;
+
+		/******************************************************************************
+			Function Name: getVariableCount
+
+			Des:
+				Gets the number of distinct variables used by any of the equations.
+
+			Returns:
+				type int, the number of variable slots.
+		******************************************************************************/
+		int getVariableCount() const;
+
+		/******************************************************************************
+			Function Name: getVariableIndex
+
+			Des:
+				Finds the slot of the variable with the given name.
+
+			Params:
+				name - type const string &, the name of the variable.
+
+			Returns:
+				type int, the slot of the variable or -1 if no equation uses it.
+		******************************************************************************/
+		int getVariableIndex(const string &name) const;
+
+		/******************************************************************************
+			Function Name: getVariableNames
+
+			Des:
+				Gets the names of the variables in the order of their slots.
+
+			Returns:
+				type const vector<string> &, the names of the variables.
+		******************************************************************************/
+		const vector<string> &getVariableNames() const;
+
+		/******************************************************************************
+			Function Name: getOperationCount
+
+			Des:
+				Gets the number of operators computed for each row.
+
+			Returns:
+				type int, the number of steps.
+		******************************************************************************/
+		int getOperationCount() const;
+
+		/******************************************************************************
+			Function Name: getSavedOperations
+
+			Des:
+				Gets the number of operators for each row that merging saved over
+					evaluating every equation on its own.
+
+			Returns:
+				type int, the number of operators saved.
+		******************************************************************************/
+		int getSavedOperations() const;
+
+		/******************************************************************************
+			Function Name: getSlotCount
+
+			Des:
+				Gets the number of scratch blocks the steps use at once.
+
+			Returns:
+				type int, the number of scratch slots.
+		******************************************************************************/
+		int getSlotCount() const;
+
+		/******************************************************************************
+			Function Name: getSteps
+
+			Des:
+				Gets the operators in the order they are computed.
+
+			Returns:
+				type const vector<Step> &, the steps.
+		******************************************************************************/
+		const vector<Step> &getSteps() const;
+
+		/******************************************************************************
+			Function Name: getAnswers
+
+			Des:
+				Gets where the answer of each equation is found once the steps have
+					run. An answer that is not its own output, such as an equation
+					that is only a variable or the same as an earlier one, must be
+					copied to the output.
+
+			Returns:
+				type const vector<Operand> &, the answer of each equation.
+		******************************************************************************/
+		const vector<Operand> &getAnswers() const;
+
+		/******************************************************************************
+			Function Name: getValues
+
+			Des:
+				Gets the values read by VALUE operands.
+
+			Returns:
+				type const vector<double> &, the values.
+		******************************************************************************/
+		const vector<double> &getValues() const;
+
+	private:
+
+		/******************************************************************************
+			Function Name: addNode
+
+			Des:
+				Finds the node for an operator and its operands, making it if it is
+					new. Operators on values only are folded into a value node.
+
+			Params:
+				opcode - type Opcode, the operator, or PUSH_VALUE or PUSH_VARIABLE.
+				left - type int, the node of the left operand, or the slot of the
+					value or variable.
+				right - type int, the node of the right operand, -1 if there is none.
+				tokenOperand - type int, the integer operand kept in the token, 0
+					for operators that have none.
+
+			Returns:
+				type int, the index of the node.
+		******************************************************************************/
+		int addNode(Opcode opcode, int left, int right, int tokenOperand);
+
+		/******************************************************************************
+			Function Name: isCommutative
+
+			Des:
+				Checks if swapping the operands of an operator gives the same answer.
+
+			Params:
+				opcode - type Opcode, the operator.
+
+			Returns:
+				type bool, true if the operands can be put in any order.
+		******************************************************************************/
+		static bool isCommutative(Opcode opcode);
+
+		/******************************************************************************
+			Function Name: addValue
+
+			Des:
+				Finds the node for a value, making it if it is new.
+
+			Params:
+				value - type double, the value.
+
+			Returns:
+				type int, the index of the node.
+		******************************************************************************/
+		int addValue(double value);
+
+		/******************************************************************************
+			Function Name: getValueSlot
+
+			Des:
+				Finds the slot of a value in getValues, adding it if it is new.
+
+			Params:
+				value - type double, the value.
+
+			Returns:
+				type int, the slot of the value.
+		******************************************************************************/
+		int getValueSlot(double value);
+	};
+}
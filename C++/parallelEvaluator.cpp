@@ -0,0 +1,98 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: parallelEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for parallelEvaluator.h
+
+	Outline:
+		Public Functions:
+			ParallelEvaluator
+			evaluate
+			evaluate
+			aggregate
+******************************************************************************/
+
+#include "parallelEvaluator.h"
+
+namespace day {
+
+	ParallelEvaluator::ParallelEvaluator(ThreadPool &pool) : pool(pool), evaluators(pool.getThreadCount()) {
+	}
+
+	void ParallelEvaluator::evaluate(const CompiledExpression &expression, const double *const *columns, double *output, size_t rows) {
+
+		size_t chunks = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+
+		if (columns == nullptr && expression.getVariableCount() > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		pool.parallelFor(chunks, [&](size_t chunk, int threadIndex) {
+
+			size_t first = chunk * CHUNK_ROWS;
+			size_t count = rows - first < (size_t)CHUNK_ROWS ? rows - first : CHUNK_ROWS;
+			vector<const double *> chunkColumns(expression.getVariableCount());
+
+			for (int i = 0; i < expression.getVariableCount(); i++)
+				chunkColumns[i] = columns[i] == nullptr ? nullptr : columns[i] + first;
+
+			evaluators[threadIndex].evaluate(expression, chunkColumns.data(), output + first, count);
+		});
+	}
+
+	void ParallelEvaluator::evaluate(const vector<const CompiledExpression *> &expressions, const vector<const double *const *> &columns, const vector<double *> &outputs, size_t rows) {
+
+		if (columns.size() != expressions.size() || outputs.size() != expressions.size())
+			throw invalid_argument("Every equation needs its own columns and output");
+
+		pool.parallelFor(expressions.size(), [&](size_t i, int threadIndex) {
+
+			evaluators[threadIndex].evaluate(*expressions[i], columns[i], outputs[i], rows);
+		});
+	}
+
+	Aggregate ParallelEvaluator::aggregate(const CompiledExpression &expression, const double *const *columns, size_t rows, Summation summation) {
+
+		size_t chunks = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+		// One aggregate for each chunk rather than each thread, so the merge does not depend on the scheduling
+		vector<Aggregate> partials(chunks, Aggregate(summation));
+		Aggregate result(summation);
+
+		if (columns == nullptr && expression.getVariableCount() > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		pool.parallelFor(chunks, [&](size_t chunk, int threadIndex) {
+
+			size_t first = chunk * CHUNK_ROWS;
+			size_t count = rows - first < (size_t)CHUNK_ROWS ? rows - first : CHUNK_ROWS;
+			vector<const double *> chunkColumns(expression.getVariableCount());
+
+			for (int i = 0; i < expression.getVariableCount(); i++)
+				chunkColumns[i] = columns[i] == nullptr ? nullptr : columns[i] + first;
+
+			evaluators[threadIndex].aggregate(expression, chunkColumns.data(), count, partials[chunk]);
+		});
+
+		for (const Aggregate &partial : partials)
+			result.merge(partial);
+
+		return result;
+	}
+}
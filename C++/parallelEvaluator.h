@@ -0,0 +1,155 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: parallelEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: ParallelEvaluator
+
+	Description:
+		Spreads batch evaluation over the threads of a ThreadPool. Rows of a
+		single equation are split into chunks of CHUNK_ROWS, and a list of
+		distinct equations is split into one task per equation. Work stealing
+		balances chunks or equations that cost more than others, such as
+		equations that use '^' heavily.
+
+		CompiledExpression is never modified after it is compiled, so the same
+		expression and the same input columns can be shared by every thread.
+		Each thread evaluates with its own BatchEvaluator, which is the only
+		state that is not shared. A ParallelEvaluator itself must not be used
+		by two threads at the same time.
+
+		aggregate reduces each chunk into its own Aggregate and merges them in
+		chunk order once every chunk is done. Which thread ran a chunk never
+		changes the result, so it is the same bits from run to run and for any
+		number of threads.
+
+	Outline:
+		Public Functions:
+			ParallelEvaluator
+			evaluate
+			evaluate
+			aggregate
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "batchEvaluator.h"
+#include "compiledExpression.h"
+#include "threadPool.h"
+
+using std::vector;
+using std::size_t;
+
+namespace day {
+
+	class ParallelEvaluator {
+
+	public:
+
+		// Rows evaluated by each task, a multiple of the batch block size
+		static const int CHUNK_ROWS = 16 * BatchEvaluator::BLOCK_SIZE;
+	private:
+
+		ThreadPool &pool;
+		// One evaluator for each thread of the pool, indexed by the thread index
+		vector<BatchEvaluator> evaluators;
+	public:
+
+		/******************************************************************************
+			Function Name: ParallelEvaluator
+
+			Des:
+				Creates an evaluator that runs on the threads of the pool.
+
+			Params:
+				pool - type ThreadPool &, the threads to run on. Must outlive the
+					evaluator.
+		******************************************************************************/
+		ParallelEvaluator(ThreadPool &pool);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for every row, splitting the rows between
+					the threads.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				output - type double *, output column to get the answer for each row.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void evaluate(const CompiledExpression &expression, const double *const *columns, double *output, size_t rows);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates several distinct equations over the same number of rows,
+					splitting the equations between the threads.
+
+			Params:
+				expressions - type const vector<const CompiledExpression *> &, the
+					equations to be evaluated.
+				columns - type const vector<const double * const *> &, the columns
+					for each equation, one for each of its variable slots.
+				outputs - type const vector<double *> &, the output column of each
+					equation.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if the number of columns or outputs does not match
+					the number of equations or if a column is missing.
+		******************************************************************************/
+		void evaluate(const vector<const CompiledExpression *> &expressions, const vector<const double *const *> &columns, const vector<double *> &outputs, size_t rows);
+
+		/******************************************************************************
+			Function Name: aggregate
+
+			Des:
+				Evaluates the equation for every row and reduces the answers,
+					splitting the rows between the threads. No output column is
+					written.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to be
+					evaluated.
+				columns - type const double * const *, one column for each variable
+					slot of param expression, each holding param rows values.
+				rows - type size_t, the number of rows.
+				summation - type Summation, how the sum is added up.
+
+			Returns:
+				type Aggregate, the count, sum, minimum and maximum of the answers.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		Aggregate aggregate(const CompiledExpression &expression, const double *const *columns, size_t rows, Summation summation = Summation::COMPENSATED);
+	};
+}
@@ -0,0 +1,444 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: registerMachine.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for registerMachine.h
+
+	Outline:
+		Public Functions:
+			RegisterMachine
+			evaluate
+			evaluate
+			getInstructionCount
+			getRegisterCount
+
+		Private Functions:
+			run
+			getOperation
+******************************************************************************/
+
+#include "registerMachine.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::copy;
+using std::pow;
+using std::sqrt;
+
+namespace day {
+
+	RegisterMachine::RegisterMachine(const CompiledExpression &expression) {
+
+		const vector<Token> &postFix = expression.getPostFix();
+		// Register holding each operand on the stack of the post-fix equation
+		vector<int> operandStack;
+		int negativeOneRegister = -1;
+
+		values = expression.getValues();
+		variableCount = expression.getVariableCount();
+
+		// PUSH_NEGATIVE_ONE reads -1 from a register like any other value
+		for (const Token &token : postFix) {
+
+			if (token.opcode == Opcode::PUSH_NEGATIVE_ONE && negativeOneRegister == -1) {
+
+				values.push_back(-1);
+				negativeOneRegister = variableCount + values.size() - 1;
+			}
+		}
+
+		int tempBase = variableCount + values.size();
+
+		registerCount = tempBase + expression.getMaxStackDepth();
+		program.reserve(postFix.size() + 1);
+
+		for (const Token &token : postFix) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack.push_back(variableCount + token.index);
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack.push_back(token.index);
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack.push_back(negativeOneRegister);
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER:
+				case Opcode::SQUARE_ROOT:
+				case Opcode::MODULO_POWER_OF_TWO: {
+
+					// The result goes to the register of its stack position, which only the operand could be using
+					int result = tempBase + operandStack.size() - 1;
+
+					program.push_back({ getOperation(token.opcode), result, operandStack.back(), token.index });
+					operandStack.back() = result;
+					break;
+				}
+				default: {
+
+					Operation operation = getOperation(token.opcode);
+					int right = operandStack.back();
+
+					operandStack.pop_back();
+
+					int result = tempBase + operandStack.size() - 1;
+
+					program.push_back({ operation, result, operandStack.back(), right });
+					operandStack.back() = result;
+					break;
+				}
+			};
+		}
+
+		program.push_back({ Operation::HALT, 0, 0, 0 });
+
+		// The equation was validated when compiled, so exactly one operand is left
+		resultRegister = operandStack.back();
+	}
+
+	double RegisterMachine::evaluate(const vector<double> &variableValues) const {
+
+		if (variableValues.size() < (size_t)variableCount)
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		return evaluate(variableValues.data());
+	}
+
+	double RegisterMachine::evaluate(const double *variableValues) const {
+
+		double result;
+
+		if (registerCount <= FIXED_REGISTER_COUNT) {
+
+			double registers[FIXED_REGISTER_COUNT];
+
+			copy(variableValues, variableValues + variableCount, registers);
+			copy(values.begin(), values.end(), registers + variableCount);
+			run(registers);
+
+			result = registers[resultRegister];
+		} else {
+
+			vector<double> registers(registerCount);
+
+			copy(variableValues, variableValues + variableCount, registers.begin());
+			copy(values.begin(), values.end(), registers.begin() + variableCount);
+			run(registers.data());
+
+			result = registers[resultRegister];
+		}
+
+		return result;
+	}
+
+	int RegisterMachine::getInstructionCount() const {
+
+		return program.size() - 1;
+	}
+
+	int RegisterMachine::getRegisterCount() const {
+
+		return registerCount;
+	}
+
+	void RegisterMachine::run(double *registers) const {
+
+		ReversePolishNotation rpn;
+		const Instruction *instruction = program.data();
+
+#if defined(__GNUC__)
+		// Address of the code for each operation, in the order of Operation
+		static void *const DISPATCH[] = { &&add, &&subtract, &&multiply, &&divide, &&modulo, &&power,
+			&&negate, &&powerInteger, &&squareRoot, &&moduloPowerOfTwo, &&logicalNot, &&logicalAnd, &&logicalOr,
+			&&equal, &&notEqual, &&less, &&lessEqual, &&greater, &&greaterEqual, &&halt };
+
+		goto *DISPATCH[(int)instruction->operation];
+
+	add:
+		registers[instruction->result] = registers[instruction->left] + registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	subtract:
+		registers[instruction->result] = registers[instruction->left] - registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	multiply:
+		registers[instruction->result] = registers[instruction->left] * registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	divide:
+		// Handling divide by 0 exception is out of scope
+		registers[instruction->result] = registers[instruction->left] / registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	modulo:
+		// WARNING: Conversion to integer causes decimal data to be lost
+		registers[instruction->result] = (int)registers[instruction->left] % (int)registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	power:
+		registers[instruction->result] = pow(registers[instruction->left], registers[instruction->right]);
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	negate:
+		registers[instruction->result] = -registers[instruction->left];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	powerInteger:
+		registers[instruction->result] = rpn.calcOperator(Opcode::POWER_INTEGER, registers[instruction->left], instruction->right);
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	squareRoot:
+		registers[instruction->result] = sqrt(registers[instruction->left]);
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	moduloPowerOfTwo:
+		registers[instruction->result] = rpn.calcOperator(Opcode::MODULO_POWER_OF_TWO, registers[instruction->left], instruction->right);
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	logicalNot:
+		// Comparisons and bool operators give 1 or 0 like calcOperator
+		registers[instruction->result] = registers[instruction->left] == 0;
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	logicalAnd:
+		registers[instruction->result] = registers[instruction->left] != 0 && registers[instruction->right] != 0;
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	logicalOr:
+		registers[instruction->result] = registers[instruction->left] != 0 || registers[instruction->right] != 0;
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	equal:
+		registers[instruction->result] = registers[instruction->left] == registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	notEqual:
+		registers[instruction->result] = registers[instruction->left] != registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	less:
+		registers[instruction->result] = registers[instruction->left] < registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	lessEqual:
+		registers[instruction->result] = registers[instruction->left] <= registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	greater:
+		registers[instruction->result] = registers[instruction->left] > registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	greaterEqual:
+		registers[instruction->result] = registers[instruction->left] >= registers[instruction->right];
+		instruction++;
+		goto *DISPATCH[(int)instruction->operation];
+	halt:
+		return;
+#else
+		for (;; instruction++) {
+
+			switch (instruction->operation) {
+
+				case Operation::ADD:
+
+					registers[instruction->result] = registers[instruction->left] + registers[instruction->right];
+					break;
+				case Operation::SUBTRACT:
+
+					registers[instruction->result] = registers[instruction->left] - registers[instruction->right];
+					break;
+				case Operation::MULTIPLY:
+
+					registers[instruction->result] = registers[instruction->left] * registers[instruction->right];
+					break;
+				case Operation::DIVIDE:
+
+					// Handling divide by 0 exception is out of scope
+					registers[instruction->result] = registers[instruction->left] / registers[instruction->right];
+					break;
+				case Operation::MODULO:
+
+					// WARNING: Conversion to integer causes decimal data to be lost
+					registers[instruction->result] = (int)registers[instruction->left] % (int)registers[instruction->right];
+					break;
+				case Operation::POWER:
+
+					registers[instruction->result] = pow(registers[instruction->left], registers[instruction->right]);
+					break;
+				case Operation::NEGATE:
+
+					registers[instruction->result] = -registers[instruction->left];
+					break;
+				case Operation::POWER_INTEGER:
+
+					registers[instruction->result] = rpn.calcOperator(Opcode::POWER_INTEGER, registers[instruction->left], instruction->right);
+					break;
+				case Operation::SQUARE_ROOT:
+
+					registers[instruction->result] = sqrt(registers[instruction->left]);
+					break;
+				case Operation::MODULO_POWER_OF_TWO:
+
+					registers[instruction->result] = rpn.calcOperator(Opcode::MODULO_POWER_OF_TWO, registers[instruction->left], instruction->right);
+					break;
+				case Operation::NOT:
+
+					registers[instruction->result] = registers[instruction->left] == 0;
+					break;
+				case Operation::AND:
+
+					registers[instruction->result] = registers[instruction->left] != 0 && registers[instruction->right] != 0;
+					break;
+				case Operation::OR:
+
+					registers[instruction->result] = registers[instruction->left] != 0 || registers[instruction->right] != 0;
+					break;
+				case Operation::EQUAL:
+
+					registers[instruction->result] = registers[instruction->left] == registers[instruction->right];
+					break;
+				case Operation::NOT_EQUAL:
+
+					registers[instruction->result] = registers[instruction->left] != registers[instruction->right];
+					break;
+				case Operation::LESS:
+
+					registers[instruction->result] = registers[instruction->left] < registers[instruction->right];
+					break;
+				case Operation::LESS_EQUAL:
+
+					registers[instruction->result] = registers[instruction->left] <= registers[instruction->right];
+					break;
+				case Operation::GREATER:
+
+					registers[instruction->result] = registers[instruction->left] > registers[instruction->right];
+					break;
+				case Operation::GREATER_EQUAL:
+
+					registers[instruction->result] = registers[instruction->left] >= registers[instruction->right];
+					break;
+				case Operation::HALT:
+
+					return;
+			};
+		}
+#endif
+	}
+
+	RegisterMachine::Operation RegisterMachine::getOperation(Opcode opcode) const {
+
+		Operation result;
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				result = Operation::ADD;
+				break;
+			case Opcode::SUBTRACT:
+
+				result = Operation::SUBTRACT;
+				break;
+			case Opcode::MULTIPLY:
+
+				result = Operation::MULTIPLY;
+				break;
+			case Opcode::DIVIDE:
+
+				result = Operation::DIVIDE;
+				break;
+			case Opcode::MODULO:
+
+				result = Operation::MODULO;
+				break;
+			case Opcode::POWER:
+
+				result = Operation::POWER;
+				break;
+			case Opcode::NEGATE:
+
+				result = Operation::NEGATE;
+				break;
+			case Opcode::POWER_INTEGER:
+
+				result = Operation::POWER_INTEGER;
+				break;
+			case Opcode::SQUARE_ROOT:
+
+				result = Operation::SQUARE_ROOT;
+				break;
+			case Opcode::MODULO_POWER_OF_TWO:
+
+				result = Operation::MODULO_POWER_OF_TWO;
+				break;
+			case Opcode::NOT:
+
+				result = Operation::NOT;
+				break;
+			case Opcode::AND:
+
+				result = Operation::AND;
+				break;
+			case Opcode::OR:
+
+				result = Operation::OR;
+				break;
+			case Opcode::EQUAL:
+
+				result = Operation::EQUAL;
+				break;
+			case Opcode::NOT_EQUAL:
+
+				result = Operation::NOT_EQUAL;
+				break;
+			case Opcode::LESS:
+
+				result = Operation::LESS;
+				break;
+			case Opcode::LESS_EQUAL:
+
+				result = Operation::LESS_EQUAL;
+				break;
+			case Opcode::GREATER:
+
+				result = Operation::GREATER;
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				result = Operation::GREATER_EQUAL;
+				break;
+			default:
+
+				throw invalid_argument("Operator is not supported by the register machine");
+		};
+
+		return result;
+	}
+}
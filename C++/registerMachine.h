@@ -0,0 +1,220 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: registerMachine.h
+
+	Author: Matthew Day
+
+	Class Name: RegisterMachine
+
+	Description:
+		A second engine for evaluating a compiled equation, used in place of
+		CompiledExpression::evaluate. The post-fix equation is compiled into
+		three-address instructions over a register file that holds the
+		variables, then the values, then the intermediate results. Pushing an
+		operand costs nothing, since an instruction names the registers of its
+		operands directly, so only the operators are executed.
+
+		The register file is laid out as:
+			[0, variableCount)          variables, copied in on every call
+			[variableCount, tempBase)   values of the equation
+			[tempBase, registerCount)   one register for each stack position
+
+		With GCC and Clang each instruction jumps straight to the code of the
+		next one through a table of label addresses (computed goto), other
+		compilers use a switch in a loop.
+
+	Outline:
+		Public Functions:
+			RegisterMachine
+			evaluate
+			evaluate
+			getInstructionCount
+			getRegisterCount
+
+		Private Functions:
+			run
+			getOperation
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include "compiledExpression.h"
+#include "token.h"
+
+using std::vector;
+using std::invalid_argument;
+
+namespace day {
+
+	class RegisterMachine {
+
+	private:
+
+		// The operations of the register machine, HALT ends every program
+		enum class Operation : unsigned char {
+
+			ADD,
+			SUBTRACT,
+			MULTIPLY,
+			DIVIDE,
+			MODULO,
+			POWER,
+			NEGATE,
+			POWER_INTEGER,
+			SQUARE_ROOT,
+			MODULO_POWER_OF_TWO,
+			NOT,
+			AND,
+			OR,
+			EQUAL,
+			NOT_EQUAL,
+			LESS,
+			LESS_EQUAL,
+			GREATER,
+			GREATER_EQUAL,
+			HALT
+		};
+
+		// registers[result] = registers[left] op registers[right]. POWER_INTEGER and
+		// MODULO_POWER_OF_TWO keep their integer operand in right instead
+		struct Instruction {
+
+			Operation operation;
+			int result;
+			int left;
+			int right;
+		};
+
+		// Largest register file kept on the stack while evaluating
+		static const int FIXED_REGISTER_COUNT = 256;
+
+		vector<Instruction> program;
+		// The values of the equation, copied into the register file after the variables
+		vector<double> values;
+		int variableCount;
+		int registerCount;
+		// Register holding the answer once the program has run
+		int resultRegister;
+	public:
+
+		/******************************************************************************
+			Function Name: RegisterMachine
+
+			Des:
+				Compiles the post-fix equation of a compiled expression into register
+					machine instructions.
+
+			Params:
+				expression - type const CompiledExpression &, the equation to compile.
+
+			Throws:
+				Throws exception if the equation uses an operator the register
+					machine does not support.
+		******************************************************************************/
+		RegisterMachine(const CompiledExpression &expression);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the values bound to its variables.
+
+			Params:
+				variableValues - type const vector<double> &, the value of each
+					variable in the order of their slots.
+
+			Returns:
+				type double, the answer to the equation
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		double evaluate(const vector<double> &variableValues) const;
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation without checking the number of variables.
+
+			Params:
+				variableValues - type const double *, the value of each variable in
+					the order of their slots.
+
+			Returns:
+				type double, the answer to the equation
+		******************************************************************************/
+		double evaluate(const double *variableValues) const;
+
+		/******************************************************************************
+			Function Name: getInstructionCount
+
+			Des:
+				Gets the number of instructions run per evaluation, not counting HALT.
+
+			Returns:
+				type int, the number of instructions.
+		******************************************************************************/
+		int getInstructionCount() const;
+
+		/******************************************************************************
+			Function Name: getRegisterCount
+
+			Des:
+				Gets the size of the register file.
+
+			Returns:
+				type int, the number of registers.
+		******************************************************************************/
+		int getRegisterCount() const;
+	private:
+
+		/******************************************************************************
+			Function Name: run
+
+			Des:
+				Runs the program over a register file whose variables and values
+					have been filled in.
+
+			Params:
+				registers - type double *, the register file.
+		******************************************************************************/
+		void run(double *registers) const;
+
+		/******************************************************************************
+			Function Name: getOperation
+
+			Des:
+				Gets the register machine operation of an operator.
+
+			Params:
+				opcode - type Opcode, the operator.
+
+			Returns:
+				type Operation, the matching operation.
+
+			Throws:
+				Throws exception if the register machine does not support the
+					operator.
+		******************************************************************************/
+		Operation getOperation(Opcode opcode) const;
+	};
+}
@@ -25,336 +25,961 @@
 	Outline:
 		Public Functions:
 			evaluateEquation
-
-		Private Functions
+			tryEvaluateEquation
+			evaluateBoolEquation
+			tryEvaluateBoolEquation
 			stripValuesFromEquation
+			stripValuesFromEquation
+			tryStripValuesFromEquation
 			convertInfixToPostFix
+			tryConvertInfixToPostFix
+			calcResult
 			calcResult
+			validatePostFix
+			tryValidatePostFix
 			calcResult
-			nextVariable
+			calcResult
+			validateBoolPostFix
+			tryValidateBoolPostFix
+			calcValidatedResult
+			calcOperator
+			formatEquation
+
+		Private Functions
+			tokenize
 			isOperator
+			getOperatorOpcode
 			isLowerPrecedence
 			getPrecedenceLevel
-			getOperandsFromStack
-			getOperandsFromStack
+			isInfixOperator
+			isBoolOperator
+			tryValidate
+			calcValidatedBoolResult
+			isVariableChar
 ******************************************************************************/
 
 #include "reversePolishNotation.h"
 
 namespace day {
 
-	double ReversePolishNotation::evaluateEquation(const char *equation, int length) {
+	struct ReversePolishNotation::TokenWriter {
+
+		vector<double> &values;
+		vector<Token> &tokens;
+
+		void push(Token token, int) {
+
+			tokens.push_back(token);
+		}
+
+		void pushValue(double value, int) {
+
+			tokens.push_back({ Opcode::PUSH_VALUE, (int)values.size() });
+			values.push_back(value);
+		}
+	};
+
+	class ReversePolishNotation::FusedEvaluator {
+
+	private:
+
+		const ReversePolishNotation &rpn;
+		// Both stacks stay on the call stack unless the equation could hold more than FIXED_STACK_DEPTH tokens
+		double fixedOperands[FIXED_STACK_DEPTH];
+		Opcode fixedOperators[FIXED_STACK_DEPTH];
+		double *operands;
+		Opcode *operators;
+		int operandCount;
+		int operatorCount;
+		// The first error convertInfixToPostFix and validatePostFix would have found. Kept until the end so
+		// that an error found by an earlier step of the staged path is still the one reported
+		EquationError closingError;
+		EquationError error;
+	public:
+
+		FusedEvaluator(const ReversePolishNotation &rpn, int length) : rpn(rpn), operandCount(0), operatorCount(0),
+			closingError({ ErrorCode::NONE, -1 }), error({ ErrorCode::NONE, -1 }) {
+
+			// An equation never has more tokens than twice its length
+			if (length * 2 <= FIXED_STACK_DEPTH) {
+
+				operands = fixedOperands;
+				operators = fixedOperators;
+			} else {
+
+				// Longer equations use stacks kept by each thread that only grow, so they are not allocated on every
+				// evaluation. Only one FusedEvaluator is alive at a time on a thread, in tryEvaluateEquation
+				static thread_local vector<double> heapOperands;
+				static thread_local vector<Opcode> heapOperators;
+
+				if (heapOperands.size() < (size_t)length * 2) {
+
+					heapOperands.resize((size_t)length * 2);
+					heapOperators.resize((size_t)length * 2);
+				}
+
+				operands = heapOperands.data();
+				operators = heapOperators.data();
+			}
+		}
+
+		FusedEvaluator(const FusedEvaluator &) = delete;
+		FusedEvaluator &operator=(const FusedEvaluator &) = delete;
+
+		void push(Token token, int position) {
+
+			// convertInfixToPostFix stops at the first ')' without a '(', so nothing after it is evaluated
+			if (closingError.code != ErrorCode::NONE)
+				return;
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VARIABLE:
+
+					// evaluateEquation has no values for variables
+					if (error.code == ErrorCode::NONE)
+						error = { ErrorCode::UNBOUND_VARIABLE, position };
+
+					break;
+				case Opcode::OPENING_PARENTHESIS:
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+
+					operators[operatorCount++] = token.opcode;
+					break;
+				case Opcode::CLOSING_PARENTHESIS:
 
-		// Recreated each time to avoid old invalid data being left from previous invalid equations
-		vector<double> values;
+					// Apply operators until the matching '(' is found
+					while (operatorCount > 0 && operators[operatorCount - 1] != Opcode::OPENING_PARENTHESIS)
+						apply(operators[--operatorCount], position);
+
+					if (operatorCount == 0)
+						closingError = { ErrorCode::TOO_MANY_CLOSING_PARENTHESIS, position };
+					else
+						operatorCount--;
+
+					break;
+				default:
+
+					// Every operator that does not have lower precedence than the current operator is applied first
+					while (operatorCount > 0 && !rpn.isLowerPrecedence(operators[operatorCount - 1], token.opcode))
+						apply(operators[--operatorCount], position);
+
+					operators[operatorCount++] = token.opcode;
+			};
+		}
+
+		void pushValue(double value, int) {
+
+			if (closingError.code == ErrorCode::NONE && error.code == ErrorCode::NONE)
+				operands[operandCount++] = value;
+		}
+
+		EquationError finish(int length, double &result) {
+
+			if (closingError.code != ErrorCode::NONE)
+				return closingError;
+
+			// Allow input to leave off the closing parenthesis at the end
+			while (operatorCount > 0) {
+
+				operatorCount--;
+
+				if (operators[operatorCount] != Opcode::OPENING_PARENTHESIS)
+					apply(operators[operatorCount], length);
+			}
+
+			if (error.code == ErrorCode::NONE && operandCount != 1)
+				error = { ErrorCode::INVALID_EQUATION, length };
+
+			if (error.code == ErrorCode::NONE)
+				result = operands[0];
+
+			return error;
+		}
+	private:
+
+		void apply(Opcode opcode, int position) {
+
+			// Once the equation is known to be invalid only the parenthesis still need to be checked
+			if (error.code != ErrorCode::NONE)
+				return;
+
+			// '!' and unary minus are the only unary operators of an in-fix equation
+			bool isUnary = opcode == Opcode::NOT || opcode == Opcode::NEGATE;
+
+			if (operandCount < (isUnary ? 1 : 2)) {
+
+				error = { ErrorCode::INVALID_EQUATION, position };
+				return;
+			}
+
+			if (isUnary) {
+
+				operands[operandCount - 1] = rpn.calcOperator(opcode, operands[operandCount - 1], 0);
+			} else {
+
+				operandCount--;
+				operands[operandCount - 1] = rpn.calcOperator(opcode, operands[operandCount - 1], operands[operandCount]);
+			}
+		}
+	};
+
+	double ReversePolishNotation::evaluateEquation(const char *equation, int length) const {
+
+		Expected<double> result = tryEvaluateEquation(equation, length);
+
+		if (!result)
+			throw invalid_argument(result.getError().getMessage());
+
+		return result.getValue();
+	}
+
+	Expected<double> ReversePolishNotation::tryEvaluateEquation(const char *equation, int length) const {
+
+		// Names are only kept so that tokenize can give each variable a slot
+		vector<string> variables;
+		FusedEvaluator evaluator(*this, length);
 		double result;
 
-		string editedEquation = stripValuesFromEquation(equation, length, values);
+		EquationError error = tokenize(equation, length, variables, evaluator);
 
-		editedEquation = convertInfixToPostFix(editedEquation.c_str(), editedEquation.size());
+		if (error.code == ErrorCode::NONE)
+			error = evaluator.finish(length, result);
 
-		result = calcResult(editedEquation.c_str(), editedEquation.size(), values);
+		if (error.code != ErrorCode::NONE)
+			return error;
 
 		return result;
 	}
 
-	string ReversePolishNotation::stripValuesFromEquation(const char *equation, int length, vector<double> &values) {
+	bool ReversePolishNotation::evaluateBoolEquation(const char *equation, int length) const {
 
-		if (equation == nullptr)
-			throw invalid_argument("Equation is null");
+		Expected<bool> result = tryEvaluateBoolEquation(equation, length);
 
-		string result = "";
-		int endPos;
+		if (!result)
+			throw invalid_argument(result.getError().getMessage());
 
-		// Counter value to show next available argument
-		int nextArgument = 0;
+		return result.getValue();
+	}
 
-		for (int i = 0; i < length; i++) {
+	Expected<bool> ReversePolishNotation::tryEvaluateBoolEquation(const char *equation, int length) const {
 
-			// Skip whitespace
-			if (isblank(equation[i]))
-				continue;
+		vector<double> numbers;
+		vector<string> variables;
+		vector<Token> infix;
+		vector<Token> postFix;
+		int maxStackDepth;
 
-			// Check whether a minus sign is being used to subtract or to make the number negative
-			if (equation[i] == '-' && (i == 0 || (isOperator(equation[i - 1]) && equation[i - 1] != ')'))) {
+		EquationError error = tryStripValuesFromEquation(equation, length, numbers, variables, infix);
 
-				if (i + 1 == length)
-					throw invalid_argument("Equation is invalid");
+		if (error.code == ErrorCode::NONE)
+			error = tryConvertInfixToPostFix(infix.data(), infix.size(), postFix);
 
-				if (equation[i + 1] == '(') {
+		// evaluateBoolEquation has no values for variables
+		if (error.code == ErrorCode::NONE)
+			error = tryValidateBoolPostFix(postFix.data(), postFix.size(), numbers.size(), 0, maxStackDepth);
 
-					// Multiply result of calculations in parenthesis by -1 to substitute for making the result negative directly
-					result.push_back(DEFAULT_NEGATIVE_ONE_VALUE);
-					result.push_back('*');
-				} else {
+		if (error.code != ErrorCode::NONE)
+			return error;
 
-					// Replace the number in the resulting equation with an argument
-					result.append(DEFAULT_ARG_PREFIX + to_string(nextArgument++));
-					values.push_back(getNumber(equation, length, i, endPos));
+		vector<bool> values(numbers.size());
+		vector<bool> noVariables;
 
-					i = endPos;
-				}
-			} else if (isdigit(equation[i]) || equation[i] == '.') {
+		for (size_t i = 0; i < numbers.size(); i++)
+			values[i] = numbers[i] != 0;
 
-				// Replace the number in the resulting equation with an argument
-				result.append(DEFAULT_ARG_PREFIX + to_string(nextArgument++));
-				values.push_back(getNumber(equation, length, i, endPos));
+		if (maxStackDepth <= FIXED_STACK_DEPTH) {
 
-				i = endPos;
-			// if the equation is in the format of a(b) then it is expanded to a*(b)
-			} else if (equation[i] == '(' && i > 0 && isdigit(equation[i - 1])) {
-
-				result.push_back('*');
-				result.push_back(equation[i]);
-			// if the equation is in the format of (a)b then it is expanded to (a)*b
-			} else if (equation[i] == ')' && i + 1 != length && isdigit(equation[i + 1])) {
+			unsigned char operandStack[FIXED_STACK_DEPTH];
 
-				result.push_back(equation[i]);
-				result.push_back('*');
-			} else
-				result.push_back(equation[i]);
+			return calcValidatedBoolResult(postFix.data(), postFix.size(), values, noVariables, operandStack);
 		}
 
+		vector<unsigned char> operandStack(maxStackDepth);
+
+		return calcValidatedBoolResult(postFix.data(), postFix.size(), values, noVariables, operandStack.data());
+	}
+
+	vector<Token> ReversePolishNotation::stripValuesFromEquation(const char *equation, int length, vector<double> &values) const {
+
+		vector<string> variables;
+
+		return stripValuesFromEquation(equation, length, values, variables);
+	}
+
+	vector<Token> ReversePolishNotation::stripValuesFromEquation(const char *equation, int length, vector<double> &values, vector<string> &variables) const {
+
+		vector<Token> result;
+		EquationError error = tryStripValuesFromEquation(equation, length, values, variables, result);
+
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
+
 		return result;
 	}
 
-	string ReversePolishNotation::convertInfixToPostFix(const char *equation, int length) {
+	EquationError ReversePolishNotation::tryStripValuesFromEquation(const char *equation, int length, vector<double> &values, vector<string> &variables, vector<Token> &result) const {
 
-		if (equation == nullptr)
-			throw invalid_argument("Equation is null");
+		TokenWriter output = { values, result };
 
-		stack<char> operatorStack;
-		string postFixString;
+		// An equation never has more tokens than twice its length, so the result is only allocated once
+		result.clear();
+		result.reserve(length * 2);
 
-		for (int i = 0; i < length; i++) {
+		return tokenize(equation, length, variables, output);
+	}
 
-			// Variables are pushed to the post-fix string
-			if (!isOperator(equation[i])) {
+	vector<Token> ReversePolishNotation::convertInfixToPostFix(const Token *equation, int length) const {
 
-				postFixString += equation[i];
-			} else {
+		vector<Token> result;
+		EquationError error = tryConvertInfixToPostFix(equation, length, result);
 
-				if (operatorStack.size() == 0) {
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
 
-					operatorStack.push(equation[i]);
-				//IF the current operator has lower precedence than the operator on top of the operator stack
-				} else if (isLowerPrecedence(operatorStack.top(), equation[i])) {
+		return result;
+	}
 
-					// IF the current operator is a ')' then pop operators off the stack into the post-fix string
-					//		until the matching '(' is found
-					if (equation[i] == ')') {
+	EquationError ReversePolishNotation::tryConvertInfixToPostFix(const Token *equation, int length, vector<Token> &postFix) const {
 
-						while (operatorStack.top() != '(') {
+		// A blank equation has no tokens, and the data of an empty vector may be null, so it is checked first
+		if (length == 0)
+			return { ErrorCode::INVALID_EQUATION, 0 };
 
-							if (operatorStack.empty())
-								throw invalid_argument("Too many closing parenthesis");
+		if (equation == nullptr)
+			return { ErrorCode::NULL_EQUATION, -1 };
 
-							postFixString += operatorStack.top();
-							operatorStack.pop();
-						}
+		stack<Opcode> operatorStack;
 
-						// Remove '(' from the stack
-						operatorStack.pop();
-					} else {
+		postFix.clear();
+		postFix.reserve(length);
 
-						operatorStack.push(equation[i]);
-					}
-				} else {
+		for (int i = 0; i < length; i++) {
 
-					// '(' always has lowest precedence, but should not be removed until the matching ')' is found
-					if (equation[i] != '(') {
+			Opcode curOperator = equation[i].opcode;
 
-						if (operatorStack.empty())
-							throw invalid_argument("Too many closing parenthesis");
+			// Operands are pushed to the post-fix equation
+			if (curOperator == Opcode::PUSH_VALUE || curOperator == Opcode::PUSH_VARIABLE || curOperator == Opcode::PUSH_NEGATIVE_ONE) {
 
-						postFixString += operatorStack.top();
-						operatorStack.pop();
-					}
+				postFix.push_back(equation[i]);
+			} else if (curOperator == Opcode::OPENING_PARENTHESIS) {
 
-					operatorStack.push(equation[i]);
+				// '(' always has lowest precedence, but should not be removed until the matching ')' is found
+				operatorStack.push(curOperator);
+			} else if (curOperator == Opcode::CLOSING_PARENTHESIS) {
+
+				// Pop operators off the stack into the post-fix equation until the matching '(' is found
+				while (!operatorStack.empty() && operatorStack.top() != Opcode::OPENING_PARENTHESIS) {
+
+					postFix.push_back({ operatorStack.top(), 0 });
+					operatorStack.pop();
 				}
+
+				if (operatorStack.empty())
+					return { ErrorCode::TOO_MANY_CLOSING_PARENTHESIS, i };
+
+				// Remove '(' from the stack
+				operatorStack.pop();
+			} else if (curOperator == Opcode::NOT || curOperator == Opcode::NEGATE) {
+
+				// '!' and unary minus apply to the operand after them, so no operator before them can be evaluated yet
+				operatorStack.push(curOperator);
+			} else if (!isInfixOperator(curOperator)) {
+
+				return { ErrorCode::INVALID_OPERATOR, i };
+			} else {
+
+				// Every operator that does not have lower precedence than the current operator is evaluated first
+				while (!operatorStack.empty() && !isLowerPrecedence(operatorStack.top(), curOperator)) {
+
+					postFix.push_back({ operatorStack.top(), 0 });
+					operatorStack.pop();
+				}
+
+				operatorStack.push(curOperator);
 			}
 		}
 
 		while (!operatorStack.empty()) {
 
 			// Allow input to leave off the closing parenthesis at the end
-			if (operatorStack.top() != '(')
-				postFixString += operatorStack.top();
+			if (operatorStack.top() != Opcode::OPENING_PARENTHESIS)
+				postFix.push_back({ operatorStack.top(), 0 });
 
 			operatorStack.pop();
 		}
 
-		return postFixString;
+		return { ErrorCode::NONE, -1 };
+	}
+
+	double ReversePolishNotation::calcResult(const Token *equation, int length, const vector<double> &values) const {
+
+		vector<double> variables;
+
+		return calcResult(equation, length, values, variables);
 	}
 
-	double ReversePolishNotation::calcResult(const char *equation, int length, vector<double> &values) {
+	double ReversePolishNotation::calcResult(const Token *equation, int length, const vector<double> &values, const vector<double> &variables) const {
 
 		if (equation == nullptr)
 			throw invalid_argument("Equation is null");
 
-		stack<double> operandStack;
 		double result;
-		double num1, num2;
+		int maxStackDepth = validatePostFix(equation, length, values.size(), variables.size());
+
+		if (maxStackDepth <= FIXED_STACK_DEPTH) {
+
+			double operandStack[FIXED_STACK_DEPTH];
+
+			result = calcValidatedResult(equation, length, values.data(), variables.data(), operandStack);
+		} else {
+
+			vector<double> operandStack(maxStackDepth);
+
+			result = calcValidatedResult(equation, length, values.data(), variables.data(), operandStack.data());
+		}
+
+		return result;
+	}
+
+	int ReversePolishNotation::validatePostFix(const Token *equation, int length, int valueCount, int variableCount) const {
+
+		int result;
+		EquationError error = tryValidatePostFix(equation, length, valueCount, variableCount, result);
+
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
+
+		return result;
+	}
+
+	EquationError ReversePolishNotation::tryValidatePostFix(const Token *equation, int length, int valueCount, int variableCount, int &maxStackDepth) const {
+
+		return tryValidate(equation, length, valueCount, variableCount, false, maxStackDepth);
+	}
+
+	bool ReversePolishNotation::calcResult(const Token *equation, int length, const vector<bool> &values) const {
+
+		vector<bool> variables;
+
+		return calcResult(equation, length, values, variables);
+	}
+
+	bool ReversePolishNotation::calcResult(const Token *equation, int length, const vector<bool> &values, const vector<bool> &variables) const {
+
+		if (equation == nullptr)
+			throw invalid_argument("Equation is null");
+
+		bool result;
+		int maxStackDepth = validateBoolPostFix(equation, length, values.size(), variables.size());
+
+		if (maxStackDepth <= FIXED_STACK_DEPTH) {
+
+			unsigned char operandStack[FIXED_STACK_DEPTH];
+
+			result = calcValidatedBoolResult(equation, length, values, variables, operandStack);
+		} else {
+
+			vector<unsigned char> operandStack(maxStackDepth);
+
+			result = calcValidatedBoolResult(equation, length, values, variables, operandStack.data());
+		}
+
+		return result;
+	}
+
+	int ReversePolishNotation::validateBoolPostFix(const Token *equation, int length, int valueCount, int variableCount) const {
+
+		int result;
+		EquationError error = tryValidateBoolPostFix(equation, length, valueCount, variableCount, result);
+
+		if (error.code != ErrorCode::NONE)
+			throw invalid_argument(error.getMessage());
+
+		return result;
+	}
+
+	EquationError ReversePolishNotation::tryValidateBoolPostFix(const Token *equation, int length, int valueCount, int variableCount, int &maxStackDepth) const {
+
+		return tryValidate(equation, length, valueCount, variableCount, true, maxStackDepth);
+	}
+
+	double ReversePolishNotation::calcValidatedResult(const Token *equation, int length, const double *values, const double *variables, double *operandStack) const {
+
+		// Number of operands on the stack, the top operand is operandStack[depth - 1]
+		int depth = 0;
 
 		for (int i = 0; i < length; i++) {
 
-			switch (equation[i]) {
+			switch (equation[i].opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = values[equation[i].index];
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack[depth++] = variables[equation[i].index];
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
 
-				case '+':
+					operandStack[depth++] = -1;
+					break;
+				case Opcode::ADD:
 
 					// Adds operands to each other
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push(num1 + num2);
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] + operandStack[depth];
 					break;
-				case '-':
+				case Opcode::SUBTRACT:
 
 					// Subtracts second operand from the first
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push(num1 - num2);
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] - operandStack[depth];
 					break;
-				case '*':
+				case Opcode::MULTIPLY:
 
 					// Multiplies operands with each other
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push(num1 * num2);
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] * operandStack[depth];
 					break;
-				case '/':
+				case Opcode::DIVIDE:
 
 					// Divides second operand from the first
 					// Handling divide by 0 exception is out of scope
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push(num1 / num2);
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] / operandStack[depth];
 					break;
-				case '%':
+				case Opcode::MODULO:
 
 					// Modulates first operand by the second
 					// Handling divide by 0 exception is out of scope
 					// WARNING: Conversion to integer causes decimal data to be lost
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push((int)num1 % (int)num2);
+					depth--;
+					operandStack[depth - 1] = (int)operandStack[depth - 1] % (int)operandStack[depth];
 					break;
-				case '^':
+				case Opcode::POWER:
 
 					// Sets first operand to the power of the second
-					getOperandsFromStack(operandStack, num1, num2);
-					operandStack.push(pow(num1, num2));
+					depth--;
+					operandStack[depth - 1] = pow(operandStack[depth - 1], operandStack[depth]);
 					break;
-				default:
+				case Opcode::NEGATE:
+
+					operandStack[depth - 1] = -operandStack[depth - 1];
+					break;
+				case Opcode::POWER_INTEGER:
+
+					operandStack[depth - 1] = calcOperator(Opcode::POWER_INTEGER, operandStack[depth - 1], equation[i].index);
+					break;
+				case Opcode::SQUARE_ROOT:
+
+					operandStack[depth - 1] = sqrt(operandStack[depth - 1]);
+					break;
+				case Opcode::MODULO_POWER_OF_TWO: {
+
+					// Same as '%' without a divide, the remainder keeps the sign of the first operand
+					int num1 = (int)operandStack[depth - 1];
+					int mask = equation[i].index - 1;
+					int bias = (num1 >> 31) & mask;
 
-					if (equation[i] == DEFAULT_NEGATIVE_ONE_VALUE) {
+					operandStack[depth - 1] = ((num1 + bias) & mask) - bias;
+					break;
+				}
+				case Opcode::NOT:
+
+					operandStack[depth - 1] = operandStack[depth - 1] == 0;
+					break;
+				case Opcode::AND:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] != 0 && operandStack[depth] != 0;
+					break;
+				case Opcode::OR:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] != 0 || operandStack[depth] != 0;
+					break;
+				case Opcode::EQUAL:
 
-						operandStack.push(-1);
-					} else if (equation[i] == DEFAULT_ARG_PREFIX) {
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] == operandStack[depth];
+					break;
+				case Opcode::NOT_EQUAL:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] != operandStack[depth];
+					break;
+				case Opcode::LESS:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] < operandStack[depth];
+					break;
+				case Opcode::LESS_EQUAL:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] <= operandStack[depth];
+					break;
+				case Opcode::GREATER:
 
-						int argumentNum = (int)getNumber(equation, length, i + 1, i);
-						operandStack.push(values[argumentNum]);
-					} else throw invalid_argument("Equation is invalid");
-					//// Convert letter to the number it represents and add it to the operand stack
-					//if (equation[i] >= (double)'a' && equation[i] <= (double)'z')
-					//	operandStack.push(values[equation[i] - 'a']);
-					//else if (equation[i] >= (double)'A' && equation[i] <= (double)'Z')
-					//	operandStack.push(values[equation[i] - 'A' + 26]);
-					//else throw invalid_argument("Equation is too long");
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] > operandStack[depth];
+					break;
+				case Opcode::GREATER_EQUAL:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] >= operandStack[depth];
+					break;
+				default:
+
+					// Any other opcode was rejected by validatePostFix
+					break;
 			};
 		}
 
-		result = operandStack.top();
-		operandStack.pop();
+		return operandStack[0];
+	}
+
+	double ReversePolishNotation::calcOperator(Opcode opcode, double num1, double num2) const {
+
+		double result;
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				result = num1 + num2;
+				break;
+			case Opcode::SUBTRACT:
+
+				result = num1 - num2;
+				break;
+			case Opcode::MULTIPLY:
+
+				result = num1 * num2;
+				break;
+			case Opcode::DIVIDE:
+
+				result = num1 / num2;
+				break;
+			case Opcode::MODULO:
+
+				// WARNING: Conversion to integer causes decimal data to be lost
+				result = (int)num1 % (int)num2;
+				break;
+			case Opcode::POWER:
+
+				result = pow(num1, num2);
+				break;
+			case Opcode::NEGATE:
+
+				result = -num1;
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				// Exponentiation by squaring, a negative power is the reciprocal of the positive one
+				unsigned int exponent = num2 < 0 ? 0u - (unsigned int)(int)num2 : (unsigned int)num2;
+				double base = num1;
+
+				result = 1;
+
+				for (; exponent != 0; exponent >>= 1) {
+
+					if (exponent & 1)
+						result *= base;
+
+					if (exponent > 1)
+						base *= base;
+				}
+
+				if (num2 < 0)
+					result = 1 / result;
+
+				break;
+			}
+			case Opcode::SQUARE_ROOT:
+
+				result = sqrt(num1);
+				break;
+			case Opcode::MODULO_POWER_OF_TWO: {
+
+				int mask = (int)num2 - 1;
+				int bias = ((int)num1 >> 31) & mask;
+
+				result = (((int)num1 + bias) & mask) - bias;
+				break;
+			}
+			case Opcode::NOT:
+
+				result = num1 == 0;
+				break;
+			case Opcode::AND:
+
+				result = num1 != 0 && num2 != 0;
+				break;
+			case Opcode::OR:
+
+				result = num1 != 0 || num2 != 0;
+				break;
+			case Opcode::EQUAL:
+
+				result = num1 == num2;
+				break;
+			case Opcode::NOT_EQUAL:
+
+				result = num1 != num2;
+				break;
+			case Opcode::LESS:
+
+				result = num1 < num2;
+				break;
+			case Opcode::LESS_EQUAL:
+
+				result = num1 <= num2;
+				break;
+			case Opcode::GREATER:
+
+				result = num1 > num2;
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				result = num1 >= num2;
+				break;
+			default:
 
-		if (!operandStack.empty())
-			throw invalid_argument("Equation is invalid");
+				throw invalid_argument("Opcode is not an operator");
+		};
 
 		return result;
 	}
 
-	bool ReversePolishNotation::calcResult(const char *equation, int length, vector<bool> &values) {
-
-		if (equation == nullptr)
-			throw invalid_argument("Equation is null");
+	string ReversePolishNotation::formatEquation(const Token *equation, int length, const vector<double> &values, const vector<string> &variables) const {
 
-		stack<bool> operandStack;
-		bool result;
-		bool bool1, bool2;
+		ostringstream result;
 
 		for (int i = 0; i < length; i++) {
 
-			switch (equation[i]) {
+			if (i > 0)
+				result << ' ';
 
-				case '!':
+			switch (equation[i].opcode) {
 
-					// Get boolean off top of the stack and NOT it
-					bool1 = operandStack.top();
-					operandStack.pop();
-					operandStack.push(!bool1);
+				case Opcode::PUSH_VALUE:
+
+					result << values[equation[i].index];
 					break;
-				case '&':
+				case Opcode::PUSH_VARIABLE:
 
-					// Confirm if both the first operand and the second operand are true
-					getOperandsFromStack(operandStack, bool1, bool2);
-					operandStack.push(bool1 && bool2);
+					result << variables[equation[i].index];
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
 
+					result << "-1";
 					break;
-				case '|':
+				case Opcode::ADD:
 
-					// Confirm if either the first operand or the second operand are true
-					getOperandsFromStack(operandStack, bool1, bool2);
-					operandStack.push(bool1 || bool2);
+					result << '+';
+					break;
+				case Opcode::SUBTRACT:
 
+					result << '-';
 					break;
-				case '=':
+				case Opcode::MULTIPLY:
 
-					// Confirm if the first operand equals the second operand
-					getOperandsFromStack(operandStack, bool1, bool2);
-					operandStack.push(bool1 == bool2);
+					result << '*';
+					break;
+				case Opcode::DIVIDE:
 
+					result << '/';
 					break;
-				default:
+				case Opcode::MODULO:
 
-					if (equation[i] == DEFAULT_ARG_PREFIX) {
+					result << '%';
+					break;
+				case Opcode::POWER:
 
-						int argumentNum = (int)getNumber(equation, length, i + 1, i);
-						operandStack.push(values[argumentNum]);
-					}
-					// Convert argument to the boolean it represents and add it to the operand stack
-			/*		if (equation[i] >= 'a' && equation[i] <= 'z')
-						operandStack.push(values[equation[i] - 'a']);
-					else if (equation[i] >= 'A' && equation[i] <= 'Z')
-						operandStack.push(values[equation[i] - 'A' + 26]);*/
+					result << '^';
+					break;
+				case Opcode::NEGATE:
+
+					result << "neg";
+					break;
+				case Opcode::POWER_INTEGER:
+
+					result << '^' << equation[i].index;
+					break;
+				case Opcode::SQUARE_ROOT:
+
+					result << "sqrt";
+					break;
+				case Opcode::MODULO_POWER_OF_TWO:
+
+					result << '%' << equation[i].index;
+					break;
+				case Opcode::NOT:
+
+					result << '!';
+					break;
+				case Opcode::AND:
+
+					result << '&';
+					break;
+				case Opcode::OR:
+
+					result << '|';
+					break;
+				case Opcode::EQUAL:
+
+					result << '=';
+					break;
+				case Opcode::NOT_EQUAL:
+
+					result << "!=";
+					break;
+				case Opcode::LESS:
+
+					result << '<';
+					break;
+				case Opcode::LESS_EQUAL:
+
+					result << "<=";
+					break;
+				case Opcode::GREATER:
+
+					result << '>';
+					break;
+				case Opcode::GREATER_EQUAL:
+
+					result << ">=";
+					break;
+				case Opcode::OPENING_PARENTHESIS:
+
+					result << '(';
+					break;
+				case Opcode::CLOSING_PARENTHESIS:
+
+					result << ')';
+					break;
 			};
 		}
 
-		result = operandStack.top();
-		operandStack.pop();
+		return result.str();
+	}
 
-		if (!operandStack.empty())
-			throw invalid_argument("Equation is invalid");
+	template <typename Output>
+	EquationError ReversePolishNotation::tokenize(const char *equation, int length, vector<string> &variables, Output &output) const {
 
-		return result;
-	}
+		if (equation == nullptr)
+			return { ErrorCode::NULL_EQUATION, -1 };
 
-	char ReversePolishNotation::nextVariable(int &nextArgument) {
+		int endPos;
+		double number;
+		// Location of the last char before and the first char after the current one that is not whitespace
+		int previous = -1;
+		int next;
 
-		char result;
+		for (int i = 0; i < length; i++) {
 
-		if ('a' + nextArgument <= 'z')
-			result = 'a' + nextArgument;
-		else if ('A' + nextArgument - 26 <= 'Z')
-			result = 'A' + nextArgument - 26;
-		else
-			throw invalid_argument("Equation is too long");
+			// Skip whitespace
+			if (isblank(equation[i]))
+				continue;
 
-		nextArgument++;
+			next = i + 1;
 
-		return result;
+			while (next < length && isblank(equation[next]))
+				next++;
+
+			// Check whether a minus sign is being used to subtract or to make the number negative
+			if (equation[i] == '-' && (previous == -1 || (isOperator(equation[previous]) && equation[previous] != ')'))) {
+
+				if (next == length)
+					return { ErrorCode::INVALID_EQUATION, i };
+
+				if (equation[next] == '(' || (isVariableChar(equation[next]) && !isdigit(equation[next]))) {
+
+					// Negate the result of calculations in parenthesis or the variable, which binds tighter than every operator but '^'
+					output.push({ Opcode::NEGATE, 0 }, i);
+				} else {
+
+					if (!parseNumber(equation, length, next, endPos, number))
+						return { ErrorCode::MALFORMED_NUMBER, endPos };
+
+					// Replace the number in the resulting equation with a token
+					output.pushValue(-number, i);
+
+					i = endPos;
+				}
+			} else if (isdigit(equation[i]) || equation[i] == '.') {
+
+				if (!parseNumber(equation, length, i, endPos, number))
+					return { ErrorCode::MALFORMED_NUMBER, endPos };
+
+				// Replace the number in the resulting equation with a token
+				output.pushValue(number, i);
+
+				i = endPos;
+			} else if (isalpha(equation[i]) || equation[i] == '_') {
+
+				// if the equation is in the format of 2x then it is expanded to 2*x
+				if (previous != -1 && (isdigit(equation[previous]) || equation[previous] == '.'))
+					output.push({ Opcode::MULTIPLY, 0 }, i);
+
+				endPos = i;
+
+				while (endPos + 1 < length && isVariableChar(equation[endPos + 1]))
+					endPos++;
+
+				int nameLength = endPos - i + 1;
+				int slot = 0;
+
+				// Variables used more than once share the same slot. Compared in place so only new names are copied
+				while (slot < (int)variables.size() && variables[slot].compare(0, string::npos, equation + i, nameLength) != 0)
+					slot++;
+
+				if (slot == (int)variables.size())
+					variables.emplace_back(equation + i, nameLength);
+
+				// Replace the variable in the resulting equation with a token
+				output.push({ Opcode::PUSH_VARIABLE, slot }, i);
+
+				i = endPos;
+			// if the equation is in the format of a(b) then it is expanded to a*(b)
+			} else if (equation[i] == '(' && previous != -1 && isVariableChar(equation[previous])) {
+
+				output.push({ Opcode::MULTIPLY, 0 }, i);
+				output.push({ Opcode::OPENING_PARENTHESIS, 0 }, i);
+			// if the equation is in the format of (a)b then it is expanded to (a)*b
+			} else if (equation[i] == ')' && next != length && isVariableChar(equation[next])) {
+
+				output.push({ Opcode::CLOSING_PARENTHESIS, 0 }, i);
+				output.push({ Opcode::MULTIPLY, 0 }, i);
+			// '<=', '>=' and '!=' are a single operator when nothing separates the two chars
+			} else if ((equation[i] == '<' || equation[i] == '>' || equation[i] == '!') && i + 1 < length && equation[i + 1] == '=') {
+
+				if (equation[i] == '<')
+					output.push({ Opcode::LESS_EQUAL, 0 }, i);
+				else if (equation[i] == '>')
+					output.push({ Opcode::GREATER_EQUAL, 0 }, i);
+				else
+					output.push({ Opcode::NOT_EQUAL, 0 }, i);
+
+				i++;
+			} else if (isOperator(equation[i]))
+				output.push({ getOperatorOpcode(equation[i]), 0 }, i);
+			else
+				return { ErrorCode::UNEXPECTED_CHARACTER, i };
+
+			previous = i;
+		}
+
+		return { ErrorCode::NONE, -1 };
 	}
 
-	bool ReversePolishNotation::isOperator(char value) {
+	bool ReversePolishNotation::isOperator(char value) const {
 
 		bool result = false;
 
-		// TODO: Add support for bool operators
-
 		switch (value) {
 
 			case '(':
@@ -362,8 +987,15 @@ namespace day {
 			case '^':
 			case '*':
 			case '/':
+			case '%':
 			case '+':
 			case '-':
+			case '!':
+			case '&':
+			case '|':
+			case '=':
+			case '<':
+			case '>':
 
 				result = true;
 		};
@@ -371,7 +1003,77 @@ namespace day {
 		return result;
 	}
 
-	bool ReversePolishNotation::isLowerPrecedence(char firstOperator, char secondOperator) {
+	Opcode ReversePolishNotation::getOperatorOpcode(char value) const {
+
+		Opcode result;
+
+		switch (value) {
+
+			case '(':
+
+				result = Opcode::OPENING_PARENTHESIS;
+				break;
+			case ')':
+
+				result = Opcode::CLOSING_PARENTHESIS;
+				break;
+			case '^':
+
+				result = Opcode::POWER;
+				break;
+			case '*':
+
+				result = Opcode::MULTIPLY;
+				break;
+			case '/':
+
+				result = Opcode::DIVIDE;
+				break;
+			case '%':
+
+				result = Opcode::MODULO;
+				break;
+			case '+':
+
+				result = Opcode::ADD;
+				break;
+			case '-':
+
+				result = Opcode::SUBTRACT;
+				break;
+			case '!':
+
+				result = Opcode::NOT;
+				break;
+			case '&':
+
+				result = Opcode::AND;
+				break;
+			case '|':
+
+				result = Opcode::OR;
+				break;
+			case '=':
+
+				result = Opcode::EQUAL;
+				break;
+			case '<':
+
+				result = Opcode::LESS;
+				break;
+			case '>':
+
+				result = Opcode::GREATER;
+				break;
+			default:
+
+				throw invalid_argument("Equation is invalid");
+		};
+
+		return result;
+	}
+
+	bool ReversePolishNotation::isLowerPrecedence(Opcode firstOperator, Opcode secondOperator) const {
 
 		bool result;
 		precedenceLevel firstPrecedenceLevel, secondPrecedenceLevel;
@@ -387,62 +1089,242 @@ namespace day {
 		return result;
 	}
 
-	ReversePolishNotation::precedenceLevel ReversePolishNotation::getPrecedenceLevel(char curOperator) {
+	ReversePolishNotation::precedenceLevel ReversePolishNotation::getPrecedenceLevel(Opcode curOperator) const {
 
 		precedenceLevel result;
 
 		switch (curOperator) {
 
-			case '(':
+			case Opcode::OPENING_PARENTHESIS:
 
 				result = OPENING_PARENTHESIS;
 				break;
-			case '+':
-			case '-':
+			case Opcode::OR:
+
+				result = OR;
+				break;
+			case Opcode::AND:
+
+				result = AND;
+				break;
+			case Opcode::EQUAL:
+			case Opcode::NOT_EQUAL:
+
+				result = EQUAL;
+				break;
+			case Opcode::LESS:
+			case Opcode::LESS_EQUAL:
+			case Opcode::GREATER:
+			case Opcode::GREATER_EQUAL:
+
+				result = COMPARE;
+				break;
+			case Opcode::ADD:
+			case Opcode::SUBTRACT:
 
 				result = ADD_SUB;
 				break;
-			case '*':
-			case '/':
-			case '%':
+			case Opcode::MULTIPLY:
+			case Opcode::DIVIDE:
+			case Opcode::MODULO:
 
 				result = MUL_DIV_MOD;
 				break;
-			case '^':
+			case Opcode::NEGATE:
+
+				result = NEGATE;
+				break;
+			case Opcode::POWER:
 
 				result = EXP;
 				break;
-			case ')':
+			case Opcode::NOT:
+
+				result = NOT;
+				break;
+			case Opcode::CLOSING_PARENTHESIS:
 
 				result = CLOSING_PARENTHESIS;
 				break;
 			default:
 
-				throw invalid_argument(curOperator + "is not a valid operator");
+				throw invalid_argument("Opcode is not a valid operator");
+		};
+
+		return result;
+	}
+
+	bool ReversePolishNotation::isInfixOperator(Opcode curOperator) const {
+
+		bool result = false;
+
+		switch (curOperator) {
+
+			case Opcode::ADD:
+			case Opcode::SUBTRACT:
+			case Opcode::MULTIPLY:
+			case Opcode::DIVIDE:
+			case Opcode::MODULO:
+			case Opcode::POWER:
+			case Opcode::AND:
+			case Opcode::OR:
+			case Opcode::EQUAL:
+			case Opcode::NOT_EQUAL:
+			case Opcode::LESS:
+			case Opcode::LESS_EQUAL:
+			case Opcode::GREATER:
+			case Opcode::GREATER_EQUAL:
+
+				result = true;
+				break;
+			default:
+
+				break;
 		};
 
 		return result;
 	}
 
-	void ReversePolishNotation::getOperandsFromStack(stack<double> &operandStack, double &value1, double &value2) {
+	bool ReversePolishNotation::isBoolOperator(Opcode curOperator) const {
 
-		if (operandStack.size() < 2)
-			throw invalid_argument("Equation is invalid");
+		return curOperator == Opcode::NOT || curOperator == Opcode::AND || curOperator == Opcode::OR || curOperator == Opcode::EQUAL
+			|| curOperator == Opcode::NOT_EQUAL;
+	}
+
+	EquationError ReversePolishNotation::tryValidate(const Token *equation, int length, int valueCount, int variableCount, bool isBool, int &maxStackDepth) const {
+
+		// An empty equation is left to the check of the operand count at the end, since its data may be null
+		if (equation == nullptr && length != 0)
+			return { ErrorCode::NULL_EQUATION, -1 };
+
+		int depth = 0;
+
+		maxStackDepth = 0;
+
+		for (int i = 0; i < length; i++) {
+
+			switch (equation[i].opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					if (equation[i].index < 0 || equation[i].index >= valueCount)
+						return { ErrorCode::INVALID_EQUATION, i };
+
+					depth++;
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					if (equation[i].index < 0 || equation[i].index >= variableCount)
+						return { ErrorCode::UNBOUND_VARIABLE, i };
+
+					depth++;
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					// Never written for a bool equation, which has no negative numbers
+					if (isBool)
+						return { ErrorCode::INVALID_OPERATOR, i };
+
+					depth++;
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER:
+				case Opcode::SQUARE_ROOT:
+				case Opcode::MODULO_POWER_OF_TWO:
+
+					if (isBool && !isBoolOperator(equation[i].opcode))
+						return { ErrorCode::INVALID_OPERATOR, i };
+
+					// Unary operators replace the operand on top of the stack
+					if (depth < 1)
+						return { ErrorCode::INVALID_EQUATION, i };
+
+					break;
+				case Opcode::OPENING_PARENTHESIS:
+				case Opcode::CLOSING_PARENTHESIS:
+
+					return { ErrorCode::INVALID_EQUATION, i };
+				default:
+
+					if (isBool && !isBoolOperator(equation[i].opcode))
+						return { ErrorCode::INVALID_OPERATOR, i };
+
+					// Binary operators replace the top two operands with their result
+					if (depth < 2)
+						return { ErrorCode::INVALID_EQUATION, i };
+
+					depth--;
+			};
+
+			if (depth > maxStackDepth)
+				maxStackDepth = depth;
+		}
+
+		if (depth != 1)
+			return { ErrorCode::INVALID_EQUATION, length };
 
-		value2 = operandStack.top();
-		operandStack.pop();
-		value1 = operandStack.top();
-		operandStack.pop();
+		return { ErrorCode::NONE, -1 };
 	}
 
-	void ReversePolishNotation::getOperandsFromStack(stack<bool> &operandStack, bool &value1, bool &value2) {
+	bool ReversePolishNotation::calcValidatedBoolResult(const Token *equation, int length, const vector<bool> &values, const vector<bool> &variables, unsigned char *operandStack) const {
+
+		// Number of operands on the stack, the top operand is operandStack[depth - 1]
+		int depth = 0;
+
+		for (int i = 0; i < length; i++) {
+
+			switch (equation[i].opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					// Convert argument to the boolean it represents and add it to the operand stack
+					operandStack[depth++] = values[equation[i].index];
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack[depth++] = variables[equation[i].index];
+					break;
+				case Opcode::NOT:
+
+					// Get boolean off top of the stack and NOT it
+					operandStack[depth - 1] = !operandStack[depth - 1];
+					break;
+				case Opcode::AND:
+
+					// Confirm if both the first operand and the second operand are true
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] && operandStack[depth];
+					break;
+				case Opcode::OR:
+
+					// Confirm if either the first operand or the second operand are true
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] || operandStack[depth];
+					break;
+				case Opcode::EQUAL:
+
+					// Confirm if the first operand equals the second operand
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] == operandStack[depth];
+					break;
+				case Opcode::NOT_EQUAL:
+
+					depth--;
+					operandStack[depth - 1] = operandStack[depth - 1] != operandStack[depth];
+					break;
+				default:
+
+					// Any other opcode was rejected by validateBoolPostFix
+					break;
+			};
+		}
+
+		return operandStack[0];
+	}
 
-		if (operandStack.size() < 2)
-			throw invalid_argument("Equation is invalid");
+	bool ReversePolishNotation::isVariableChar(char value) const {
 
-		value2 = operandStack.top();
-		operandStack.pop();
-		value1 = operandStack.top();
-		operandStack.pop();
+		return isalnum(value) || value == '_';
 	}
 }
\ No newline at end of file
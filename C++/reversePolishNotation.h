@@ -25,21 +25,68 @@
 		Converts a mathematical equation from in-fix notation to post-fix
 		notation then solves for the answer.
 
+		evaluateEquation solves the equation in a single pass over the text.
+		Operators are applied as soon as the shunting-yard algorithm would have
+		written them to the post-fix equation, so neither the in-fix tokens nor
+		the post-fix equation are ever stored. It accepts the same equations and
+		gives the same answers and errors as stripValuesFromEquation,
+		convertInfixToPostFix and calcResult called one after the other.
+
+		Each step that can reject an equation has a try version that returns an
+		EquationError instead of throwing, for callers where invalid equations
+		are common and an exception per rejected equation is too expensive. The
+		throwing versions call them and throw the message of the error.
+
+		Arithmetic equations may also compare numbers with '<', '>', '<=',
+		'>=', '=' and '!=' and join the comparisons with '!', '&' and '|', e.g.
+		(a*b) > 100 & c != 0. Comparisons and bool operators give 1 or 0, and
+		numbers are true when they are not 0. All of them bind looser than the
+		arithmetic operators except '!', which applies to the operand after it
+		and binds tightest. Then come '<', '>', '<=' and '>=', then '=' and
+		'!=', then '&' and lowest '|'.
+
+		Bool equations use the same steps with only '!', '&', '|', '=' and '!='.
+		Every number is converted to a bool before it is used, so 2 = 3 is true
+		in a bool equation and 0 in an arithmetic one. validateBoolPostFix
+		rejects the arithmetic operators and the comparisons.
+
+		The class keeps no state between calls, so every function is
+		reentrant and a single instance may be used by many threads at once.
+
 	Outline:
 		Public Functions:
 			evaluateEquation
-
-		Private Functions
+			tryEvaluateEquation
+			evaluateBoolEquation
+			tryEvaluateBoolEquation
+			stripValuesFromequation
 			stripValuesFromequation
+			tryStripValuesFromEquation
 			convertInfixToPostFix
+			tryConvertInfixToPostFix
 			calcResult
 			calcResult
-			nextVariable
+			validatePostFix
+			tryValidatePostFix
+			calcResult
+			calcResult
+			validateBoolPostFix
+			tryValidateBoolPostFix
+			calcValidatedResult
+			calcOperator
+			formatEquation
+
+		Private Functions
+			tokenize
 			isOperator
+			getOperatorOpcode
 			isLowerPrecedence
 			getPrecedenceLevel
-			getOperandsFromStack
-			getOperandsFromStack
+			isInfixOperator
+			isBoolOperator
+			tryValidate
+			calcValidatedBoolResult
+			isVariableChar
 ******************************************************************************/
 
 #pragma once
@@ -47,20 +94,26 @@
 #include <string>
 #include <cctype>
 #include <stack>
-#include <queue>
 #include <vector>
 #include <cmath>
+#include <sstream>
 #include <stdexcept>
 
+#include "equationError.h"
+#include "expected.h"
 #include "stringUtils.h"
+#include "token.h"
 
 using std::string;
 using std::stack;
 using std::vector;
+using std::ostringstream;
 using std::invalid_argument;
 using std::pow;
+using std::sqrt;
 using std::to_string;
 using std::isalpha;
+using std::isalnum;
 using std::isblank;
 
 namespace day {
@@ -69,14 +122,19 @@ namespace day {
 
 	private:
 
-		enum precedenceLevel { OPENING_PARENTHESIS, ADD_SUB, MUL_DIV_MOD, EXP, CLOSING_PARENTHESIS };
+		enum precedenceLevel { OPENING_PARENTHESIS, OR, AND, EQUAL, COMPARE, ADD_SUB, MUL_DIV_MOD, NEGATE, EXP, NOT, CLOSING_PARENTHESIS };
 
-		// Generic replacement prefix for values in equation
-		const char DEFAULT_ARG_PREFIX = '`';
-		// Default slot for inserted -1 values
-		const char DEFAULT_NEGATIVE_ONE_VALUE = '~';
+		// Receives the tokens of tokenize as a list of in-fix tokens and values, used by stripValuesFromEquation
+		struct TokenWriter;
+		// Receives the tokens of tokenize and evaluates them as they arrive with an operator and an operand
+		// stack, used by evaluateEquation
+		class FusedEvaluator;
 	public:
 
+		// Operand stacks up to this depth are kept on the call stack instead of the heap
+		static const int FIXED_STACK_DEPTH = 64;
+
+
 		/******************************************************************************
 			Function Name: evaluateEquation
 
@@ -90,28 +148,131 @@ namespace day {
 			Returns:
 				type double, the answer to the equation
 		******************************************************************************/
-		double evaluateEquation(const char *equation, int length);
+		double evaluateEquation(const char *equation, int length) const;
+
+		/******************************************************************************
+			Function Name: tryEvaluateEquation
+
+			Des:
+				Evaluates the equation to find the answer without throwing if the
+					equation is invalid.
+
+			Params:
+				equation - type const char *, the equation to be evaluated
+				length - type int, the length of the param equation.
+
+			Returns:
+				type Expected<double>, the answer to the equation, or the reason the
+					equation is invalid with the position of the char it was found at.
+		******************************************************************************/
+		Expected<double> tryEvaluateEquation(const char *equation, int length) const;
+
+		/******************************************************************************
+			Function Name: evaluateBoolEquation
+
+			Des:
+				Evaluates the bool equation to find the answer.
+
+			Params:
+				equation - type const char *, the bool equation to be evaluated.
+					Example input: 1 | !0 & 0.
+				length - type int, the length of the param equation.
+
+			Returns:
+				type bool, the answer to the equation
+
+			Throws:
+				Throws exception if the equation is invalid.
+		******************************************************************************/
+		bool evaluateBoolEquation(const char *equation, int length) const;
+
+		/******************************************************************************
+			Function Name: tryEvaluateBoolEquation
+
+			Des:
+				Evaluates the bool equation to find the answer without throwing if
+					the equation is invalid.
+
+			Params:
+				equation - type const char *, the bool equation to be evaluated.
+				length - type int, the length of the param equation.
+
+			Returns:
+				type Expected<bool>, the answer to the equation, or the reason the
+					equation is invalid.
+		******************************************************************************/
+		Expected<bool> tryEvaluateBoolEquation(const char *equation, int length) const;
+
+		/******************************************************************************
+			Function Name: stripValuesFromEquation
+
+			Des:
+				Strips values from the equation and replaces them with tokens
+
+			Params:
+				equation - type const char *, the data the number is to be
+					extracted from.
+				length - type int, the length of the param equation.
+				values - type vector<double> &, output vector containing all values
+					corresponding to the PUSH_VALUE tokens in the result.
+
+			Returns:
+				type vector<Token>, the equation as tokens in in-fix order
+
+			Throws:
+				Throws exception if the equation is invalid.
+		******************************************************************************/
+		vector<Token> stripValuesFromEquation(const char *equation, int length, vector<double> &values) const;
 
 		/******************************************************************************
 			Function Name: stripValuesFromEquation
 
 			Des:
-				Strips values from the equation and replaces them with letters
+				Strips values and named variables from the equation and replaces them
+					with tokens. Variables are names made up of letters, digits and
+					'_' that do not start with a digit, e.g. price*qty-fee.
 
 			Params:
 				equation - type const char *, the data the number is to be
 					extracted from.
 				length - type int, the length of the param equation.
 				values - type vector<double> &, output vector containing all values
-					corresponding to the letters in param equation.
+					corresponding to the PUSH_VALUE tokens in the result.
+				variables - type vector<string> &, output vector containing the name
+					of each variable in the order of their slots. A variable used more
+					than once shares a single slot.
 
 			Returns:
-				type string, the equation with all values replaced with letters
+				type vector<Token>, the equation as tokens in in-fix order
 
 			Throws:
 				Throws exception if the equation is invalid.
 		******************************************************************************/
-		string stripValuesFromEquation(const char *equation, int length, vector<double> &values);
+		vector<Token> stripValuesFromEquation(const char *equation, int length, vector<double> &values, vector<string> &variables) const;
+
+		/******************************************************************************
+			Function Name: tryStripValuesFromEquation
+
+			Des:
+				Same as stripValuesFromEquation, but returns the error instead of
+					throwing it.
+
+			Params:
+				equation - type const char *, the data the number is to be
+					extracted from.
+				length - type int, the length of the param equation.
+				values - type vector<double> &, output vector containing all values
+					corresponding to the PUSH_VALUE tokens in the result.
+				variables - type vector<string> &, output vector containing the name
+					of each variable in the order of their slots.
+				result - type vector<Token> &, output vector containing the equation
+					as tokens in in-fix order. Its capacity is reused.
+
+			Returns:
+				type EquationError, the error with the position of the char it was
+					found at, ErrorCode::NONE if the equation was stripped.
+		******************************************************************************/
+		EquationError tryStripValuesFromEquation(const char *equation, int length, vector<double> &values, vector<string> &variables, vector<Token> &result) const;
 
 		/******************************************************************************
 			Function Name: convertInfixToPostFix
@@ -121,19 +282,39 @@ namespace day {
 					post-fix notation.
 
 			Params:
-				equation - type const char *, the list of operands and operators
-					sorted in postfix notation. All bool's are expected to have been
-					replaced with letters. Case matters so 'A' is not equal to 'a.'
-					Example input: (A+B)*C.
+				equation - type const Token *, the list of operands and operators
+					in in-fix order, as returned by stripValuesFromEquation.
 				length - type int, the length of the param equation.
 
 			Returns:
-				type string, the in-fix equation converted to post-fix.
+				type vector<Token>, the in-fix equation converted to post-fix.
 
 			Throws:
 				Throws exception if the equation is invalid.
 		******************************************************************************/
-		string convertInfixToPostFix(const char *equation, int length);
+		vector<Token> convertInfixToPostFix(const Token *equation, int length) const;
+
+		/******************************************************************************
+			Function Name: tryConvertInfixToPostFix
+
+			Des:
+				Same as convertInfixToPostFix, but returns the error instead of
+					throwing it.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					in in-fix order, as returned by stripValuesFromEquation.
+				length - type int, the length of the param equation.
+				postFix - type vector<Token> &, output vector containing the in-fix
+					equation converted to post-fix. Its capacity is reused.
+
+			Returns:
+				type EquationError, the error with the index of the token it was
+					found at, ErrorCode::NONE if the equation was converted. An
+					empty list is ErrorCode::INVALID_EQUATION like a blank equation
+					in evaluateEquation, even when param equation is null.
+		******************************************************************************/
+		EquationError tryConvertInfixToPostFix(const Token *equation, int length, vector<Token> &postFix) const;
 
 		/******************************************************************************
 			Function Name: calcResult
@@ -142,13 +323,11 @@ namespace day {
 				Calculates the result of the equation used with the values.
 
 			Params:
-				equation - type const char *, the list of operands and operators
-					sorted in postfix notation. All bool's are expected to have been
-					replaced with letters. Case matters so 'A' is not equal to 'a.'
-					Example input: AB+c*.
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
 				length - type int, the length of the param equation.
-				values - type double [], array containing all values corresponding
-					to the letters in param equation.
+				values - type const vector<double> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
 
 			Returns:
 				type double, result of the equation.
@@ -156,24 +335,97 @@ namespace day {
 			Throws:
 				Throws exception if the equation is unsolvable.
 		******************************************************************************/
-		double calcResult(const char *equation, int length, vector<double> &values);
+		double calcResult(const Token *equation, int length, const vector<double> &values) const;
 
-	private:
+		/******************************************************************************
+			Function Name: calcResult
+
+			Des:
+				Calculates the result of the equation used with the values and the
+					values bound to its variables.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation, as returned by convertInfixToPostFix.
+				length - type int, the length of the param equation.
+				values - type const vector<double> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
+				variables - type const vector<double> &, array containing the value
+					bound to each variable slot in param equation.
+
+			Returns:
+				type double, result of the equation.
+
+			Throws:
+				Throws exception if the equation is unsolvable or uses a variable that
+					has no value bound to it.
+		******************************************************************************/
+		double calcResult(const Token *equation, int length, const vector<double> &values, const vector<double> &variables) const;
+
+		/******************************************************************************
+			Function Name: validatePostFix
+
+			Des:
+				Checks that a post-fix equation can be solved and works out the
+					maximum number of operands that are on the stack at once. Done
+					once so that calcValidatedResult does not need any checks. Every
+					operator is accepted, the comparisons and bool operators give 1
+					or 0.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				valueCount - type int, the number of values the PUSH_VALUE tokens in
+					param equation can refer to.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+
+			Returns:
+				type int, the maximum depth of the operand stack.
+
+			Throws:
+				Throws exception if the equation is unsolvable or refers to a value or
+					variable that does not exist.
+		******************************************************************************/
+		int validatePostFix(const Token *equation, int length, int valueCount, int variableCount) const;
+
+		/******************************************************************************
+			Function Name: tryValidatePostFix
+
+			Des:
+				Same as validatePostFix, but returns the error instead of throwing it.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				valueCount - type int, the number of values the PUSH_VALUE tokens in
+					param equation can refer to.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+				maxStackDepth - type int &, output to return the maximum depth of the
+					operand stack.
+
+			Returns:
+				type EquationError, the error with the index of the token it was
+					found at, or param length if operands are left over.
+					ErrorCode::NONE if the equation can be solved.
+		******************************************************************************/
+		EquationError tryValidatePostFix(const Token *equation, int length, int valueCount, int variableCount, int &maxStackDepth) const;
 
 		/******************************************************************************
 			Function Name: calcResult
 
 			Des:
-				Calculates the result of the equation used with the values.
+				Calculates the result of the bool equation used with the values.
 
 			Params:
-				equation - type const char *, the list of operands and operators
-					sorted in postfix notation. All bool's are expected to have been
-					replaced with letters. Case matters so 'A' is not equal to 'a.'
-					Example input: AB=c|.
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation. Example input: AB=c|.
 				length - type int, the length of the param equation.
-				values - type bool [], array containing all values corresponding
-					to the letters in param equation.
+				values - type const vector<bool> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
 
 			Returns:
 				type bool, result of the equation.
@@ -186,25 +438,178 @@ namespace day {
 					equivalent to the '==' operator. However, '==' is the equivalent
 					of typing '====' which would have a different result than expected
 		******************************************************************************/
-		bool calcResult(const char *equation, int length, vector<bool> &values);
+		bool calcResult(const Token *equation, int length, const vector<bool> &values) const;
+
+		/******************************************************************************
+			Function Name: calcResult
+
+			Des:
+				Calculates the result of the bool equation used with the values and
+					the values bound to its variables.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				values - type const vector<bool> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
+				variables - type const vector<bool> &, array containing the value
+					bound to each variable slot in param equation.
+
+			Returns:
+				type bool, result of the equation.
+
+			Throws:
+				Throws exception if the equation is unsolvable or uses a variable that
+					has no value bound to it.
+		******************************************************************************/
+		bool calcResult(const Token *equation, int length, const vector<bool> &values, const vector<bool> &variables) const;
 
 		/******************************************************************************
-			Function Name: nextVariable
+			Function Name: validateBoolPostFix
 
 			Des:
-				Get the next available variable
+				Same as validatePostFix for bool equations, which may only use
+					'!', '&', '|', '=' and '!='.
 
 			Params:
-				numVariablesUsed - type int &, modified input current total number of variables
-					used, output to show the new total number of variables used
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				valueCount - type int, the number of values the PUSH_VALUE tokens in
+					param equation can refer to.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
 
 			Returns:
-				type char, the next available variable
+				type int, the maximum depth of the operand stack.
 
 			Throws:
-				Throws exception if all variables have been used
+				Throws exception if the equation is unsolvable, uses an arithmetic
+					operator or a comparison, or refers to a value or variable that
+					does not exist.
+		******************************************************************************/
+		int validateBoolPostFix(const Token *equation, int length, int valueCount, int variableCount) const;
+
+		/******************************************************************************
+			Function Name: tryValidateBoolPostFix
+
+			Des:
+				Same as validateBoolPostFix, but returns the error instead of
+					throwing it.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				valueCount - type int, the number of values the PUSH_VALUE tokens in
+					param equation can refer to.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+				maxStackDepth - type int &, output to return the maximum depth of the
+					operand stack.
+
+			Returns:
+				type EquationError, the error with the index of the token it was
+					found at, or param length if operands are left over.
+					ErrorCode::NONE if the equation can be solved.
+		******************************************************************************/
+		EquationError tryValidateBoolPostFix(const Token *equation, int length, int valueCount, int variableCount, int &maxStackDepth) const;
+
+		/******************************************************************************
+			Function Name: calcValidatedResult
+
+			Des:
+				Calculates the result of an equation that has already been checked by
+					validatePostFix. No bounds are checked.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				values - type const double *, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
+				variables - type const double *, array containing the value bound to
+					each variable slot in param equation.
+				operandStack - type double *, scratch space for the operands, must
+					hold at least the maximum depth returned by validatePostFix.
+
+			Returns:
+				type double, result of the equation.
+		******************************************************************************/
+		double calcValidatedResult(const Token *equation, int length, const double *values, const double *variables, double *operandStack) const;
+
+		/******************************************************************************
+			Function Name: calcOperator
+
+			Des:
+				Applies a single operator to its operands with the same arithmetic as
+					calcResult. Used to evaluate constant parts of an equation ahead
+					of time.
+
+			Params:
+				opcode - type Opcode, the operator to be applied. Comparisons and
+					bool operators give 1 or 0.
+				num1 - type double, the first operand, or the only operand of a
+					unary operator.
+				num2 - type double, the second operand, ignored by unary operators.
+					For POWER_INTEGER and MODULO_POWER_OF_TWO it is the integer kept
+					in the token.
+
+			Returns:
+				type double, the result of the operator.
+
+			Throws:
+				Throws exception if the opcode is not an operator.
+		******************************************************************************/
+		double calcOperator(Opcode opcode, double num1, double num2) const;
+
+		/******************************************************************************
+			Function Name: formatEquation
+
+			Des:
+				Converts a list of tokens back to text, separating each token with a
+					space. Used to display the intermediate forms of an equation.
+
+			Params:
+				equation - type const Token *, the list of operands and operators.
+				length - type int, the length of the param equation.
+				values - type const vector<double> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
+				variables - type const vector<string> &, the name of each variable
+					slot in param equation.
+
+			Returns:
+				type string, the tokens as text.
 		******************************************************************************/
-		char nextVariable(int &nextArgument);
+		string formatEquation(const Token *equation, int length, const vector<double> &values, const vector<string> &variables) const;
+
+	private:
+
+		/******************************************************************************
+			Function Name: tokenize
+
+			Des:
+				Splits the equation into tokens with the rules described by
+					stripValuesFromEquation, passing each one to param output as it is
+					found.
+
+			Params:
+				equation - type const char *, the equation to be split.
+				length - type int, the length of the param equation.
+				variables - type vector<string> &, output vector containing the name
+					of each variable in the order of their slots.
+				output - type Output &, receives push(Token, position) for each
+					operator, variable and -1, and pushValue(double, position) for
+					each number, where position is the location of the char in param
+					equation that produced it.
+
+			Returns:
+				type EquationError, the error with the position of the char it was
+					found at, ErrorCode::NONE if the whole equation was split.
+		******************************************************************************/
+		template <typename Output>
+		EquationError tokenize(const char *equation, int length, vector<string> &variables, Output &output) const;
 
 		/******************************************************************************
 			Function Name: isOperator
@@ -217,12 +622,25 @@ namespace day {
 
 			Returns:
 				type bool, true if it is an operator, otherwise false.
+		******************************************************************************/
+		bool isOperator(char value) const;
 
-			Note:
-				Does not support bool operators
-				TODO: Add support for bool operators
+		/******************************************************************************
+			Function Name: getOperatorOpcode
+
+			Des:
+				Finds the opcode of the operator.
+
+			Params:
+				value - type char, the operator to be converted.
+
+			Returns:
+				type Opcode, the opcode of the operator.
+
+			Throws:
+				Throws exception if the value is not an operator.
 		******************************************************************************/
-		bool isOperator(char value);
+		Opcode getOperatorOpcode(char value) const;
 
 		/******************************************************************************
 			Function Name: isLowerPrecedence
@@ -231,13 +649,13 @@ namespace day {
 				Checks if the first operator has lower precedence than the second operator.
 
 			Params:
-				firstOperator - type char, the first operator.
-				secondOperator - type char, the second operator.
+				firstOperator - type Opcode, the first operator.
+				secondOperator - type Opcode, the second operator.
 
 			Returns:
 				type bool, is the first operater lower precedence than the second one, otherwise false.
 		******************************************************************************/
-		bool isLowerPrecedence(char firstOperator, char secondOperator);
+		bool isLowerPrecedence(Opcode firstOperator, Opcode secondOperator) const;
 
 		/******************************************************************************
 			Function Name: getPrecedenceLevel
@@ -246,46 +664,104 @@ namespace day {
 				Finds the precedence level of the operator.
 
 			Params:
-				curOperator - type char, the operator to be checked.
+				curOperator - type Opcode, the operator to be checked.
 
 			Returns:
 				type ReversePolishNotation::precedenceLevel, the level of precedence
 					that the operator has.
 		******************************************************************************/
-		precedenceLevel getPrecedenceLevel(char curOperator);
+		precedenceLevel getPrecedenceLevel(Opcode curOperator) const;
 
 		/******************************************************************************
-			Function Name: getOperandsFromStack
+			Function Name: isInfixOperator
 
 			Des:
-				Pops the top two int's off the top of the stack.
+				Checks if the opcode is a binary operator that can appear in an
+					in-fix equation, which are the ones getPrecedenceLevel knows.
 
 			Params:
-				operandStack - type stack<bool> &, is a stack containing all unprocessed
-					operands.
-				value1 - type int &, output to get the first int in the equation.
-				value2 - type int &, output to get the second int in the equation.
+				curOperator - type Opcode, the opcode to be checked.
 
-			Throws:
-				Throws exception if the there are less than 2 operands on the stack.
+			Returns:
+				type bool, true if it is an in-fix operator, otherwise false.
 		******************************************************************************/
-		void getOperandsFromStack(stack<double> &operandStack, double &value1, double &value2);
+		bool isInfixOperator(Opcode curOperator) const;
 
 		/******************************************************************************
-			Function Name: getOperandsFromStack
+			Function Name: isBoolOperator
 
 			Des:
-				Pops the top two bool's off the top of the stack.
+				Checks if the opcode is one of the bool operators.
 
 			Params:
-				operandStack - type stack<bool> &, is a stack containing all unprocessed
-					operands.
-				value1 - type bool &, output to get the first bool in the equation.
-				value2 - type bool &, output to get the second bool in the equation.
+				curOperator - type Opcode, the opcode to be checked.
 
-			Throws:
-				Throws exception if the there are less than 2 operands on the stack.
+			Returns:
+				type bool, true if it is '!', '&', '|', '=' or '!=', otherwise false.
+		******************************************************************************/
+		bool isBoolOperator(Opcode curOperator) const;
+
+		/******************************************************************************
+			Function Name: tryValidate
+
+			Des:
+				Does the checks of tryValidatePostFix and tryValidateBoolPostFix.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				valueCount - type int, the number of values the PUSH_VALUE tokens in
+					param equation can refer to.
+				variableCount - type int, the number of variables the PUSH_VARIABLE
+					tokens in param equation can refer to.
+				isBool - type bool, true to only allow bool operators, false to allow
+					every operator.
+				maxStackDepth - type int &, output to return the maximum depth of the
+					operand stack.
+
+			Returns:
+				type EquationError, the error with the index of the token it was
+					found at, ErrorCode::NONE if the equation can be solved.
+		******************************************************************************/
+		EquationError tryValidate(const Token *equation, int length, int valueCount, int variableCount, bool isBool, int &maxStackDepth) const;
+
+		/******************************************************************************
+			Function Name: calcValidatedBoolResult
+
+			Des:
+				Calculates the result of a bool equation that has already been
+					checked by validateBoolPostFix.
+
+			Params:
+				equation - type const Token *, the list of operands and operators
+					sorted in postfix notation.
+				length - type int, the length of the param equation.
+				values - type const vector<bool> &, array containing all values
+					corresponding to the PUSH_VALUE tokens in param equation.
+				variables - type const vector<bool> &, array containing the value
+					bound to each variable slot in param equation.
+				operandStack - type unsigned char *, scratch space for the operands,
+					must hold at least the maximum depth returned by
+					validateBoolPostFix.
+
+			Returns:
+				type bool, result of the equation.
+		******************************************************************************/
+		bool calcValidatedBoolResult(const Token *equation, int length, const vector<bool> &values, const vector<bool> &variables, unsigned char *operandStack) const;
+
+		/******************************************************************************
+			Function Name: isVariableChar
+
+			Des:
+				Checks if the value can be part of a variable name.
+
+			Params:
+				value - type char, the value to be checked.
+
+			Returns:
+				type bool, true if it is a letter, digit or '_', otherwise false.
 		******************************************************************************/
-		void getOperandsFromStack(stack<bool> &operandStack, bool &value1, bool &value2);
+		bool isVariableChar(char value) const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,1413 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: simdKernels.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for simdKernels.h
+
+		Each kernel takes a stride for both operands. A stride of 1 walks a
+		block of values and a stride of 0 reads a single value over and over,
+		which apply uses to broadcast scalar operands without a second copy of
+		every loop.
+
+	Outline:
+		Public Functions:
+			SimdKernels
+			SimdKernels
+			apply
+			applyBitwise
+			getInstructionSet
+			detectInstructionSet
+			getInstructionSetName
+
+		Local Functions:
+			applyScalar
+			isVectorPowerExponent
+			addDoubles
+			addDoubleDouble
+			multiplyDoubleDouble
+			divideDoubleDouble
+			logDoubleDouble
+			exp2DoubleDouble
+			makePowerTables
+			getPowerTables
+			applySse2
+			powerAvx2
+			applyAvx2
+			truncateAvx512
+			toDoubleAvx512
+			powerAvx512
+			applyAvx512
+			applyBitwiseScalar
+			applyBitwiseSse2
+			applyBitwiseAvx2
+			applyBitwiseAvx512
+******************************************************************************/
+
+#include "simdKernels.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using std::pow;
+using std::sqrt;
+using std::fma;
+using std::frexp;
+using std::ldexp;
+using std::nearbyint;
+using std::memcpy;
+
+namespace day {
+
+	// Plain loops used for the SCALAR instruction set and for the values left over after the last full vector
+	static void applyScalar(Opcode opcode, const double *left, int leftStride, const double *right, int rightStride, double *result, int count) {
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] + right[i * rightStride];
+				break;
+			case Opcode::SUBTRACT:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] - right[i * rightStride];
+				break;
+			case Opcode::MULTIPLY:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] * right[i * rightStride];
+				break;
+			case Opcode::DIVIDE:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] / right[i * rightStride];
+				break;
+			case Opcode::MODULO:
+
+				// WARNING: Conversion to integer causes decimal data to be lost
+				for (int i = 0; i < count; i++)
+					result[i] = (int)left[i * leftStride] % (int)right[i * rightStride];
+				break;
+			case Opcode::POWER:
+
+				for (int i = 0; i < count; i++)
+					result[i] = pow(left[i * leftStride], right[i * rightStride]);
+				break;
+			case Opcode::NEGATE:
+
+				for (int i = 0; i < count; i++)
+					result[i] = -left[i * leftStride];
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				// Same multiplications in the same order as calcOperator
+				unsigned int power = right[0] < 0 ? 0u - (unsigned int)(int)right[0] : (unsigned int)right[0];
+
+				for (int i = 0; i < count; i++) {
+
+					double base = left[i * leftStride];
+					double num1 = 1;
+
+					for (unsigned int exponent = power; exponent != 0; exponent >>= 1) {
+
+						if (exponent & 1)
+							num1 *= base;
+
+						if (exponent > 1)
+							base *= base;
+					}
+
+					result[i] = right[0] < 0 ? 1 / num1 : num1;
+				}
+				break;
+			}
+			case Opcode::SQUARE_ROOT:
+
+				for (int i = 0; i < count; i++)
+					result[i] = sqrt(left[i * leftStride]);
+				break;
+			case Opcode::MODULO_POWER_OF_TWO: {
+
+				int mask = (int)right[0] - 1;
+
+				for (int i = 0; i < count; i++) {
+
+					int num1 = (int)left[i * leftStride];
+					int bias = (num1 >> 31) & mask;
+
+					result[i] = ((num1 + bias) & mask) - bias;
+				}
+				break;
+			}
+			case Opcode::NOT:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] == 0;
+				break;
+			case Opcode::AND:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] != 0 && right[i * rightStride] != 0;
+				break;
+			case Opcode::OR:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] != 0 || right[i * rightStride] != 0;
+				break;
+			case Opcode::EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] == right[i * rightStride];
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] != right[i * rightStride];
+				break;
+			case Opcode::LESS:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] < right[i * rightStride];
+				break;
+			case Opcode::LESS_EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] <= right[i * rightStride];
+				break;
+			case Opcode::GREATER:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] > right[i * rightStride];
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i * leftStride] >= right[i * rightStride];
+				break;
+			default:
+
+				break;
+		};
+	}
+
+	// Exponents where the vector fast path gives exactly the same result as pow
+	static bool isVectorPowerExponent(const double *right, int rightStride) {
+
+		return rightStride == 0 && (right[0] == 0 || right[0] == 1 || right[0] == 2 || right[0] == -1);
+	}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+	// The vector pow follows the log and exp of glibc's pow, computing log(x) as k*ln2 + log(c) + log(1 + r) and exp as
+	//		2^(n/128) * exp(r), with both tables of POWER_TABLE_SIZE entries worked out once in double-double precision
+	static const int POWER_TABLE_SIZE = 128;
+	// Bits of the first mantissa of the log table, which covers x = 2^k * z for z from about 0.71 to 1.41
+	static const uint64_t POWER_LOG_OFFSET = 0x3fe6955500000000ULL;
+	// ln2 split so that k*LN2_HIGH is exact for every exponent k of a double
+	static const double LN2_HIGH = 0x1.62e42fefa3800p-1, LN2_LOW = 0x1.ef35793c76730p-45;
+	// ln2/128 split so that n*LN2_BY_SIZE_HIGH is exact for every n that keeps the answer finite
+	static const double LN2_BY_SIZE_HIGH = 0x1.62e42fefa0000p-8, LN2_BY_SIZE_LOW = 0x1.cf79abc9e3b3ap-47;
+	static const double SIZE_BY_LN2 = 0x1.71547652b82fep7;
+	// Adding it rounds a double below 2^51 to an integer held in the low bits of the sum
+	static const double ROUNDING_SHIFT = 0x1.8p52;
+	// Largest |y*log(x)| the vector pow handles, so that the answer is a normal number and exp needs no special cases
+	static const double POWER_MAX_EXPONENT = 700;
+	// Series of log(1 + r) - r + r*r/2 for |r| < 0x1.78p-8, each term divided by the powers of -r*r/2 it is multiplied by
+	static const double LOG_POLYNOMIAL[] = { -2.0 / 3, 0.5, 0.8, -2.0 / 3, -8.0 / 7, 1, 16.0 / 9, -1.6 };
+	// exp(r) - 1 - r for |r| < ln2/256
+	static const double EXP_POLYNOMIAL[] = { 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720 };
+
+	struct PowerTables {
+
+		// 1/c for the center c of each interval, rounded to 8 bits so that r = z/c - 1 is exact, which keeps |r| below
+		//		0x1.78p-8. The interval holding 1 uses c = 1, so log(x) keeps its relative precision for x near 1
+		double inverseCenters[POWER_TABLE_SIZE];
+		// -log(1/c) as a multiple of 2^-42, so that adding k*LN2_HIGH to it is exact, and what is left over
+		double logCenters[POWER_TABLE_SIZE];
+		double logCenterTails[POWER_TABLE_SIZE];
+		// 2^(i/128) rounded, with i << 45 taken from its bits so that i and the exponent can be added together
+		uint64_t exponentBits[POWER_TABLE_SIZE];
+		// Relative error of the rounded 2^(i/128)
+		double exponentTails[POWER_TABLE_SIZE];
+	};
+
+	// A value held as the sum of two doubles, about 106 bits, only used to work out the tables
+	struct DoubleDouble {
+
+		double high;
+		double low;
+	};
+
+	static DoubleDouble addDoubles(double a, double b) {
+
+		double sum = a + b;
+		double bPart = sum - a;
+
+		return { sum, (a - (sum - bPart)) + (b - bPart) };
+	}
+
+	static DoubleDouble addDoubleDouble(DoubleDouble a, DoubleDouble b) {
+
+		DoubleDouble sum = addDoubles(a.high, b.high);
+
+		return addDoubles(sum.high, sum.low + a.low + b.low);
+	}
+
+	static DoubleDouble multiplyDoubleDouble(DoubleDouble a, DoubleDouble b) {
+
+		double product = a.high * b.high;
+
+		// fma gives the rounding error of the product exactly
+		return addDoubles(product, fma(a.high, b.high, -product) + a.high * b.low + a.low * b.high);
+	}
+
+	static DoubleDouble divideDoubleDouble(DoubleDouble a, DoubleDouble b) {
+
+		// Long division, each quotient takes the next 53 bits of what is left
+		double first = a.high / b.high;
+		DoubleDouble rest = addDoubleDouble(a, multiplyDoubleDouble(b, { -first, 0 }));
+		double second = rest.high / b.high;
+
+		rest = addDoubleDouble(rest, multiplyDoubleDouble(b, { -second, 0 }));
+
+		return addDoubleDouble(addDoubles(first, second), { rest.high / b.high, 0 });
+	}
+
+	// log(value) for value from 0.5 to 2, as 2*atanh(s) with s = (value - 1)/(value + 1)
+	static DoubleDouble logDoubleDouble(double value) {
+
+		DoubleDouble s = divideDoubleDouble({ value - 1, 0 }, addDoubles(value, 1));
+		DoubleDouble square = multiplyDoubleDouble(s, s);
+		DoubleDouble power = s;
+		DoubleDouble sum = s;
+
+		// |s| is at most 1/3, so the terms are past 106 bits long before the last one
+		for (int n = 1; n <= 40; n++) {
+
+			power = multiplyDoubleDouble(power, square);
+			sum = addDoubleDouble(sum, divideDoubleDouble(power, { 2.0 * n + 1, 0 }));
+		}
+
+		return { 2 * sum.high, 2 * sum.low };
+	}
+
+	// 2^(i/POWER_TABLE_SIZE), from the series of exp
+	static DoubleDouble exp2DoubleDouble(int i) {
+
+		const DoubleDouble LN2 = { 0x1.62e42fefa39efp-1, 0x1.abc9e3b39803fp-56 };
+
+		DoubleDouble x = multiplyDoubleDouble(LN2, { (double)i / POWER_TABLE_SIZE, 0 });
+		DoubleDouble term = { 1, 0 };
+		DoubleDouble sum = { 1, 0 };
+
+		for (int n = 1; n <= 30; n++) {
+
+			term = divideDoubleDouble(multiplyDoubleDouble(term, x), { (double)n, 0 });
+			sum = addDoubleDouble(sum, term);
+		}
+
+		return sum;
+	}
+
+	static PowerTables makePowerTables() {
+
+		PowerTables tables;
+
+		for (int i = 0; i < POWER_TABLE_SIZE; i++) {
+
+			uint64_t firstBits = POWER_LOG_OFFSET + ((uint64_t)i << 45);
+			uint64_t lastBits = firstBits + (1ULL << 45);
+			double first, last;
+			double inverseCenter = 1;
+
+			memcpy(&first, &firstBits, sizeof(double));
+			memcpy(&last, &lastBits, sizeof(double));
+
+			if (first > 1 || last <= 1) {
+
+				int exponent;
+				double mantissa = frexp(2 / (first + last), &exponent);
+
+				inverseCenter = ldexp(nearbyint(ldexp(mantissa, 8)), exponent - 8);
+			}
+
+			DoubleDouble logCenter = logDoubleDouble(inverseCenter);
+			double rounded = ldexp(nearbyint(ldexp(-logCenter.high, 42)), -42);
+
+			tables.inverseCenters[i] = inverseCenter;
+			tables.logCenters[i] = rounded;
+			tables.logCenterTails[i] = (-logCenter.high - rounded) - logCenter.low;
+
+			DoubleDouble power = exp2DoubleDouble(i);
+			uint64_t bits;
+
+			memcpy(&bits, &power.high, sizeof(double));
+
+			tables.exponentBits[i] = bits - ((uint64_t)i << 45);
+			tables.exponentTails[i] = power.low / power.high;
+		}
+
+		return tables;
+	}
+
+	static const PowerTables &getPowerTables() {
+
+		// Worked out on first use, which C++11 makes safe from several threads
+		static const PowerTables TABLES = makePowerTables();
+
+		return TABLES;
+	}
+
+	__attribute__((target("sse2")))
+	static void applySse2(Opcode opcode, const double *left, int leftStride, const double *right, int rightStride, double *result, int count) {
+
+		const int WIDTH = 2;
+		int i = 0;
+		const __m128d ZERO = _mm_setzero_pd(), ONE = _mm_set1_pd(1);
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_add_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::SUBTRACT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_sub_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MULTIPLY:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_mul_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::DIVIDE:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_div_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MODULO:
+
+				// The truncated quotient of two ints is exact in double precision, so num1 - quotient * num2 is the exact remainder
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m128d num1 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_loadu_pd(left + i * leftStride)));
+					__m128d num2 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_loadu_pd(right + i * rightStride)));
+					__m128d quotient = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_div_pd(num1, num2)));
+
+					_mm_storeu_pd(result + i, _mm_sub_pd(num1, _mm_mul_pd(quotient, num2)));
+				}
+				break;
+			case Opcode::POWER:
+
+				if (!isVectorPowerExponent(right, rightStride))
+					break;
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m128d num1 = _mm_loadu_pd(left + i * leftStride);
+
+					if (right[0] == 0)
+						num1 = _mm_set1_pd(1);
+					else if (right[0] == 2)
+						num1 = _mm_mul_pd(num1, num1);
+					else if (right[0] == -1)
+						num1 = _mm_div_pd(_mm_set1_pd(1), num1);
+
+					_mm_storeu_pd(result + i, num1);
+				}
+				break;
+			case Opcode::NEGATE:
+
+				// Flips the sign bit like unary minus
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_xor_pd(_mm_loadu_pd(left + i * leftStride), _mm_set1_pd(-0.0)));
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				unsigned int power = right[0] < 0 ? 0u - (unsigned int)(int)right[0] : (unsigned int)right[0];
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m128d base = _mm_loadu_pd(left + i * leftStride);
+					__m128d num1 = _mm_set1_pd(1);
+
+					for (unsigned int exponent = power; exponent != 0; exponent >>= 1) {
+
+						if (exponent & 1)
+							num1 = _mm_mul_pd(num1, base);
+
+						if (exponent > 1)
+							base = _mm_mul_pd(base, base);
+					}
+
+					if (right[0] < 0)
+						num1 = _mm_div_pd(_mm_set1_pd(1), num1);
+
+					_mm_storeu_pd(result + i, num1);
+				}
+				break;
+			}
+			case Opcode::SQUARE_ROOT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_sqrt_pd(_mm_loadu_pd(left + i * leftStride)));
+				break;
+			case Opcode::MODULO_POWER_OF_TWO: {
+
+				__m128i mask = _mm_set1_epi32((int)right[0] - 1);
+
+				// The remainder is worked out on the truncated ints with the same bias trick as applyScalar
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m128i num1 = _mm_cvttpd_epi32(_mm_loadu_pd(left + i * leftStride));
+					__m128i bias = _mm_and_si128(_mm_srai_epi32(num1, 31), mask);
+
+					_mm_storeu_pd(result + i, _mm_cvtepi32_pd(_mm_sub_epi32(_mm_and_si128(_mm_add_epi32(num1, bias), mask), bias)));
+				}
+				break;
+			}
+			case Opcode::NOT:
+
+				// Comparisons give a mask of all 1s or all 0s, which keeps or clears the bits of 1.0
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmpeq_pd(_mm_loadu_pd(left + i * leftStride), ZERO), ONE));
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_and_pd(_mm_cmpneq_pd(_mm_loadu_pd(left + i * leftStride), ZERO), _mm_cmpneq_pd(_mm_loadu_pd(right + i * rightStride), ZERO)), ONE));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(left + i * leftStride), ZERO), _mm_cmpneq_pd(_mm_loadu_pd(right + i * rightStride), ZERO)), ONE));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmpeq_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmpneq_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			case Opcode::LESS:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmplt_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			case Opcode::LESS_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			case Opcode::GREATER:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmpgt_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_pd(result + i, _mm_and_pd(_mm_cmpge_pd(_mm_loadu_pd(left + i * leftStride), _mm_loadu_pd(right + i * rightStride)), ONE));
+				break;
+			default:
+
+				break;
+		};
+
+		applyScalar(opcode, left + i * leftStride, leftStride, right + i * rightStride, rightStride, result + i, count - i);
+	}
+
+	// pow for lanes where x is a positive normal number and |y*log(x)| <= POWER_MAX_EXPONENT, within a last bit
+	//		of pow. Returns a bit for each of those lanes, the others are left for pow
+	__attribute__((target("avx2")))
+	static inline int powerAvx2(__m256d x, __m256d y, const PowerTables &tables, __m256d &result) {
+
+		const __m256i ix = _mm256_castpd_si256(x);
+
+		// x = 2^k * z, the top bits of the offset from POWER_LOG_OFFSET are k and the interval of z
+		__m256i offset = _mm256_sub_epi64(ix, _mm256_set1_epi64x((long long)POWER_LOG_OFFSET));
+		__m256i index = _mm256_and_si256(_mm256_srli_epi64(offset, 45), _mm256_set1_epi64x(POWER_TABLE_SIZE - 1));
+		__m256d z = _mm256_castsi256_pd(_mm256_sub_epi64(ix, _mm256_and_si256(offset, _mm256_set1_epi64x((long long)0xfff0000000000000ULL))));
+		// There is no conversion from 64-bit ints, so k + 1023 is put in the low bits of 2^52
+		__m256i biasedExponent = _mm256_srli_epi64(_mm256_add_epi64(offset, _mm256_set1_epi64x(0x3ff0000000000000LL)), 52);
+		__m256d k = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biasedExponent, _mm256_set1_epi64x(0x4330000000000000LL))), _mm256_set1_pd(0x1p52 + 1023));
+		__m256d inverseCenter = _mm256_i64gather_pd(tables.inverseCenters, index, 8);
+		__m256d logCenter = _mm256_i64gather_pd(tables.logCenters, index, 8);
+		__m256d logCenterTail = _mm256_i64gather_pd(tables.logCenterTails, index, 8);
+
+		// r = z/c - 1, split so that rHigh and rHigh*rHigh are exact
+		__m256d zHigh = _mm256_castsi256_pd(_mm256_and_si256(_mm256_add_epi64(_mm256_castpd_si256(z), _mm256_set1_epi64x(1LL << 31)), _mm256_set1_epi64x((long long)0xffffffff00000000ULL)));
+		__m256d rHigh = _mm256_sub_pd(_mm256_mul_pd(zHigh, inverseCenter), _mm256_set1_pd(1));
+		__m256d rLow = _mm256_mul_pd(_mm256_sub_pd(z, zHigh), inverseCenter);
+		__m256d r = _mm256_add_pd(rHigh, rLow);
+
+		// log(x) = k*ln2 + log(c) + r - r*r/2 + polynomial, added up as high and low parts
+		__m256d t1 = _mm256_add_pd(_mm256_mul_pd(k, _mm256_set1_pd(LN2_HIGH)), logCenter);
+		__m256d t2 = _mm256_add_pd(t1, r);
+		__m256d low1 = _mm256_add_pd(_mm256_mul_pd(k, _mm256_set1_pd(LN2_LOW)), logCenterTail);
+		__m256d low2 = _mm256_add_pd(_mm256_sub_pd(t1, t2), r);
+		__m256d ar = _mm256_mul_pd(_mm256_set1_pd(-0.5), r);
+		__m256d ar2 = _mm256_mul_pd(r, ar);
+		__m256d ar3 = _mm256_mul_pd(r, ar2);
+		__m256d arHigh = _mm256_mul_pd(_mm256_set1_pd(-0.5), rHigh);
+		__m256d arHigh2 = _mm256_mul_pd(rHigh, arHigh);
+		__m256d high = _mm256_add_pd(t2, arHigh2);
+		__m256d low3 = _mm256_mul_pd(rLow, _mm256_add_pd(ar, arHigh));
+		__m256d low4 = _mm256_add_pd(_mm256_sub_pd(t2, high), arHigh2);
+		__m256d polynomial = _mm256_add_pd(_mm256_set1_pd(LOG_POLYNOMIAL[6]), _mm256_mul_pd(r, _mm256_set1_pd(LOG_POLYNOMIAL[7])));
+
+		polynomial = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(LOG_POLYNOMIAL[4]), _mm256_mul_pd(r, _mm256_set1_pd(LOG_POLYNOMIAL[5]))), _mm256_mul_pd(ar2, polynomial));
+		polynomial = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(LOG_POLYNOMIAL[2]), _mm256_mul_pd(r, _mm256_set1_pd(LOG_POLYNOMIAL[3]))), _mm256_mul_pd(ar2, polynomial));
+		polynomial = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(LOG_POLYNOMIAL[0]), _mm256_mul_pd(r, _mm256_set1_pd(LOG_POLYNOMIAL[1]))), _mm256_mul_pd(ar2, polynomial));
+		polynomial = _mm256_mul_pd(ar3, polynomial);
+
+		__m256d low = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(low1, low2), low3), low4), polynomial);
+		__m256d logHigh = _mm256_add_pd(high, low);
+		__m256d logLow = _mm256_add_pd(_mm256_sub_pd(high, logHigh), low);
+
+		// y*log(x) as the exact product of the top 26 bits of each and the rest
+		const __m256d TOP_BITS = _mm256_castsi256_pd(_mm256_set1_epi64x((long long)0xfffffffff8000000ULL));
+		__m256d yHigh = _mm256_and_pd(y, TOP_BITS);
+		__m256d logTop = _mm256_and_pd(logHigh, TOP_BITS);
+		__m256d exponentHigh = _mm256_mul_pd(yHigh, logTop);
+		__m256d exponentLow = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(y, yHigh), logTop), _mm256_mul_pd(y, _mm256_add_pd(_mm256_sub_pd(logHigh, logTop), logLow)));
+
+		// Comparisons with NaN are false, so NaN in x or y is left to pow
+		__m256d valid = _mm256_and_pd(_mm256_cmp_pd(x, _mm256_set1_pd(DBL_MIN), _CMP_GE_OQ), _mm256_cmp_pd(x, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ));
+
+		valid = _mm256_and_pd(valid, _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), exponentHigh), _mm256_set1_pd(POWER_MAX_EXPONENT), _CMP_LE_OQ));
+
+		int lanes = _mm256_movemask_pd(valid);
+
+		if (lanes == 0)
+			return 0;
+
+		// exp(exponentHigh + exponentLow) = 2^(n/128) * exp(r) with n the nearest integer to the exponent*128/ln2
+		__m256d shifted = _mm256_add_pd(_mm256_mul_pd(exponentHigh, _mm256_set1_pd(SIZE_BY_LN2)), _mm256_set1_pd(ROUNDING_SHIFT));
+		__m256i n = _mm256_castpd_si256(shifted);
+		__m256d nd = _mm256_sub_pd(shifted, _mm256_set1_pd(ROUNDING_SHIFT));
+		__m256d rExp = _mm256_add_pd(_mm256_sub_pd(exponentHigh, _mm256_mul_pd(nd, _mm256_set1_pd(LN2_BY_SIZE_HIGH))), _mm256_mul_pd(nd, _mm256_set1_pd(-LN2_BY_SIZE_LOW)));
+
+		rExp = _mm256_add_pd(rExp, exponentLow);
+
+		__m256i exponentIndex = _mm256_and_si256(n, _mm256_set1_epi64x(POWER_TABLE_SIZE - 1));
+		__m256d tail = _mm256_i64gather_pd(tables.exponentTails, exponentIndex, 8);
+		// Adding n << 45 to the bits of 2^(i/128) adds the whole part of n/128 to its exponent
+		__m256i scaleBits = _mm256_add_epi64(_mm256_i64gather_epi64((const long long *)tables.exponentBits, exponentIndex, 8), _mm256_slli_epi64(n, 45));
+		__m256d scale = _mm256_castsi256_pd(scaleBits);
+		__m256d r2 = _mm256_mul_pd(rExp, rExp);
+		__m256d series = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(EXP_POLYNOMIAL[2]), _mm256_mul_pd(rExp, _mm256_set1_pd(EXP_POLYNOMIAL[3]))), _mm256_mul_pd(r2, _mm256_set1_pd(EXP_POLYNOMIAL[4])));
+
+		series = _mm256_add_pd(_mm256_mul_pd(r2, _mm256_add_pd(_mm256_set1_pd(EXP_POLYNOMIAL[0]), _mm256_mul_pd(rExp, _mm256_set1_pd(EXP_POLYNOMIAL[1])))), _mm256_mul_pd(_mm256_mul_pd(r2, r2), series));
+		series = _mm256_add_pd(_mm256_add_pd(tail, rExp), series);
+		result = _mm256_add_pd(scale, _mm256_mul_pd(scale, series));
+
+		return lanes;
+	}
+
+	__attribute__((target("avx2")))
+	static void applyAvx2(Opcode opcode, const double *left, int leftStride, const double *right, int rightStride, double *result, int count) {
+
+		const int WIDTH = 4;
+		int i = 0;
+		const __m256d ZERO = _mm256_setzero_pd(), ONE = _mm256_set1_pd(1);
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::SUBTRACT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_sub_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MULTIPLY:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::DIVIDE:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_div_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MODULO:
+
+				// The truncated quotient of two ints is exact in double precision, so num1 - quotient * num2 is the exact remainder
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m256d num1 = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_loadu_pd(left + i * leftStride)));
+					__m256d num2 = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_loadu_pd(right + i * rightStride)));
+					__m256d quotient = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_div_pd(num1, num2)));
+
+					_mm256_storeu_pd(result + i, _mm256_sub_pd(num1, _mm256_mul_pd(quotient, num2)));
+				}
+				break;
+			case Opcode::POWER: {
+
+				if (isVectorPowerExponent(right, rightStride)) {
+
+					for (; i + WIDTH <= count; i += WIDTH) {
+
+						__m256d num1 = _mm256_loadu_pd(left + i * leftStride);
+
+						if (right[0] == 0)
+							num1 = _mm256_set1_pd(1);
+						else if (right[0] == 2)
+							num1 = _mm256_mul_pd(num1, num1);
+						else if (right[0] == -1)
+							num1 = _mm256_div_pd(_mm256_set1_pd(1), num1);
+
+						_mm256_storeu_pd(result + i, num1);
+					}
+
+					break;
+				}
+
+				const PowerTables &tables = getPowerTables();
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m256d power;
+					double powers[WIDTH];
+					int lanes = powerAvx2(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), tables, power);
+
+					if (lanes == 0) {
+
+						applyScalar(opcode, left + i * leftStride, leftStride, right + i * rightStride, rightStride, result + i, WIDTH);
+						continue;
+					}
+
+					// The other lanes are filled in before the store, since result may be the same block as left or right
+					_mm256_storeu_pd(powers, power);
+
+					for (int lane = 0; lane < WIDTH; lane++)
+						if (!(lanes & 1 << lane))
+							applyScalar(opcode, left + (i + lane) * leftStride, leftStride, right + (i + lane) * rightStride, rightStride, powers + lane, 1);
+
+					_mm256_storeu_pd(result + i, _mm256_loadu_pd(powers));
+				}
+				break;
+			}
+			case Opcode::NEGATE:
+
+				// Flips the sign bit like unary minus
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_xor_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_set1_pd(-0.0)));
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				unsigned int power = right[0] < 0 ? 0u - (unsigned int)(int)right[0] : (unsigned int)right[0];
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m256d base = _mm256_loadu_pd(left + i * leftStride);
+					__m256d num1 = _mm256_set1_pd(1);
+
+					for (unsigned int exponent = power; exponent != 0; exponent >>= 1) {
+
+						if (exponent & 1)
+							num1 = _mm256_mul_pd(num1, base);
+
+						if (exponent > 1)
+							base = _mm256_mul_pd(base, base);
+					}
+
+					if (right[0] < 0)
+						num1 = _mm256_div_pd(_mm256_set1_pd(1), num1);
+
+					_mm256_storeu_pd(result + i, num1);
+				}
+				break;
+			}
+			case Opcode::SQUARE_ROOT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_sqrt_pd(_mm256_loadu_pd(left + i * leftStride)));
+				break;
+			case Opcode::MODULO_POWER_OF_TWO: {
+
+				__m128i mask = _mm_set1_epi32((int)right[0] - 1);
+
+				// The remainder is worked out on the truncated ints with the same bias trick as applyScalar
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m128i num1 = _mm256_cvttpd_epi32(_mm256_loadu_pd(left + i * leftStride));
+					__m128i bias = _mm_and_si128(_mm_srai_epi32(num1, 31), mask);
+
+					_mm256_storeu_pd(result + i, _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_and_si128(_mm_add_epi32(num1, bias), mask), bias)));
+				}
+				break;
+			}
+			case Opcode::NOT:
+
+				// Same predicates as the C++ operators, only '!=' is true when either operand is NaN
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), ZERO, _CMP_EQ_OQ), ONE));
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), ZERO, _CMP_NEQ_UQ), _mm256_cmp_pd(_mm256_loadu_pd(right + i * rightStride), ZERO, _CMP_NEQ_UQ)), ONE));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), ZERO, _CMP_NEQ_UQ), _mm256_cmp_pd(_mm256_loadu_pd(right + i * rightStride), ZERO, _CMP_NEQ_UQ)), ONE));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_EQ_OQ), ONE));
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_NEQ_UQ), ONE));
+				break;
+			case Opcode::LESS:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_LT_OQ), ONE));
+				break;
+			case Opcode::LESS_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_LE_OQ), ONE));
+				break;
+			case Opcode::GREATER:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_GT_OQ), ONE));
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_pd(result + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + i * leftStride), _mm256_loadu_pd(right + i * rightStride), _CMP_GE_OQ), ONE));
+				break;
+			default:
+
+				break;
+		};
+
+		applyScalar(opcode, left + i * leftStride, leftStride, right + i * rightStride, rightStride, result + i, count - i);
+	}
+
+	// The unmasked conversions, shifts, gathers and square root in GCC's headers merge into an undefined register,
+	//		which -Wmaybe-uninitialized reports, so the zero-masked forms with every lane selected are used instead
+	__attribute__((target("avx512f")))
+	static inline __m256i truncateAvx512(__m512d value) {
+
+		return _mm512_maskz_cvttpd_epi32(0xFF, value);
+	}
+
+	__attribute__((target("avx512f")))
+	static inline __m512d toDoubleAvx512(__m256i value) {
+
+		return _mm512_maskz_cvtepi32_pd(0xFF, value);
+	}
+
+	// powerAvx2 eight lanes at a time. Every AVX-512 processor has fma, which gives the rounding error of r*r and
+	//		y*log(x) directly instead of from split halves, as in glibc's pow
+	__attribute__((target("avx512f")))
+	static inline int powerAvx512(__m512d x, __m512d y, const PowerTables &tables, __m512d &result) {
+
+		const __m512i ix = _mm512_castpd_si512(x);
+		const __m512i ABSOLUTE = _mm512_set1_epi64(0x7fffffffffffffffLL);
+
+		__m512i offset = _mm512_sub_epi64(ix, _mm512_set1_epi64((long long)POWER_LOG_OFFSET));
+		__m512i index = _mm512_and_si512(_mm512_maskz_srli_epi64(0xFF, offset, 45), _mm512_set1_epi64(POWER_TABLE_SIZE - 1));
+		__m512d z = _mm512_castsi512_pd(_mm512_sub_epi64(ix, _mm512_and_si512(offset, _mm512_set1_epi64((long long)0xfff0000000000000ULL))));
+		__m512i biasedExponent = _mm512_maskz_srli_epi64(0xFF, _mm512_add_epi64(offset, _mm512_set1_epi64(0x3ff0000000000000LL)), 52);
+		__m512d k = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(biasedExponent, _mm512_set1_epi64(0x4330000000000000LL))), _mm512_set1_pd(0x1p52 + 1023));
+		__m512d inverseCenter = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, index, tables.inverseCenters, 8);
+		__m512d logCenter = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, index, tables.logCenters, 8);
+		__m512d logCenterTail = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, index, tables.logCenterTails, 8);
+
+		__m512d r = _mm512_fmsub_pd(z, inverseCenter, _mm512_set1_pd(1));
+		__m512d t1 = _mm512_fmadd_pd(k, _mm512_set1_pd(LN2_HIGH), logCenter);
+		__m512d t2 = _mm512_add_pd(t1, r);
+		__m512d low1 = _mm512_fmadd_pd(k, _mm512_set1_pd(LN2_LOW), logCenterTail);
+		__m512d low2 = _mm512_add_pd(_mm512_sub_pd(t1, t2), r);
+		__m512d ar = _mm512_mul_pd(_mm512_set1_pd(-0.5), r);
+		__m512d ar2 = _mm512_mul_pd(r, ar);
+		__m512d ar3 = _mm512_mul_pd(r, ar2);
+		__m512d high = _mm512_add_pd(t2, ar2);
+		__m512d low3 = _mm512_fmsub_pd(ar, r, ar2);
+		__m512d low4 = _mm512_add_pd(_mm512_sub_pd(t2, high), ar2);
+		__m512d polynomial = _mm512_fmadd_pd(r, _mm512_set1_pd(LOG_POLYNOMIAL[7]), _mm512_set1_pd(LOG_POLYNOMIAL[6]));
+
+		polynomial = _mm512_fmadd_pd(ar2, polynomial, _mm512_fmadd_pd(r, _mm512_set1_pd(LOG_POLYNOMIAL[5]), _mm512_set1_pd(LOG_POLYNOMIAL[4])));
+		polynomial = _mm512_fmadd_pd(ar2, polynomial, _mm512_fmadd_pd(r, _mm512_set1_pd(LOG_POLYNOMIAL[3]), _mm512_set1_pd(LOG_POLYNOMIAL[2])));
+		polynomial = _mm512_fmadd_pd(ar2, polynomial, _mm512_fmadd_pd(r, _mm512_set1_pd(LOG_POLYNOMIAL[1]), _mm512_set1_pd(LOG_POLYNOMIAL[0])));
+		polynomial = _mm512_mul_pd(ar3, polynomial);
+
+		__m512d low = _mm512_add_pd(_mm512_add_pd(_mm512_add_pd(_mm512_add_pd(low1, low2), low3), low4), polynomial);
+		__m512d logHigh = _mm512_add_pd(high, low);
+		__m512d logLow = _mm512_add_pd(_mm512_sub_pd(high, logHigh), low);
+
+		__m512d exponentHigh = _mm512_mul_pd(y, logHigh);
+		__m512d exponentLow = _mm512_fmadd_pd(y, logLow, _mm512_fmsub_pd(y, logHigh, exponentHigh));
+		__m512d exponentSize = _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(exponentHigh), ABSOLUTE));
+
+		__mmask8 valid = _mm512_cmp_pd_mask(x, _mm512_set1_pd(DBL_MIN), _CMP_GE_OQ) & _mm512_cmp_pd_mask(x, _mm512_set1_pd(DBL_MAX), _CMP_LE_OQ);
+
+		valid &= _mm512_cmp_pd_mask(exponentSize, _mm512_set1_pd(POWER_MAX_EXPONENT), _CMP_LE_OQ);
+
+		if (valid == 0)
+			return 0;
+
+		__m512d shifted = _mm512_fmadd_pd(exponentHigh, _mm512_set1_pd(SIZE_BY_LN2), _mm512_set1_pd(ROUNDING_SHIFT));
+		__m512i n = _mm512_castpd_si512(shifted);
+		__m512d nd = _mm512_sub_pd(shifted, _mm512_set1_pd(ROUNDING_SHIFT));
+		__m512d rExp = _mm512_fmadd_pd(nd, _mm512_set1_pd(-LN2_BY_SIZE_LOW), _mm512_fnmadd_pd(nd, _mm512_set1_pd(LN2_BY_SIZE_HIGH), exponentHigh));
+
+		rExp = _mm512_add_pd(rExp, exponentLow);
+
+		__m512i exponentIndex = _mm512_and_si512(n, _mm512_set1_epi64(POWER_TABLE_SIZE - 1));
+		__m512d tail = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, exponentIndex, tables.exponentTails, 8);
+		__m512i scaleBits = _mm512_add_epi64(_mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, exponentIndex, tables.exponentBits, 8), _mm512_maskz_slli_epi64(0xFF, n, 45));
+		__m512d scale = _mm512_castsi512_pd(scaleBits);
+		__m512d r2 = _mm512_mul_pd(rExp, rExp);
+		__m512d series = _mm512_fmadd_pd(r2, _mm512_set1_pd(EXP_POLYNOMIAL[4]), _mm512_fmadd_pd(rExp, _mm512_set1_pd(EXP_POLYNOMIAL[3]), _mm512_set1_pd(EXP_POLYNOMIAL[2])));
+
+		series = _mm512_fmadd_pd(_mm512_mul_pd(r2, r2), series, _mm512_mul_pd(r2, _mm512_fmadd_pd(rExp, _mm512_set1_pd(EXP_POLYNOMIAL[1]), _mm512_set1_pd(EXP_POLYNOMIAL[0]))));
+		series = _mm512_add_pd(_mm512_add_pd(tail, rExp), series);
+		result = _mm512_fmadd_pd(scale, series, scale);
+
+		return valid;
+	}
+
+	__attribute__((target("avx512f")))
+	static void applyAvx512(Opcode opcode, const double *left, int leftStride, const double *right, int rightStride, double *result, int count) {
+
+		const int WIDTH = 8;
+		int i = 0;
+		const __m512d ZERO = _mm512_setzero_pd(), ONE = _mm512_set1_pd(1);
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_add_pd(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::SUBTRACT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_sub_pd(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MULTIPLY:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_mul_pd(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::DIVIDE:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_div_pd(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride)));
+				break;
+			case Opcode::MODULO:
+
+				// The truncated quotient of two ints is exact in double precision, so num1 - quotient * num2 is the exact remainder
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m512d num1 = toDoubleAvx512(truncateAvx512(_mm512_loadu_pd(left + i * leftStride)));
+					__m512d num2 = toDoubleAvx512(truncateAvx512(_mm512_loadu_pd(right + i * rightStride)));
+					__m512d quotient = toDoubleAvx512(truncateAvx512(_mm512_div_pd(num1, num2)));
+
+					_mm512_storeu_pd(result + i, _mm512_sub_pd(num1, _mm512_mul_pd(quotient, num2)));
+				}
+				break;
+			case Opcode::POWER: {
+
+				if (isVectorPowerExponent(right, rightStride)) {
+
+					for (; i + WIDTH <= count; i += WIDTH) {
+
+						__m512d num1 = _mm512_loadu_pd(left + i * leftStride);
+
+						if (right[0] == 0)
+							num1 = _mm512_set1_pd(1);
+						else if (right[0] == 2)
+							num1 = _mm512_mul_pd(num1, num1);
+						else if (right[0] == -1)
+							num1 = _mm512_div_pd(_mm512_set1_pd(1), num1);
+
+						_mm512_storeu_pd(result + i, num1);
+					}
+
+					break;
+				}
+
+				const PowerTables &tables = getPowerTables();
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m512d power;
+					double powers[WIDTH];
+					int lanes = powerAvx512(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), tables, power);
+
+					if (lanes == 0) {
+
+						applyScalar(opcode, left + i * leftStride, leftStride, right + i * rightStride, rightStride, result + i, WIDTH);
+						continue;
+					}
+
+					// The other lanes are filled in before the store, since result may be the same block as left or right
+					_mm512_storeu_pd(powers, power);
+
+					for (int lane = 0; lane < WIDTH; lane++)
+						if (!(lanes & 1 << lane))
+							applyScalar(opcode, left + (i + lane) * leftStride, leftStride, right + (i + lane) * rightStride, rightStride, powers + lane, 1);
+
+					_mm512_storeu_pd(result + i, _mm512_loadu_pd(powers));
+				}
+				break;
+			}
+			case Opcode::NEGATE:
+
+				// Flips the sign bit like unary minus, AVX-512F has no xor for doubles
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_loadu_pd(left + i * leftStride)), _mm512_set1_epi64(0x8000000000000000LL))));
+				break;
+			case Opcode::POWER_INTEGER: {
+
+				unsigned int power = right[0] < 0 ? 0u - (unsigned int)(int)right[0] : (unsigned int)right[0];
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m512d base = _mm512_loadu_pd(left + i * leftStride);
+					__m512d num1 = _mm512_set1_pd(1);
+
+					for (unsigned int exponent = power; exponent != 0; exponent >>= 1) {
+
+						if (exponent & 1)
+							num1 = _mm512_mul_pd(num1, base);
+
+						if (exponent > 1)
+							base = _mm512_mul_pd(base, base);
+					}
+
+					if (right[0] < 0)
+						num1 = _mm512_div_pd(_mm512_set1_pd(1), num1);
+
+					_mm512_storeu_pd(result + i, num1);
+				}
+				break;
+			}
+			case Opcode::SQUARE_ROOT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_sqrt_pd(0xFF, _mm512_loadu_pd(left + i * leftStride)));
+				break;
+			case Opcode::MODULO_POWER_OF_TWO: {
+
+				__m256i mask = _mm256_set1_epi32((int)right[0] - 1);
+
+				// The remainder is worked out on the truncated ints with the same bias trick as applyScalar
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m256i num1 = truncateAvx512(_mm512_loadu_pd(left + i * leftStride));
+					__m256i bias = _mm256_and_si256(_mm256_srai_epi32(num1, 31), mask);
+
+					_mm512_storeu_pd(result + i, toDoubleAvx512(_mm256_sub_epi32(_mm256_and_si256(_mm256_add_epi32(num1, bias), mask), bias)));
+				}
+				break;
+			}
+			case Opcode::NOT:
+
+				// Comparisons give a mask register, 1.0 is kept in every lane whose bit is set
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), ZERO, _CMP_EQ_OQ), ONE));
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), ZERO, _CMP_NEQ_UQ) & _mm512_cmp_pd_mask(_mm512_loadu_pd(right + i * rightStride), ZERO, _CMP_NEQ_UQ), ONE));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), ZERO, _CMP_NEQ_UQ) | _mm512_cmp_pd_mask(_mm512_loadu_pd(right + i * rightStride), ZERO, _CMP_NEQ_UQ), ONE));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_EQ_OQ), ONE));
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_NEQ_UQ), ONE));
+				break;
+			case Opcode::LESS:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_LT_OQ), ONE));
+				break;
+			case Opcode::LESS_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_LE_OQ), ONE));
+				break;
+			case Opcode::GREATER:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_GT_OQ), ONE));
+				break;
+			case Opcode::GREATER_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_pd(result + i, _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(_mm512_loadu_pd(left + i * leftStride), _mm512_loadu_pd(right + i * rightStride), _CMP_GE_OQ), ONE));
+				break;
+			default:
+
+				break;
+		};
+
+		applyScalar(opcode, left + i * leftStride, leftStride, right + i * rightStride, rightStride, result + i, count - i);
+	}
+
+#endif
+
+	// Plain loops for the bool operators on 64 rows at a time, also used for the words left over after the last full vector
+	static void applyBitwiseScalar(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) {
+
+		switch (opcode) {
+
+			case Opcode::NOT:
+
+				for (int i = 0; i < count; i++)
+					result[i] = ~left[i];
+				break;
+			case Opcode::AND:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i] & right[i];
+				break;
+			case Opcode::OR:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i] | right[i];
+				break;
+			case Opcode::EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = ~(left[i] ^ right[i]);
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (int i = 0; i < count; i++)
+					result[i] = left[i] ^ right[i];
+				break;
+			default:
+
+				throw invalid_argument("Opcode is not a bool operator");
+		};
+	}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+	__attribute__((target("sse2")))
+	static void applyBitwiseSse2(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) {
+
+		const int WIDTH = 2;
+		const __m128i ONES = _mm_set1_epi64x(-1);
+		int i = 0;
+
+		switch (opcode) {
+
+			case Opcode::NOT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_si128((__m128i *)(result + i), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(left + i)), ONES));
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_si128((__m128i *)(result + i), _mm_and_si128(_mm_loadu_si128((const __m128i *)(left + i)), _mm_loadu_si128((const __m128i *)(right + i))));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_si128((__m128i *)(result + i), _mm_or_si128(_mm_loadu_si128((const __m128i *)(left + i)), _mm_loadu_si128((const __m128i *)(right + i))));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_si128((__m128i *)(result + i), _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(left + i)), _mm_loadu_si128((const __m128i *)(right + i))), ONES));
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm_storeu_si128((__m128i *)(result + i), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(left + i)), _mm_loadu_si128((const __m128i *)(right + i))));
+				break;
+			default:
+
+				break;
+		};
+
+		applyBitwiseScalar(opcode, left + i, right + i, result + i, count - i);
+	}
+
+	__attribute__((target("avx2")))
+	static void applyBitwiseAvx2(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) {
+
+		const int WIDTH = 4;
+		const __m256i ONES = _mm256_set1_epi64x(-1);
+		int i = 0;
+
+		switch (opcode) {
+
+			case Opcode::NOT:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_si256((__m256i *)(result + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(left + i)), ONES));
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_si256((__m256i *)(result + i), _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(left + i)), _mm256_loadu_si256((const __m256i *)(right + i))));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_si256((__m256i *)(result + i), _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(left + i)), _mm256_loadu_si256((const __m256i *)(right + i))));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_si256((__m256i *)(result + i), _mm256_xor_si256(_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(left + i)), _mm256_loadu_si256((const __m256i *)(right + i))), ONES));
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm256_storeu_si256((__m256i *)(result + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(left + i)), _mm256_loadu_si256((const __m256i *)(right + i))));
+				break;
+			default:
+
+				break;
+		};
+
+		applyBitwiseScalar(opcode, left + i, right + i, result + i, count - i);
+	}
+
+	__attribute__((target("avx512f")))
+	static void applyBitwiseAvx512(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) {
+
+		const int WIDTH = 8;
+		int i = 0;
+
+		// ternarylogic applies the function of its inputs a, b and c whose truth table is the immediate, bit a*4+b*2+c.
+		// 0x0F is NOT a and 0xC3 is a EQUAL b
+		switch (opcode) {
+
+			case Opcode::NOT:
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m512i operand = _mm512_loadu_si512(left + i);
+
+					_mm512_storeu_si512(result + i, _mm512_ternarylogic_epi64(operand, operand, operand, 0x0F));
+				}
+				break;
+			case Opcode::AND:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_si512(result + i, _mm512_and_si512(_mm512_loadu_si512(left + i), _mm512_loadu_si512(right + i)));
+				break;
+			case Opcode::OR:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_si512(result + i, _mm512_or_si512(_mm512_loadu_si512(left + i), _mm512_loadu_si512(right + i)));
+				break;
+			case Opcode::EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH) {
+
+					__m512i operand = _mm512_loadu_si512(right + i);
+
+					_mm512_storeu_si512(result + i, _mm512_ternarylogic_epi64(_mm512_loadu_si512(left + i), operand, operand, 0xC3));
+				}
+				break;
+			case Opcode::NOT_EQUAL:
+
+				for (; i + WIDTH <= count; i += WIDTH)
+					_mm512_storeu_si512(result + i, _mm512_xor_si512(_mm512_loadu_si512(left + i), _mm512_loadu_si512(right + i)));
+				break;
+			default:
+
+				break;
+		};
+
+		applyBitwiseScalar(opcode, left + i, right + i, result + i, count - i);
+	}
+
+#endif
+
+	SimdKernels::SimdKernels() {
+
+		instructionSet = detectInstructionSet();
+	}
+
+	SimdKernels::SimdKernels(InstructionSet instructionSet) {
+
+		InstructionSet supported = detectInstructionSet();
+
+		this->instructionSet = instructionSet <= supported ? instructionSet : supported;
+	}
+
+	void SimdKernels::apply(Opcode opcode, const double *left, bool leftIsScalar, const double *right, bool rightIsScalar, double *result, int count) const {
+
+		// Scalar operands are copied to a full vector so that every kernel can load them with a stride of 0
+		double leftBroadcast[MAX_WIDTH];
+		double rightBroadcast[MAX_WIDTH];
+		int leftStride = 1, rightStride = 1;
+
+		if (leftIsScalar) {
+
+			for (int i = 0; i < MAX_WIDTH; i++)
+				leftBroadcast[i] = left[0];
+
+			left = leftBroadcast;
+			leftStride = 0;
+		}
+
+		if (rightIsScalar) {
+
+			for (int i = 0; i < MAX_WIDTH; i++)
+				rightBroadcast[i] = right[0];
+
+			right = rightBroadcast;
+			rightStride = 0;
+		}
+
+		switch (instructionSet) {
+
+#if defined(__GNUC__) && defined(__x86_64__)
+			case InstructionSet::AVX512:
+
+				applyAvx512(opcode, left, leftStride, right, rightStride, result, count);
+				break;
+			case InstructionSet::AVX2:
+
+				applyAvx2(opcode, left, leftStride, right, rightStride, result, count);
+				break;
+			case InstructionSet::SSE2:
+
+				applySse2(opcode, left, leftStride, right, rightStride, result, count);
+				break;
+#endif
+			default:
+
+				applyScalar(opcode, left, leftStride, right, rightStride, result, count);
+		};
+	}
+
+	void SimdKernels::applyBitwise(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) const {
+
+		switch (instructionSet) {
+
+#if defined(__GNUC__) && defined(__x86_64__)
+			case InstructionSet::AVX512:
+
+				applyBitwiseAvx512(opcode, left, right, result, count);
+				break;
+			case InstructionSet::AVX2:
+
+				applyBitwiseAvx2(opcode, left, right, result, count);
+				break;
+			case InstructionSet::SSE2:
+
+				applyBitwiseSse2(opcode, left, right, result, count);
+				break;
+#endif
+			default:
+
+				applyBitwiseScalar(opcode, left, right, result, count);
+		};
+	}
+
+	InstructionSet SimdKernels::getInstructionSet() const {
+
+		return instructionSet;
+	}
+
+	InstructionSet SimdKernels::detectInstructionSet() {
+
+		InstructionSet result = InstructionSet::SCALAR;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+		// Also checks that the OS saves the wider registers on a context switch
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx512f"))
+			result = InstructionSet::AVX512;
+		else if (__builtin_cpu_supports("avx2"))
+			result = InstructionSet::AVX2;
+		else if (__builtin_cpu_supports("sse2"))
+			result = InstructionSet::SSE2;
+#endif
+
+		return result;
+	}
+
+	const char *SimdKernels::getInstructionSetName(InstructionSet instructionSet) {
+
+		const char *result;
+
+		switch (instructionSet) {
+
+			case InstructionSet::SSE2:
+
+				result = "SSE2";
+				break;
+			case InstructionSet::AVX2:
+
+				result = "AVX2";
+				break;
+			case InstructionSet::AVX512:
+
+				result = "AVX-512";
+				break;
+			default:
+
+				result = "Scalar";
+		};
+
+		return result;
+	}
+}
@@ -0,0 +1,179 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: simdKernels.h
+
+	Author: Matthew Day
+
+	Class Name: SimdKernels
+
+	Description:
+		Applies the operators of calcResult to whole blocks of values
+		using the widest SIMD instruction set the CPU supports. The instruction
+		set is detected at run time so a single binary runs on every x86-64 CPU,
+		and other targets fall back to plain loops.
+
+		Results match calcResult bit-for-bit, except for '^' under AVX2 and
+		AVX-512. '+', '-', '*' and '/' are exact IEEE operations at every width
+		and NEGATE flips the sign bit. '%' truncates both operands to int like
+		calcResult and works out the remainder exactly in double precision.
+		'^' with the exponents 0, 1, 2 and -1 gives 1, x, x*x and 1/x, which are
+		identical to pow. Otherwise AVX2 and AVX-512 work out x^y as
+		exp(y*log(x)) with tables, within a last bit of pow, for positive
+		normal x and results between e^-700 and e^700. Other values and
+		narrower instruction sets call pow. As in calcResult, '%' by 0 is out of scope.
+		Comparisons and bool operators compare with the same predicates as C++,
+		so every comparison with NaN is false except '!=', and give 1 or 0.
+
+		applyBitwise runs the bool operators on words of 64 bools, one bool per
+		bit, so a 512-bit register handles 512 bools per instruction.
+
+	Outline:
+		Public Functions:
+			SimdKernels
+			SimdKernels
+			apply
+			applyBitwise
+			getInstructionSet
+			detectInstructionSet
+			getInstructionSetName
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "token.h"
+
+using std::uint64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	enum class InstructionSet { SCALAR, SSE2, AVX2, AVX512 };
+
+	class SimdKernels {
+
+	private:
+
+		InstructionSet instructionSet;
+	public:
+
+		// Widest number of doubles handled by a single instruction
+		static const int MAX_WIDTH = 8;
+
+		/******************************************************************************
+			Function Name: SimdKernels
+
+			Des:
+				Uses the widest instruction set supported by the CPU.
+		******************************************************************************/
+		SimdKernels();
+
+		/******************************************************************************
+			Function Name: SimdKernels
+
+			Des:
+				Uses the given instruction set, or the widest one supported by the
+					CPU if it does not support the given one. Used to compare the
+					instruction sets with each other.
+
+			Params:
+				instructionSet - type InstructionSet, the requested instruction set.
+		******************************************************************************/
+		SimdKernels(InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: apply
+
+			Des:
+				Applies an operator to each pair of values. Unary operators only
+					use param left, except that POWER_INTEGER and MODULO_POWER_OF_TWO
+					take the integer kept in their token from a scalar param right.
+
+			Params:
+				opcode - type Opcode, the operator to be applied.
+				left - type const double *, the first operands.
+				leftIsScalar - type bool, true if param left is a single value used
+					for every pair.
+				right - type const double *, the second operands.
+				rightIsScalar - type bool, true if param right is a single value used
+					for every pair.
+				result - type double *, output to get the result of each pair. May be
+					the same as param left or param right.
+				count - type int, the number of pairs.
+		******************************************************************************/
+		void apply(Opcode opcode, const double *left, bool leftIsScalar, const double *right, bool rightIsScalar, double *result, int count) const;
+
+		/******************************************************************************
+			Function Name: applyBitwise
+
+			Des:
+				Applies a bool operator to each pair of words, where every bit is a
+					separate bool. NOT only uses param left.
+
+			Params:
+				opcode - type Opcode, NOT, AND, OR, EQUAL or NOT_EQUAL.
+				left - type const uint64_t *, the first operands.
+				right - type const uint64_t *, the second operands.
+				result - type uint64_t *, output to get the result of each pair. May
+					be the same as param left or param right.
+				count - type int, the number of pairs of words.
+
+			Throws:
+				Throws exception if the opcode is not a bool operator.
+		******************************************************************************/
+		void applyBitwise(Opcode opcode, const uint64_t *left, const uint64_t *right, uint64_t *result, int count) const;
+
+		/******************************************************************************
+			Function Name: getInstructionSet
+
+			Des:
+				Gets the instruction set that is used.
+
+			Returns:
+				type InstructionSet, the instruction set that is used.
+		******************************************************************************/
+		InstructionSet getInstructionSet() const;
+
+		/******************************************************************************
+			Function Name: detectInstructionSet
+
+			Des:
+				Finds the widest instruction set supported by the CPU and the OS.
+
+			Returns:
+				type InstructionSet, the widest supported instruction set.
+		******************************************************************************/
+		static InstructionSet detectInstructionSet();
+
+		/******************************************************************************
+			Function Name: getInstructionSetName
+
+			Des:
+				Gets the name of the instruction set.
+
+			Params:
+				instructionSet - type InstructionSet, the instruction set.
+
+			Returns:
+				type const char *, the name of the instruction set.
+		******************************************************************************/
+		static const char *getInstructionSetName(InstructionSet instructionSet);
+	};
+}
@@ -0,0 +1,174 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: streamEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for streamEvaluator.h
+
+	Outline:
+		Public Functions:
+			StreamEvaluator
+			evaluate
+			evaluate
+
+		Private Functions:
+			addLines
+			evaluateBlock
+			formatAnswer
+******************************************************************************/
+
+#include "streamEvaluator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+using std::min;
+using std::to_chars;
+using std::memchr;
+using std::memmove;
+
+namespace day {
+
+	StreamEvaluator::StreamEvaluator(ThreadPool &pool) : pool(pool) {
+
+		lineStarts.reserve(BLOCK_LINES);
+		lineLengths.reserve(BLOCK_LINES);
+	}
+
+	size_t StreamEvaluator::evaluate(const char *data, size_t size, ostream &output) {
+
+		size_t result = addLines(data, size, output);
+
+		evaluateBlock(output);
+
+		return result;
+	}
+
+	size_t StreamEvaluator::evaluate(istream &input, ostream &output) {
+
+		vector<char> buffer(READ_SIZE);
+		// Chars at the start of the buffer left over from a line that was not finished by the last read
+		size_t carried = 0;
+		size_t result = 0;
+
+		while (input) {
+
+			// A line longer than the buffer makes the buffer grow
+			if (carried == buffer.size())
+				buffer.resize(buffer.size() * 2);
+
+			input.read(buffer.data() + carried, buffer.size() - carried);
+
+			size_t size = carried + input.gcount();
+			size_t complete = size;
+
+			// Only whole lines are evaluated until the end of the stream
+			if (input) {
+
+				while (complete > 0 && buffer[complete - 1] != '\n')
+					complete--;
+			}
+
+			result += addLines(buffer.data(), complete, output);
+
+			// The lines point into the buffer, so they are evaluated before it is reused
+			evaluateBlock(output);
+
+			carried = size - complete;
+			memmove(buffer.data(), buffer.data() + complete, carried);
+		}
+
+		return result;
+	}
+
+	size_t StreamEvaluator::addLines(const char *data, size_t size, ostream &output) {
+
+		size_t result = 0;
+		size_t start = 0;
+
+		while (start < size) {
+
+			const char *newline = (const char *)memchr(data + start, '\n', size - start);
+			size_t end = newline == nullptr ? size : newline - data;
+			size_t length = end - start;
+
+			if (length > 0 && data[end - 1] == '\r')
+				length--;
+
+			lineStarts.push_back(data + start);
+			lineLengths.push_back(length);
+			result++;
+
+			if (lineStarts.size() == (size_t)BLOCK_LINES)
+				evaluateBlock(output);
+
+			start = end + 1;
+		}
+
+		return result;
+	}
+
+	void StreamEvaluator::evaluateBlock(ostream &output) {
+
+		size_t lines = lineStarts.size();
+		size_t chunks = (lines + CHUNK_LINES - 1) / CHUNK_LINES;
+
+		if (chunkOutputs.size() < chunks)
+			chunkOutputs.resize(chunks);
+
+		pool.parallelFor(chunks, [&](size_t chunk, int) {
+
+			size_t first = chunk * CHUNK_LINES;
+			size_t last = min(lines, first + CHUNK_LINES);
+			string &chunkOutput = chunkOutputs[chunk];
+
+			chunkOutput.clear();
+
+			for (size_t i = first; i < last; i++)
+				formatAnswer(lineStarts[i], lineLengths[i], chunkOutput);
+		});
+
+		for (size_t i = 0; i < chunks; i++)
+			output.write(chunkOutputs[i].data(), chunkOutputs[i].size());
+
+		lineStarts.clear();
+		lineLengths.clear();
+	}
+
+	void StreamEvaluator::formatAnswer(const char *line, int length, string &output) const {
+
+		Expected<double> answer = rpn.tryEvaluateEquation(line, length);
+
+		if (answer) {
+
+			// Enough for any double written with the fewest digits that read back the same
+			char digits[32];
+			char *end = to_chars(digits, digits + sizeof(digits), answer.getValue()).ptr;
+
+			output.append(digits, end);
+		} else {
+
+			output += "error: ";
+			output += answer.getError().getMessage();
+		}
+
+		output += '\n';
+	}
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+/******************************************************************************
+	File Name: streamEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: StreamEvaluator
+
+	Description:
+		Evaluates text with one equation per line and writes one answer per
+		line in the same order, for scoring large files of equations without
+		an interactive loop.
+
+		Lines are gathered into blocks of BLOCK_LINES. The lines of a block are
+		split into tasks of CHUNK_LINES, which the threads of a ThreadPool
+		evaluate with evaluateEquation's non-throwing single pass, so an
+		invalid line costs no more than a valid one. Each task formats its
+		answers into its own buffer, and the buffers are written in order once
+		the block is done, so the output is written in a few large writes and
+		never flushed per line.
+
+		An answer is written with the fewest digits that read back as the same
+		double. A line that cannot be evaluated is written as "error: " and
+		the message evaluateEquation would have thrown. A '\r' before the end
+		of a line is ignored.
+
+	Outline:
+		Public Functions:
+			StreamEvaluator
+			evaluate
+			evaluate
+
+		Private Functions:
+			addLines
+			evaluateBlock
+			formatAnswer
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstddef>
+
+#include "reversePolishNotation.h"
+#include "threadPool.h"
+
+using std::string;
+using std::vector;
+using std::istream;
+using std::ostream;
+using std::size_t;
+
+namespace day {
+
+	class StreamEvaluator {
+
+	public:
+
+		// Lines evaluated by each task
+		static const int CHUNK_LINES = 1024;
+		// Lines evaluated before their answers are written
+		static const int BLOCK_LINES = 64 * CHUNK_LINES;
+		// Bytes read from a stream at once
+		static const size_t READ_SIZE = 1 << 22;
+	private:
+
+		ThreadPool &pool;
+		ReversePolishNotation rpn;
+		// First char and length of each line of the current block
+		vector<const char *> lineStarts;
+		vector<int> lineLengths;
+		// Answers of each task of the current block, kept so their memory is reused by the next block
+		vector<string> chunkOutputs;
+	public:
+
+		/******************************************************************************
+			Function Name: StreamEvaluator
+
+			Des:
+				Creates an evaluator that runs on the threads of the pool.
+
+			Params:
+				pool - type ThreadPool &, the threads to run on. Must outlive the
+					evaluator.
+		******************************************************************************/
+		StreamEvaluator(ThreadPool &pool);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates every line of text held in memory, such as a MappedFile.
+
+			Params:
+				data - type const char *, the text.
+				size - type size_t, the number of chars in param data.
+				output - type ostream &, receives the answer of each line.
+
+			Returns:
+				type size_t, the number of lines evaluated.
+		******************************************************************************/
+		size_t evaluate(const char *data, size_t size, ostream &output);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates every line read from the stream, READ_SIZE bytes at a
+					time.
+
+			Params:
+				input - type istream &, the lines to be evaluated.
+				output - type ostream &, receives the answer of each line.
+
+			Returns:
+				type size_t, the number of lines evaluated.
+		******************************************************************************/
+		size_t evaluate(istream &input, ostream &output);
+	private:
+
+		/******************************************************************************
+			Function Name: addLines
+
+			Des:
+				Adds the lines of the text to the current block, evaluating the
+					block each time it is full. The text must stay valid until the
+					block is evaluated.
+
+			Params:
+				data - type const char *, the text.
+				size - type size_t, the number of chars in param data.
+				output - type ostream &, receives the answers of each full block.
+
+			Returns:
+				type size_t, the number of lines added.
+		******************************************************************************/
+		size_t addLines(const char *data, size_t size, ostream &output);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Evaluates the lines of the current block, writes their answers in
+					order and empties the block.
+
+			Params:
+				output - type ostream &, receives the answers.
+		******************************************************************************/
+		void evaluateBlock(ostream &output);
+
+		/******************************************************************************
+			Function Name: formatAnswer
+
+			Des:
+				Evaluates one line and appends its answer and a newline.
+
+			Params:
+				line - type const char *, the equation.
+				length - type int, the length of the param line.
+				output - type string &, the answer is appended to it.
+		******************************************************************************/
+		void formatAnswer(const char *line, int length, string &output) const;
+	};
+}
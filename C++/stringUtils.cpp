@@ -30,34 +30,80 @@ namespace day {
 	double getNumber(const char *data, int length, int start, int &end) {
 
 		double result;
-		string number = "";
+
+		if (!parseNumber(data, length, start, end, result))
+			throw invalid_argument("Malformed number at position " + to_string(end));
+
+		return result;
+	}
+
+	bool parseNumber(const char *data, int length, int start, int &end, double &result) {
+
 		int pos = start;
+		int digits = 0;
 
 		// Skip the negative sign to avoid checking if the sign is relative to this number or just a minus sign
-		if (data[start] == '-') {
+		if (pos < length && data[pos] == '-')
+			pos++;
+
+		while (pos < length && isdigit(data[pos])) {
 
-			number.push_back('-');
 			pos++;
+			digits++;
 		}
 
-		// Avoid having to increment with every iteration to prevent it from not being set if the loop runs until equal to length
-		end = length - 1;
+		if (pos < length && data[pos] == '.') {
 
-		for (int i = pos; i < length; i++) {
+			pos++;
 
-			// Check if current char is a number or a decimal point
-			if (isdigit(data[i]) || data[i] == '.')
-				number.push_back(data[i]);
-			else {
+			while (pos < length && isdigit(data[pos])) {
 
-				end = i - 1;
-				break;
+				pos++;
+				digits++;
 			}
 		}
 
-		// Convert to double
-		result = stod(number);
+		if (digits == 0) {
 
-		return result;
+			end = pos;
+			return false;
+		}
+
+		// Only treat 'e' as an exponent when digits follow it, with or without a sign
+		if (pos + 1 < length && (data[pos] == 'e' || data[pos] == 'E')) {
+
+			int exponentPos = pos + 1;
+
+			if (exponentPos + 1 < length && (data[exponentPos] == '+' || data[exponentPos] == '-'))
+				exponentPos++;
+
+			if (isdigit(data[exponentPos])) {
+
+				pos = exponentPos;
+
+				while (pos < length && isdigit(data[pos]))
+					pos++;
+			}
+		}
+
+		// A second decimal point or an exponent with a decimal point, e.g. 1.2.3 or 1e2.5
+		if (pos < length && (data[pos] == '.' || isdigit(data[pos]))) {
+
+			end = pos;
+			return false;
+		}
+
+		// from_chars does not accept a leading '+', which is already excluded by the scan above
+		auto conversion = from_chars(data + start, data + pos, result);
+
+		if (conversion.ec != errc() || conversion.ptr != data + pos) {
+
+			end = start;
+			return false;
+		}
+
+		end = pos - 1;
+
+		return true;
 	}
 }
\ No newline at end of file
@@ -28,10 +28,15 @@
 
 #include <string>
 #include <cctype>
+#include <charconv>
+#include <stdexcept>
 
 using std::string;
 using std::isdigit;
-using std::stod;
+using std::from_chars;
+using std::errc;
+using std::invalid_argument;
+using std::to_string;
 
 namespace day {
 
@@ -51,6 +56,36 @@ namespace day {
 
 		Returns:
 			type double, the value after it has been extracted
+
+		Throws:
+			Throws exception if the number is malformed or out of range, the
+				message gives the location of the first invalid char.
 	******************************************************************************/
 	double getNumber(const char *data, int length, int start, int &end);
+
+	/******************************************************************************
+		Function Name: parseNumber
+
+		Des:
+			Extract a numerical value from the string starting from the specified
+				location without allocating or throwing. Accepts an optional '-',
+				digits with at most one decimal point and an optional exponent,
+				e.g. -1.5e-3. An 'e' that is not followed by digits is not part of
+				the number so 2e is left as 2 followed by e. The conversion does not
+				depend on the current locale.
+
+		Params:
+			data - type char *, the data the number is to be extracted from.
+			length - type int, the length of the param data.
+			start - type int, starting location in param data
+			end - type int &, output to return the location of the last char of
+				the number, or the location of the first invalid char if the
+				number is malformed
+			result - type double &, output to return the value after it has been
+				extracted
+
+		Returns:
+			type bool, true if the number is valid, otherwise false.
+	******************************************************************************/
+	bool parseNumber(const char *data, int length, int start, int &end, double &result);
 };
\ No newline at end of file
@@ -0,0 +1,217 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: threadPool.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for threadPool.h
+
+	Outline:
+		Public Functions:
+			ThreadPool
+			ThreadPool
+			~ThreadPool
+			getThreadCount
+			parallelFor
+
+		Private Functions
+			workerLoop
+			runTasks
+			takeTask
+******************************************************************************/
+
+#include "threadPool.h"
+
+namespace day {
+
+	// The pool and index of the task running on this thread, used to run nested calls to parallelFor in place
+	static thread_local const ThreadPool *currentPool = nullptr;
+	static thread_local int currentThreadIndex = -1;
+
+	ThreadPool::ThreadPool() : ThreadPool(thread::hardware_concurrency()) {
+	}
+
+	ThreadPool::ThreadPool(int threadCount) : currentTask(nullptr), remainingTasks(0), jobId(0), stopping(false) {
+
+		// hardware_concurrency returns 0 when it is unknown
+		if (threadCount < 1)
+			threadCount = 1;
+
+		for (int i = 0; i < threadCount; i++)
+			queues.emplace_back(new WorkQueue());
+
+		for (int i = 0; i < threadCount - 1; i++)
+			workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+
+	ThreadPool::~ThreadPool() {
+
+		{
+			lock_guard<mutex> guard(stateLock);
+			stopping = true;
+		}
+
+		wakeWorkers.notify_all();
+
+		for (thread &worker : workers)
+			worker.join();
+	}
+
+	int ThreadPool::getThreadCount() const {
+
+		return queues.size();
+	}
+
+	void ThreadPool::parallelFor(size_t taskCount, const function<void(size_t, int)> &task) {
+
+		if (taskCount == 0)
+			return;
+
+		// A task calling back into the pool would wait on itself, so its tasks are run in place
+		if (currentPool == this) {
+
+			for (size_t i = 0; i < taskCount; i++)
+				task(i, currentThreadIndex);
+
+			return;
+		}
+
+		lock_guard<mutex> jobGuard(jobLock);
+		int callerIndex = workers.size();
+
+		currentTask = &task;
+		remainingTasks = taskCount;
+		firstError = nullptr;
+
+		// Each queue gets a contiguous range of tasks so neighbouring tasks usually run on the same thread
+		for (size_t i = 0; i < queues.size(); i++) {
+
+			lock_guard<mutex> guard(queues[i]->lock);
+
+			for (size_t j = taskCount * i / queues.size(); j < taskCount * (i + 1) / queues.size(); j++)
+				queues[i]->tasks.push_back(j);
+		}
+
+		{
+			lock_guard<mutex> guard(stateLock);
+			jobId++;
+		}
+
+		wakeWorkers.notify_all();
+
+		currentPool = this;
+		currentThreadIndex = callerIndex;
+
+		runTasks(callerIndex);
+
+		currentPool = nullptr;
+		currentThreadIndex = -1;
+
+		unique_lock<mutex> guard(stateLock);
+
+		jobDone.wait(guard, [this] { return remainingTasks == 0; });
+		currentTask = nullptr;
+
+		if (firstError != nullptr)
+			rethrow_exception(firstError);
+	}
+
+	void ThreadPool::workerLoop(int threadIndex) {
+
+		size_t lastJobId = 0;
+
+		currentPool = this;
+		currentThreadIndex = threadIndex;
+
+		while (true) {
+
+			{
+				unique_lock<mutex> guard(stateLock);
+
+				wakeWorkers.wait(guard, [this, lastJobId] { return stopping || jobId != lastJobId; });
+
+				if (stopping)
+					return;
+
+				lastJobId = jobId;
+			}
+
+			runTasks(threadIndex);
+		}
+	}
+
+	void ThreadPool::runTasks(int threadIndex) {
+
+		size_t task;
+
+		while (takeTask(threadIndex, task)) {
+
+			try {
+
+				(*currentTask)(task, threadIndex);
+			} catch (...) {
+
+				lock_guard<mutex> guard(stateLock);
+
+				if (firstError == nullptr)
+					firstError = current_exception();
+			}
+
+			// The last task to finish wakes the thread waiting in parallelFor
+			if (--remainingTasks == 0) {
+
+				lock_guard<mutex> guard(stateLock);
+				jobDone.notify_all();
+			}
+		}
+	}
+
+	bool ThreadPool::takeTask(int threadIndex, size_t &task) {
+
+		bool result = false;
+
+		{
+			WorkQueue &own = *queues[threadIndex];
+			lock_guard<mutex> guard(own.lock);
+
+			if (!own.tasks.empty()) {
+
+				task = own.tasks.front();
+				own.tasks.pop_front();
+				result = true;
+			}
+		}
+
+		// Steal from the back of the other queues, away from where their owners are working
+		for (size_t i = 1; i < queues.size() && !result; i++) {
+
+			WorkQueue &victim = *queues[(threadIndex + i) % queues.size()];
+			lock_guard<mutex> guard(victim.lock);
+
+			if (!victim.tasks.empty()) {
+
+				task = victim.tasks.back();
+				victim.tasks.pop_back();
+				result = true;
+			}
+		}
+
+		return result;
+	}
+}
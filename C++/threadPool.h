@@ -0,0 +1,209 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: threadPool.h
+
+	Author: Matthew Day
+
+	Class Name: ThreadPool
+
+	Description:
+		A fixed set of worker threads that run numbered tasks with work
+		stealing. Each thread starts on its own contiguous range of tasks and,
+		once that runs out, steals tasks from the far end of another thread's
+		range, so tasks of uneven cost still keep every thread busy. The thread
+		that calls parallelFor runs tasks as well.
+
+	Outline:
+		Public Functions:
+			ThreadPool
+			ThreadPool
+			~ThreadPool
+			getThreadCount
+			parallelFor
+
+		Private Functions
+			workerLoop
+			runTasks
+			takeTask
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+using std::vector;
+using std::deque;
+using std::unique_ptr;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::atomic;
+using std::function;
+using std::exception_ptr;
+using std::rethrow_exception;
+using std::current_exception;
+using std::size_t;
+
+namespace day {
+
+	class ThreadPool {
+
+	private:
+
+		// The tasks waiting to be run by one thread
+		struct WorkQueue {
+
+			mutex lock;
+			deque<size_t> tasks;
+		};
+
+		vector<thread> workers;
+		// One queue for each worker followed by one for the thread calling parallelFor
+		vector<unique_ptr<WorkQueue>> queues;
+
+		// Only one parallelFor runs at a time
+		mutex jobLock;
+		mutex stateLock;
+		condition_variable wakeWorkers;
+		condition_variable jobDone;
+
+		atomic<const function<void(size_t, int)> *> currentTask;
+		atomic<size_t> remainingTasks;
+		size_t jobId;
+		exception_ptr firstError;
+		bool stopping;
+	public:
+
+		/******************************************************************************
+			Function Name: ThreadPool
+
+			Des:
+				Creates a worker for each hardware thread after the first, since the
+					thread calling parallelFor also runs tasks.
+		******************************************************************************/
+		ThreadPool();
+
+		/******************************************************************************
+			Function Name: ThreadPool
+
+			Des:
+				Creates the given number of threads, including the thread calling
+					parallelFor.
+
+			Params:
+				threadCount - type int, the number of threads that run tasks.
+		******************************************************************************/
+		ThreadPool(int threadCount);
+
+		/******************************************************************************
+			Function Name: ~ThreadPool
+
+			Des:
+				Stops and joins every worker.
+		******************************************************************************/
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		/******************************************************************************
+			Function Name: getThreadCount
+
+			Des:
+				Gets the number of threads that run tasks, including the thread
+					calling parallelFor.
+
+			Returns:
+				type int, the number of threads. Thread indexes passed to tasks are
+					less than this.
+		******************************************************************************/
+		int getThreadCount() const;
+
+		/******************************************************************************
+			Function Name: parallelFor
+
+			Des:
+				Runs task(i, threadIndex) for every i from 0 to taskCount - 1 and
+					waits for all of them to finish. No two tasks run at the same
+					time with the same threadIndex, so it can be used to pick
+					per-thread scratch space. Calls made from inside a task run
+					every task on the calling thread.
+
+			Params:
+				taskCount - type size_t, the number of tasks.
+				task - type const function<void(size_t, int)> &, the task to be run.
+
+			Throws:
+				Rethrows the first exception thrown by a task once every task has
+					finished.
+		******************************************************************************/
+		void parallelFor(size_t taskCount, const function<void(size_t, int)> &task);
+
+	private:
+
+		/******************************************************************************
+			Function Name: workerLoop
+
+			Des:
+				Waits for jobs and runs their tasks until the pool is stopped.
+
+			Params:
+				threadIndex - type int, the index of the worker.
+		******************************************************************************/
+		void workerLoop(int threadIndex);
+
+		/******************************************************************************
+			Function Name: runTasks
+
+			Des:
+				Runs tasks from the thread's own queue, then steals from the other
+					queues until no task is left.
+
+			Params:
+				threadIndex - type int, the index of the thread.
+		******************************************************************************/
+		void runTasks(int threadIndex);
+
+		/******************************************************************************
+			Function Name: takeTask
+
+			Des:
+				Takes the next task from the thread's own queue or steals one from
+					the back of another queue.
+
+			Params:
+				threadIndex - type int, the index of the thread.
+				task - type size_t &, output to get the task.
+
+			Returns:
+				type bool, true if a task was taken, otherwise false.
+		******************************************************************************/
+		bool takeTask(int threadIndex, size_t &task);
+	};
+}
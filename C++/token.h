@@ -0,0 +1,86 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: token.h
+
+	Author: Matthew Day
+
+	Description:
+		The typed token passed between the stages of ReversePolishNotation.
+		stripValuesFromEquation produces tokens in in-fix order,
+		convertInfixToPostFix reorders them into post-fix order and calcResult
+		evaluates them without re-parsing any text.
+******************************************************************************/
+
+#pragma once
+
+namespace day {
+
+	enum class Opcode : unsigned char {
+
+		// Operands, index is the slot of the value or variable
+		PUSH_VALUE,
+		PUSH_VARIABLE,
+		PUSH_NEGATIVE_ONE,
+
+		// Arithmetic operators
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		MODULO,
+		POWER,
+
+		// Unary minus, written for a '-' before '(' or a variable and by ExpressionOptimizer in place of
+		// multiplying by -1
+		NEGATE,
+
+		// Cheaper forms of '^' and '%' added by ExpressionOptimizer. They replace
+		// the operand on top of the stack and keep any integer operand in index
+		// Raises to the power of index by exponentiation by squaring
+		POWER_INTEGER,
+		// Square root, in place of raising to the power of 0.5
+		SQUARE_ROOT,
+		// '%' by index, which is a power of two
+		MODULO_POWER_OF_TWO,
+
+		// Bool operators. In an arithmetic equation they give 1 or 0, and numbers
+		// are true when they are not 0
+		NOT,
+		AND,
+		OR,
+		EQUAL,
+		NOT_EQUAL,
+
+		// Comparisons, only found in arithmetic equations, give 1 or 0
+		LESS,
+		LESS_EQUAL,
+		GREATER,
+		GREATER_EQUAL,
+
+		// Only found in in-fix token streams
+		OPENING_PARENTHESIS,
+		CLOSING_PARENTHESIS
+	};
+
+	struct Token {
+
+		Opcode opcode;
+		// Slot of the value or variable for operands, unused by operators
+		int index;
+	};
+}
@@ -0,0 +1,163 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedBatchEvaluator.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for typedBatchEvaluator.h
+
+	Outline:
+		Public Functions:
+			TypedBatchEvaluator
+			TypedBatchEvaluator
+			evaluate
+
+		Private Functions
+			prepare
+			evaluateBlock
+******************************************************************************/
+
+#include "typedBatchEvaluator.h"
+
+namespace day {
+
+	template <typename T>
+	TypedBatchEvaluator<T>::TypedBatchEvaluator() {
+	}
+
+	template <typename T>
+	TypedBatchEvaluator<T>::TypedBatchEvaluator(InstructionSet instructionSet) : kernels(instructionSet) {
+	}
+
+	template <typename T>
+	void TypedBatchEvaluator<T>::evaluate(const TypedExpression<T> &expression, const T *const *columns, T *output, size_t rows) {
+
+		prepare(expression, columns);
+
+		for (size_t first = 0; first < rows; first += BLOCK_SIZE) {
+
+			int count = rows - first < BLOCK_SIZE ? rows - first : BLOCK_SIZE;
+
+			evaluateBlock(expression, columns, first, count, output + first);
+		}
+	}
+
+	template <typename T>
+	void TypedBatchEvaluator<T>::prepare(const TypedExpression<T> &expression, const T *const *columns) {
+
+		if (columns == nullptr && expression.getVariableCount() > 0)
+			throw invalid_argument("Not every variable has a column bound to it");
+
+		for (int i = 0; i < expression.getVariableCount(); i++) {
+
+			if (columns[i] == nullptr)
+				throw invalid_argument("Not every variable has a column bound to it");
+		}
+
+		// Only grows, so an evaluator that is reused does not allocate again
+		if (scratch.size() < (size_t)expression.getMaxStackDepth() * BLOCK_SIZE) {
+
+			scratch.resize((size_t)expression.getMaxStackDepth() * BLOCK_SIZE);
+			operandStack.resize(expression.getMaxStackDepth());
+		}
+	}
+
+	template <typename T>
+	void TypedBatchEvaluator<T>::evaluateBlock(const TypedExpression<T> &expression, const T *const *columns, size_t first, int count, T *output) {
+
+		const vector<Token> &postFix = expression.getPostFix();
+		const vector<T> &values = expression.getValues();
+		// Number of operands on the stack, the top operand is operandStack[depth - 1]
+		int depth = 0;
+
+		for (const Token &token : postFix) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = { nullptr, values[token.index], true };
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					// Columns are read in place instead of being copied to the stack
+					operandStack[depth++] = { columns[token.index] + first, 0, false };
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack[depth++] = { nullptr, -1, true };
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER: {
+
+					Operand &top = operandStack[depth - 1];
+					// Exponent of POWER_INTEGER kept in the token
+					T tokenOperand = token.index;
+
+					if (top.isScalar) {
+
+						kernels.apply(token.opcode, &top.scalar, true, &tokenOperand, true, &top.scalar, 1);
+					} else {
+
+						T *result = scratch.data() + (size_t)(depth - 1) * BLOCK_SIZE;
+
+						kernels.apply(token.opcode, top.data, false, &tokenOperand, true, result, count);
+						top = { result, 0, false };
+					}
+
+					break;
+				}
+				default:
+
+					// Every other opcode left by TypedExpression is a binary operator
+					Operand &left = operandStack[depth - 2];
+					const Operand &right = operandStack[depth - 1];
+
+					if (left.isScalar && right.isScalar) {
+
+						kernels.apply(token.opcode, &left.scalar, true, &right.scalar, true, &left.scalar, 1);
+					} else {
+
+						T *result = scratch.data() + (size_t)(depth - 2) * BLOCK_SIZE;
+
+						kernels.apply(token.opcode, left.isScalar ? &left.scalar : left.data, left.isScalar, right.isScalar ? &right.scalar : right.data, right.isScalar, result, count);
+						left = { result, 0, false };
+					}
+
+					depth--;
+			};
+		}
+
+		if (operandStack[0].isScalar) {
+
+			for (int i = 0; i < count; i++)
+				output[i] = operandStack[0].scalar;
+		} else {
+
+			for (int i = 0; i < count; i++)
+				output[i] = operandStack[0].data[i];
+		}
+	}
+
+	template class TypedBatchEvaluator<float>;
+	template class TypedBatchEvaluator<double>;
+	template class TypedBatchEvaluator<int64_t>;
+	template class TypedBatchEvaluator<long double>;
+}
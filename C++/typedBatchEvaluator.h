@@ -0,0 +1,167 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedBatchEvaluator.h
+
+	Author: Matthew Day
+
+	Class Name: TypedBatchEvaluator
+
+	Description:
+		Evaluates a TypedExpression over many rows at once, like
+		BatchEvaluator does for a CompiledExpression. The rows are split into
+		blocks of BLOCK_SIZE and each operator runs over a whole block on the
+		TypedKernels of T, so the number of rows handled by one instruction
+		follows the size of T.
+
+		An evaluator reuses its scratch space between calls, so each thread
+		should use its own evaluator.
+
+	Outline:
+		Public Functions:
+			TypedBatchEvaluator
+			TypedBatchEvaluator
+			evaluate
+
+		Private Functions
+			prepare
+			evaluateBlock
+******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "typedExpression.h"
+#include "typedKernels.h"
+#include "token.h"
+
+using std::vector;
+using std::size_t;
+using std::int64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	template <typename T>
+	class TypedBatchEvaluator {
+
+	public:
+
+		// Number of rows evaluated together, as in BatchEvaluator
+		static const int BLOCK_SIZE = 1024;
+	private:
+
+		// An entry on the operand stack, either a single value shared by every row or a block of values
+		struct Operand {
+
+			const T *data;
+			T scalar;
+			bool isScalar;
+		};
+
+		// One block of BLOCK_SIZE values for each level of the operand stack
+		vector<T> scratch;
+		vector<Operand> operandStack;
+		TypedKernels<T> kernels;
+	public:
+
+		/******************************************************************************
+			Function Name: TypedBatchEvaluator
+
+			Des:
+				Uses the widest instruction set supported by the CPU.
+		******************************************************************************/
+		TypedBatchEvaluator();
+
+		/******************************************************************************
+			Function Name: TypedBatchEvaluator
+
+			Des:
+				Uses the given instruction set if the CPU supports it.
+
+			Params:
+				instructionSet - type InstructionSet, the requested instruction set.
+		******************************************************************************/
+		TypedBatchEvaluator(InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation for every row.
+
+			Params:
+				expression - type const TypedExpression<T> &, the equation to be
+					evaluated.
+				columns - type const T * const *, one column for each variable slot
+					of param expression, each holding param rows values.
+				output - type T *, output column to get the answer for each row.
+				rows - type size_t, the number of rows.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void evaluate(const TypedExpression<T> &expression, const T *const *columns, T *output, size_t rows);
+
+	private:
+
+		/******************************************************************************
+			Function Name: prepare
+
+			Des:
+				Checks the columns and grows the scratch space for the equation.
+
+			Params:
+				expression - type const TypedExpression<T> &, the equation to be
+					evaluated.
+				columns - type const T * const *, one column for each variable slot
+					of param expression.
+
+			Throws:
+				Throws exception if a column is missing.
+		******************************************************************************/
+		void prepare(const TypedExpression<T> &expression, const T *const *columns);
+
+		/******************************************************************************
+			Function Name: evaluateBlock
+
+			Des:
+				Evaluates the equation for a single block of rows.
+
+			Params:
+				expression - type const TypedExpression<T> &, the equation to be
+					evaluated.
+				columns - type const T * const *, one column for each variable slot
+					of param expression.
+				first - type size_t, the first row of the block.
+				count - type int, the number of rows in the block.
+				output - type T *, output to get the answer for each row of the
+					block.
+		******************************************************************************/
+		void evaluateBlock(const TypedExpression<T> &expression, const T *const *columns, size_t first, int count, T *output);
+	};
+
+	// Defined for these types only, in typedBatchEvaluator.cpp
+	extern template class TypedBatchEvaluator<float>;
+	extern template class TypedBatchEvaluator<double>;
+	extern template class TypedBatchEvaluator<int64_t>;
+	extern template class TypedBatchEvaluator<long double>;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedExpression.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for typedExpression.h
+
+	Outline:
+		Public Functions:
+			TypedExpression
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getMaxStackDepth
+			getPostFix
+			getValues
+
+		Private Functions:
+			toValue
+			isIntegerPower
+******************************************************************************/
+
+#include "typedExpression.h"
+
+#include <cmath>
+#include <climits>
+#include <type_traits>
+
+using std::is_integral;
+
+namespace day {
+
+	template <typename T>
+	TypedExpression<T>::TypedExpression(const char *equation, int length) {
+
+		// Folding by ExpressionOptimizer would be done in double, so the equation is taken as written
+		CompiledExpression compiled(equation, length, OptimizationLevel::NONE);
+		const vector<double> &numbers = compiled.getValues();
+
+		// An operand on the stack while lowering, where its tokens start and its value if it is constant
+		struct Operand {
+
+			size_t start;
+			bool constant;
+			T value;
+		};
+
+		vector<Operand> operandStack;
+
+		variableNames = compiled.getVariableNames();
+		maxStackDepth = compiled.getMaxStackDepth();
+
+		// Replaces the tokens of an operand from start on with a single value
+		auto pushValue = [&](size_t start, T value) {
+
+			postFix.resize(start);
+			postFix.push_back({ Opcode::PUSH_VALUE, (int)values.size() });
+			values.push_back(value);
+			operandStack.push_back({ start, true, value });
+		};
+
+		for (const Token &token : compiled.getPostFix()) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					pushValue(postFix.size(), toValue(numbers[token.index]));
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack.push_back({ postFix.size(), true, (T)-1 });
+					postFix.push_back(token);
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack.push_back({ postFix.size(), false, 0 });
+					postFix.push_back(token);
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE: {
+
+					Operand top = operandStack.back();
+
+					operandStack.pop_back();
+
+					if (top.constant) {
+
+						pushValue(top.start, TypedKernels<T>::calculate(token.opcode, top.value, 0));
+					} else {
+
+						postFix.push_back(token);
+						operandStack.push_back(top);
+					}
+
+					break;
+				}
+				default: {
+
+					// Every other opcode left by validatePostFix without optimizing is a binary operator
+					Operand right = operandStack.back();
+
+					operandStack.pop_back();
+
+					Operand left = operandStack.back();
+
+					operandStack.pop_back();
+
+					if (left.constant && right.constant) {
+
+						pushValue(left.start, TypedKernels<T>::calculate(token.opcode, left.value, right.value));
+					} else if (token.opcode == Opcode::POWER && right.constant && isIntegerPower(right.value)) {
+
+						postFix.resize(right.start);
+						postFix.push_back({ Opcode::POWER_INTEGER, (int)right.value });
+						operandStack.push_back({ left.start, false, 0 });
+					} else {
+
+						postFix.push_back(token);
+						operandStack.push_back({ left.start, false, 0 });
+					}
+				}
+			};
+		}
+	}
+
+	template <typename T>
+	T TypedExpression<T>::evaluate(const vector<T> &variableValues) const {
+
+		if (variableValues.size() < variableNames.size())
+			throw invalid_argument("Not every variable has a value bound to it");
+
+		// The equation was validated when compiled so it is evaluated without any checks
+		vector<T> operandStack(maxStackDepth);
+		int depth = 0;
+
+		for (const Token &token : postFix) {
+
+			switch (token.opcode) {
+
+				case Opcode::PUSH_VALUE:
+
+					operandStack[depth++] = values[token.index];
+					break;
+				case Opcode::PUSH_NEGATIVE_ONE:
+
+					operandStack[depth++] = -1;
+					break;
+				case Opcode::PUSH_VARIABLE:
+
+					operandStack[depth++] = variableValues[token.index];
+					break;
+				case Opcode::NOT:
+				case Opcode::NEGATE:
+				case Opcode::POWER_INTEGER:
+
+					// The exponent of POWER_INTEGER is kept in the token
+					operandStack[depth - 1] = TypedKernels<T>::calculate(token.opcode, operandStack[depth - 1], token.index);
+					break;
+				default:
+
+					depth--;
+					operandStack[depth - 1] = TypedKernels<T>::calculate(token.opcode, operandStack[depth - 1], operandStack[depth]);
+			};
+		}
+
+		return operandStack[0];
+	}
+
+	template <typename T>
+	int TypedExpression<T>::getVariableCount() const {
+
+		return variableNames.size();
+	}
+
+	template <typename T>
+	int TypedExpression<T>::getVariableIndex(const string &name) const {
+
+		for (size_t i = 0; i < variableNames.size(); i++)
+			if (variableNames[i] == name)
+				return i;
+
+		return -1;
+	}
+
+	template <typename T>
+	const vector<string> &TypedExpression<T>::getVariableNames() const {
+
+		return variableNames;
+	}
+
+	template <typename T>
+	int TypedExpression<T>::getMaxStackDepth() const {
+
+		return maxStackDepth;
+	}
+
+	template <typename T>
+	const vector<Token> &TypedExpression<T>::getPostFix() const {
+
+		return postFix;
+	}
+
+	template <typename T>
+	const vector<T> &TypedExpression<T>::getValues() const {
+
+		return values;
+	}
+
+	template <typename T>
+	T TypedExpression<T>::toValue(double number) {
+
+		if constexpr (is_integral<T>::value) {
+
+			// 2^63 is the first double past the range of int64_t
+			if (number != std::trunc(number) || number < -9223372036854775808.0 || number >= 9223372036854775808.0)
+				throw invalid_argument("Number is not an integer");
+		}
+
+		return (T)number;
+	}
+
+	template <typename T>
+	bool TypedExpression<T>::isIntegerPower(T exponent) {
+
+		if constexpr (is_integral<T>::value)
+			return exponent > INT_MIN && exponent <= INT_MAX;
+		else
+			return exponent == 2 || exponent == -1;
+	}
+
+	template class TypedExpression<float>;
+	template class TypedExpression<double>;
+	template class TypedExpression<int64_t>;
+	template class TypedExpression<long double>;
+}
@@ -0,0 +1,238 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedExpression.h
+
+	Author: Matthew Day
+
+	Class Name: TypedExpression
+
+	Description:
+		A compiled equation whose values and answers are of type T, one of
+		float, double, int64_t and long double, evaluated by TypedKernels.
+		float halves the memory of each column and doubles the number of
+		values in a vector register, int64_t gives exact integer arithmetic,
+		and long double gives more precision where the CPU has it.
+
+		Tokenizing, validating and converting to post-fix do not depend on
+		the type and are done by CompiledExpression without optimizing. The
+		post-fix equation is then lowered to T: each number is converted to
+		T, operators on numbers only are folded in the arithmetic of T, so
+		7/2 is 3 for int64_t and 3.5 otherwise, and '^' by a constant becomes
+		POWER_INTEGER where that is exact: by any int for int64_t, and by 2
+		or -1 for the other types, where x*x and 1/x round like pow.
+
+		Numbers are parsed as double before they are converted, so a number
+		in an int64_t equation must be an integer and is exact up to 2^53, and
+		a number in a long double equation only has the precision of double.
+
+	Outline:
+		Public Functions:
+			TypedExpression
+			evaluate
+			getVariableCount
+			getVariableIndex
+			getVariableNames
+			getMaxStackDepth
+			getPostFix
+			getValues
+
+		Private Functions:
+			toValue
+			isIntegerPower
+******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "compiledExpression.h"
+#include "typedKernels.h"
+#include "token.h"
+
+using std::string;
+using std::vector;
+using std::int64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	template <typename T>
+	class TypedExpression {
+
+	private:
+
+		// The equation in post-fix notation, lowered to T
+		vector<Token> postFix;
+		// Values corresponding to the PUSH_VALUE tokens in the post-fix equation
+		vector<T> values;
+		// Names of the variables in the order of their slots
+		vector<string> variableNames;
+		// Maximum depth of the operand stack
+		int maxStackDepth;
+	public:
+
+		/******************************************************************************
+			Function Name: TypedExpression
+
+			Des:
+				Compiles the equation for values of type T.
+
+			Params:
+				equation - type const char *, the in-fix equation to be compiled.
+					Example input: hits%60 + misses*2.
+				length - type int, the length of the param equation.
+
+			Throws:
+				Throws exception if the equation is invalid, or has a number that is
+					not an integer when T is int64_t.
+		******************************************************************************/
+		TypedExpression(const char *equation, int length);
+
+		/******************************************************************************
+			Function Name: evaluate
+
+			Des:
+				Evaluates the equation with the values bound to its variables.
+
+			Params:
+				variableValues - type const vector<T> &, the value of each variable
+					in the order of their slots.
+
+			Returns:
+				type T, the answer to the equation.
+
+			Throws:
+				Throws exception if not every variable has a value bound to it.
+		******************************************************************************/
+		T evaluate(const vector<T> &variableValues) const;
+
+		/******************************************************************************
+			Function Name: getVariableCount
+
+			Des:
+				Gets the number of distinct variables used in the equation.
+
+			Returns:
+				type int, the number of variable slots.
+		******************************************************************************/
+		int getVariableCount() const;
+
+		/******************************************************************************
+			Function Name: getVariableIndex
+
+			Des:
+				Finds the slot of the variable with the given name.
+
+			Params:
+				name - type const string &, the name of the variable.
+
+			Returns:
+				type int, the slot of the variable or -1 if the equation does not use it.
+		******************************************************************************/
+		int getVariableIndex(const string &name) const;
+
+		/******************************************************************************
+			Function Name: getVariableNames
+
+			Des:
+				Gets the names of the variables in the order of their slots.
+
+			Returns:
+				type const vector<string> &, the names of the variables.
+		******************************************************************************/
+		const vector<string> &getVariableNames() const;
+
+		/******************************************************************************
+			Function Name: getMaxStackDepth
+
+			Des:
+				Gets the maximum number of operands on the stack while evaluating.
+
+			Returns:
+				type int, the maximum depth of the operand stack.
+		******************************************************************************/
+		int getMaxStackDepth() const;
+
+		/******************************************************************************
+			Function Name: getPostFix
+
+			Des:
+				Gets the lowered equation in post-fix notation.
+
+			Returns:
+				type const vector<Token> &, the post-fix equation.
+		******************************************************************************/
+		const vector<Token> &getPostFix() const;
+
+		/******************************************************************************
+			Function Name: getValues
+
+			Des:
+				Gets the values corresponding to the PUSH_VALUE tokens in the post-fix
+					equation.
+
+			Returns:
+				type const vector<T> &, the values of the equation.
+		******************************************************************************/
+		const vector<T> &getValues() const;
+
+	private:
+
+		/******************************************************************************
+			Function Name: toValue
+
+			Des:
+				Converts a parsed number to T.
+
+			Params:
+				number - type double, the number as parsed.
+
+			Returns:
+				type T, the number as T.
+
+			Throws:
+				Throws exception if T is int64_t and the number is not an integer
+					in its range.
+		******************************************************************************/
+		static T toValue(double number);
+
+		/******************************************************************************
+			Function Name: isIntegerPower
+
+			Des:
+				Checks if '^' by a constant can be done by POWER_INTEGER with the
+					same answer.
+
+			Params:
+				exponent - type T, the constant exponent.
+
+			Returns:
+				type bool, true if the exponent can be kept in the token.
+		******************************************************************************/
+		static bool isIntegerPower(T exponent);
+	};
+
+	// Defined for these types only, in typedExpression.cpp
+	extern template class TypedExpression<float>;
+	extern template class TypedExpression<double>;
+	extern template class TypedExpression<int64_t>;
+	extern template class TypedExpression<long double>;
+}
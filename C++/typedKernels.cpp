@@ -0,0 +1,389 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedKernels.cpp
+
+	Author: Matthew Day
+
+	Description:
+		Implementation file for typedKernels.h
+
+		The vector loops are written once with GCC vector extensions and
+		compiled for each instruction set by the target attribute of the
+		function they are inlined into, so a vector is 16, 32 or 64 bytes
+		wide whatever the type of its values.
+
+	Outline:
+		Public Functions:
+			TypedKernels
+			TypedKernels
+			apply
+			calculate
+			getInstructionSet
+******************************************************************************/
+
+#include "typedKernels.h"
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+using std::uint64_t;
+using std::memcpy;
+using std::is_integral;
+using std::is_same;
+using std::conditional;
+
+namespace day {
+
+	// '/' by 0 and the smallest int64_t divided by -1 have no answer in C++, so they are given one
+	static inline int64_t divideValues(int64_t left, int64_t right) {
+
+		if (right == 0)
+			return 0;
+
+		return right == -1 ? (int64_t)(0 - (uint64_t)left) : left / right;
+	}
+
+	template <typename T>
+	static inline T divideValues(T left, T right) {
+
+		return left / right;
+	}
+
+	static inline int64_t moduloValues(int64_t left, int64_t right) {
+
+		return right == 0 || right == -1 ? 0 : left % right;
+	}
+
+	// WARNING: Conversion to integer causes decimal data to be lost, like calcResult
+	template <typename T>
+	static inline T moduloValues(T left, T right) {
+
+		return (int)left % (int)right;
+	}
+
+	// Exponentiation by squaring, wrapping around on overflow
+	static inline int64_t powerValues(int64_t base, int64_t exponent) {
+
+		if (exponent < 0)
+			return base == 1 ? 1 : base == -1 ? ((exponent & 1) ? -1 : 1) : 0;
+
+		uint64_t result = 1;
+		uint64_t square = base;
+
+		for (uint64_t power = exponent; power != 0; power >>= 1) {
+
+			if (power & 1)
+				result *= square;
+
+			if (power > 1)
+				square *= square;
+		}
+
+		return result;
+	}
+
+	template <typename T>
+	static inline T powerValues(T base, T exponent) {
+
+		return std::pow(base, exponent);
+	}
+
+	static inline int64_t powerIntegerValues(int64_t base, int64_t exponent) {
+
+		return powerValues(base, exponent);
+	}
+
+	// Same multiplications in the same order as calcOperator
+	template <typename T>
+	static inline T powerIntegerValues(T base, T exponent) {
+
+		unsigned int power = exponent < 0 ? 0u - (unsigned int)(int)exponent : (unsigned int)exponent;
+		T result = 1;
+
+		for (; power != 0; power >>= 1) {
+
+			if (power & 1)
+				result *= base;
+
+			if (power > 1)
+				base *= base;
+		}
+
+		return exponent < 0 ? 1 / result : result;
+	}
+
+	template <typename T>
+	static inline T calculateValue(Opcode opcode, T left, T right) {
+
+		// int64_t works on the bits as uint64_t where it may overflow, which wraps around instead of being undefined
+		const bool WRAPS = is_integral<T>::value;
+
+		switch (opcode) {
+
+			case Opcode::ADD:
+
+				return WRAPS ? (T)((uint64_t)left + (uint64_t)right) : left + right;
+			case Opcode::SUBTRACT:
+
+				return WRAPS ? (T)((uint64_t)left - (uint64_t)right) : left - right;
+			case Opcode::MULTIPLY:
+
+				return WRAPS ? (T)((uint64_t)left * (uint64_t)right) : left * right;
+			case Opcode::DIVIDE:
+
+				return divideValues(left, right);
+			case Opcode::MODULO:
+
+				return moduloValues(left, right);
+			case Opcode::POWER:
+
+				return powerValues(left, right);
+			case Opcode::POWER_INTEGER:
+
+				return powerIntegerValues(left, right);
+			case Opcode::NEGATE:
+
+				return WRAPS ? (T)(0 - (uint64_t)left) : -left;
+			case Opcode::NOT:
+
+				return left == 0;
+			case Opcode::AND:
+
+				return left != 0 && right != 0;
+			case Opcode::OR:
+
+				return left != 0 || right != 0;
+			case Opcode::EQUAL:
+
+				return left == right;
+			case Opcode::NOT_EQUAL:
+
+				return left != right;
+			case Opcode::LESS:
+
+				return left < right;
+			case Opcode::LESS_EQUAL:
+
+				return left <= right;
+			case Opcode::GREATER:
+
+				return left > right;
+			case Opcode::GREATER_EQUAL:
+
+				return left >= right;
+			default:
+
+				throw invalid_argument("Operator is not supported for typed values");
+		};
+	}
+
+#if defined(__GNUC__)
+	// Applies one of the operators with a vector form to every full vector of BYTES bytes
+	template <typename T, int BYTES, Opcode OPCODE>
+	static inline __attribute__((always_inline)) int applyVectors(const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		typedef typename conditional<is_integral<T>::value, uint64_t, T>::type Element;
+		typedef Element Vector __attribute__((vector_size(BYTES)));
+		const int WIDTH = BYTES / sizeof(T);
+		int i = 0;
+
+		for (; i + WIDTH <= count; i += WIDTH) {
+
+			Vector num1, num2, answer;
+
+			memcpy(&num1, left + i * leftStride, BYTES);
+			memcpy(&num2, right + i * rightStride, BYTES);
+
+			if constexpr (OPCODE == Opcode::ADD)
+				answer = num1 + num2;
+			else if constexpr (OPCODE == Opcode::SUBTRACT)
+				answer = num1 - num2;
+			else if constexpr (OPCODE == Opcode::MULTIPLY)
+				answer = num1 * num2;
+			else if constexpr (OPCODE == Opcode::DIVIDE)
+				answer = num1 / num2;
+			else
+				answer = -num1;
+
+			memcpy(result + i, &answer, BYTES);
+		}
+
+		return i;
+	}
+#endif
+
+	// Runs the vector loops where BYTES is not 0, and plain loops for the other operators and the values left over
+	template <typename T, int BYTES>
+	static inline __attribute__((always_inline)) void applyValues(Opcode opcode, const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		int i = 0;
+
+#if defined(__GNUC__)
+		if constexpr (BYTES > 0) {
+
+			switch (opcode) {
+
+				case Opcode::ADD:
+
+					i = applyVectors<T, BYTES, Opcode::ADD>(left, leftStride, right, rightStride, result, count);
+					break;
+				case Opcode::SUBTRACT:
+
+					i = applyVectors<T, BYTES, Opcode::SUBTRACT>(left, leftStride, right, rightStride, result, count);
+					break;
+				case Opcode::MULTIPLY:
+
+					i = applyVectors<T, BYTES, Opcode::MULTIPLY>(left, leftStride, right, rightStride, result, count);
+					break;
+				case Opcode::DIVIDE:
+
+					// Integers need the checks of divideValues
+					if constexpr (!is_integral<T>::value)
+						i = applyVectors<T, BYTES, Opcode::DIVIDE>(left, leftStride, right, rightStride, result, count);
+					break;
+				case Opcode::NEGATE:
+
+					i = applyVectors<T, BYTES, Opcode::NEGATE>(left, leftStride, right, rightStride, result, count);
+					break;
+				default:
+
+					break;
+			};
+		}
+#endif
+
+		for (; i < count; i++)
+			result[i] = calculateValue(opcode, left[i * leftStride], right[i * rightStride]);
+	}
+
+	template <typename T>
+	static void applyScalar(Opcode opcode, const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		applyValues<T, 0>(opcode, left, leftStride, right, rightStride, result, count);
+	}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	template <typename T>
+	__attribute__((target("sse2")))
+	static void applySse2(Opcode opcode, const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		applyValues<T, 16>(opcode, left, leftStride, right, rightStride, result, count);
+	}
+
+	template <typename T>
+	__attribute__((target("avx2")))
+	static void applyAvx2(Opcode opcode, const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		applyValues<T, 32>(opcode, left, leftStride, right, rightStride, result, count);
+	}
+
+	template <typename T>
+	__attribute__((target("avx512f")))
+	static void applyAvx512(Opcode opcode, const T *left, int leftStride, const T *right, int rightStride, T *result, int count) {
+
+		applyValues<T, 64>(opcode, left, leftStride, right, rightStride, result, count);
+	}
+#endif
+
+	template <typename T>
+	TypedKernels<T>::TypedKernels() {
+
+		instructionSet = SimdKernels::detectInstructionSet();
+	}
+
+	template <typename T>
+	TypedKernels<T>::TypedKernels(InstructionSet instructionSet) {
+
+		InstructionSet supported = SimdKernels::detectInstructionSet();
+
+		this->instructionSet = instructionSet <= supported ? instructionSet : supported;
+	}
+
+	template <typename T>
+	void TypedKernels<T>::apply(Opcode opcode, const T *left, bool leftIsScalar, const T *right, bool rightIsScalar, T *result, int count) const {
+
+		// Scalar operands are copied to a full vector so that every kernel can load them with a stride of 0
+		T leftBroadcast[MAX_WIDTH];
+		T rightBroadcast[MAX_WIDTH];
+		int leftStride = 1, rightStride = 1;
+
+		if (leftIsScalar) {
+
+			for (int i = 0; i < MAX_WIDTH; i++)
+				leftBroadcast[i] = left[0];
+
+			left = leftBroadcast;
+			leftStride = 0;
+		}
+
+		if (rightIsScalar) {
+
+			for (int i = 0; i < MAX_WIDTH; i++)
+				rightBroadcast[i] = right[0];
+
+			right = rightBroadcast;
+			rightStride = 0;
+		}
+
+		// long double has no vector registers
+		if constexpr (is_same<T, long double>::value) {
+
+			applyScalar(opcode, left, leftStride, right, rightStride, result, count);
+		} else {
+
+			switch (instructionSet) {
+
+#if defined(__GNUC__) && defined(__x86_64__)
+				case InstructionSet::AVX512:
+
+					applyAvx512(opcode, left, leftStride, right, rightStride, result, count);
+					break;
+				case InstructionSet::AVX2:
+
+					applyAvx2(opcode, left, leftStride, right, rightStride, result, count);
+					break;
+				case InstructionSet::SSE2:
+
+					applySse2(opcode, left, leftStride, right, rightStride, result, count);
+					break;
+#endif
+				default:
+
+					applyScalar(opcode, left, leftStride, right, rightStride, result, count);
+			};
+		}
+	}
+
+	template <typename T>
+	T TypedKernels<T>::calculate(Opcode opcode, T left, T right) {
+
+		return calculateValue(opcode, left, right);
+	}
+
+	template <typename T>
+	InstructionSet TypedKernels<T>::getInstructionSet() const {
+
+		return instructionSet;
+	}
+
+	template class TypedKernels<float>;
+	template class TypedKernels<double>;
+	template class TypedKernels<int64_t>;
+	template class TypedKernels<long double>;
+}
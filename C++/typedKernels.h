@@ -0,0 +1,163 @@
+/******************************************************************************
+	Copyright 2018 Matthew Day
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	https://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+******************************************************************************/
+
+/******************************************************************************
+	File Name: typedKernels.h
+
+	Author: Matthew Day
+
+	Class Name: TypedKernels
+
+	Description:
+		Applies the operators to whole blocks of values of type T, for float,
+		double, int64_t and long double. Like SimdKernels, the widest
+		instruction set is detected at run time. '+', '-', '*', '/' and unary
+		minus run on vectors of the full register width, so a vector of floats
+		holds twice as many values as one of doubles, and the other operators
+		are plain loops. long double has no vector registers and is always
+		plain loops.
+
+		float and long double follow the rules of double, including '%'
+		truncating both operands to int.
+
+		int64_t is exact integer arithmetic. '+', '-' and '*' wrap around on
+		overflow, '/' truncates toward 0 and '%' is the remainder of the
+		operands themselves, with the sign of the first. As integers have no
+		infinity, x/0 and x%0 are 0, and so is x^y for a negative y unless x
+		is 1 or -1. The smallest int64_t divided by -1 wraps around to itself.
+		Comparisons and bool operators give 1 or 0 for every type.
+
+		The double instantiation gives the same answers as SimdKernels, which
+		stays the kernel of BatchEvaluator.
+
+	Outline:
+		Public Functions:
+			TypedKernels
+			TypedKernels
+			apply
+			calculate
+			getInstructionSet
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "simdKernels.h"
+#include "token.h"
+
+using std::int64_t;
+using std::invalid_argument;
+
+namespace day {
+
+	template <typename T>
+	class TypedKernels {
+
+	private:
+
+		InstructionSet instructionSet;
+	public:
+
+		// Widest number of values of T handled by a single instruction, 16 floats in a 512-bit register
+		static const int MAX_WIDTH = 16;
+
+		/******************************************************************************
+			Function Name: TypedKernels
+
+			Des:
+				Uses the widest instruction set supported by the CPU.
+		******************************************************************************/
+		TypedKernels();
+
+		/******************************************************************************
+			Function Name: TypedKernels
+
+			Des:
+				Uses the given instruction set, or the widest one supported by the
+					CPU if it does not support the given one.
+
+			Params:
+				instructionSet - type InstructionSet, the requested instruction set.
+		******************************************************************************/
+		TypedKernels(InstructionSet instructionSet);
+
+		/******************************************************************************
+			Function Name: apply
+
+			Des:
+				Applies an operator to every value of a block.
+
+			Params:
+				opcode - type Opcode, the operator. For POWER_INTEGER param right
+					holds the exponent.
+				left - type const T *, the left operands, or the only operands of a
+					unary operator.
+				leftIsScalar - type bool, true if param left is a single value used
+					for every row.
+				right - type const T *, the right operands.
+				rightIsScalar - type bool, true if param right is a single value used
+					for every row.
+				result - type T *, output to get the answers. May be param left or
+					param right.
+				count - type int, the number of values.
+
+			Throws:
+				Throws exception if the operator is not supported for typed values.
+		******************************************************************************/
+		void apply(Opcode opcode, const T *left, bool leftIsScalar, const T *right, bool rightIsScalar, T *result, int count) const;
+
+		/******************************************************************************
+			Function Name: calculate
+
+			Des:
+				Applies an operator to a single pair of values, with the same
+					answer as apply.
+
+			Params:
+				opcode - type Opcode, the operator.
+				left - type T, the left operand, or the only operand of a unary
+					operator.
+				right - type T, the right operand, or the exponent of
+					POWER_INTEGER.
+
+			Returns:
+				type T, the answer.
+
+			Throws:
+				Throws exception if the operator is not supported for typed values.
+		******************************************************************************/
+		static T calculate(Opcode opcode, T left, T right);
+
+		/******************************************************************************
+			Function Name: getInstructionSet
+
+			Des:
+				Gets the instruction set used by apply.
+
+			Returns:
+				type InstructionSet, the instruction set in use.
+		******************************************************************************/
+		InstructionSet getInstructionSet() const;
+	};
+
+	// Defined for these types only, in typedKernels.cpp
+	extern template class TypedKernels<float>;
+	extern template class TypedKernels<double>;
+	extern template class TypedKernels<int64_t>;
+	extern template class TypedKernels<long double>;
+}